@@ -17,6 +17,8 @@
 #ifndef ANJAY_INCLUDE_ANJAY_MODULES_DM_MODULES_H
 #define ANJAY_INCLUDE_ANJAY_MODULES_DM_MODULES_H
 
+#include <avsystem/commons/stream.h>
+
 #include <anjay/dm.h>
 
 #include <anjay_modules/notify.h>
@@ -25,6 +27,24 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 
 typedef void anjay_dm_module_deleter_t(anjay_t *anjay, void *arg);
 
+typedef int anjay_dm_module_persist_t(anjay_t *anjay,
+                                      avs_stream_abstract_t *out_stream);
+
+typedef int anjay_dm_module_restore_t(anjay_t *anjay,
+                                      avs_stream_abstract_t *in_stream);
+
+typedef enum {
+    /**
+     * State of modules that implement LwM2M Objects themselves.
+     */
+    ANJAY_DM_MODULE_SNAPSHOT_OBJECTS,
+    /**
+     * State that refers to Instances of other Objects, which therefore needs
+     * to be restored after all the Objects have been restored.
+     */
+    ANJAY_DM_MODULE_SNAPSHOT_METADATA
+} anjay_dm_module_snapshot_stage_t;
+
 typedef struct {
     /**
      * Global overlay of handlers that may replace handlers natively declared
@@ -68,6 +88,26 @@ typedef struct {
      * up any resources used by it.
      */
     anjay_dm_module_deleter_t *deleter;
+
+    /**
+     * Name of the section holding the module state in snapshots created by
+     * @ref anjay_snapshot_persist, or <c>NULL</c> if the module state is not
+     * a part of the snapshot. If set, <c>persist</c> and <c>restore</c> shall
+     * also be set.
+     */
+    const char *snapshot_name;
+
+    /**
+     * Determines the order in which snapshot sections are restored.
+     */
+    anjay_dm_module_snapshot_stage_t snapshot_stage;
+
+    /**
+     * Functions that dump and load the module state, e.g. the public
+     * <c>*_persist</c> and <c>*_restore</c> APIs of the module.
+     */
+    anjay_dm_module_persist_t *persist;
+    anjay_dm_module_restore_t *restore;
 } anjay_dm_module_t;
 
 /**
@@ -100,6 +100,7 @@ static inline bool _anjay_uri_path_equal(const anjay_uri_path_t *left,
 
 typedef enum anjay_request_action {
     ANJAY_ACTION_READ,
+    ANJAY_ACTION_READ_COMPOSITE,
     ANJAY_ACTION_DISCOVER,
     ANJAY_ACTION_WRITE,
     ANJAY_ACTION_WRITE_UPDATE,
@@ -284,6 +285,11 @@ int _anjay_dm_resource_read(anjay_t *anjay,
                             anjay_rid_t rid,
                             anjay_output_ctx_t *ctx,
                             const anjay_dm_module_t *current_module);
+int _anjay_dm_instance_read(anjay_t *anjay,
+                            const anjay_dm_object_def_t *const *obj_ptr,
+                            anjay_iid_t iid,
+                            anjay_output_ctx_t *ctx,
+                            const anjay_dm_module_t *current_module);
 int _anjay_dm_resource_write(anjay_t *anjay,
                              const anjay_dm_object_def_t *const *obj_ptr,
                              anjay_iid_t iid,
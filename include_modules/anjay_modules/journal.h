@@ -0,0 +1,82 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_MODULES_JOURNAL_H
+#define ANJAY_INCLUDE_ANJAY_MODULES_JOURNAL_H
+
+#include <stdbool.h>
+
+#include <avsystem/commons/stream.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Size of the magic constant that identifies records of a given journal.
+ */
+#define ANJAY_JOURNAL_MAGIC_SIZE 4
+
+typedef int anjay_journal_record_writer_t(avs_stream_abstract_t *out_stream,
+                                          void *arg);
+
+typedef int anjay_journal_record_handler_t(avs_stream_abstract_t *in_stream,
+                                           void *arg);
+
+/**
+ * Appends a single record to an append-only persistence journal.
+ *
+ * The record payload is whatever @p writer writes into the stream passed to
+ * it. It is framed with @p magic (@ref ANJAY_JOURNAL_MAGIC_SIZE bytes long),
+ * its size and a CRC-32, and written to @p out_stream using a single write
+ * call, so that a record torn by a power failure can be recognized by
+ * @ref _anjay_journal_replay .
+ *
+ * @returns 0 on success, a negative value in case of error. If @p writer
+ *          fails, nothing is written.
+ */
+int _anjay_journal_append(avs_stream_abstract_t *out_stream,
+                          const char *magic,
+                          anjay_journal_record_writer_t *writer,
+                          void *arg);
+
+/**
+ * Reads all records from @p in_stream and calls @p handler for the payload of
+ * each of them, in order.
+ *
+ * A truncated or damaged record is treated as the end of the journal, as it
+ * is the expected result of an interrupted append; records that follow it are
+ * not replayed. Memory is only allocated for payload data actually present in
+ * @p in_stream , so a damaged size field cannot cause a huge allocation.
+ *
+ * Anything appended after such a record would never be replayed, so the caller
+ * is informed about it through @p out_damaged_tail and shall write the state
+ * into a new journal before appending any further records.
+ *
+ * @param out_damaged_tail Set to true if replay succeeded, but the journal
+ *                         ended with a truncated or damaged record.
+ *
+ * @returns Number of records replayed, or a negative value if reading the
+ *          stream failed, a record with a valid checksum but an unexpected
+ *          magic constant was found, or @p handler failed.
+ */
+int _anjay_journal_replay(avs_stream_abstract_t *in_stream,
+                          const char *magic,
+                          anjay_journal_record_handler_t *handler,
+                          void *arg,
+                          bool *out_damaged_tail);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_INCLUDE_ANJAY_MODULES_JOURNAL_H */
@@ -84,12 +84,27 @@ int _anjay_notify_queue_resource_change(anjay_notify_queue_t *out_queue,
                                         anjay_iid_t iid,
                                         anjay_rid_t rid);
 
+/**
+ * Adds all changes listed in <c>*queue_ptr</c> to <c>out_queue</c>, and clears
+ * <c>*queue_ptr</c> on success. On failure, <c>*queue_ptr</c> is left intact,
+ * while <c>out_queue</c> may contain some of its changes.
+ */
+int _anjay_notify_queue_merge(anjay_notify_queue_t *out_queue,
+                              anjay_notify_queue_t *queue_ptr);
+
 void _anjay_notify_clear_queue(anjay_notify_queue_t *out_queue);
 
 int _anjay_notify_instance_created(anjay_t *anjay,
                                    anjay_oid_t oid,
                                    anjay_iid_t iid);
 
+/**
+ * Changes reported using anjay_notify_* functions are not processed during the
+ * Bootstrap Sequence. If it ends without Bootstrap-Finish, this function shall
+ * be called to schedule processing them.
+ */
+int _anjay_notify_schedule_deferred(anjay_t *anjay);
+
 typedef int anjay_notify_callback_t(anjay_t *anjay,
                                     anjay_notify_queue_t queue,
                                     void *data);
@@ -22,6 +22,7 @@
 #include <stdio.h>
 
 #include <avsystem/commons/defs.h>
+#include <avsystem/commons/stream.h>
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
@@ -73,6 +74,25 @@ int _anjay_raw_buffer_from_data(anjay_raw_buffer_t *dst,
                                 const void *src,
                                 size_t size);
 
+/**
+ * Appends @p size bytes pointed by @p src to a heap raw buffer, reallocating
+ * it if necessary.
+ *
+ * @returns 0 on success, negative value if no memory is available
+ */
+int _anjay_raw_buffer_append(anjay_raw_buffer_t *buffer,
+                             const void *src,
+                             size_t size);
+
+/**
+ * Reads everything that remains in @p stream and appends it to a heap raw
+ * buffer, reallocating it if necessary.
+ *
+ * @returns 0 on success, negative value in case of error
+ */
+int _anjay_raw_buffer_append_stream(anjay_raw_buffer_t *buffer,
+                                    avs_stream_abstract_t *stream);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* ANJAY_INCLUDE_ANJAY_MODULES_RAW_BUFFER_H */
@@ -68,6 +68,38 @@ int _anjay_sched(anjay_sched_t *sched,
                  avs_time_duration_t delay,
                  anjay_sched_clb_t clb,
                  void *clb_data);
+
+/**
+ * Schedules oneshot job that may be executed at any moment between @p delay
+ * and @p delay + @p slack from now. Otherwise, it behaves exactly like
+ * @ref _anjay_sched .
+ *
+ * Jobs with non-zero slack are used to coalesce wakeups: the scheduler reports
+ * the earliest deadline of all pending jobs as the time to next job, and each
+ * time it runs, it executes all jobs whose windows have already started, in
+ * the order of their deadlines. This way, jobs with overlapping windows are
+ * executed during a single wakeup.
+ *
+ * @param sched         Scheduler object to add the job into.
+ * @param out_handle    Pointer to the storage of scheduler handle, that might
+ *                      be used to cancel the job or NULL if no handle
+ *                      information is required.
+ * @param delay         Delay until the earliest moment of job execution.
+ * @param slack         Length of the window during which the job may be
+ *                      executed. Invalid or negative values are treated as
+ *                      zero.
+ * @param clb           Scheduled task.
+ * @param clb_data      Opaque pointer passed to @p clb.
+ *
+ * @return 0 on success, negative value in case of error.
+ */
+int _anjay_sched_with_slack(anjay_sched_t *sched,
+                            anjay_sched_handle_t *out_handle,
+                            avs_time_duration_t delay,
+                            avs_time_duration_t slack,
+                            anjay_sched_clb_t clb,
+                            void *clb_data);
+
 /**
  * Removes job handle (pointed by @p handle) from the scheduler, and therefore
  * invalidates it by setting it to NULL.
@@ -132,6 +164,20 @@ int _anjay_sched_retryable(anjay_sched_t *sched,
                            anjay_sched_retryable_clb_t clb,
                            void *clb_data);
 
+/**
+ * Variant of @ref _anjay_sched_retryable in which the first execution of
+ * @p clb may happen at any moment between @p delay and @p delay + @p slack from
+ * now - see @ref _anjay_sched_with_slack for details. Retries after a failed
+ * attempt are always executed exactly after the backoff delay.
+ */
+int _anjay_sched_retryable_with_slack(anjay_sched_t *sched,
+                                      anjay_sched_handle_t *out_handle,
+                                      avs_time_duration_t delay,
+                                      avs_time_duration_t slack,
+                                      anjay_sched_retryable_backoff_t backoff,
+                                      anjay_sched_retryable_clb_t clb,
+                                      void *clb_data);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* ANJAY_INCLUDE_ANJAY_MODULES_SCHED_H */
@@ -50,6 +50,23 @@ int _anjay_get_security_info(anjay_t *anjay,
                              anjay_iid_t security_iid,
                              anjay_connection_type_t conn_type);
 
+/**
+ * Invalidates cached Server Object settings of all servers. Needs to be called
+ * whenever Server Object Instances are replaced without going through the
+ * notification queue, e.g. when the object state is restored.
+ */
+void _anjay_servers_invalidate_config_cache(anjay_t *anjay);
+
+/**
+ * Drops the cached security mode and key material of the Security Object
+ * Instance @p security_iid , or of all instances if it is
+ * @ref ANJAY_IID_INVALID . Like @ref _anjay_servers_invalidate_config_cache ,
+ * needs to be called whenever Security Object Instances are replaced without
+ * going through the notification queue.
+ */
+void _anjay_servers_invalidate_security_cache(anjay_t *anjay,
+                                              anjay_iid_t security_iid);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* ANJAY_INCLUDE_ANJAY_MODULES_SERVERS_H */
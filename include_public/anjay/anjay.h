@@ -21,5 +21,6 @@
 #include <anjay/dm.h>
 #include <anjay/io.h>
 #include <anjay/download.h>
+#include <anjay/send.h>
 
 #endif /*ANJAY_INCLUDE_ANJAY_ANJAY_H*/
@@ -23,6 +23,7 @@
 #include <avsystem/commons/coap/tx_params.h>
 #include <avsystem/commons/list.h>
 #include <avsystem/commons/net.h>
+#include <avsystem/commons/stream.h>
 #include <avsystem/commons/time.h>
 
 #ifdef __cplusplus
@@ -197,6 +198,43 @@ typedef struct anjay_configuration {
      * call e.g. @ref anjay_schedule_reconnect() method.
      */
     const uint32_t *max_icmp_failures;
+
+    /**
+     * Maximum total size, in bytes, of notifications kept in memory for a
+     * single server connection while they cannot be sent, e.g. when the server
+     * is inactive and Notification Storing is enabled. The oldest values that
+     * exceed this limit, starting with the ones of the lowest priority, are
+     * moved to a file as configured by
+     * <c>stored_notifications_spill_path</c>, or dropped if it is NULL.
+     *
+     * The newest value of each observation is always kept in memory, as it is
+     * necessary to decide whether to send further notifications.
+     *
+     * If 0, the amount of memory used for stored notifications is not limited.
+     */
+    size_t stored_notifications_limit;
+
+    /**
+     * Path prefix of the append-only files that hold stored notifications not
+     * fitting within <c>stored_notifications_limit</c>. A separate file is
+     * created for each server connection and notification priority (see
+     * @ref anjay_notify_set_priority), named by appending the SSID, the
+     * connection type and the priority index to the prefix; notifications are
+     * read back from it in the original order once the server becomes
+     * reachable, and the file is removed as soon as it is drained.
+     *
+     * NOTE: The files are only meaningful to the Anjay object that created
+     * them; they are not restored after the application restarts.
+     */
+    const char *stored_notifications_spill_path;
+
+    /**
+     * If set to true, a stored notification that has not been sent yet is
+     * replaced by a newer value of the same observation, so that only the
+     * newest value is sent once the server becomes reachable. Notifications
+     * about errors are never replaced.
+     */
+    bool coalesce_stored_notifications;
 } anjay_configuration_t;
 
 /**
@@ -544,6 +582,106 @@ int anjay_disable_server_with_timeout(anjay_t *anjay,
 int anjay_enable_server(anjay_t *anjay,
                         anjay_ssid_t ssid);
 
+/**
+ * Dumps the connection state that allows reconnecting to LwM2M servers
+ * without a full handshake into the @p out_stream . For each server, this
+ * includes the DTLS session resumption data, the previously used remote
+ * endpoint address and the local port number.
+ *
+ * The stored data shall be treated as confidential, as it allows resuming the
+ * DTLS sessions. It is only valid for the same build of the library.
+ *
+ * @param anjay      Anjay object to operate on.
+ * @param out_stream Stream to write to.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_connection_state_persist(anjay_t *anjay,
+                                   avs_stream_abstract_t *out_stream);
+
+/**
+ * Loads connection state previously stored using
+ * @ref anjay_connection_state_persist from the @p in_stream .
+ *
+ * The restored state of each server is used during the next connection
+ * attempt to that server, which makes it possible to resume the DTLS session
+ * and skip the DNS resolution. If the session cannot be resumed (e.g. because
+ * the server or its credentials changed in the meantime), a full handshake is
+ * performed as usual. For this reason, this function is meant to be called
+ * right after restoring the Security and Server objects, before the first
+ * call to @ref anjay_sched_run .
+ *
+ * Note: if restore fails, the previously restored state (if any) is left
+ * untouched.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param in_stream Stream to read from.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_connection_state_restore(anjay_t *anjay,
+                                   avs_stream_abstract_t *in_stream);
+
+/**
+ * Dumps the whole persistent state of the client into the @p out_stream as a
+ * single snapshot. The snapshot contains the state of all installed modules
+ * that support persistence (Security, Server, Access Control, Attribute
+ * Storage and Firmware Update), followed by the connection state (see
+ * @ref anjay_connection_state_persist ). Each of them is stored in the same
+ * format as the corresponding <c>*_persist</c> function uses, framed in a
+ * versioned container protected with a CRC-32 checksum.
+ *
+ * The snapshot is assembled in memory and written to @p out_stream using a
+ * single write call, so that a partially written snapshot is never produced
+ * because of an error in one of the modules.
+ *
+ * Note: established observations are not a part of the snapshot, as they are
+ * bound to the CoAP tokens used on the previous connections; LwM2M Servers
+ * are expected to observe again after the client registers.
+ *
+ * @param anjay      Anjay object to operate on.
+ * @param out_stream Stream to write to.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_snapshot_persist(anjay_t *anjay, avs_stream_abstract_t *out_stream);
+
+/**
+ * Loads a snapshot previously stored using @ref anjay_snapshot_persist from
+ * the @p in_stream . The whole stream is read into memory first, and nothing
+ * is restored unless the version and the checksum of the snapshot are valid.
+ *
+ * The sections are then restored as if the appropriate <c>*_restore</c>
+ * functions were called in the correct order: the Objects first, then the
+ * data referring to their Instances (Access Control and Attribute Storage),
+ * and the connection state last. Sections of modules that are not installed
+ * are ignored, and the state of installed modules for which the snapshot
+ * contains no section is left untouched.
+ *
+ * Note: if restoring any of the sections fails, this function fails, but the
+ * sections restored before it are not rolled back.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param in_stream Stream to read from.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_snapshot_restore(anjay_t *anjay, avs_stream_abstract_t *in_stream);
+
+/**
+ * Works like @ref anjay_snapshot_restore , but reads the snapshot from a
+ * memory buffer, e.g. a memory-mapped snapshot file, without copying it.
+ *
+ * @param anjay Anjay object to operate on.
+ * @param data  Pointer to the snapshot data.
+ * @param size  Size of the snapshot data, in bytes.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_snapshot_restore_from_buffer(anjay_t *anjay,
+                                       const void *data,
+                                       size_t size);
+
 /**
  * Checks whether anjay is currently in offline state.
  *
@@ -422,6 +422,39 @@ typedef int anjay_dm_resource_read_t(anjay_t *anjay,
                                      anjay_rid_t rid,
                                      anjay_output_ctx_t *ctx);
 
+/**
+ * An optional handler that reads all readable Resources of an Object Instance
+ * in a single call. If implemented, it is used instead of querying
+ * @ref anjay_dm_resource_present_t, @ref anjay_dm_resource_operations_t and
+ * @ref anjay_dm_resource_read_t separately for each supported Resource whenever
+ * a whole Object Instance or Object is read, either directly or as part of
+ * a notification.
+ *
+ * The handler shall return every Resource that is PRESENT in the Instance and
+ * readable, in ascending order of Resource IDs. The ID of each Resource shall
+ * be passed to @ref anjay_ret_resource_id right before returning its value
+ * using the anjay_ret_* function family. Resources that are not present or not
+ * readable shall be skipped.
+ *
+ * Note that data model overlays installed by modules that only override
+ * Resource-level handlers are not consulted when this handler is used.
+ *
+ * @param anjay   Anjay object to operate on.
+ * @param obj_ptr Object definition pointer, as passed to
+ *                @ref anjay_register_object .
+ * @param iid     Object Instance ID.
+ * @param ctx     Output context to write the Resource values to.
+ *
+ * @returns This handler should return:
+ * - 0 on success,
+ * - a negative value in case of error. The error code semantics are the same
+ *   as for @ref anjay_dm_resource_read_t .
+ */
+typedef int anjay_dm_instance_read_t(anjay_t *anjay,
+                                     const anjay_dm_object_def_t *const *obj_ptr,
+                                     anjay_iid_t iid,
+                                     anjay_output_ctx_t *ctx);
+
 /**
  * A handler that writes the Resource value.
  *
@@ -703,6 +736,9 @@ typedef struct {
     anjay_dm_transaction_commit_t *transaction_commit;
     /** Rollback changes made in a transaction, @ref anjay_dm_transaction_rollback_t */
     anjay_dm_transaction_rollback_t *transaction_rollback;
+
+    /** Get values of all readable Resources in an Object Instance, @ref anjay_dm_instance_read_t */
+    anjay_dm_instance_read_t *instance_read;
 } anjay_dm_handlers_t;
 
 /** A simple array-plus-size container for a list of supported Resource IDs. */
@@ -803,6 +839,36 @@ int anjay_notify_changed(anjay_t *anjay,
  */
 int anjay_notify_instances_changed(anjay_t *anjay, anjay_oid_t oid);
 
+/**
+ * Priority of notifications waiting to be sent to a server, e.g. after it
+ * becomes reachable again. Pending notifications of higher priority are sent
+ * before any of lower priority; notifications of equal priority, as well as
+ * all notifications of a single observation, are sent in the order in which
+ * they were generated.
+ */
+typedef enum {
+    ANJAY_NOTIFY_PRIORITY_LOW = -1,
+    ANJAY_NOTIFY_PRIORITY_NORMAL = 0,
+    ANJAY_NOTIFY_PRIORITY_HIGH = 1
+} anjay_notify_priority_t;
+
+/**
+ * Sets the priority of notifications about the given Object, its Instances and
+ * Resources. By default, all Objects have @ref ANJAY_NOTIFY_PRIORITY_NORMAL.
+ *
+ * The priority is assigned to an observation when it is established, so the
+ * change only affects observations established after this call.
+ *
+ * @param anjay    Anjay object to operate on.
+ * @param oid      Object ID to set the priority for.
+ * @param priority Priority of notifications about the Object.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_notify_set_priority(anjay_t *anjay,
+                              anjay_oid_t oid,
+                              anjay_notify_priority_t priority);
+
 /**
  * Registers the Object in the data model, making it available for RPC calls.
  *
@@ -180,6 +180,45 @@ anjay_download_handle_t anjay_download(anjay_t *anjay,
 void anjay_download_abort(anjay_t *anjay,
                           anjay_download_handle_t dl_handle);
 
+/**
+ * Pauses a download identified by @p dl_handle. While suspended, no further
+ * blocks are requested, retransmissions are stopped and the download socket is
+ * not returned by @ref anjay_get_sockets . Data that has already been received
+ * may still be passed to @ref anjay_download_next_block_handler_t if this
+ * function is called outside of that handler.
+ *
+ * May be safely called from within @ref anjay_download_next_block_handler_t to
+ * apply back-pressure - in that case, the block being handled is the last one
+ * delivered until @ref anjay_download_resume is called.
+ *
+ * Note that suspending a download for too long may cause the remote server to
+ * drop the transfer, in which case the download fails after it is resumed.
+ *
+ * @param anjay     Anjay object managing the download process.
+ * @param dl_handle Download handle previously returned by
+ *                  @ref anjay_download.
+ *
+ * @returns 0 on success, negative value if @p dl_handle does not represent
+ *          a valid download handle.
+ */
+int anjay_download_suspend(anjay_t *anjay,
+                           anjay_download_handle_t dl_handle);
+
+/**
+ * Resumes a download previously paused using @ref anjay_download_suspend .
+ * The next block is requested during the next call to @ref anjay_sched_run .
+ * Does nothing if the download is not suspended.
+ *
+ * @param anjay     Anjay object managing the download process.
+ * @param dl_handle Download handle previously returned by
+ *                  @ref anjay_download.
+ *
+ * @returns 0 on success, negative value if @p dl_handle does not represent
+ *          a valid download handle or the download could not be resumed.
+ */
+int anjay_download_resume(anjay_t *anjay,
+                          anjay_download_handle_t dl_handle);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
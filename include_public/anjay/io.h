@@ -236,6 +236,58 @@ int anjay_ret_array_index(anjay_output_ctx_t *array_ctx, anjay_riid_t index);
  */
 int anjay_ret_array_finish(anjay_output_ctx_t *array_ctx);
 
+/**
+ * Returns a whole Multiple Resource consisting of 64-bit integer values from
+ * a contiguous array, as if by calling @ref anjay_ret_array_start,
+ * @ref anjay_ret_array_index and @ref anjay_ret_i64 for each element, followed
+ * by @ref anjay_ret_array_finish . Resource Instance IDs are assigned
+ * consecutively, starting from 0.
+ *
+ * Output formats that support it encode the whole array in one pass, which is
+ * significantly faster for large arrays than returning the elements one by
+ * one.
+ *
+ * @param ctx    Output context to operate on.
+ * @param values Array of values to return.
+ * @param count  Number of elements in @p values . Must not be greater than
+ *               <c>UINT16_MAX</c>.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_ret_i64_array(anjay_output_ctx_t *ctx,
+                        const int64_t *values,
+                        size_t count);
+
+/**
+ * Same as @ref anjay_ret_i64_array, but for double-precision floating-point
+ * values.
+ */
+int anjay_ret_double_array(anjay_output_ctx_t *ctx,
+                           const double *values,
+                           size_t count);
+
+/**
+ * Assigns a Resource ID to the next value returned using one of the
+ * anjay_ret_* functions. Only valid within
+ * @ref anjay_dm_instance_read_t handlers.
+ *
+ * Example usage:
+ * @code
+ * if (anjay_ret_resource_id(ctx, 0)
+ *         || anjay_ret_i32(ctx, 42)
+ *         || anjay_ret_resource_id(ctx, 1)
+ *         || anjay_ret_string(ctx, "foo")) {
+ *     return ANJAY_ERR_INTERNAL;
+ * }
+ * @endcode
+ *
+ * @param ctx Output context to operate on.
+ * @param rid Resource ID to assign.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_ret_resource_id(anjay_output_ctx_t *ctx, anjay_rid_t rid);
+
 /** Type used to retrieve RPC content. */
 typedef struct anjay_input_ctx_struct anjay_input_ctx_t;
 
@@ -490,6 +542,43 @@ anjay_input_ctx_t *anjay_get_array(anjay_input_ctx_t *ctx);
 int anjay_get_array_index(anjay_input_ctx_t *array_ctx,
                           anjay_riid_t *out_index);
 
+/**
+ * Reads a whole Multiple Resource consisting of 64-bit integer values into
+ * a contiguous array. Equivalent to calling @ref anjay_get_array, followed by
+ * @ref anjay_get_array_index and @ref anjay_get_i64 for each entry.
+ *
+ * Values are stored in the order in which they appear in the request.
+ *
+ * @param      ctx        Input context to operate on.
+ * @param[out] out_values Array to store the values in.
+ * @param[out] out_riids  Array to store Resource Instance IDs of respective
+ *                        values in. May be NULL if they are not needed.
+ * @param      capacity   Number of elements that @p out_values (and
+ *                        @p out_riids , if not NULL) can hold.
+ * @param[out] out_count  Number of entries stored.
+ *
+ * @returns
+ * - 0 on success,
+ * - ANJAY_BUFFER_TOO_SHORT if the array has more than @p capacity entries;
+ *   in that case, the first @p capacity entries are stored,
+ * - a negative value in case of error.
+ */
+int anjay_get_i64_array(anjay_input_ctx_t *ctx,
+                        int64_t *out_values,
+                        anjay_riid_t *out_riids,
+                        size_t capacity,
+                        size_t *out_count);
+
+/**
+ * Same as @ref anjay_get_i64_array, but for double-precision floating-point
+ * values.
+ */
+int anjay_get_double_array(anjay_input_ctx_t *ctx,
+                           double *out_values,
+                           anjay_riid_t *out_riids,
+                           size_t capacity,
+                           size_t *out_count);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_SEND_H
+#define ANJAY_INCLUDE_ANJAY_SEND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <avsystem/commons/time.h>
+
+#include <anjay/core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Configuration of a Send batch - a buffer of timestamped Resource values
+ * that are reported to a single LwM2M Server in one Send (POST /dp) request,
+ * encoded as SenML JSON.
+ */
+typedef struct anjay_send_batch_config {
+    /**
+     * Maximum number of samples held by the batch. Must not be zero.
+     *
+     * If a sample is added while the batch is full, the oldest buffered sample
+     * is discarded to make room for it.
+     */
+    size_t capacity;
+
+    /**
+     * Number of buffered samples that causes the batch to be flushed. If zero,
+     * <c>capacity</c> is used.
+     */
+    size_t flush_threshold;
+
+    /**
+     * Maximum time a sample may wait in the batch before it is flushed,
+     * counted since the moment a sample is added to an empty batch. If the
+     * flush fails, it is retried after the same period.
+     *
+     * If not a valid duration (e.g. @ref AVS_TIME_DURATION_INVALID), samples
+     * are only flushed when the threshold is reached or
+     * @ref anjay_send_batch_flush is called.
+     */
+    avs_time_duration_t max_age;
+} anjay_send_batch_config_t;
+
+/**
+ * Creates, reconfigures or removes the Send batch associated with the LwM2M
+ * Server identified by @p ssid .
+ *
+ * If the batch already exists and @p config specifies a different
+ * <c>capacity</c>, samples that do not fit in the new capacity are discarded,
+ * starting with the oldest ones.
+ *
+ * @param anjay  Anjay object to operate on.
+ * @param ssid   Short Server ID of the server to send data to.
+ * @param config Batch configuration, or NULL to remove the batch, discarding
+ *               any samples that have not been sent yet.
+ *
+ * @returns 0 on success, negative value in case of an error.
+ */
+int anjay_send_batch_configure(anjay_t *anjay,
+                               anjay_ssid_t ssid,
+                               const anjay_send_batch_config_t *config);
+
+/**
+ * Adds an integer value of the Resource /<c>oid</c>/<c>iid</c>/<c>rid</c> to
+ * the Send batch associated with @p ssid .
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param ssid      Short Server ID of a server configured using
+ *                  @ref anjay_send_batch_configure .
+ * @param oid       Object ID of the sampled Resource.
+ * @param iid       Object Instance ID of the sampled Resource.
+ * @param rid       Resource ID of the sampled Resource.
+ * @param timestamp Time at which the value was sampled. If not valid, the
+ *                  current time is used.
+ * @param value     Sampled value.
+ *
+ * @returns 0 on success, negative value if there is no batch for @p ssid or
+ *          the path is invalid.
+ */
+int anjay_send_batch_add_int(anjay_t *anjay,
+                             anjay_ssid_t ssid,
+                             anjay_oid_t oid,
+                             anjay_iid_t iid,
+                             anjay_rid_t rid,
+                             avs_time_real_t timestamp,
+                             int64_t value);
+
+/**
+ * Same as @ref anjay_send_batch_add_int, but for floating-point values.
+ * NaN and infinite values are rejected, as they cannot be represented in
+ * SenML JSON.
+ */
+int anjay_send_batch_add_double(anjay_t *anjay,
+                                anjay_ssid_t ssid,
+                                anjay_oid_t oid,
+                                anjay_iid_t iid,
+                                anjay_rid_t rid,
+                                avs_time_real_t timestamp,
+                                double value);
+
+/**
+ * Same as @ref anjay_send_batch_add_int, but for boolean values.
+ */
+int anjay_send_batch_add_bool(anjay_t *anjay,
+                              anjay_ssid_t ssid,
+                              anjay_oid_t oid,
+                              anjay_iid_t iid,
+                              anjay_rid_t rid,
+                              avs_time_real_t timestamp,
+                              bool value);
+
+/**
+ * Schedules sending all samples buffered in the Send batch associated with
+ * @p ssid . The request is sent during the next call to
+ * @ref anjay_sched_run.
+ *
+ * Samples are removed from the batch once the server acknowledges them, or
+ * rejects them with a 4.xx error. In case of a network error, or if the server
+ * is not registered at the moment, they are kept for the next attempt.
+ *
+ * @returns 0 on success, negative value if there is no batch for @p ssid or
+ *          the flush could not be scheduled.
+ */
+int anjay_send_batch_flush(anjay_t *anjay, anjay_ssid_t ssid);
+
+/**
+ * @returns Number of samples currently buffered in the Send batch associated
+ *          with @p ssid , or 0 if there is no such batch.
+ */
+size_t anjay_send_batch_size(anjay_t *anjay, anjay_ssid_t ssid);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* ANJAY_INCLUDE_ANJAY_SEND_H */
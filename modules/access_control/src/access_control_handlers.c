@@ -668,7 +668,11 @@ static void ac_delete(anjay_t *anjay, void *access_control_) {
 
 static const anjay_dm_module_t ACCESS_CONTROL_MODULE = {
     .notify_callback = sync_on_notify,
-    .deleter = ac_delete
+    .deleter = ac_delete,
+    .snapshot_name = "access_control",
+    .snapshot_stage = ANJAY_DM_MODULE_SNAPSHOT_METADATA,
+    .persist = anjay_access_control_persist,
+    .restore = anjay_access_control_restore
 };
 
 static const anjay_dm_object_def_t ACCESS_CONTROL = {
@@ -29,10 +29,6 @@
 
 VISIBILITY_SOURCE_BEGIN
 
-#define HANDLE_LIST(Type, Ctx, ListPtr, UserPtr) \
-        avs_persistence_list((Ctx), (AVS_LIST(void) *) (ListPtr), \
-                             sizeof(**(ListPtr)), handle_##Type, UserPtr, NULL)
-
 //// DATA STRUCTURE HANDLERS ///////////////////////////////////////////////////
 
 static int handle_dm_attributes(avs_persistence_context_t *ctx,
@@ -102,63 +98,16 @@ static int handle_internal_res_attrs(avs_persistence_context_t *ctx,
     return retval;
 }
 
-static int handle_default_attrs(avs_persistence_context_t *ctx,
-                                void *attrs_,
-                                void *version_as_ptr) {
-    fas_default_attrs_t *attrs = (fas_default_attrs_t *) attrs_;
-    int retval;
-    (void) ((retval = avs_persistence_u16(ctx, &attrs->ssid))
-            || (retval = handle_internal_attrs(
-                    ctx, &attrs->attrs, (int) (intptr_t) version_as_ptr)));
-    return retval;
-}
-
-static int handle_resource_attrs(avs_persistence_context_t *ctx,
-                                 void *attrs_,
-                                 void *version_as_ptr) {
-    fas_resource_attrs_t *attrs = (fas_resource_attrs_t *) attrs_;
-    int retval;
-    (void) ((retval = avs_persistence_u16(ctx, &attrs->ssid))
-            || (retval = handle_internal_res_attrs(
-                    ctx, &attrs->attrs, (int) (intptr_t) version_as_ptr)));
-    return retval;
-}
-
-static int handle_resource_entry(avs_persistence_context_t *ctx,
-                                 void *resource_,
-                                 void *version_as_ptr) {
-    fas_resource_entry_t *resource = (fas_resource_entry_t *) resource_;
-    int retval;
-    (void) ((retval = avs_persistence_u16(ctx, &resource->rid))
-            || (retval = HANDLE_LIST(resource_attrs, ctx, &resource->attrs,
-                                     version_as_ptr)));
-    return retval;
-}
-
-static int handle_instance_entry(avs_persistence_context_t *ctx,
-                                 void *instance_,
-                                 void *version_as_ptr) {
-    fas_instance_entry_t *instance = (fas_instance_entry_t *) instance_;
-    int retval;
-    (void) ((retval = avs_persistence_u16(ctx, &instance->iid))
-            || (retval = HANDLE_LIST(default_attrs, ctx,
-                                     &instance->default_attrs, version_as_ptr))
-            || (retval = HANDLE_LIST(resource_entry, ctx,
-                                     &instance->resources, version_as_ptr)));
-    return retval;
-}
-
-static int handle_object(avs_persistence_context_t *ctx,
-                         void *object_,
-                         void *version_as_ptr) {
-    fas_object_entry_t *object = (fas_object_entry_t *) object_;
-    int retval;
-    (void) ((retval = avs_persistence_u16(ctx, &object->oid))
-            || (retval = HANDLE_LIST(default_attrs, ctx,
-                                     &object->default_attrs, version_as_ptr))
-            || (retval = HANDLE_LIST(instance_entry, ctx, &object->instances,
-                                     version_as_ptr)));
-    return retval;
+static int handle_entry_attrs(avs_persistence_context_t *ctx,
+                              fas_entry_t *entry,
+                              bool resource_level,
+                              int version) {
+    if (resource_level) {
+        return handle_internal_res_attrs(ctx, &entry->attrs, version);
+    } else {
+        return handle_internal_attrs(ctx, fas_entry_default_attrs(entry),
+                                     version);
+    }
 }
 
 // HELPERS /////////////////////////////////////////////////////////////////////
@@ -179,77 +128,245 @@ static int stream_at_end(avs_stream_abstract_t *in) {
     return result < 0 ? result : -1;
 }
 
-static bool is_attrs_list_sane(AVS_LIST(void) attrs_list,
-                               size_t attrs_field_offset,
-                               is_empty_func_t *is_empty_func) {
-    int32_t last_ssid = -1;
-    AVS_LIST(void) attrs;
-    AVS_LIST_FOREACH(attrs, attrs_list) {
-        if (*get_ssid_ptr(attrs) <= last_ssid
-                || is_empty_func(get_attrs_ptr(attrs, attrs_field_offset))) {
-            return false;
-        }
-        last_ssid = *get_ssid_ptr(attrs);
+static size_t count_groups(const fas_table_t *table,
+                           size_t begin,
+                           size_t end,
+                           unsigned shift) {
+    size_t count = 0;
+    while (begin < end) {
+        begin = fas_table_group_end(table, begin, end, shift);
+        ++count;
     }
-    return true;
+    return count;
 }
 
-static bool is_resources_list_sane(AVS_LIST(fas_resource_entry_t) resources) {
-    int32_t last_rid = -1;
-    AVS_LIST(fas_resource_entry_t) resource;
-    AVS_LIST_FOREACH(resource, resources) {
-        if (resource->rid <= last_rid) {
-            return false;
+/**
+ * Entries with the ID field at @p shift equal to FAS_ID_NONE (i.e. default
+ * attributes of the enclosing Object or Instance) sort first within their
+ * range; this returns the index just past them.
+ */
+static size_t default_attrs_end(const fas_table_t *table,
+                                size_t begin,
+                                size_t end,
+                                unsigned shift) {
+    while (begin < end && !(uint16_t) (table->entries[begin].key >> shift)) {
+        ++begin;
+    }
+    return begin;
+}
+
+// PERSIST /////////////////////////////////////////////////////////////////////
+
+/*
+ * The persisted format mirrors the logical Object -> Instance -> Resource
+ * hierarchy, as it did when the storage itself was a tree of nested lists.
+ * Each list is a 32-bit element count followed by the elements.
+ */
+
+static int persist_count(avs_persistence_context_t *ctx, size_t count) {
+    if (count > UINT32_MAX) {
+        return -1;
+    }
+    uint32_t count32 = (uint32_t) count;
+    return avs_persistence_u32(ctx, &count32);
+}
+
+static int persist_attrs_list(avs_persistence_context_t *ctx,
+                              fas_table_t *table,
+                              size_t begin,
+                              size_t end,
+                              bool resource_level) {
+    int retval = persist_count(ctx, end - begin);
+    for (size_t i = begin; !retval && i < end; ++i) {
+        anjay_ssid_t ssid = fas_key_ssid(table->entries[i].key);
+        (void) ((retval = avs_persistence_u16(ctx, &ssid))
+                || (retval = handle_entry_attrs(ctx, &table->entries[i],
+                                                resource_level, 2)));
+    }
+    return retval;
+}
+
+static int persist_resource(avs_persistence_context_t *ctx,
+                            fas_table_t *table,
+                            size_t begin,
+                            size_t end) {
+    anjay_rid_t rid = fas_key_rid(table->entries[begin].key);
+    int retval;
+    (void) ((retval = avs_persistence_u16(ctx, &rid))
+            || (retval = persist_attrs_list(ctx, table, begin, end, true)));
+    return retval;
+}
+
+static int persist_instance(avs_persistence_context_t *ctx,
+                            fas_table_t *table,
+                            size_t begin,
+                            size_t end) {
+    anjay_iid_t iid = fas_key_iid(table->entries[begin].key);
+    size_t resources_begin =
+            default_attrs_end(table, begin, end, FAS_KEY_RID_SHIFT);
+    int retval;
+    (void) ((retval = avs_persistence_u16(ctx, &iid))
+            || (retval = persist_attrs_list(ctx, table, begin,
+                                            resources_begin, false))
+            || (retval = persist_count(
+                    ctx, count_groups(table, resources_begin, end,
+                                      FAS_KEY_RID_SHIFT))));
+    while (!retval && resources_begin < end) {
+        size_t resource_end = fas_table_group_end(table, resources_begin, end,
+                                                  FAS_KEY_RID_SHIFT);
+        retval = persist_resource(ctx, table, resources_begin, resource_end);
+        resources_begin = resource_end;
+    }
+    return retval;
+}
+
+static int persist_object(avs_persistence_context_t *ctx,
+                          fas_table_t *table,
+                          size_t begin,
+                          size_t end) {
+    anjay_oid_t oid = fas_key_oid(table->entries[begin].key);
+    size_t instances_begin =
+            default_attrs_end(table, begin, end, FAS_KEY_IID_SHIFT);
+    int retval;
+    (void) ((retval = avs_persistence_u16(ctx, &oid))
+            || (retval = persist_attrs_list(ctx, table, begin,
+                                            instances_begin, false))
+            || (retval = persist_count(
+                    ctx, count_groups(table, instances_begin, end,
+                                      FAS_KEY_IID_SHIFT))));
+    while (!retval && instances_begin < end) {
+        size_t instance_end = fas_table_group_end(table, instances_begin, end,
+                                                  FAS_KEY_IID_SHIFT);
+        retval = persist_instance(ctx, table, instances_begin, instance_end);
+        instances_begin = instance_end;
+    }
+    return retval;
+}
+
+static int persist_table(avs_persistence_context_t *ctx, fas_table_t *table) {
+    int retval = persist_count(
+            ctx, count_groups(table, 0, table->size, FAS_KEY_OID_SHIFT));
+    size_t begin = 0;
+    while (!retval && begin < table->size) {
+        size_t end = fas_table_group_end(table, begin, table->size,
+                                         FAS_KEY_OID_SHIFT);
+        retval = persist_object(ctx, table, begin, end);
+        begin = end;
+    }
+    return retval;
+}
+
+// RESTORE /////////////////////////////////////////////////////////////////////
+
+/*
+ * IDs on each level are required to be strictly increasing, so that the
+ * entries can be appended to the table in the order they are read and it
+ * stays sorted. Data that does not satisfy this, or that contains entries with
+ * empty attributes, is rejected.
+ */
+
+static int restore_attrs_list(avs_persistence_context_t *ctx,
+                              anjay_attr_storage_t *fas,
+                              anjay_oid_t oid,
+                              anjay_iid_t iid,
+                              anjay_rid_t rid,
+                              int version) {
+    const bool resource_level = (rid != FAS_ID_NONE);
+    int32_t last_ssid = -1;
+    uint32_t count;
+    int retval = avs_persistence_u32(ctx, &count);
+    for (uint32_t i = 0; !retval && i < count; ++i) {
+        anjay_ssid_t ssid;
+        if ((retval = avs_persistence_u16(ctx, &ssid))) {
+            break;
         }
-        last_rid = resource->rid;
-        if (!is_attrs_list_sane(resource->attrs,
-                                offsetof(fas_resource_attrs_t, attrs),
-                                resource_attrs_empty)) {
-            return false;
+        if (ssid <= last_ssid) {
+            return -1;
+        }
+        last_ssid = ssid;
+        fas_entry_t *entry = _anjay_attr_storage_insert_entry(
+                fas, fas->table.size, fas_key_make(oid, iid, rid, ssid));
+        if (!entry) {
+            return -1;
+        }
+        if (!(retval = handle_entry_attrs(ctx, entry, resource_level, version))
+                && (resource_level
+                        ? resource_attrs_empty(&entry->attrs)
+                        : default_attrs_empty(
+                                  fas_entry_default_attrs(entry)))) {
+            retval = -1;
         }
     }
-    return true;
+    return retval;
 }
 
-static bool is_instances_list_sane(AVS_LIST(fas_instance_entry_t) instances) {
-    int32_t last_iid = -1;
-    AVS_LIST(fas_instance_entry_t) instance;
-    AVS_LIST_FOREACH(instance, instances) {
-        if (instance->iid <= last_iid) {
-            return false;
+static int restore_instance(avs_persistence_context_t *ctx,
+                            anjay_attr_storage_t *fas,
+                            anjay_oid_t oid,
+                            int32_t *last_iid,
+                            int version) {
+    anjay_iid_t iid;
+    int retval = avs_persistence_u16(ctx, &iid);
+    if (retval) {
+        return retval;
+    }
+    if (iid <= *last_iid || iid == FAS_ID_NONE) {
+        return -1;
+    }
+    *last_iid = iid;
+    uint32_t count;
+    (void) ((retval = restore_attrs_list(ctx, fas, oid, iid, FAS_ID_NONE,
+                                         version))
+            || (retval = avs_persistence_u32(ctx, &count)));
+    int32_t last_rid = -1;
+    for (uint32_t i = 0; !retval && i < count; ++i) {
+        anjay_rid_t rid;
+        if ((retval = avs_persistence_u16(ctx, &rid))) {
+            break;
         }
-        last_iid = instance->iid;
-        if (!is_attrs_list_sane(instance->default_attrs,
-                                offsetof(fas_default_attrs_t, attrs),
-                                default_attrs_empty)
-                || !is_resources_list_sane(instance->resources)) {
-            return false;
+        if (rid <= last_rid || rid == FAS_ID_NONE) {
+            return -1;
         }
+        last_rid = rid;
+        retval = restore_attrs_list(ctx, fas, oid, iid, rid, version);
     }
-    return true;
+    return retval;
 }
 
-static bool is_object_sane(fas_object_entry_t *object) {
-    return is_attrs_list_sane(object->default_attrs,
-                              offsetof(fas_default_attrs_t, attrs),
-                              default_attrs_empty)
-            && is_instances_list_sane(object->instances);
+static int restore_object(avs_persistence_context_t *ctx,
+                          anjay_attr_storage_t *fas,
+                          int32_t *last_oid,
+                          int version) {
+    anjay_oid_t oid;
+    int retval = avs_persistence_u16(ctx, &oid);
+    if (retval) {
+        return retval;
+    }
+    if (oid <= *last_oid) {
+        return -1;
+    }
+    *last_oid = oid;
+    uint32_t count;
+    (void) ((retval = restore_attrs_list(ctx, fas, oid, FAS_ID_NONE,
+                                         FAS_ID_NONE, version))
+            || (retval = avs_persistence_u32(ctx, &count)));
+    int32_t last_iid = -1;
+    for (uint32_t i = 0; !retval && i < count; ++i) {
+        retval = restore_instance(ctx, fas, oid, &last_iid, version);
+    }
+    return retval;
 }
 
-static bool is_attr_storage_sane(anjay_attr_storage_t *fas) {
+static int restore_table(avs_persistence_context_t *ctx,
+                         anjay_attr_storage_t *fas,
+                         int version) {
+    uint32_t count;
+    int retval = avs_persistence_u32(ctx, &count);
     int32_t last_oid = -1;
-    AVS_LIST(fas_object_entry_t) *object_ptr;
-    AVS_LIST(fas_object_entry_t) object_helper;
-    AVS_LIST_DELETABLE_FOREACH_PTR(object_ptr, object_helper, &fas->objects) {
-        if ((*object_ptr)->oid <= last_oid) {
-            return false;
-        }
-        last_oid = (*object_ptr)->oid;
-        if (!is_object_sane(*object_ptr)) {
-            return false;
-        }
+    for (uint32_t i = 0; !retval && i < count; ++i) {
+        retval = restore_object(ctx, fas, &last_oid, version);
     }
-    return true;
+    return retval;
 }
 
 static int collect_existing_iids(anjay_t *anjay,
@@ -282,63 +399,76 @@ static int collect_existing_iids(anjay_t *anjay,
 
 static int clear_nonexistent_iids(anjay_t *anjay,
                                   anjay_attr_storage_t *fas,
-                                  AVS_LIST(fas_object_entry_t) *object_ptr,
                                   const anjay_dm_object_def_t *const *def_ptr) {
     AVS_LIST(anjay_iid_t) iids = NULL;
     int result = collect_existing_iids(anjay, &iids, def_ptr);
     if (!result) {
         _anjay_attr_storage_remove_instances_not_on_sorted_list(
-                fas, *object_ptr, iids);
+                fas, (*def_ptr)->oid, iids);
     }
     AVS_LIST_CLEAR(&iids);
     return result;
 }
 
+static void find_object_range(const fas_table_t *table,
+                              anjay_oid_t oid,
+                              size_t *out_begin,
+                              size_t *out_end) {
+    fas_table_find_range(table, fas_key_make(oid, FAS_ID_NONE, FAS_ID_NONE, 0),
+                         FAS_KEY_OID_SHIFT, out_begin, out_end);
+}
+
 static int clear_nonexistent_rids(anjay_t *anjay,
                                   anjay_attr_storage_t *fas,
-                                  AVS_LIST(fas_object_entry_t) *object_ptr,
                                   const anjay_dm_object_def_t *const *def_ptr) {
-    AVS_LIST(fas_instance_entry_t) *instance_ptr;
-    AVS_LIST(fas_instance_entry_t) instance_helper;
-    AVS_LIST_DELETABLE_FOREACH_PTR(instance_ptr, instance_helper,
-                                   &(*object_ptr)->instances) {
-        AVS_LIST(fas_resource_entry_t) *resource_ptr;
-        AVS_LIST(fas_resource_entry_t) resource_helper;
-        AVS_LIST_DELETABLE_FOREACH_PTR(resource_ptr, resource_helper,
-                                       &(*instance_ptr)->resources) {
-            int rid_present = _anjay_dm_resource_supported_and_present(
-                    anjay, def_ptr, (*instance_ptr)->iid, (*resource_ptr)->rid,
-                    &_anjay_attr_storage_MODULE);
-            if (rid_present < 0) {
-                return -1;
-            } else if (!rid_present) {
-                remove_resource_entry(fas, resource_ptr);
-            }
+    size_t begin, end;
+    find_object_range(&fas->table, (*def_ptr)->oid, &begin, &end);
+    while (begin < end) {
+        size_t resource_end = fas_table_group_end(&fas->table, begin, end,
+                                                  FAS_KEY_RID_SHIFT);
+        fas_key_t key = fas->table.entries[begin].key;
+        if (fas_key_rid(key) == FAS_ID_NONE) {
+            // Object-level or Instance-level default attributes
+            begin = resource_end;
+            continue;
+        }
+        int rid_present = _anjay_dm_resource_supported_and_present(
+                anjay, def_ptr, fas_key_iid(key), fas_key_rid(key),
+                &_anjay_attr_storage_MODULE);
+        if (rid_present < 0) {
+            return -1;
+        } else if (!rid_present) {
+            _anjay_attr_storage_erase_entries(fas, begin, resource_end);
+            end -= resource_end - begin;
+        } else {
+            begin = resource_end;
         }
-        remove_instance_if_empty(instance_ptr);
     }
     return 0;
 }
 
 static int clear_nonexistent_entries(anjay_t *anjay,
                                      anjay_attr_storage_t *fas) {
-    AVS_LIST(fas_object_entry_t) *object_ptr;
-    AVS_LIST(fas_object_entry_t) object_helper;
-    AVS_LIST_DELETABLE_FOREACH_PTR(object_ptr, object_helper, &fas->objects) {
+    size_t begin = 0;
+    while (begin < fas->table.size) {
+        anjay_oid_t oid = fas_key_oid(fas->table.entries[begin].key);
         const anjay_dm_object_def_t *const *def_ptr =
-                _anjay_dm_find_object_by_oid(anjay, (*object_ptr)->oid);
-        if (!def_ptr) {
-            remove_object_entry(fas, object_ptr);
-        } else {
+                _anjay_dm_find_object_by_oid(anjay, oid);
+        if (def_ptr) {
             int retval;
-            if ((retval = clear_nonexistent_iids(anjay, fas, object_ptr,
-                                                 def_ptr))
-                    || (retval = clear_nonexistent_rids(anjay, fas, object_ptr,
+            if ((retval = clear_nonexistent_iids(anjay, fas, def_ptr))
+                    || (retval = clear_nonexistent_rids(anjay, fas,
                                                         def_ptr))) {
                 return retval;
             }
-            remove_object_if_empty(object_ptr);
         }
+        size_t end;
+        find_object_range(&fas->table, oid, &begin, &end);
+        if (!def_ptr) {
+            _anjay_attr_storage_erase_entries(fas, begin, end);
+            end = begin;
+        }
+        begin = end;
     }
     return 0;
 }
@@ -368,7 +498,7 @@ int _anjay_attr_storage_persist_inner(anjay_attr_storage_t *attr_storage,
         fas_log(ERROR, "Out of memory");
         return -1;
     }
-    retval = HANDLE_LIST(object, ctx, &attr_storage->objects, (void *) 2);
+    retval = persist_table(ctx, &attr_storage->table);
     avs_persistence_context_delete(ctx);
     return retval;
 }
@@ -389,7 +519,7 @@ int _anjay_attr_storage_restore_inner(anjay_t *anjay,
         return retval;
     }
 
-    intptr_t version;
+    int version;
     if (!memcmp(magic_buffer, MAGIC_V0, sizeof(MAGIC_V0))) {
         version = 0;
     } else if (!memcmp(magic_buffer, MAGIC_V2, sizeof(MAGIC_V2))) {
@@ -404,9 +534,7 @@ int _anjay_attr_storage_restore_inner(anjay_t *anjay,
         fas_log(ERROR, "Out of memory");
         retval = -1;
     } else {
-        (void) ((retval = HANDLE_LIST(object, ctx, &attr_storage->objects,
-                                      (void *) version))
-                || (retval = (is_attr_storage_sane(attr_storage) ? 0 : -1))
+        (void) ((retval = restore_table(ctx, attr_storage, version))
                 || (retval = clear_nonexistent_entries(anjay,
                                                        attr_storage)));
         avs_persistence_context_delete(ctx);
@@ -21,8 +21,6 @@
 #include <math.h>
 #include <string.h>
 
-#include <avsystem/commons/stream/stream_membuf.h>
-
 #include <anjay_modules/dm_utils.h>
 #include <anjay_modules/raw_buffer.h>
 
@@ -46,12 +44,14 @@ static anjay_dm_transaction_begin_t transaction_begin;
 static anjay_dm_transaction_commit_t transaction_commit;
 static anjay_dm_transaction_rollback_t transaction_rollback;
 
+static void journal_reset(fas_saved_state_t *state);
+
 static void fas_delete(anjay_t *anjay, void *fas_) {
     (void) anjay;
     anjay_attr_storage_t *fas = (anjay_attr_storage_t *) fas_;
     assert(fas);
     _anjay_attr_storage_clear(fas);
-    avs_stream_cleanup(&fas->saved_state.persist_data);
+    journal_reset(&fas->saved_state);
     avs_free(fas);
 }
 
@@ -71,7 +71,11 @@ const anjay_dm_module_t _anjay_attr_storage_MODULE = {
         .transaction_commit = transaction_commit,
         .transaction_rollback = transaction_rollback
     },
-    .deleter = fas_delete
+    .deleter = fas_delete,
+    .snapshot_name = "attr_storage",
+    .snapshot_stage = ANJAY_DM_MODULE_SNAPSHOT_METADATA,
+    .persist = anjay_attr_storage_persist,
+    .restore = anjay_attr_storage_restore
 };
 
 int anjay_attr_storage_install(anjay_t *anjay) {
@@ -85,10 +89,7 @@ int anjay_attr_storage_install(anjay_t *anjay) {
         fas_log(ERROR, "out of memory");
         return -1;
     }
-    if (!(fas->saved_state.persist_data = avs_stream_membuf_create())
-            || _anjay_dm_module_install(anjay,
-                                        &_anjay_attr_storage_MODULE, fas)) {
-        avs_stream_cleanup(&fas->saved_state.persist_data);
+    if (_anjay_dm_module_install(anjay, &_anjay_attr_storage_MODULE, fas)) {
         avs_free(fas);
         return -1;
     }
@@ -110,10 +111,176 @@ bool anjay_attr_storage_is_modified(anjay_t *anjay) {
     return fas->modified_since_persist;
 }
 
+static void journal_record_range(anjay_attr_storage_t *fas,
+                                 size_t begin,
+                                 size_t end);
+
 void _anjay_attr_storage_clear(anjay_attr_storage_t *fas) {
     reset_it_state(&fas->iteration);
-    while (fas->objects) {
-        remove_object_entry(fas, &fas->objects);
+    if (fas->table.size) {
+        journal_record_range(fas, 0, fas->table.size);
+        mark_modified(fas);
+    }
+    _anjay_attr_storage_table_clear(&fas->table);
+}
+
+//// ENTRY TABLE ///////////////////////////////////////////////////////////////
+
+fas_entry_t *_anjay_attr_storage_table_insert(fas_table_t *table,
+                                              size_t index,
+                                              fas_key_t key) {
+    assert(index <= table->size);
+    assert(index == 0 || table->entries[index - 1].key < key);
+    assert(index == table->size || key < table->entries[index].key);
+    if (table->size == table->capacity) {
+        size_t new_capacity = table->capacity ? 2 * table->capacity : 8;
+        fas_entry_t *new_entries = NULL;
+        if (new_capacity <= SIZE_MAX / sizeof(fas_entry_t)) {
+            new_entries = (fas_entry_t *) avs_realloc(
+                    table->entries, new_capacity * sizeof(fas_entry_t));
+        }
+        if (!new_entries) {
+            fas_log(ERROR, "Out of memory");
+            return NULL;
+        }
+        table->entries = new_entries;
+        table->capacity = new_capacity;
+    }
+    memmove(&table->entries[index + 1], &table->entries[index],
+            (table->size - index) * sizeof(fas_entry_t));
+    ++table->size;
+    table->entries[index].key = key;
+    table->entries[index].attrs = ANJAY_DM_INTERNAL_RES_ATTRS_EMPTY;
+    return &table->entries[index];
+}
+
+void _anjay_attr_storage_table_erase(fas_table_t *table,
+                                     size_t begin,
+                                     size_t end) {
+    assert(begin <= end && end <= table->size);
+    if (begin < end) {
+        memmove(&table->entries[begin], &table->entries[end],
+                (table->size - end) * sizeof(fas_entry_t));
+        table->size -= end - begin;
+    }
+}
+
+void _anjay_attr_storage_table_clear(fas_table_t *table) {
+    avs_free(table->entries);
+    table->entries = NULL;
+    table->size = 0;
+    table->capacity = 0;
+}
+
+//// TRANSACTION JOURNAL ///////////////////////////////////////////////////////
+
+/**
+ * Records the state of the entry with @p key from before its modification.
+ * @p old_entry is the current entry, or NULL if it does not exist yet.
+ */
+static void journal_record(anjay_attr_storage_t *fas,
+                           fas_key_t key,
+                           const fas_entry_t *old_entry) {
+    fas_saved_state_t *state = &fas->saved_state;
+    if (!state->depth || state->records_lost) {
+        return;
+    }
+    if (state->records_size == state->records_capacity) {
+        size_t new_capacity =
+                state->records_capacity ? 2 * state->records_capacity : 8;
+        fas_undo_record_t *new_records = NULL;
+        if (new_capacity <= SIZE_MAX / sizeof(fas_undo_record_t)) {
+            new_records = (fas_undo_record_t *) avs_realloc(
+                    state->records, new_capacity * sizeof(fas_undo_record_t));
+        }
+        if (!new_records) {
+            fas_log(ERROR, "Out of memory, transaction will not be possible "
+                           "to roll back");
+            state->records_lost = true;
+            return;
+        }
+        state->records = new_records;
+        state->records_capacity = new_capacity;
+    }
+    fas_undo_record_t *record = &state->records[state->records_size++];
+    if (old_entry) {
+        assert(old_entry->key == key);
+        record->entry = *old_entry;
+        record->existed = true;
+    } else {
+        record->entry.key = key;
+        record->entry.attrs = ANJAY_DM_INTERNAL_RES_ATTRS_EMPTY;
+        record->existed = false;
+    }
+}
+
+static void journal_record_range(anjay_attr_storage_t *fas,
+                                 size_t begin,
+                                 size_t end) {
+    if (fas->saved_state.depth) {
+        for (size_t i = begin; i < end; ++i) {
+            journal_record(fas, fas->table.entries[i].key,
+                           &fas->table.entries[i]);
+        }
+    }
+}
+
+static void journal_reset(fas_saved_state_t *state) {
+    avs_free(state->records);
+    state->records = NULL;
+    state->records_size = 0;
+    state->records_capacity = 0;
+    state->records_lost = false;
+}
+
+/**
+ * Undoes all the recorded modifications, newest first.
+ */
+static int journal_replay(anjay_attr_storage_t *fas) {
+    const fas_saved_state_t *state = &fas->saved_state;
+    if (state->records_lost) {
+        return -1;
+    }
+    for (size_t i = state->records_size; i-- > 0;) {
+        const fas_undo_record_t *record = &state->records[i];
+        size_t index = fas_table_lower_bound(&fas->table, record->entry.key);
+        bool found = (index < fas->table.size
+                      && fas->table.entries[index].key == record->entry.key);
+        if (record->existed) {
+            fas_entry_t *entry =
+                    found ? &fas->table.entries[index]
+                          : _anjay_attr_storage_table_insert(
+                                    &fas->table, index, record->entry.key);
+            if (!entry) {
+                return -1;
+            }
+            entry->attrs = record->entry.attrs;
+        } else if (found) {
+            _anjay_attr_storage_table_erase(&fas->table, index, index + 1);
+        }
+    }
+    return 0;
+}
+
+fas_entry_t *_anjay_attr_storage_insert_entry(anjay_attr_storage_t *fas,
+                                              size_t index,
+                                              fas_key_t key) {
+    journal_record(fas, key, NULL);
+    fas_entry_t *entry =
+            _anjay_attr_storage_table_insert(&fas->table, index, key);
+    if (entry) {
+        mark_modified(fas);
+    }
+    return entry;
+}
+
+void _anjay_attr_storage_erase_entries(anjay_attr_storage_t *fas,
+                                       size_t begin,
+                                       size_t end) {
+    if (begin < end) {
+        journal_record_range(fas, begin, end);
+        _anjay_attr_storage_table_erase(&fas->table, begin, end);
+        mark_modified(fas);
     }
 }
 
@@ -158,13 +325,6 @@ static bool implements_any_resource_attrs_handlers(
                                                       resource_write_attrs));
 }
 
-static void
-remove_resource_if_empty(AVS_LIST(fas_resource_entry_t) *entry_ptr) {
-    if (!(*entry_ptr)->attrs) {
-        AVS_LIST_DELETE(entry_ptr);
-    }
-}
-
 anjay_attr_storage_t *_anjay_attr_storage_get(anjay_t *anjay) {
     return (anjay_attr_storage_t *)
             _anjay_dm_module_get_arg(anjay, &_anjay_attr_storage_MODULE);
@@ -177,109 +337,44 @@ static anjay_attr_storage_t *get_fas(anjay_t *anjay) {
     return (anjay_attr_storage_t *) fas;
 }
 
-AVS_STATIC_ASSERT(offsetof(fas_object_entry_t, oid) == 0,
-                  object_id_offset);
-AVS_STATIC_ASSERT(offsetof(fas_instance_entry_t, iid) == 0,
-                  instance_id_offset);
-AVS_STATIC_ASSERT(offsetof(fas_resource_entry_t, rid) == 0,
-                  resource_id_offset);
-
-static AVS_LIST(void) *
-find_or_create_entry_impl(AVS_LIST(void) *children_list_ptr,
-                          size_t entry_size,
-                          uint16_t id,
-                          bool allow_create) {
-    AVS_LIST(void) *entry_ptr;
-    AVS_LIST_FOREACH_PTR(entry_ptr, children_list_ptr) {
-        if (*(uint16_t *) *entry_ptr >= id) {
-            break;
-        }
-    }
-    if (!*entry_ptr || *(uint16_t *) *entry_ptr != id) {
-        if (allow_create) {
-            AVS_LIST(void) new_entry = AVS_LIST_NEW_BUFFER(entry_size);
-            if (!new_entry) {
-                fas_log(ERROR, "Out of memory");
-                return NULL;
-            }
-            *(uint16_t *) new_entry = id;
-            AVS_LIST_INSERT(entry_ptr, new_entry);
-        } else {
-            return NULL;
-        }
+/**
+ * Erases the tail left over after compacting the range that ends at @p end
+ * down to @p kept entries. The removed entries are expected to have been
+ * already recorded in the journal.
+ */
+static void erase_compacted(anjay_attr_storage_t *fas,
+                            size_t kept,
+                            size_t end) {
+    if (kept < end) {
+        _anjay_attr_storage_table_erase(&fas->table, kept, end);
+        mark_modified(fas);
     }
-    return entry_ptr;
-}
-
-static inline
-AVS_LIST(fas_object_entry_t) *find_object(anjay_attr_storage_t *parent,
-                                          anjay_oid_t id) {
-    return (AVS_LIST(fas_object_entry_t) *)
-            find_or_create_entry_impl((AVS_LIST(void) *) &parent->objects,
-                                      sizeof(fas_object_entry_t), id, false);
-}
-
-static inline
-AVS_LIST(fas_object_entry_t) *find_or_create_object(anjay_attr_storage_t *parent,
-                                                    anjay_oid_t id) {
-    return (AVS_LIST(fas_object_entry_t) *)
-            find_or_create_entry_impl((AVS_LIST(void) *) &parent->objects,
-                                      sizeof(fas_object_entry_t), id, true);
-}
-
-static inline
-AVS_LIST(fas_instance_entry_t) *find_instance(fas_object_entry_t *parent,
-                                              anjay_iid_t id) {
-    return (AVS_LIST(fas_instance_entry_t) *)
-            find_or_create_entry_impl((AVS_LIST(void) *) &parent->instances,
-                                      sizeof(fas_instance_entry_t), id, false);
-}
-
-static inline
-AVS_LIST(fas_instance_entry_t) *find_or_create_instance(fas_object_entry_t *parent,
-                                                        anjay_iid_t id) {
-    return (AVS_LIST(fas_instance_entry_t) *)
-            find_or_create_entry_impl((AVS_LIST(void) *) &parent->instances,
-                                      sizeof(fas_instance_entry_t), id, true);
-}
-
-static inline
-AVS_LIST(fas_resource_entry_t) *find_resource(fas_instance_entry_t *parent,
-                                              anjay_rid_t id) {
-    return (AVS_LIST(fas_resource_entry_t) *)
-            find_or_create_entry_impl((AVS_LIST(void) *) &parent->resources,
-                                      sizeof(fas_resource_entry_t), id, false);
-}
-
-static inline AVS_LIST(fas_resource_entry_t) *
-find_or_create_resource(fas_instance_entry_t *parent, anjay_rid_t id) {
-    return (AVS_LIST(fas_resource_entry_t) *)
-            find_or_create_entry_impl((AVS_LIST(void) *) &parent->resources,
-                                      sizeof(fas_resource_entry_t), id, true);
 }
 
 static void remove_instance(anjay_attr_storage_t *fas,
-                            AVS_LIST(fas_object_entry_t) *object_ptr,
+                            anjay_oid_t oid,
                             anjay_iid_t iid) {
-    AVS_LIST(fas_instance_entry_t) *instance_ptr = find_instance(*object_ptr,
-                                                                 iid);
-    if (instance_ptr && *instance_ptr) {
-        remove_instance_entry(fas, instance_ptr);
-    }
-    remove_object_if_empty(object_ptr);
+    if (iid == FAS_ID_NONE) {
+        return;
+    }
+    size_t begin, end;
+    fas_table_find_range(&fas->table,
+                         fas_key_make(oid, iid, FAS_ID_NONE, 0),
+                         FAS_KEY_IID_SHIFT, &begin, &end);
+    _anjay_attr_storage_erase_entries(fas, begin, end);
 }
 
 static void remove_resource(anjay_attr_storage_t *fas,
-                            AVS_LIST(fas_object_entry_t) *object_ptr,
-                            AVS_LIST(fas_instance_entry_t) *instance_ptr,
+                            anjay_oid_t oid,
+                            anjay_iid_t iid,
                             anjay_rid_t rid) {
-    AVS_LIST(fas_resource_entry_t) *resource_ptr = find_resource(*instance_ptr,
-                                                                 rid);
-    if (resource_ptr) {
-        remove_resource_entry(fas, resource_ptr);
+    if (iid == FAS_ID_NONE || rid == FAS_ID_NONE) {
+        return;
     }
-    remove_instance_if_empty(instance_ptr);
-    remove_object_if_empty(object_ptr);
+    size_t begin, end;
+    fas_table_find_range(&fas->table, fas_key_make(oid, iid, rid, 0),
+                         FAS_KEY_RID_SHIFT, &begin, &end);
+    _anjay_attr_storage_erase_entries(fas, begin, end);
 }
 
 static inline bool is_ssid_reference_object(anjay_oid_t oid) {
@@ -315,80 +410,42 @@ query_ssid(anjay_t *anjay, anjay_oid_t oid, anjay_iid_t iid) {
     return (anjay_ssid_t) ssid;
 }
 
-static void remove_attrs_entry(anjay_attr_storage_t *fas,
-                               AVS_LIST(void) *attrs_ptr) {
-    AVS_LIST_DELETE(attrs_ptr);
-    mark_modified(fas);
-}
+typedef bool entry_predicate_t(const fas_entry_t *entry, void *arg);
 
-static void remove_attrs_for_server(anjay_attr_storage_t *fas,
-                                    AVS_LIST(void) *attrs_ptr,
-                                    void *ssid_ptr) {
-    anjay_ssid_t ssid = *(anjay_ssid_t *) ssid_ptr;
-    AVS_LIST_ITERATE_PTR(attrs_ptr) {
-        assert(!*AVS_LIST_NEXT_PTR(attrs_ptr)
-               || *get_ssid_ptr(*attrs_ptr)
-                        < *get_ssid_ptr(*AVS_LIST_NEXT_PTR(attrs_ptr)));
-        if (*get_ssid_ptr(*attrs_ptr) == ssid) {
-            remove_attrs_entry(fas, attrs_ptr);
-            assert(!*attrs_ptr || ssid < *get_ssid_ptr(*attrs_ptr));
-            return;
-        } else if (*get_ssid_ptr(*attrs_ptr) > ssid) {
-            break;
-        }
-    }
-}
-
-static void remove_attrs_for_servers_not_on_list(anjay_attr_storage_t *fas,
-                                                 AVS_LIST(void) *attrs_ptr,
-                                                 void *ssid_list_ptr) {
-    AVS_LIST(anjay_ssid_t) ssid_ptr = *(AVS_LIST(anjay_ssid_t) *) ssid_list_ptr;
-    while (*attrs_ptr) {
-        if (!ssid_ptr || *get_ssid_ptr(*attrs_ptr) < *ssid_ptr) {
-            remove_attrs_entry(fas, attrs_ptr);
+static void remove_entries_if(anjay_attr_storage_t *fas,
+                              entry_predicate_t *predicate,
+                              void *arg) {
+    fas_entry_t *entries = fas->table.entries;
+    size_t kept = 0;
+    for (size_t i = 0; i < fas->table.size; ++i) {
+        if (predicate(&entries[i], arg)) {
+            journal_record(fas, entries[i].key, &entries[i]);
         } else {
-            while (ssid_ptr && *get_ssid_ptr(*attrs_ptr) > *ssid_ptr) {
-                AVS_LIST_ADVANCE(&ssid_ptr);
-            }
-            if (ssid_ptr && *get_ssid_ptr(*attrs_ptr) == *ssid_ptr) {
-                AVS_LIST_ADVANCE(&ssid_ptr);
-                AVS_LIST_ADVANCE_PTR(&attrs_ptr);
+            if (kept != i) {
+                entries[kept] = entries[i];
             }
+            ++kept;
         }
     }
+    erase_compacted(fas, kept, fas->table.size);
 }
 
-typedef void remove_attrs_func_t(anjay_attr_storage_t *fas,
-                                 AVS_LIST(void) *attrs_ptr,
-                                 void *ssid_ref_ptr);
-
-static void remove_servers(anjay_attr_storage_t *fas,
-                           remove_attrs_func_t *remove_attrs_func,
-                           void *ssid_ref) {
-    AVS_LIST(fas_object_entry_t) *object_ptr;
-    AVS_LIST(fas_object_entry_t) object_helper;
-    AVS_LIST_DELETABLE_FOREACH_PTR(object_ptr, object_helper, &fas->objects) {
-        remove_attrs_func(fas, (AVS_LIST(void) *) &(*object_ptr)->default_attrs,
-                          ssid_ref);
-        AVS_LIST(fas_instance_entry_t) *instance_ptr;
-        AVS_LIST(fas_instance_entry_t) instance_helper;
-        AVS_LIST_DELETABLE_FOREACH_PTR(instance_ptr, instance_helper,
-                                       &(*object_ptr)->instances) {
-            remove_attrs_func(
-                    fas, (AVS_LIST(void) *) &(*instance_ptr)->default_attrs,
-                              ssid_ref);
-            AVS_LIST(fas_resource_entry_t) *res_ptr;
-            AVS_LIST(fas_resource_entry_t) res_helper;
-            AVS_LIST_DELETABLE_FOREACH_PTR(res_ptr, res_helper,
-                                           &(*instance_ptr)->resources) {
-                remove_attrs_func(fas, (AVS_LIST(void) *) &(*res_ptr)->attrs,
-                                  ssid_ref);
-                remove_resource_if_empty(res_ptr);
-            }
-            remove_instance_if_empty(instance_ptr);
+static bool is_for_server(const fas_entry_t *entry, void *ssid_ptr) {
+    return fas_key_ssid(entry->key) == *(const anjay_ssid_t *) ssid_ptr;
+}
+
+static bool is_for_server_not_on_list(const fas_entry_t *entry,
+                                      void *ssid_list_ptr) {
+    anjay_ssid_t ssid = fas_key_ssid(entry->key);
+    AVS_LIST(anjay_ssid_t) ssid_ptr;
+    AVS_LIST_FOREACH(ssid_ptr, *(AVS_LIST(anjay_ssid_t) *) ssid_list_ptr) {
+        if (*ssid_ptr == ssid) {
+            return false;
+        } else if (*ssid_ptr > ssid) {
+            break;
         }
-        remove_object_if_empty(object_ptr);
     }
+    return true;
 }
 
 int _anjay_attr_storage_compare_u16ids(const void *a, const void *b,
@@ -417,43 +474,48 @@ remove_servers_after_iteration(anjay_t *anjay,
     }
 
     AVS_LIST_SORT(&ssids, _anjay_attr_storage_compare_u16ids);
-    remove_servers(fas, remove_attrs_for_servers_not_on_list, &ssids);
+    remove_entries_if(fas, is_for_server_not_on_list, &ssids);
     AVS_LIST_CLEAR(&ssids);
     return 0;
 }
 
 void _anjay_attr_storage_remove_instances_not_on_sorted_list(
         anjay_attr_storage_t *fas,
-        fas_object_entry_t *object,
+        anjay_oid_t oid,
         AVS_LIST(anjay_iid_t) iids) {
-    AVS_LIST(anjay_iid_t) iid = iids;
-    AVS_LIST(fas_instance_entry_t) *instance_ptr = &object->instances;
-    while (*instance_ptr) {
-        if (!iid || (*instance_ptr)->iid < *iid) {
-            remove_instance_entry(fas, instance_ptr);
-        } else {
-            while (iid && (*instance_ptr)->iid > *iid) {
-                AVS_LIST_ADVANCE(&iid);
+    size_t begin, end;
+    fas_table_find_range(&fas->table,
+                         fas_key_make(oid, FAS_ID_NONE, FAS_ID_NONE, 0),
+                         FAS_KEY_OID_SHIFT, &begin, &end);
+    // both the entries and the IID list are sorted, so a single merge-like
+    // pass is enough; Object-level entries sort first and are always kept
+    fas_entry_t *entries = fas->table.entries;
+    size_t kept = begin;
+    for (size_t i = begin; i < end; ++i) {
+        anjay_iid_t entry_iid = fas_key_iid(entries[i].key);
+        if (entry_iid != FAS_ID_NONE) {
+            while (iids && *iids < entry_iid) {
+                AVS_LIST_ADVANCE(&iids);
             }
-            if (iid && (*instance_ptr)->iid == *iid) {
-                AVS_LIST_ADVANCE(&iid);
-                AVS_LIST_ADVANCE_PTR(&instance_ptr);
+            if (!iids || *iids != entry_iid) {
+                journal_record(fas, entries[i].key, &entries[i]);
+                continue;
             }
         }
+        if (kept != i) {
+            entries[kept] = entries[i];
+        }
+        ++kept;
     }
+    erase_compacted(fas, kept, end);
 }
 
 static int remove_instances_after_iteration(anjay_t *anjay,
                                             anjay_attr_storage_t *fas) {
     int result = 0;
-    AVS_LIST(fas_object_entry_t) *object_ptr =
-            find_object(fas, fas->iteration.oid);
-    if (object_ptr) {
-        AVS_LIST_SORT(&fas->iteration.iids, _anjay_attr_storage_compare_u16ids);
-        _anjay_attr_storage_remove_instances_not_on_sorted_list(
-                fas, *object_ptr, fas->iteration.iids);
-        remove_object_if_empty(object_ptr);
-    }
+    AVS_LIST_SORT(&fas->iteration.iids, _anjay_attr_storage_compare_u16ids);
+    _anjay_attr_storage_remove_instances_not_on_sorted_list(
+            fas, fas->iteration.oid, fas->iteration.iids);
     if (is_ssid_reference_object(fas->iteration.oid)) {
         result = remove_servers_after_iteration(anjay, fas);
     }
@@ -461,77 +523,68 @@ static int remove_instances_after_iteration(anjay_t *anjay,
     return result;
 }
 
-static void read_default_attrs(AVS_LIST(fas_default_attrs_t) attrs,
-                               anjay_ssid_t ssid,
+static void read_default_attrs(anjay_attr_storage_t *fas,
+                               fas_key_t key,
                                anjay_dm_internal_attrs_t *out) {
-    AVS_LIST_ITERATE(attrs) {
-        if (attrs->ssid == ssid) {
-            *out = attrs->attrs;
-            return;
-        } else if (attrs->ssid > ssid) {
-            break;
-        }
+    const fas_entry_t *entry = fas_table_find(&fas->table, key);
+    if (entry) {
+        *out = *fas_entry_default_attrs_const(entry);
+    } else {
+        *out = ANJAY_DM_INTERNAL_ATTRS_EMPTY;
     }
-    *out = ANJAY_DM_INTERNAL_ATTRS_EMPTY;
 }
 
-static void read_resource_attrs(AVS_LIST(fas_resource_attrs_t) attrs,
-                                anjay_ssid_t ssid,
+static void read_resource_attrs(anjay_attr_storage_t *fas,
+                                fas_key_t key,
                                 anjay_dm_internal_res_attrs_t *out) {
-    AVS_LIST_ITERATE(attrs) {
-        if (attrs->ssid == ssid) {
-            *out = attrs->attrs;
-            return;
-        } else if (attrs->ssid > ssid) {
-            break;
-        }
+    const fas_entry_t *entry = fas_table_find(&fas->table, key);
+    if (entry) {
+        *out = entry->attrs;
+    } else {
+        *out = ANJAY_DM_INTERNAL_RES_ATTRS_EMPTY;
     }
-    *out = ANJAY_DM_INTERNAL_RES_ATTRS_EMPTY;
 }
 
-static int write_attrs_impl(anjay_attr_storage_t *fas,
-                            AVS_LIST(void) *out_attrs,
-                            size_t element_size,
-                            size_t attrs_field_offset,
-                            size_t attrs_field_size,
-                            is_empty_func_t *is_empty_func,
-                            anjay_ssid_t ssid,
-                            const void *attrs) {
-    AVS_LIST_ITERATE_PTR(out_attrs) {
-        if (*get_ssid_ptr(*out_attrs) >= ssid) {
-            break;
-        }
-    }
-    bool found = (*out_attrs && *get_ssid_ptr(*out_attrs) == ssid);
-    bool filled = !is_empty_func(attrs);
+/**
+ * Prepares the entry for @p key to be written. If @p filled is true, the entry
+ * is created if necessary and returned through @p out_entry. Otherwise, i.e.
+ * when writing an empty set of attributes, the entry is removed if it exists
+ * and @p out_entry is set to NULL.
+ */
+static int prepare_entry_for_write(anjay_attr_storage_t *fas,
+                                   fas_key_t key,
+                                   bool filled,
+                                   fas_entry_t **out_entry) {
+    size_t index = fas_table_lower_bound(&fas->table, key);
+    bool found = (index < fas->table.size
+                  && fas->table.entries[index].key == key);
+    *out_entry = NULL;
     if (filled) {
-        // writing non-empty set of attributes
-        if (!found) {
-            // entry does not exist, creating
-            AVS_LIST(void) new_attrs = AVS_LIST_NEW_BUFFER(element_size);
-            if (!new_attrs) {
-                fas_log(ERROR, "Out of memory");
-                return ANJAY_ERR_INTERNAL;
-            }
-            *get_ssid_ptr(new_attrs) = ssid;
-            AVS_LIST_INSERT(out_attrs, new_attrs);
+        if (found) {
+            *out_entry = &fas->table.entries[index];
+            journal_record(fas, key, *out_entry);
+            mark_modified(fas);
+        } else if (!(*out_entry = _anjay_attr_storage_insert_entry(fas, index,
+                                                                   key))) {
+            return -1;
         }
-        memcpy(get_attrs_ptr(*out_attrs, attrs_field_offset), attrs,
-               attrs_field_size);
-        mark_modified(fas);
     } else if (found) {
-        // entry exists, but writing EMPTY set of attributes
-        // hence - removing
-        remove_attrs_entry(fas, (AVS_LIST(void) *) out_attrs);
+        _anjay_attr_storage_erase_entries(fas, index, index + 1);
     }
     return 0;
 }
 
-#define WRITE_ATTRS(Fas, OutAttrs, IsEmptyFunc, Ssid, Attrs) \
-    write_attrs_impl( \
-            (Fas), (AVS_LIST(void) *) (OutAttrs), sizeof(**(OutAttrs)), \
-            (size_t) ((char *) &(*(OutAttrs))->attrs - (char *) *(OutAttrs)), \
-            sizeof((*(OutAttrs))->attrs), (IsEmptyFunc), (Ssid), (Attrs))
+static int write_default_attrs(anjay_attr_storage_t *fas,
+                               fas_key_t key,
+                               const anjay_dm_internal_attrs_t *attrs) {
+    fas_entry_t *entry;
+    int result = prepare_entry_for_write(fas, key, !default_attrs_empty(attrs),
+                                         &entry);
+    if (entry) {
+        *fas_entry_default_attrs(entry) = *attrs;
+    }
+    return result;
+}
 
 static int write_object_attrs(anjay_t *anjay,
                               anjay_ssid_t ssid,
@@ -542,15 +595,9 @@ static int write_object_attrs(anjay_t *anjay,
         fas_log(ERROR, "Attribute Storage module is not installed");
         return -1;
     }
-    AVS_LIST(fas_object_entry_t) *object_ptr =
-            find_or_create_object(fas, (*obj_ptr)->oid);
-    if (!object_ptr) {
-        return -1;
-    }
-    int result = WRITE_ATTRS(fas, &(*object_ptr)->default_attrs,
-                             default_attrs_empty, ssid, attrs);
-    remove_object_if_empty(object_ptr);
-    return result;
+    return write_default_attrs(
+            fas, fas_key_make((*obj_ptr)->oid, FAS_ID_NONE, FAS_ID_NONE, ssid),
+            attrs);
 }
 
 static int write_instance_attrs(anjay_t *anjay,
@@ -563,26 +610,12 @@ static int write_instance_attrs(anjay_t *anjay,
         fas_log(ERROR, "Attribute Storage module is not installed");
         return -1;
     }
-    AVS_LIST(fas_object_entry_t) *object_ptr =
-            find_or_create_object(fas, (*obj_ptr)->oid);
-    if (!object_ptr) {
+    if (iid == FAS_ID_NONE) {
+        fas_log(ERROR, "invalid instance id");
         return -1;
     }
-    int result = 0;
-    AVS_LIST(fas_instance_entry_t) *instance_ptr =
-            find_or_create_instance(*object_ptr, iid);
-    if (!instance_ptr) {
-        result = -1;
-    }
-    if (!result) {
-        result = WRITE_ATTRS(fas, &(*instance_ptr)->default_attrs,
-                             default_attrs_empty, ssid, attrs);
-    }
-    if (instance_ptr) {
-        remove_instance_if_empty(instance_ptr);
-    }
-    remove_object_if_empty(object_ptr);
-    return result;
+    return write_default_attrs(
+            fas, fas_key_make((*obj_ptr)->oid, iid, FAS_ID_NONE, ssid), attrs);
 }
 
 static int write_resource_attrs(anjay_t *anjay,
@@ -596,33 +629,17 @@ static int write_resource_attrs(anjay_t *anjay,
         fas_log(ERROR, "Attribute Storage module is not installed");
         return -1;
     }
-    AVS_LIST(fas_object_entry_t) *object_ptr =
-            find_or_create_object(fas, (*obj_ptr)->oid);
-    if (!object_ptr) {
+    if (iid == FAS_ID_NONE || rid == FAS_ID_NONE) {
+        fas_log(ERROR, "invalid instance or resource id");
         return -1;
     }
-    int result = 0;
-    AVS_LIST(fas_instance_entry_t) *instance_ptr =
-            find_or_create_instance(*object_ptr, iid);
-    if (!instance_ptr) {
-        result = -1;
-    }
-    AVS_LIST(fas_resource_entry_t) *resource_ptr =
-            result ? NULL : find_or_create_resource(*instance_ptr, rid);
-    if (!resource_ptr) {
-        result = -1;
+    fas_entry_t *entry;
+    int result = prepare_entry_for_write(
+            fas, fas_key_make((*obj_ptr)->oid, iid, rid, ssid),
+            !resource_attrs_empty(attrs), &entry);
+    if (entry) {
+        entry->attrs = *attrs;
     }
-    if (!result) {
-        result = WRITE_ATTRS(fas, &(*resource_ptr)->attrs,
-                             resource_attrs_empty, ssid, attrs);
-    }
-    if (resource_ptr) {
-        remove_resource_if_empty(resource_ptr);
-    }
-    if (instance_ptr) {
-        remove_instance_if_empty(instance_ptr);
-    }
-    remove_object_if_empty(object_ptr);
     return result;
 }
 
@@ -638,10 +655,10 @@ static int object_read_default_attrs(anjay_t *anjay,
         return _anjay_dm_object_read_default_attrs(anjay, obj_ptr, ssid, out,
                                                    &_anjay_attr_storage_MODULE);
     }
-    AVS_LIST(fas_object_entry_t) *object_ptr = find_object(get_fas(anjay),
-                                                           (*obj_ptr)->oid);
-    read_default_attrs(object_ptr ? (*object_ptr)->default_attrs : NULL,
-                       ssid, out);
+    read_default_attrs(get_fas(anjay),
+                       fas_key_make((*obj_ptr)->oid, FAS_ID_NONE, FAS_ID_NONE,
+                                    ssid),
+                       out);
     return 0;
 }
 
@@ -669,12 +686,9 @@ static int instance_read_default_attrs(anjay_t *anjay,
         return _anjay_dm_instance_read_default_attrs(
                 anjay, obj_ptr, iid, ssid, out, &_anjay_attr_storage_MODULE);
     }
-    AVS_LIST(fas_object_entry_t) *object_ptr = find_object(get_fas(anjay),
-                                                           (*obj_ptr)->oid);
-    AVS_LIST(fas_instance_entry_t) *instance_ptr =
-            object_ptr ? find_instance(*object_ptr, iid) : NULL;
-    read_default_attrs(instance_ptr ? (*instance_ptr)->default_attrs : NULL,
-                       ssid, out);
+    read_default_attrs(get_fas(anjay),
+                       fas_key_make((*obj_ptr)->oid, iid, FAS_ID_NONE, ssid),
+                       out);
     return 0;
 }
 
@@ -705,13 +719,8 @@ static int resource_read_attrs(anjay_t *anjay,
         return _anjay_dm_resource_read_attrs(anjay, obj_ptr, iid, rid, ssid,
                                              out, &_anjay_attr_storage_MODULE);
     }
-    AVS_LIST(fas_object_entry_t) *object_ptr = find_object(get_fas(anjay),
-                                                           (*obj_ptr)->oid);
-    AVS_LIST(fas_instance_entry_t) *instance_ptr =
-            object_ptr ? find_instance(*object_ptr, iid) : NULL;
-    AVS_LIST(fas_resource_entry_t) *res_ptr =
-            instance_ptr ? find_resource(*instance_ptr, rid) : NULL;
-    read_resource_attrs(res_ptr ? (*res_ptr)->attrs : NULL, ssid, out);
+    read_resource_attrs(get_fas(anjay),
+                        fas_key_make((*obj_ptr)->oid, iid, rid, ssid), out);
     return 0;
 }
 
@@ -784,11 +793,7 @@ static int instance_present(anjay_t *anjay,
                                             &_anjay_attr_storage_MODULE);
     if (result == 0) {
         anjay_attr_storage_t *fas = get_fas(anjay);
-        AVS_LIST(fas_object_entry_t) *object_ptr = find_object(fas,
-                                                               (*obj_ptr)->oid);
-        if (object_ptr) {
-            remove_instance(fas, object_ptr, iid);
-        }
+        remove_instance(fas, (*obj_ptr)->oid, iid);
     }
     return result;
 }
@@ -801,13 +806,9 @@ static int instance_remove(anjay_t *anjay,
                                            &_anjay_attr_storage_MODULE);
     if (result == 0) {
         anjay_attr_storage_t *fas = get_fas(anjay);
-        AVS_LIST(fas_object_entry_t) *object_ptr = find_object(fas,
-                                                               (*obj_ptr)->oid);
-        if (object_ptr) {
-            remove_instance(fas, object_ptr, iid);
-        }
+        remove_instance(fas, (*obj_ptr)->oid, iid);
         if (ssid) {
-            remove_servers(fas, remove_attrs_for_server, &ssid);
+            remove_entries_if(fas, is_for_server, &ssid);
         }
     }
     return result;
@@ -820,34 +821,23 @@ static int resource_present(anjay_t *anjay,
     int result = _anjay_dm_resource_present(anjay, obj_ptr, iid, rid,
                                             &_anjay_attr_storage_MODULE);
     if (result == 0) {
-        anjay_attr_storage_t *fas = get_fas(anjay);
-        AVS_LIST(fas_object_entry_t) *object_ptr = find_object(fas,
-                                                               (*obj_ptr)->oid);
-        AVS_LIST(fas_instance_entry_t) *instance_ptr =
-                object_ptr ? find_instance(*object_ptr, iid) : NULL;
-        if (instance_ptr) {
-            remove_resource(fas, object_ptr, instance_ptr, rid);
-        }
+        remove_resource(get_fas(anjay), (*obj_ptr)->oid, iid, rid);
     }
     return result;
 }
 
-static void saved_state_reset(anjay_attr_storage_t *fas) {
-    avs_stream_reset(fas->saved_state.persist_data);
-    avs_stream_membuf_fit(fas->saved_state.persist_data);
-}
-
-static int saved_state_save(anjay_attr_storage_t *fas) {
+static void saved_state_save(anjay_attr_storage_t *fas) {
+    assert(!fas->saved_state.records_size);
     fas->saved_state.modified_since_persist = fas->modified_since_persist;
-    return _anjay_attr_storage_persist_inner(fas,
-                                             fas->saved_state.persist_data);
 }
 
-static int saved_state_restore(anjay_t *anjay,
-                               anjay_attr_storage_t *fas) {
-    int result =
-            _anjay_attr_storage_restore_inner(anjay, fas,
-                                              fas->saved_state.persist_data);
+static int saved_state_restore(anjay_attr_storage_t *fas) {
+    reset_it_state(&fas->iteration);
+    int result = journal_replay(fas);
+    if (result) {
+        fas_log(ERROR, "could not roll back Attribute Storage, clearing it");
+        _anjay_attr_storage_table_clear(&fas->table);
+    }
     fas->modified_since_persist =
             (result ? true : fas->saved_state.modified_since_persist);
     return result;
@@ -856,16 +846,10 @@ static int saved_state_restore(anjay_t *anjay,
 static int transaction_begin(anjay_t *anjay,
                              const anjay_dm_object_def_t *const *obj_ptr) {
     anjay_attr_storage_t *fas = get_fas(anjay);
-    if (fas->saved_state.depth++ == 0) {
-        if (saved_state_save(fas)) {
-            --fas->saved_state.depth;
-            return ANJAY_ERR_INTERNAL;
-        }
-    }
     int result = _anjay_dm_delegate_transaction_begin(
             anjay, obj_ptr, &_anjay_attr_storage_MODULE);
-    if (result) {
-        saved_state_reset(fas);
+    if (!result && fas->saved_state.depth++ == 0) {
+        saved_state_save(fas);
     }
     return result;
 }
@@ -876,10 +860,10 @@ static int transaction_commit(anjay_t *anjay,
     int result = _anjay_dm_delegate_transaction_commit(
             anjay, obj_ptr, &_anjay_attr_storage_MODULE);
     if (--fas->saved_state.depth == 0) {
-        if (result && saved_state_restore(anjay, fas)) {
+        if (result && saved_state_restore(fas)) {
             result = ANJAY_ERR_INTERNAL;
         }
-        saved_state_reset(fas);
+        journal_reset(&fas->saved_state);
     }
     return result;
 }
@@ -890,10 +874,10 @@ static int transaction_rollback(anjay_t *anjay,
     int result = _anjay_dm_delegate_transaction_rollback(
             anjay, obj_ptr, &_anjay_attr_storage_MODULE);
     if (--fas->saved_state.depth == 0) {
-        if (saved_state_restore(anjay, fas)) {
+        if (saved_state_restore(fas)) {
             result = ANJAY_ERR_INTERNAL;
         }
-        saved_state_reset(fas);
+        journal_reset(&fas->saved_state);
     }
     return result;
 }
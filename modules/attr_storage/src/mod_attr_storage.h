@@ -17,41 +17,56 @@
 #ifndef ATTR_STORAGE_H
 #define ATTR_STORAGE_H
 
+#include <assert.h>
+
 #include <anjay/attr_storage.h>
 #include <anjay/core.h>
 
+#include <anjay_modules/dm_utils.h>
 #include <anjay_modules/utils_core.h>
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
 #define fas_log(...) _anjay_log(anjay_attr_storage, __VA_ARGS__)
 
-typedef struct {
-    anjay_ssid_t ssid;
-    anjay_dm_internal_attrs_t attrs;
-} fas_default_attrs_t;
+/**
+ * Used in place of the IID and/or RID in keys of Object-level and
+ * Instance-level (default) attribute entries.
+ */
+#define FAS_ID_NONE UINT16_MAX
+
+#define FAS_KEY_OID_SHIFT 48
+#define FAS_KEY_IID_SHIFT 32
+#define FAS_KEY_RID_SHIFT 16
+
+/**
+ * Key of a single attribute entry: OID, IID, RID and SSID, 16 bits each, most
+ * significant first. IID and RID are stored incremented by one (modulo 2^16),
+ * so that FAS_ID_NONE wraps to zero. Thanks to that, comparing keys as plain
+ * integers sorts Object-level entries before any Instance-level ones, and
+ * Instance-level entries before the Resource-level ones of that Instance -
+ * which is also the order in which they are persisted.
+ */
+typedef uint64_t fas_key_t;
 
 typedef struct {
-    anjay_ssid_t ssid;
+    fas_key_t key;
+    /**
+     * For Object-level and Instance-level entries, only the part accessible
+     * via fas_entry_default_attrs() is used; the rest is kept empty.
+     */
     anjay_dm_internal_res_attrs_t attrs;
-} fas_resource_attrs_t;
-
-typedef struct {
-    anjay_rid_t rid;
-    AVS_LIST(fas_resource_attrs_t) attrs;
-} fas_resource_entry_t;
+} fas_entry_t;
 
 typedef struct {
-    anjay_iid_t iid;
-    AVS_LIST(fas_default_attrs_t) default_attrs;
-    AVS_LIST(fas_resource_entry_t) resources;
-} fas_instance_entry_t;
-
-typedef struct {
-    anjay_oid_t oid;
-    AVS_LIST(fas_default_attrs_t) default_attrs;
-    AVS_LIST(fas_instance_entry_t) instances;
-} fas_object_entry_t;
+    /**
+     * Sorted by key, without duplicates and without entries with empty
+     * attributes.
+     */
+    fas_entry_t *entries;
+    size_t size;
+    size_t capacity;
+} fas_table_t;
 
 typedef struct {
     anjay_oid_t oid;
@@ -59,14 +74,38 @@ typedef struct {
     void *last_cookie;
 } fas_iteration_state_t;
 
+/**
+ * Undo record of a single entry modified during a transaction.
+ */
+typedef struct {
+    /**
+     * Key of the modified entry, and its attributes from before the
+     * modification, if it existed.
+     */
+    fas_entry_t entry;
+    bool existed;
+} fas_undo_record_t;
+
 typedef struct {
     size_t depth;
-    avs_stream_abstract_t *persist_data;
+    /**
+     * Undo log of the current transaction, in the order the modifications were
+     * made. Replaying it backwards on rollback restores the table to the state
+     * from before the transaction. Entries are recorded only while depth > 0.
+     */
+    fas_undo_record_t *records;
+    size_t records_size;
+    size_t records_capacity;
+    /**
+     * Set if a record could not be stored due to an out-of-memory condition.
+     * The journal is then incomplete and cannot be used for rollback.
+     */
+    bool records_lost;
     bool modified_since_persist;
 } fas_saved_state_t;
 
 typedef struct {
-    AVS_LIST(fas_object_entry_t) objects;
+    fas_table_t table;
     bool modified_since_persist;
     fas_iteration_state_t iteration;
     fas_saved_state_t saved_state;
@@ -78,79 +117,170 @@ void _anjay_attr_storage_clear(anjay_attr_storage_t *fas);
 
 anjay_attr_storage_t *_anjay_attr_storage_get(anjay_t *anjay);
 
-void _anjay_attr_storage_remove_instances_not_on_sorted_list(
-        anjay_attr_storage_t *fas,
-        fas_object_entry_t *object,
-        AVS_LIST(anjay_iid_t) iids);
+static inline fas_key_t fas_key_make(anjay_oid_t oid,
+                                     anjay_iid_t iid,
+                                     anjay_rid_t rid,
+                                     anjay_ssid_t ssid) {
+    return ((fas_key_t) oid << FAS_KEY_OID_SHIFT)
+            | ((fas_key_t) (uint16_t) (iid + 1) << FAS_KEY_IID_SHIFT)
+            | ((fas_key_t) (uint16_t) (rid + 1) << FAS_KEY_RID_SHIFT)
+            | (fas_key_t) ssid;
+}
 
-static inline void mark_modified(anjay_attr_storage_t *fas) {
-    fas->modified_since_persist = true;
+static inline anjay_oid_t fas_key_oid(fas_key_t key) {
+    return (anjay_oid_t) (key >> FAS_KEY_OID_SHIFT);
 }
 
-static void remove_resource_entry(anjay_attr_storage_t *fas,
-                                  AVS_LIST(fas_resource_entry_t) *entry_ptr) {
-    AVS_LIST_CLEAR(&(*entry_ptr)->attrs);
-    AVS_LIST_DELETE(entry_ptr);
-    mark_modified(fas);
+static inline anjay_iid_t fas_key_iid(fas_key_t key) {
+    return (anjay_iid_t) ((uint16_t) (key >> FAS_KEY_IID_SHIFT) - 1);
 }
 
-static void remove_instance_entry(anjay_attr_storage_t *fas,
-                                  AVS_LIST(fas_instance_entry_t) *entry_ptr) {
-    AVS_LIST_CLEAR(&(*entry_ptr)->default_attrs);
-    while ((*entry_ptr)->resources) {
-        remove_resource_entry(fas, &(*entry_ptr)->resources);
-    }
-    AVS_LIST_DELETE(entry_ptr);
-    mark_modified(fas);
+static inline anjay_rid_t fas_key_rid(fas_key_t key) {
+    return (anjay_rid_t) ((uint16_t) (key >> FAS_KEY_RID_SHIFT) - 1);
+}
+
+static inline anjay_ssid_t fas_key_ssid(fas_key_t key) {
+    return (anjay_ssid_t) key;
+}
+
+static inline anjay_dm_internal_attrs_t *
+fas_entry_default_attrs(fas_entry_t *entry) {
+    return _anjay_dm_get_internal_attrs(&entry->attrs.standard.common);
+}
+
+static inline const anjay_dm_internal_attrs_t *
+fas_entry_default_attrs_const(const fas_entry_t *entry) {
+    return _anjay_dm_get_internal_attrs_const(&entry->attrs.standard.common);
 }
 
-static void remove_object_entry(anjay_attr_storage_t *fas,
-                                AVS_LIST(fas_object_entry_t) *entry_ptr) {
-    AVS_LIST_CLEAR(&(*entry_ptr)->default_attrs);
-    while ((*entry_ptr)->instances) {
-        remove_instance_entry(fas, &(*entry_ptr)->instances);
+/**
+ * @returns Index of the first entry with key not less than @p key.
+ */
+static inline size_t fas_table_lower_bound(const fas_table_t *table,
+                                           fas_key_t key) {
+    size_t begin = 0;
+    size_t end = table->size;
+    while (begin < end) {
+        size_t middle = begin + (end - begin) / 2;
+        if (table->entries[middle].key < key) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
     }
-    AVS_LIST_DELETE(entry_ptr);
-    mark_modified(fas);
+    return begin;
 }
 
-static void
-remove_instance_if_empty(AVS_LIST(fas_instance_entry_t) *entry_ptr) {
-    if (!(*entry_ptr)->default_attrs && !(*entry_ptr)->resources) {
-        AVS_LIST_DELETE(entry_ptr);
+/**
+ * @returns Index of the first entry with key greater than @p key.
+ */
+static inline size_t fas_table_upper_bound(const fas_table_t *table,
+                                           fas_key_t key) {
+    size_t begin = 0;
+    size_t end = table->size;
+    while (begin < end) {
+        size_t middle = begin + (end - begin) / 2;
+        if (table->entries[middle].key <= key) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
     }
+    return begin;
 }
 
-static void
-remove_object_if_empty(AVS_LIST(fas_object_entry_t) *entry_ptr) {
-    if (!(*entry_ptr)->default_attrs && !(*entry_ptr)->instances) {
-        AVS_LIST_DELETE(entry_ptr);
+static inline fas_entry_t *fas_table_find(fas_table_t *table, fas_key_t key) {
+    size_t index = fas_table_lower_bound(table, key);
+    if (index < table->size && table->entries[index].key == key) {
+        return &table->entries[index];
     }
+    return NULL;
 }
 
-static inline anjay_ssid_t *get_ssid_ptr(void *generic_attrs) {
-    AVS_STATIC_ASSERT(offsetof(fas_default_attrs_t, ssid) == 0,
-                      default_attrs_ssid_offset);
-    AVS_STATIC_ASSERT(offsetof(fas_resource_attrs_t, ssid) == 0,
-                      resource_attrs_ssid_offset);
-    return (anjay_ssid_t *) generic_attrs;
+/**
+ * Finds the range of entries whose keys differ from @p key only on bits below
+ * @p shift, e.g. all entries of an Object for shift == FAS_KEY_OID_SHIFT, or
+ * all entries of an Instance, including those of its Resources, for
+ * shift == FAS_KEY_IID_SHIFT.
+ */
+static inline void fas_table_find_range(const fas_table_t *table,
+                                        fas_key_t key,
+                                        unsigned shift,
+                                        size_t *out_begin,
+                                        size_t *out_end) {
+    const fas_key_t mask = ((fas_key_t) 1 << shift) - 1;
+    *out_begin = fas_table_lower_bound(table, key & ~mask);
+    *out_end = fas_table_upper_bound(table, key | mask);
 }
 
-static inline void *get_attrs_ptr(void *generic_attrs,
-                                  size_t attrs_field_offset) {
-    return (char *) generic_attrs + attrs_field_offset;
+/**
+ * @returns Index of the first entry, starting at @p begin, whose key differs
+ *          from the key at @p begin on any bits at or above @p shift, or
+ *          @p end if there is no such entry.
+ */
+static inline size_t fas_table_group_end(const fas_table_t *table,
+                                         size_t begin,
+                                         size_t end,
+                                         unsigned shift) {
+    assert(begin < end);
+    fas_key_t prefix = table->entries[begin].key >> shift;
+    do {
+        ++begin;
+    } while (begin < end && table->entries[begin].key >> shift == prefix);
+    return begin;
+}
+
+/**
+ * Inserts a new entry with empty attributes at @p index. The caller is
+ * responsible for keeping the table sorted.
+ *
+ * @returns Pointer to the new entry, or NULL in case of an out-of-memory
+ *          condition.
+ */
+fas_entry_t *_anjay_attr_storage_table_insert(fas_table_t *table,
+                                              size_t index,
+                                              fas_key_t key);
+
+void _anjay_attr_storage_table_erase(fas_table_t *table,
+                                     size_t begin,
+                                     size_t end);
+
+void _anjay_attr_storage_table_clear(fas_table_t *table);
+
+static inline void mark_modified(anjay_attr_storage_t *fas) {
+    fas->modified_since_persist = true;
 }
 
-typedef bool is_empty_func_t(const void *attrs);
+/**
+ * Variant of @ref _anjay_attr_storage_table_insert that operates on the
+ * storage's table, records the change in the transaction journal and marks the
+ * storage as modified.
+ */
+fas_entry_t *_anjay_attr_storage_insert_entry(anjay_attr_storage_t *fas,
+                                              size_t index,
+                                              fas_key_t key);
+
+/**
+ * Variant of @ref _anjay_attr_storage_table_erase that operates on the
+ * storage's table, records the change in the transaction journal and marks the
+ * storage as modified.
+ */
+void _anjay_attr_storage_erase_entries(anjay_attr_storage_t *fas,
+                                       size_t begin,
+                                       size_t end);
+
+void _anjay_attr_storage_remove_instances_not_on_sorted_list(
+        anjay_attr_storage_t *fas,
+        anjay_oid_t oid,
+        AVS_LIST(anjay_iid_t) iids);
 
-static bool default_attrs_empty(const void *attrs) {
-    return _anjay_dm_attributes_empty(
-            (const anjay_dm_internal_attrs_t *) attrs);
+static inline bool default_attrs_empty(const anjay_dm_internal_attrs_t *attrs) {
+    return _anjay_dm_attributes_empty(attrs);
 }
 
-static bool resource_attrs_empty(const void *attrs) {
-    return _anjay_dm_resource_attributes_empty(
-            (const anjay_dm_internal_res_attrs_t *) attrs);
+static inline bool
+resource_attrs_empty(const anjay_dm_internal_res_attrs_t *attrs) {
+    return _anjay_dm_resource_attributes_empty(attrs);
 }
 
 int _anjay_attr_storage_compare_u16ids(const void *a, const void *b,
@@ -138,7 +138,7 @@ AVS_UNIT_TEST(attr_storage, instance_it) {
     void *cookie = NULL;
 
     // prepare initial state
-    AVS_LIST_APPEND(&get_fas(anjay)->objects,
+    test_insert_object(get_fas(anjay),
             test_object_entry(
                     42,
                     NULL,
@@ -220,9 +220,9 @@ AVS_UNIT_TEST(attr_storage, instance_it) {
                                                   NULL));
     AVS_UNIT_ASSERT_EQUAL(iid, ANJAY_IID_INVALID);
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     42,
                     NULL,
@@ -263,58 +263,58 @@ AVS_UNIT_TEST(attr_storage, instance_present) {
     DM_ATTR_STORAGE_TEST_INIT;
 
     // prepare initial state
-    AVS_LIST_APPEND(&get_fas(anjay)->objects,
+    test_insert_object(get_fas(anjay),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(
                             4, NULL,
-                            test_resource_entry(33, NULL),
-                            test_resource_entry(69, NULL),
+                            test_some_resource_entry(33),
+                            test_some_resource_entry(69),
                             NULL),
                     test_instance_entry(
                             7, NULL,
-                            test_resource_entry(11, NULL),
+                            test_some_resource_entry(11),
                             NULL),
                     test_instance_entry(
                             21, NULL,
-                            test_resource_entry(22, NULL),
+                            test_some_resource_entry(22),
                             NULL),
                     test_instance_entry(
                             42, NULL,
-                            test_resource_entry(17, NULL),
+                            test_some_resource_entry(17),
                             NULL),
                     NULL));
 
     // tests
     _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 42, 1);
     AVS_UNIT_ASSERT_EQUAL(_anjay_dm_instance_present(anjay, &OBJ, 42, NULL), 1);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE((*find_object(get_fas(anjay), 42))->instances), 4);
+    AVS_UNIT_ASSERT_EQUAL(test_instance_count(get_fas(anjay), 42), 4);
     AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
     _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 21, -1);
     AVS_UNIT_ASSERT_EQUAL(_anjay_dm_instance_present(anjay, &OBJ, 21, NULL),
                           -1);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE((*find_object(get_fas(anjay), 42))->instances), 4);
+    AVS_UNIT_ASSERT_EQUAL(test_instance_count(get_fas(anjay), 42), 4);
     AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
     _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 4, 0);
     AVS_UNIT_ASSERT_EQUAL(_anjay_dm_instance_present(anjay, &OBJ, 4, NULL), 0);
 
     // verification
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(
                             7, NULL,
-                            test_resource_entry(11, NULL),
+                            test_some_resource_entry(11),
                             NULL),
                     test_instance_entry(
                             21, NULL,
-                            test_resource_entry(22, NULL),
+                            test_some_resource_entry(22),
                             NULL),
                     test_instance_entry(
                             42, NULL,
-                            test_resource_entry(17, NULL),
+                            test_some_resource_entry(17),
                             NULL),
                     NULL));
     AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
@@ -325,51 +325,51 @@ AVS_UNIT_TEST(attr_storage, instance_remove) {
     DM_ATTR_STORAGE_TEST_INIT;
 
     // prepare initial state
-    AVS_LIST_APPEND(&get_fas(anjay)->objects,
+    test_insert_object(get_fas(anjay),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(
                             4, NULL,
-                            test_resource_entry(33, NULL),
-                            test_resource_entry(69, NULL),
+                            test_some_resource_entry(33),
+                            test_some_resource_entry(69),
                             NULL),
                     test_instance_entry(
                             7, NULL,
-                            test_resource_entry(11, NULL),
+                            test_some_resource_entry(11),
                             NULL),
                     test_instance_entry(
                             42, NULL,
-                            test_resource_entry(17, NULL),
+                            test_some_resource_entry(17),
                             NULL),
                     NULL));
 
     // tests
     _anjay_mock_dm_expect_instance_remove(anjay, &OBJ, 42, 0);
     AVS_UNIT_ASSERT_EQUAL(_anjay_dm_instance_remove(anjay, &OBJ, 42, NULL), 0);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE((*find_object(get_fas(anjay), 42))->instances), 2);
+    AVS_UNIT_ASSERT_EQUAL(test_instance_count(get_fas(anjay), 42), 2);
     AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
     get_fas(anjay)->modified_since_persist = false;
     _anjay_mock_dm_expect_instance_remove(anjay, &OBJ, 2, 0);
     AVS_UNIT_ASSERT_EQUAL(_anjay_dm_instance_remove(anjay, &OBJ, 2, NULL), 0);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE((*find_object(get_fas(anjay), 42))->instances), 2);
+    AVS_UNIT_ASSERT_EQUAL(test_instance_count(get_fas(anjay), 42), 2);
     AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
     _anjay_mock_dm_expect_instance_remove(anjay, &OBJ, 7, -44);
     AVS_UNIT_ASSERT_EQUAL(_anjay_dm_instance_remove(anjay, &OBJ, 7, NULL), -44);
 
     // verification
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(
                             4, NULL,
-                            test_resource_entry(33, NULL),
-                            test_resource_entry(69, NULL),
+                            test_some_resource_entry(33),
+                            test_some_resource_entry(69),
                             NULL),
                     test_instance_entry(
                             7, NULL,
-                            test_resource_entry(11, NULL),
+                            test_some_resource_entry(11),
                             NULL),
                     NULL));
     AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
@@ -380,29 +380,29 @@ AVS_UNIT_TEST(attr_storage, resource_present) {
     DM_ATTR_STORAGE_TEST_INIT;
 
     // prepare initial state
-    AVS_LIST_APPEND(&get_fas(anjay)->objects,
+    test_insert_object(get_fas(anjay),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(
                             4, NULL,
-                            test_resource_entry(11, NULL),
-                            test_resource_entry(33, NULL),
-                            test_resource_entry(69, NULL),
+                            test_some_resource_entry(11),
+                            test_some_resource_entry(33),
+                            test_some_resource_entry(69),
                             NULL),
                     test_instance_entry(
                             7, NULL,
-                            test_resource_entry(11, NULL),
-                            test_resource_entry(42, NULL),
+                            test_some_resource_entry(11),
+                            test_some_resource_entry(42),
                             NULL),
                     test_instance_entry(
                             21, NULL,
-                            test_resource_entry(22, NULL),
-                            test_resource_entry(33, NULL),
+                            test_some_resource_entry(22),
+                            test_some_resource_entry(33),
                             NULL),
                     test_instance_entry(
                             42, NULL,
-                            test_resource_entry(17, NULL),
-                            test_resource_entry(69, NULL),
+                            test_some_resource_entry(17),
+                            test_some_resource_entry(69),
                             NULL),
                     NULL));
 
@@ -426,7 +426,7 @@ AVS_UNIT_TEST(attr_storage, resource_present) {
     AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
     get_fas(anjay)->modified_since_persist = false;
     AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE((*find_object(get_fas(anjay), 42))->instances), 4);
+            test_instance_count(get_fas(anjay), 42), 4);
     _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 7, 11, 0);
     AVS_UNIT_ASSERT_EQUAL(_anjay_dm_resource_present(anjay, &OBJ, 7, 11, NULL),
                           0);
@@ -438,29 +438,196 @@ AVS_UNIT_TEST(attr_storage, resource_present) {
     AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
 
     // verification
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(
                             4, NULL,
-                            test_resource_entry(11, NULL),
-                            test_resource_entry(69, NULL),
+                            test_some_resource_entry(11),
+                            test_some_resource_entry(69),
                             NULL),
                     test_instance_entry(
                             21, NULL,
-                            test_resource_entry(22, NULL),
-                            test_resource_entry(33, NULL),
+                            test_some_resource_entry(22),
+                            test_some_resource_entry(33),
                             NULL),
                     test_instance_entry(
                             42, NULL,
-                            test_resource_entry(17, NULL),
+                            test_some_resource_entry(17),
                             NULL),
                     NULL));
     DM_ATTR_STORAGE_TEST_FINISH;
 }
 
+AVS_UNIT_TEST(attr_storage, remove_instances_not_on_sorted_list) {
+    DM_ATTR_STORAGE_TEST_INIT;
+
+    // prepare initial state
+    test_insert_object(get_fas(anjay),
+            test_object_entry(
+                    42,
+                    test_default_attrlist(
+                            test_default_attrs(1, 2, 3,
+                                               ANJAY_DM_CON_ATTR_DEFAULT),
+                            NULL),
+                    test_instance_entry(
+                            1, NULL,
+                            test_some_resource_entry(1),
+                            NULL),
+                    test_instance_entry(
+                            3,
+                            test_default_attrlist(
+                                    test_default_attrs(
+                                            4, 5, 6,
+                                            ANJAY_DM_CON_ATTR_DEFAULT),
+                                    NULL),
+                            test_some_resource_entry(7),
+                            NULL),
+                    test_instance_entry(
+                            5, NULL,
+                            test_some_resource_entry(2),
+                            NULL),
+                    NULL));
+    test_insert_object(get_fas(anjay),
+            test_object_entry(
+                    43, NULL,
+                    test_instance_entry(
+                            1, NULL,
+                            test_some_resource_entry(1),
+                            NULL),
+                    NULL));
+
+    // tests
+    AVS_LIST(anjay_iid_t) iids = NULL;
+    static const anjay_iid_t EXISTING_IIDS[] = { 2, 3, 6 };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(EXISTING_IIDS); ++i) {
+        AVS_LIST(anjay_iid_t) iid = AVS_LIST_NEW_ELEMENT(anjay_iid_t);
+        AVS_UNIT_ASSERT_NOT_NULL(iid);
+        *iid = EXISTING_IIDS[i];
+        AVS_LIST_APPEND(&iids, iid);
+    }
+    _anjay_attr_storage_remove_instances_not_on_sorted_list(get_fas(anjay), 42,
+                                                            iids);
+    AVS_LIST_CLEAR(&iids);
+
+    // verification
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 2);
+    assert_object_equal(
+            get_fas(anjay),
+            test_object_entry(
+                    42,
+                    test_default_attrlist(
+                            test_default_attrs(1, 2, 3,
+                                               ANJAY_DM_CON_ATTR_DEFAULT),
+                            NULL),
+                    test_instance_entry(
+                            3,
+                            test_default_attrlist(
+                                    test_default_attrs(
+                                            4, 5, 6,
+                                            ANJAY_DM_CON_ATTR_DEFAULT),
+                                    NULL),
+                            test_some_resource_entry(7),
+                            NULL),
+                    NULL));
+    assert_object_equal(
+            get_fas(anjay),
+            test_object_entry(
+                    43, NULL,
+                    test_instance_entry(
+                            1, NULL,
+                            test_some_resource_entry(1),
+                            NULL),
+                    NULL));
+    AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
+    DM_ATTR_STORAGE_TEST_FINISH;
+}
+
+static fas_object_entry_t *test_transaction_initial_object(void) {
+    return test_object_entry(
+            42,
+            test_default_attrlist(
+                    test_default_attrs(1, 2, 3, ANJAY_DM_CON_ATTR_DEFAULT),
+                    NULL),
+            test_instance_entry(1, NULL, test_some_resource_entry(1), NULL),
+            test_instance_entry(
+                    3,
+                    test_default_attrlist(
+                            test_default_attrs(2, 4, 5,
+                                               ANJAY_DM_CON_ATTR_DEFAULT),
+                            NULL),
+                    NULL),
+            NULL);
+}
+
+static void modify_in_transaction(anjay_t *anjay) {
+    anjay_dm_internal_attrs_t attrs = ANJAY_DM_INTERNAL_ATTRS_EMPTY;
+    attrs.standard.min_period = 7;
+    // overwrite existing entry
+    AVS_UNIT_ASSERT_SUCCESS(write_object_attrs(anjay, 1, &OBJ, &attrs));
+    // create new entry
+    AVS_UNIT_ASSERT_SUCCESS(write_instance_attrs(anjay, 1, &OBJ, 2, &attrs));
+    // remove existing entries
+    AVS_UNIT_ASSERT_SUCCESS(
+            write_resource_attrs(anjay, 1, &OBJ, 1, 1,
+                                 &ANJAY_DM_INTERNAL_RES_ATTRS_EMPTY));
+    remove_instance(get_fas(anjay), 42, 3);
+    AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
+}
+
+AVS_UNIT_TEST(attr_storage, transaction_rollback) {
+    DM_ATTR_STORAGE_TEST_INIT;
+    test_insert_object(get_fas(anjay), test_transaction_initial_object());
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_transaction_include_object(anjay, &OBJ));
+    modify_in_transaction(anjay);
+    AVS_UNIT_ASSERT_FAILED(_anjay_dm_transaction_finish(anjay, -1));
+
+    AVS_UNIT_ASSERT_EQUAL(get_fas(anjay)->saved_state.depth, 0);
+    AVS_UNIT_ASSERT_NULL(get_fas(anjay)->saved_state.records);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
+    assert_object_equal(get_fas(anjay), test_transaction_initial_object());
+    AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
+
+    _anjay_dm_transaction_begin(anjay);
+    DM_ATTR_STORAGE_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(attr_storage, transaction_commit) {
+    DM_ATTR_STORAGE_TEST_INIT;
+    test_insert_object(get_fas(anjay), test_transaction_initial_object());
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_transaction_include_object(anjay, &OBJ));
+    modify_in_transaction(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_transaction_finish(anjay, 0));
+
+    AVS_UNIT_ASSERT_EQUAL(get_fas(anjay)->saved_state.depth, 0);
+    AVS_UNIT_ASSERT_NULL(get_fas(anjay)->saved_state.records);
+    assert_object_equal(
+            get_fas(anjay),
+            test_object_entry(
+                    42,
+                    test_default_attrlist(
+                            test_default_attrs(1, 7, ANJAY_ATTRIB_PERIOD_NONE,
+                                               ANJAY_DM_CON_ATTR_DEFAULT),
+                            NULL),
+                    test_instance_entry(
+                            2,
+                            test_default_attrlist(
+                                    test_default_attrs(
+                                            1, 7, ANJAY_ATTRIB_PERIOD_NONE,
+                                            ANJAY_DM_CON_ATTR_DEFAULT),
+                                    NULL),
+                            NULL),
+                    NULL));
+    AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
+
+    _anjay_dm_transaction_begin(anjay);
+    DM_ATTR_STORAGE_TEST_FINISH;
+}
+
 //// ATTRIBUTE HANDLERS ////////////////////////////////////////////////////////
 
 AVS_UNIT_TEST(attr_storage, read_object_default_attrs_proxy) {
@@ -580,7 +747,7 @@ AVS_UNIT_TEST(attr_storage, write_object_default_attrs_proxy) {
     AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_object_write_default_attrs(
             anjay, &OBJ, 11, &ANJAY_DM_INTERNAL_ATTRS_EMPTY, NULL));
 
-    AVS_UNIT_ASSERT_NULL(get_fas(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(get_fas(anjay)->table.size, 0);
     AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
 
     DM_ATTR_STORAGE_TEST_FINISH;
@@ -637,7 +804,7 @@ AVS_UNIT_TEST(attr_storage, object_default_attrs) {
     get_fas(anjay)->modified_since_persist = false;
 
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     69,
                     test_default_attrlist(
@@ -795,7 +962,7 @@ AVS_UNIT_TEST(attr_storage, write_instance_default_attrs_proxy) {
             anjay, &OBJ, 11, 11, &ANJAY_DM_INTERNAL_ATTRS_EMPTY,
             NULL));
 
-    AVS_UNIT_ASSERT_NULL(get_fas(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(get_fas(anjay)->table.size, 0);
 
     AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
     DM_ATTR_STORAGE_TEST_FINISH;
@@ -810,7 +977,7 @@ AVS_UNIT_TEST(attr_storage, instance_default_attrs) {
             NULL));
     // nothing actually changed
     AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
-    AVS_UNIT_ASSERT_NULL(get_fas(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(get_fas(anjay)->table.size, 0);
     AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_instance_write_default_attrs(
             anjay, &OBJ2, 3, 2,
             &(const anjay_dm_internal_attrs_t) {
@@ -860,9 +1027,9 @@ AVS_UNIT_TEST(attr_storage, instance_default_attrs) {
     AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
     get_fas(anjay)->modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1097,7 +1264,7 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs_proxy) {
             anjay, &OBJ, 11, 11, 11,
             &ANJAY_DM_INTERNAL_RES_ATTRS_EMPTY, NULL));
 
-    AVS_UNIT_ASSERT_NULL(get_fas(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(get_fas(anjay)->table.size, 0);
 
     AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
     DM_ATTR_STORAGE_TEST_FINISH;
@@ -1106,7 +1273,7 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs_proxy) {
 AVS_UNIT_TEST(attr_storage, read_resource_attrs) {
     DM_ATTR_STORAGE_TEST_INIT;
 
-    AVS_LIST_APPEND(&get_fas(anjay)->objects,
+    test_insert_object(get_fas(anjay),
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1159,7 +1326,7 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
             NULL));
     // nothing actually changed
     AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
-    AVS_UNIT_ASSERT_NULL(get_fas(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(get_fas(anjay)->table.size, 0);
     AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_resource_write_attrs(
             anjay, &OBJ2, 2, 3, 1,
             &(const anjay_dm_internal_res_attrs_t) {
@@ -1177,9 +1344,9 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
     AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
     get_fas(anjay)->modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1232,9 +1399,9 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
     AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
     get_fas(anjay)->modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1285,9 +1452,9 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
     AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
     get_fas(anjay)->modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1312,9 +1479,9 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
     AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
     get_fas(anjay)->modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1348,9 +1515,9 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
     AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
     get_fas(anjay)->modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1370,7 +1537,7 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
             NULL));
     AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
     get_fas(anjay)->modified_since_persist = false;
-    AVS_UNIT_ASSERT_NULL(get_fas(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(get_fas(anjay)->table.size, 0);
 
     AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
     DM_ATTR_STORAGE_TEST_FINISH;
@@ -1391,7 +1558,7 @@ AVS_UNIT_TEST(attr_storage, ssid_it) {
     // /1/10/0 == 2
     // /1/11/0 == -5 (invalid)
 
-    AVS_LIST_APPEND(&get_fas(anjay)->objects,
+    test_insert_object(get_fas(anjay),
             test_object_entry(
                     42,
                     test_default_attrlist(
@@ -1493,9 +1660,9 @@ AVS_UNIT_TEST(attr_storage, ssid_it) {
     get_fas(anjay)->modified_since_persist = false;
     AVS_UNIT_ASSERT_EQUAL(iid, ANJAY_IID_INVALID);
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     42,
                     test_default_attrlist(
@@ -1549,9 +1716,9 @@ AVS_UNIT_TEST(attr_storage, ssid_it) {
     get_fas(anjay)->modified_since_persist = false;
     AVS_UNIT_ASSERT_EQUAL(iid, ANJAY_IID_INVALID);
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     42,
                     test_default_attrlist(
@@ -1574,7 +1741,7 @@ AVS_UNIT_TEST(attr_storage, ssid_it) {
 AVS_UNIT_TEST(attr_storage, ssid_remove) {
     DM_ATTR_STORAGE_TEST_INIT;
 
-    AVS_LIST_APPEND(&get_fas(anjay)->objects,
+    test_insert_object(get_fas(anjay),
             test_object_entry(
                     42,
                     test_default_attrlist(
@@ -1647,9 +1814,9 @@ AVS_UNIT_TEST(attr_storage, ssid_remove) {
     AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
     get_fas(anjay)->modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     42,
                     test_default_attrlist(
@@ -1720,9 +1887,9 @@ AVS_UNIT_TEST(attr_storage, ssid_remove) {
     AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
     get_fas(anjay)->modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     42,
                     test_default_attrlist(
@@ -1782,7 +1949,7 @@ AVS_UNIT_TEST(attr_storage, nested_iterations) {
     anjay_iid_t iid;
 
     // prepare initial state
-    AVS_LIST_APPEND(&get_fas(anjay)->objects,
+    test_insert_object(get_fas(anjay),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(1, NULL, NULL),
@@ -1830,9 +1997,9 @@ AVS_UNIT_TEST(attr_storage, nested_iterations) {
                                                   NULL));
     AVS_UNIT_ASSERT_EQUAL(iid, ANJAY_IID_INVALID);
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(1, NULL, NULL),
@@ -1848,7 +2015,7 @@ AVS_UNIT_TEST(attr_storage, parallel_iterations) {
     anjay_iid_t iid;
 
     // prepare initial state
-    AVS_LIST_APPEND(&get_fas(anjay)->objects,
+    test_insert_object(get_fas(anjay),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(1, NULL, NULL),
@@ -1893,9 +2060,9 @@ AVS_UNIT_TEST(attr_storage, parallel_iterations) {
                                                   NULL));
     AVS_UNIT_ASSERT_EQUAL(iid, ANJAY_IID_INVALID);
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(get_fas(anjay)->objects), 1);
+    AVS_UNIT_ASSERT_EQUAL(test_object_count(get_fas(anjay)), 1);
     assert_object_equal(
-            get_fas(anjay)->objects,
+            get_fas(anjay),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(1, NULL, NULL),
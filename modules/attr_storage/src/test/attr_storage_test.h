@@ -24,6 +24,40 @@
 
 #include "../mod_attr_storage.h"
 
+/*
+ * The expected contents of Attribute Storage are described in test cases as
+ * a tree of nested lists, which is much more readable than a list of flat
+ * entries. test_insert_object() and assert_object_equal() convert it to the
+ * actual, flat representation.
+ */
+
+typedef struct {
+    anjay_ssid_t ssid;
+    anjay_dm_internal_attrs_t attrs;
+} fas_default_attrs_t;
+
+typedef struct {
+    anjay_ssid_t ssid;
+    anjay_dm_internal_res_attrs_t attrs;
+} fas_resource_attrs_t;
+
+typedef struct {
+    anjay_rid_t rid;
+    AVS_LIST(fas_resource_attrs_t) attrs;
+} fas_resource_entry_t;
+
+typedef struct {
+    anjay_iid_t iid;
+    AVS_LIST(fas_default_attrs_t) default_attrs;
+    AVS_LIST(fas_resource_entry_t) resources;
+} fas_instance_entry_t;
+
+typedef struct {
+    anjay_oid_t oid;
+    AVS_LIST(fas_default_attrs_t) default_attrs;
+    AVS_LIST(fas_instance_entry_t) instances;
+} fas_object_entry_t;
+
 static fas_resource_attrs_t *test_resource_attrs(anjay_ssid_t ssid,
                                                  int32_t min_period,
                                                  int32_t max_period,
@@ -62,6 +96,17 @@ static fas_resource_entry_t *test_resource_entry(unsigned /*anjay_rid_t*/ rid, .
     return resource;
 }
 
+/**
+ * Resource entry with a single, arbitrary set of attributes - for test cases
+ * that only care about the presence of attributes for a given Resource.
+ */
+static fas_resource_entry_t *test_some_resource_entry(unsigned rid) {
+    return test_resource_entry(rid,
+                               test_resource_attrs(1, 2, 3, 4.0, 5.0, 6.0,
+                                                   ANJAY_DM_CON_ATTR_DEFAULT),
+                               NULL);
+}
+
 static fas_default_attrs_t *test_default_attrs(anjay_ssid_t ssid,
                                                int32_t min_period,
                                                int32_t max_period,
@@ -150,85 +195,115 @@ assert_res_attrs_equal(const anjay_dm_internal_res_attrs_t *actual,
     AVS_UNIT_ASSERT_EQUAL(actual->standard.step, expected->standard.step);
 }
 
-static void assert_fas_default_attrs_equal(fas_default_attrs_t *actual,
-                                           fas_default_attrs_t *tmp_expected) {
-    AVS_UNIT_ASSERT_EQUAL(actual->ssid, tmp_expected->ssid);
-    assert_attrs_equal(&actual->attrs, &tmp_expected->attrs);
-    AVS_LIST_DELETE(&tmp_expected);
+static void flatten_default_attrs(fas_table_t *out,
+                                  anjay_oid_t oid,
+                                  anjay_iid_t iid,
+                                  AVS_LIST(fas_default_attrs_t) *attrs_ptr) {
+    while (*attrs_ptr) {
+        fas_entry_t *entry = _anjay_attr_storage_table_insert(
+                out, out->size,
+                fas_key_make(oid, iid, FAS_ID_NONE, (*attrs_ptr)->ssid));
+        AVS_UNIT_ASSERT_NOT_NULL(entry);
+        *fas_entry_default_attrs(entry) = (*attrs_ptr)->attrs;
+        AVS_LIST_DELETE(attrs_ptr);
+    }
 }
 
-static void
-assert_fas_resource_attrs_equal(fas_resource_attrs_t *actual,
-                                fas_resource_attrs_t *tmp_expected) {
-    AVS_UNIT_ASSERT_EQUAL(actual->ssid, tmp_expected->ssid);
-    assert_res_attrs_equal(&actual->attrs, &tmp_expected->attrs);
-    AVS_LIST_DELETE(&tmp_expected);
-}
-
-static void assert_resource_equal(fas_resource_entry_t *actual,
-                                  fas_resource_entry_t *tmp_expected) {
-    AVS_UNIT_ASSERT_EQUAL(actual->rid, tmp_expected->rid);
-
-    size_t count = AVS_LIST_SIZE(tmp_expected->attrs);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(actual->attrs), count);
-    AVS_LIST(fas_resource_attrs_t) attrs = actual->attrs;
-    while (count--) {
-        assert_fas_resource_attrs_equal(attrs,
-                                        AVS_LIST_DETACH(&tmp_expected->attrs));
-        attrs = AVS_LIST_NEXT(attrs);
+static void flatten_resource(fas_table_t *out,
+                             anjay_oid_t oid,
+                             anjay_iid_t iid,
+                             AVS_LIST(fas_resource_entry_t) *resource_ptr) {
+    while ((*resource_ptr)->attrs) {
+        fas_entry_t *entry = _anjay_attr_storage_table_insert(
+                out, out->size,
+                fas_key_make(oid, iid, (*resource_ptr)->rid,
+                             (*resource_ptr)->attrs->ssid));
+        AVS_UNIT_ASSERT_NOT_NULL(entry);
+        entry->attrs = (*resource_ptr)->attrs->attrs;
+        AVS_LIST_DELETE(&(*resource_ptr)->attrs);
     }
-
-    AVS_LIST_DELETE(&tmp_expected);
+    AVS_LIST_DELETE(resource_ptr);
 }
 
-static void assert_instance_equal(fas_instance_entry_t *actual,
-                                  fas_instance_entry_t *tmp_expected) {
-    AVS_UNIT_ASSERT_EQUAL(actual->iid, tmp_expected->iid);
-
-    size_t count = AVS_LIST_SIZE(tmp_expected->default_attrs);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(actual->default_attrs), count);
-    AVS_LIST(fas_default_attrs_t) default_attrs = actual->default_attrs;
-    while (count--) {
-        assert_fas_default_attrs_equal(
-                default_attrs, AVS_LIST_DETACH(&tmp_expected->default_attrs));
-        default_attrs = AVS_LIST_NEXT(default_attrs);
+/**
+ * Converts the tree into a table of entries, consuming (freeing) it. Since
+ * the table's insertion routine asserts proper ordering, this also verifies
+ * that the test data is sorted properly. Empty Instance and Resource entries
+ * have no flat representation and simply vanish.
+ */
+static void flatten_object(fas_table_t *out,
+                           AVS_LIST(fas_object_entry_t) object) {
+    const anjay_oid_t oid = object->oid;
+    flatten_default_attrs(out, oid, FAS_ID_NONE, &object->default_attrs);
+    while (object->instances) {
+        fas_instance_entry_t *instance = object->instances;
+        flatten_default_attrs(out, oid, instance->iid,
+                              &instance->default_attrs);
+        while (instance->resources) {
+            flatten_resource(out, oid, instance->iid, &instance->resources);
+        }
+        AVS_LIST_DELETE(&object->instances);
     }
+    AVS_LIST_DELETE(&object);
+}
 
-    count = AVS_LIST_SIZE(tmp_expected->resources);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(actual->resources), count);
-    AVS_LIST(fas_resource_entry_t) resource = actual->resources;
-    while (count--) {
-        assert_resource_equal(resource,
-                              AVS_LIST_DETACH(&tmp_expected->resources));
-        resource = AVS_LIST_NEXT(resource);
+static void test_insert_object(anjay_attr_storage_t *fas,
+                               AVS_LIST(fas_object_entry_t) object) {
+    fas_table_t flat = { NULL };
+    flatten_object(&flat, object);
+    for (size_t i = 0; i < flat.size; ++i) {
+        size_t index =
+                fas_table_lower_bound(&fas->table, flat.entries[i].key);
+        fas_entry_t *entry = _anjay_attr_storage_table_insert(
+                &fas->table, index, flat.entries[i].key);
+        AVS_UNIT_ASSERT_NOT_NULL(entry);
+        entry->attrs = flat.entries[i].attrs;
     }
-
-    AVS_LIST_DELETE(&tmp_expected);
+    _anjay_attr_storage_table_clear(&flat);
 }
 
-static void assert_object_equal(fas_object_entry_t *actual,
-                                fas_object_entry_t *tmp_expected) {
-    AVS_UNIT_ASSERT_EQUAL(actual->oid, tmp_expected->oid);
-    size_t count = AVS_LIST_SIZE(tmp_expected->default_attrs);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(actual->default_attrs), count);
-    AVS_LIST(fas_default_attrs_t) default_attrs = actual->default_attrs;
-    while (count--) {
-        assert_fas_default_attrs_equal(
-                default_attrs, AVS_LIST_DETACH(&tmp_expected->default_attrs));
-        default_attrs = AVS_LIST_NEXT(default_attrs);
+static size_t test_object_count(anjay_attr_storage_t *fas) {
+    size_t count = 0;
+    for (size_t i = 0; i < fas->table.size;
+         i = fas_table_group_end(&fas->table, i, fas->table.size,
+                                 FAS_KEY_OID_SHIFT)) {
+        ++count;
     }
+    return count;
+}
 
-    count = AVS_LIST_SIZE(tmp_expected->instances);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(actual->instances), count);
-    AVS_LIST(fas_instance_entry_t) instance = actual->instances;
-    while (count--) {
-        assert_instance_equal(instance,
-                              AVS_LIST_DETACH(&tmp_expected->instances));
-        instance = AVS_LIST_NEXT(instance);
+static size_t test_instance_count(anjay_attr_storage_t *fas, anjay_oid_t oid) {
+    size_t begin, end;
+    fas_table_find_range(&fas->table,
+                         fas_key_make(oid, FAS_ID_NONE, FAS_ID_NONE, 0),
+                         FAS_KEY_OID_SHIFT, &begin, &end);
+    size_t count = 0;
+    for (size_t i = begin; i < end;
+         i = fas_table_group_end(&fas->table, i, end, FAS_KEY_IID_SHIFT)) {
+        if (fas_key_iid(fas->table.entries[i].key) != FAS_ID_NONE) {
+            ++count;
+        }
     }
+    return count;
+}
+
+static void assert_object_equal(anjay_attr_storage_t *fas,
+                                AVS_LIST(fas_object_entry_t) tmp_expected) {
+    size_t begin, end;
+    fas_table_find_range(&fas->table,
+                         fas_key_make(tmp_expected->oid, FAS_ID_NONE,
+                                      FAS_ID_NONE, 0),
+                         FAS_KEY_OID_SHIFT, &begin, &end);
+    fas_table_t expected = { NULL };
+    flatten_object(&expected, tmp_expected);
 
-    AVS_LIST_DELETE(&tmp_expected);
+    AVS_UNIT_ASSERT_EQUAL(end - begin, expected.size);
+    for (size_t i = 0; i < expected.size; ++i) {
+        const fas_entry_t *actual = &fas->table.entries[begin + i];
+        AVS_UNIT_ASSERT_EQUAL(actual->key, expected.entries[i].key);
+        assert_res_attrs_equal(&actual->attrs, &expected.entries[i].attrs);
+    }
+    _anjay_attr_storage_table_clear(&expected);
 }
 
 #endif /* ATTR_STORAGE_TEST_H */
-
@@ -279,7 +279,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_no_objects) {
     RESTORE_TEST_INIT(PERSIST_TEST_DATA);
     AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_restore(
             anjay, (avs_stream_abstract_t *) &inbuf));
-    AVS_UNIT_ASSERT_NULL(_anjay_attr_storage_get(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_attr_storage_get(anjay)->table.size, 0);
     PERSISTENCE_TEST_FINISH;
 }
 
@@ -295,8 +295,8 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_one_object) {
             anjay, (avs_stream_abstract_t *) &inbuf));
 
     AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(_anjay_attr_storage_get(anjay)->objects), 1);
-    assert_object_equal(_anjay_attr_storage_get(anjay)->objects,
+            test_object_count(_anjay_attr_storage_get(anjay)), 1);
+    assert_object_equal(_anjay_attr_storage_get(anjay),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(
@@ -362,10 +362,10 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_all_objects) {
             anjay, (avs_stream_abstract_t *) &inbuf));
 
     AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(_anjay_attr_storage_get(anjay)->objects), 3);
+            test_object_count(_anjay_attr_storage_get(anjay)), 3);
 
     // object 4
-    assert_object_equal(_anjay_attr_storage_get(anjay)->objects,
+    assert_object_equal(_anjay_attr_storage_get(anjay),
             test_object_entry(
                     4,
                     test_default_attrlist(
@@ -377,7 +377,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_all_objects) {
                     NULL));
 
     // object 42
-    assert_object_equal(AVS_LIST_NEXT(_anjay_attr_storage_get(anjay)->objects),
+    assert_object_equal(_anjay_attr_storage_get(anjay),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(
@@ -411,7 +411,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_all_objects) {
 
     // object 517
     assert_object_equal(
-            AVS_LIST_NTH(_anjay_attr_storage_get(anjay)->objects, 2),
+            _anjay_attr_storage_get(anjay),
             test_object_entry(
                     517, NULL,
                     test_instance_entry(
@@ -482,7 +482,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_no_instances) {
                                       ANJAY_IID_INVALID);
     AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_restore(
             anjay, (avs_stream_abstract_t *) &inbuf));
-    AVS_UNIT_ASSERT_NULL(_anjay_attr_storage_get(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_attr_storage_get(anjay)->table.size, 0);
     PERSISTENCE_TEST_FINISH;
 }
 
@@ -499,7 +499,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_no_supported_resources) {
                                       ANJAY_IID_INVALID);
     AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_restore(
             anjay, (avs_stream_abstract_t *) &inbuf));
-    AVS_UNIT_ASSERT_NULL(_anjay_attr_storage_get(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_attr_storage_get(anjay)->table.size, 0);
     PERSISTENCE_TEST_FINISH;
 }
 
@@ -518,7 +518,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_no_present_resources) {
     _anjay_mock_dm_expect_resource_present(anjay, &OBJ517, 516, 515, 0);
     AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_restore(
             anjay, (avs_stream_abstract_t *) &inbuf));
-    AVS_UNIT_ASSERT_NULL(_anjay_attr_storage_get(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_attr_storage_get(anjay)->table.size, 0);
     PERSISTENCE_TEST_FINISH;
 }
 
@@ -580,7 +580,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_broken_stream) {
     AVS_UNIT_ASSERT_FAILED(anjay_attr_storage_restore(
             anjay, (avs_stream_abstract_t *) &inbuf));
 
-    AVS_UNIT_ASSERT_NULL(_anjay_attr_storage_get(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_attr_storage_get(anjay)->table.size, 0);
     PERSISTENCE_TEST_FINISH;
 }
 
@@ -655,7 +655,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_insane_data) {
     AVS_UNIT_ASSERT_FAILED(anjay_attr_storage_restore(
             anjay, (avs_stream_abstract_t *) &inbuf));
 
-    AVS_UNIT_ASSERT_NULL(_anjay_attr_storage_get(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_attr_storage_get(anjay)->table.size, 0);
     PERSISTENCE_TEST_FINISH;
 }
 
@@ -728,7 +728,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_data_with_empty_##Suffix) { \
     AVS_UNIT_ASSERT_FAILED(anjay_attr_storage_restore( \
             anjay, (avs_stream_abstract_t *) &inbuf)); \
     \
-    AVS_UNIT_ASSERT_NULL(_anjay_attr_storage_get(anjay)->objects); \
+    AVS_UNIT_ASSERT_EQUAL(_anjay_attr_storage_get(anjay)->table.size, 0); \
     PERSISTENCE_TEST_FINISH; \
 }
 
@@ -747,7 +747,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_data_with_bad_magic) {
     AVS_UNIT_ASSERT_FAILED(anjay_attr_storage_restore(
             anjay, (avs_stream_abstract_t *) &inbuf));
 
-    AVS_UNIT_ASSERT_NULL(_anjay_attr_storage_get(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_attr_storage_get(anjay)->table.size, 0);
     PERSISTENCE_TEST_FINISH;
 }
 
@@ -784,7 +784,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_duplicate_oid) {
     AVS_UNIT_ASSERT_FAILED(anjay_attr_storage_restore(
             anjay, (avs_stream_abstract_t *) &inbuf));
 
-    AVS_UNIT_ASSERT_NULL(_anjay_attr_storage_get(anjay)->objects);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_attr_storage_get(anjay)->table.size, 0);
     PERSISTENCE_TEST_FINISH;
 }
 
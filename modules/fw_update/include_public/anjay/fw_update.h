@@ -19,6 +19,8 @@
 
 #include <anjay/dm.h>
 
+#include <avsystem/commons/stream.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -383,6 +385,55 @@ anjay_fw_update_get_security_info_t(void *user_ptr,
                                     avs_net_security_info_t *out_security_info,
                                     const char *download_uri);
 
+/**
+ * Reads a fragment of the firmware image that is currently installed on the
+ * device. Implementing this handler enables support for delta packages.
+ *
+ * If this handler is set and the firmware package starts with the
+ * <c>ENDSLEY/BSDIFF43</c> magic string, the package is treated as an
+ * <strong>uncompressed</strong> bsdiff 4.3 patch against the current image.
+ * The patch is applied while it is being downloaded, so
+ * @ref anjay_fw_update_stream_write_t receives the new image, not the patch.
+ * Memory usage of the patching process is constant and small.
+ *
+ * Such a patch may be created using the <c>bsdiff</c> tool from
+ * https://github.com/mendsley/bsdiff, which compresses everything after the
+ * 24-byte header with bzip2. To obtain the uncompressed form, keep the header
+ * and decompress the rest, e.g.:
+ *
+ * @code
+ * head -c 24 fw.patch > fw.delta && tail -c +25 fw.patch | bunzip2 >> fw.delta
+ * @endcode
+ *
+ * Any package that does not start with the magic string is treated as a full
+ * image, as if this handler was not implemented.
+ *
+ * The state of the patching process is not known to
+ * <c>ANJAY_FW_UPDATE_INITIAL_DOWNLOADING</c>, so if this handler is set,
+ * downloads resumed that way with a non-zero offset are restarted from the
+ * beginning. Use @ref anjay_fw_update_persist and
+ * @ref anjay_fw_update_restore to resume them instead.
+ *
+ * @param user_ptr Opaque pointer to user data, as passed to
+ *                 @ref anjay_fw_update_install
+ *
+ * @param offset   Offset in the current image to read from.
+ *
+ * @param buffer   Buffer to fill with exactly @p length bytes of data.
+ *
+ * @param length   Number of bytes to read.
+ *
+ * @returns The callback shall return 0 if successful or a negative value in
+ *          case of error, including an attempt to read past the end of the
+ *          image. If one of the <c>ANJAY_FW_UPDATE_ERR_*</c> value is
+ *          returned, an equivalent value will be set in the Update Result
+ *          Resource.
+ */
+typedef int anjay_fw_update_read_current_image_t(void *user_ptr,
+                                                 size_t offset,
+                                                 void *buffer,
+                                                 size_t length);
+
 /**
  * Handler callbacks that shall implement the platform-specific part of firmware
  * update process.
@@ -407,6 +458,8 @@ anjay_fw_update_get_security_info_t(void *user_ptr,
  *   - <c>stream_write</c> - shall write a chunk of data into the download
  *     stream; it normally does not change state - however, if it fails, it will
  *     be immediately followed by a call to <c>reset</c>
+ *   - <c>read_current_image</c> - shall read a fragment of the currently
+ *     installed image, when a delta package is being applied
  *   - <c>stream_finish</c> - shall close the download stream and perform
  *     integrity check on the downloaded image; if successful, this moves the
  *     object into the <em>Downloaded</em> state. If failed - into the
@@ -456,6 +509,10 @@ typedef struct {
     /** Queries security information that shall be used for an encrypted
      * connection; @ref anjay_fw_update_get_security_info_t */
     anjay_fw_update_get_security_info_t *get_security_info;
+
+    /** Reads a fragment of the currently installed firmware image, enabling
+     * delta packages; @ref anjay_fw_update_read_current_image_t */
+    anjay_fw_update_read_current_image_t *read_current_image;
 } anjay_fw_update_handlers_t;
 
 /**
@@ -520,6 +577,121 @@ anjay_fw_update_install(anjay_t *anjay,
 avs_net_security_info_t *
 anjay_fw_update_load_security_from_dm(anjay_t *anjay, const char *uri);
 
+/**
+ * Dumps the state of the Firmware Update object into the @p out_stream , so
+ * that it can be brought back after a reboot using
+ * @ref anjay_fw_update_restore .
+ *
+ * During a PULL download, the Package URI, the number of bytes received so far,
+ * the ETag and the progress of applying a delta package are stored. If
+ * asynchronous writing is enabled, this function first waits until all data
+ * received so far is passed to @ref anjay_fw_update_stream_write_t . The
+ * application shall make sure that the written data itself is durable before
+ * relying on the persisted state.
+ *
+ * The <em>Updating</em> state is stored as <em>Downloaded</em>.
+ *
+ * @param anjay      Anjay object with the Firmware Update object installed.
+ * @param out_stream Stream to write to.
+ *
+ * @returns 0 on success, negative value in case of an error, including a
+ *          failed asynchronous write.
+ */
+int anjay_fw_update_persist(anjay_t *anjay,
+                            avs_stream_abstract_t *out_stream);
+
+/**
+ * Restores the state of the Firmware Update object from @p in_stream , as
+ * written by @ref anjay_fw_update_persist . It is an alternative to passing
+ * <c>initial_state</c> to @ref anjay_fw_update_install , which shall then be
+ * <c>NULL</c>.
+ *
+ * If the download was in progress and some data had been received, the
+ * download stream shall be open before calling this function, just as with
+ * <c>ANJAY_FW_UPDATE_INITIAL_DOWNLOADING</c>, and contain exactly the data
+ * received before @ref anjay_fw_update_persist was called. The download is
+ * then scheduled to continue from that offset, including the application of a
+ * delta package. If resumption turns out to be impossible, the stream is reset
+ * and the download is restarted from the beginning.
+ *
+ * @param anjay     Anjay object with the Firmware Update object installed, in
+ *                  the Idle state.
+ * @param in_stream Stream to read from.
+ *
+ * @returns 0 on success, negative value in case of an error, in which case the
+ *          object is left untouched.
+ */
+int anjay_fw_update_restore(anjay_t *anjay,
+                            avs_stream_abstract_t *in_stream);
+
+/**
+ * Opaque handle of the asynchronous firmware writer, see
+ * @ref anjay_fw_update_async_write_enable .
+ */
+typedef struct anjay_fw_update_async_writer anjay_fw_update_async_writer_t;
+
+/**
+ * Configuration of the asynchronous firmware writer.
+ */
+typedef struct {
+    /**
+     * Number of buffers in the ring. Must not be zero. At least two are
+     * necessary for downloading and writing to proceed at the same time.
+     */
+    size_t buffer_count;
+
+    /** Size of each buffer, in bytes. Must not be zero. */
+    size_t buffer_size;
+} anjay_fw_update_async_write_config_t;
+
+/**
+ * Makes the Firmware Update object pass the firmware package to
+ * @ref anjay_fw_update_stream_write_t through a ring of buffers, so that slow
+ * writes (e.g. flash erases) do not block the Anjay event loop.
+ *
+ * Downloaded data is copied into the ring and written by a worker thread that
+ * calls @ref anjay_fw_update_async_writer_run . Whenever the ring is too full
+ * to hold another block, PULL downloads are suspended until the worker makes
+ * some room. A failed write aborts the download and sets the Update Result
+ * Resource in the same way as a synchronous one would.
+ *
+ * @ref anjay_fw_update_stream_write_t is called from the worker thread, so it
+ * must not use the Anjay object. All other handlers are still called from the
+ * thread that runs the event loop, never while a write is in progress. In
+ * particular, all data queued so far is written before each call to
+ * @ref anjay_fw_update_read_current_image_t , which may thus slow down applying
+ * delta packages.
+ *
+ * Until @ref anjay_fw_update_async_writer_run is called, buffers are written
+ * synchronously whenever the ring is full, and before finishing the stream.
+ *
+ * @param anjay  Anjay object with the Firmware Update object installed.
+ * @param config Ring configuration.
+ *
+ * @returns Writer handle to be passed to
+ *          @ref anjay_fw_update_async_writer_run , or NULL in case of error.
+ *          The writer is freed during the call to @ref anjay_delete .
+ */
+anjay_fw_update_async_writer_t *anjay_fw_update_async_write_enable(
+        anjay_t *anjay,
+        const anjay_fw_update_async_write_config_t *config);
+
+/**
+ * Writes buffers queued by the Firmware Update object until the Anjay object
+ * that owns @p writer is deleted. Intended to be the body of a dedicated
+ * thread.
+ *
+ * @ref anjay_delete blocks until this function returns, so the thread must
+ * keep running (or never have started) at that point. The function must not be
+ * called once @ref anjay_delete has started.
+ *
+ * @param writer Handle returned by @ref anjay_fw_update_async_write_enable .
+ *
+ * @returns 0 after the Anjay object is deleted, or a negative value if
+ *          @p writer is NULL or already being run by another thread.
+ */
+int anjay_fw_update_async_writer_run(anjay_fw_update_async_writer_t *writer);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,301 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <avsystem/commons/condvar.h>
+#include <avsystem/commons/memory.h>
+#include <avsystem/commons/mutex.h>
+
+#include <anjay_modules/utils_core.h>
+
+#include "fw_async_writer.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#define fw_log(level, ...) _anjay_log(fw_update, level, __VA_ARGS__)
+
+struct anjay_fw_update_async_writer {
+    const anjay_fw_update_handlers_t *handlers;
+    void *arg;
+
+    avs_mutex_t *mutex;
+    /** Notified whenever any of the fields below changes. */
+    avs_condvar_t *cond;
+
+    /**
+     * Ring of <c>buffer_count</c> buffers of <c>buffer_size</c> bytes each;
+     * <c>queued</c> of them are waiting to be written, starting at index
+     * <c>first</c>. <c>lengths</c> holds the number of valid bytes in each.
+     */
+    size_t buffer_count;
+    size_t buffer_size;
+    size_t first;
+    size_t queued;
+    size_t *lengths;
+    char *data;
+
+    /** True while buffer <c>first</c> is being passed to stream_write. */
+    bool write_in_progress;
+    /** Result of the first failed stream_write call, or 0. */
+    int result;
+
+    bool worker_running;
+    bool shutdown;
+};
+
+static char *buffer_ptr(anjay_fw_update_async_writer_t *writer,
+                        size_t index) {
+    return &writer->data[index * writer->buffer_size];
+}
+
+static size_t last_index(anjay_fw_update_async_writer_t *writer) {
+    assert(writer->queued > 0);
+    return (writer->first + writer->queued - 1) % writer->buffer_count;
+}
+
+static bool last_buffer_appendable(anjay_fw_update_async_writer_t *writer) {
+    // the buffer currently being written is always the first one
+    return writer->queued > 0
+            && !(writer->queued == 1 && writer->write_in_progress)
+            && writer->lengths[last_index(writer)] < writer->buffer_size;
+}
+
+static void wait_locked(anjay_fw_update_async_writer_t *writer) {
+    avs_condvar_wait(writer->cond, writer->mutex, AVS_TIME_MONOTONIC_INVALID);
+}
+
+/**
+ * Passes the first queued buffer to stream_write. The mutex is released for
+ * the duration of the call.
+ */
+static void write_first_locked(anjay_fw_update_async_writer_t *writer) {
+    assert(writer->queued > 0);
+    assert(!writer->write_in_progress);
+    assert(!writer->result);
+
+    size_t index = writer->first;
+    writer->write_in_progress = true;
+    avs_mutex_unlock(writer->mutex);
+    int result = writer->handlers->stream_write(writer->arg,
+                                                buffer_ptr(writer, index),
+                                                writer->lengths[index]);
+    avs_mutex_lock(writer->mutex);
+    writer->write_in_progress = false;
+
+    assert(writer->queued > 0);
+    writer->first = (writer->first + 1) % writer->buffer_count;
+    --writer->queued;
+    if (result) {
+        fw_log(ERROR, "could not write firmware: %d", result);
+        writer->result = result;
+        writer->first = 0;
+        writer->queued = 0;
+    }
+    avs_condvar_notify_all(writer->cond);
+}
+
+/**
+ * Waits until there is at least one free buffer, writing the oldest one from
+ * the calling thread if there is no worker to do it.
+ */
+static void make_room_locked(anjay_fw_update_async_writer_t *writer) {
+    while (writer->queued == writer->buffer_count && !writer->result) {
+        if (writer->worker_running || writer->write_in_progress) {
+            wait_locked(writer);
+        } else {
+            write_first_locked(writer);
+        }
+    }
+}
+
+anjay_fw_update_async_writer_t *
+_anjay_fw_async_writer_new(const anjay_fw_update_handlers_t *handlers,
+                           void *arg,
+                           size_t buffer_count,
+                           size_t buffer_size) {
+    assert(buffer_count > 0);
+    assert(buffer_size > 0 && buffer_size <= SIZE_MAX / buffer_count);
+
+    anjay_fw_update_async_writer_t *writer =
+            (anjay_fw_update_async_writer_t *) avs_calloc(
+                    1, sizeof(anjay_fw_update_async_writer_t));
+    if (!writer) {
+        return NULL;
+    }
+    writer->handlers = handlers;
+    writer->arg = arg;
+    writer->buffer_count = buffer_count;
+    writer->buffer_size = buffer_size;
+    if (avs_mutex_create(&writer->mutex)
+            || avs_condvar_create(&writer->cond)
+            || !(writer->lengths =
+                    (size_t *) avs_calloc(buffer_count, sizeof(size_t)))
+            || !(writer->data =
+                    (char *) avs_malloc(buffer_count * buffer_size))) {
+        _anjay_fw_async_writer_delete(&writer);
+    }
+    return writer;
+}
+
+void _anjay_fw_async_writer_delete(anjay_fw_update_async_writer_t **writer_ptr) {
+    if (!writer_ptr || !*writer_ptr) {
+        return;
+    }
+    anjay_fw_update_async_writer_t *writer = *writer_ptr;
+    if (writer->mutex && writer->cond) {
+        avs_mutex_lock(writer->mutex);
+        writer->shutdown = true;
+        avs_condvar_notify_all(writer->cond);
+        while (writer->worker_running) {
+            wait_locked(writer);
+        }
+        avs_mutex_unlock(writer->mutex);
+    }
+    avs_free(writer->data);
+    avs_free(writer->lengths);
+    avs_condvar_cleanup(&writer->cond);
+    avs_mutex_cleanup(&writer->mutex);
+    avs_free(writer);
+    *writer_ptr = NULL;
+}
+
+int anjay_fw_update_async_writer_run(anjay_fw_update_async_writer_t *writer) {
+    if (!writer) {
+        return -1;
+    }
+    avs_mutex_lock(writer->mutex);
+    if (writer->worker_running) {
+        avs_mutex_unlock(writer->mutex);
+        fw_log(ERROR, "asynchronous firmware writer is already running");
+        return -1;
+    }
+    writer->worker_running = true;
+    while (!writer->shutdown) {
+        if (writer->queued > 0 && !writer->write_in_progress
+                && !writer->result) {
+            write_first_locked(writer);
+        } else {
+            wait_locked(writer);
+        }
+    }
+    writer->worker_running = false;
+    avs_condvar_notify_all(writer->cond);
+    avs_mutex_unlock(writer->mutex);
+    return 0;
+}
+
+int _anjay_fw_async_writer_write(anjay_fw_update_async_writer_t *writer,
+                                 const void *data,
+                                 size_t length) {
+    const char *ptr = (const char *) data;
+    avs_mutex_lock(writer->mutex);
+    while (length > 0 && !writer->result) {
+        size_t index;
+        if (last_buffer_appendable(writer)) {
+            index = last_index(writer);
+        } else {
+            make_room_locked(writer);
+            if (writer->result) {
+                break;
+            }
+            index = (writer->first + writer->queued) % writer->buffer_count;
+            writer->lengths[index] = 0;
+            ++writer->queued;
+        }
+        size_t chunk = AVS_MIN(length,
+                               writer->buffer_size - writer->lengths[index]);
+        memcpy(buffer_ptr(writer, index) + writer->lengths[index], ptr, chunk);
+        writer->lengths[index] += chunk;
+        ptr += chunk;
+        length -= chunk;
+        avs_condvar_notify_all(writer->cond);
+    }
+    int result = writer->result;
+    avs_mutex_unlock(writer->mutex);
+    return result;
+}
+
+size_t
+_anjay_fw_async_writer_available(anjay_fw_update_async_writer_t *writer) {
+    size_t result = 0;
+    avs_mutex_lock(writer->mutex);
+    if (!writer->result) {
+        result = (writer->buffer_count - writer->queued) * writer->buffer_size;
+        if (last_buffer_appendable(writer)) {
+            result += writer->buffer_size - writer->lengths[last_index(writer)];
+        }
+    }
+    avs_mutex_unlock(writer->mutex);
+    return result;
+}
+
+bool _anjay_fw_async_writer_failed(anjay_fw_update_async_writer_t *writer) {
+    avs_mutex_lock(writer->mutex);
+    bool result = (writer->result != 0);
+    avs_mutex_unlock(writer->mutex);
+    return result;
+}
+
+static int wait_written_locked(anjay_fw_update_async_writer_t *writer) {
+    while ((writer->queued > 0 || writer->write_in_progress)
+            && !writer->result) {
+        if (writer->worker_running || writer->write_in_progress) {
+            wait_locked(writer);
+        } else {
+            write_first_locked(writer);
+        }
+    }
+    return writer->result;
+}
+
+int _anjay_fw_async_writer_wait(anjay_fw_update_async_writer_t *writer) {
+    avs_mutex_lock(writer->mutex);
+    int result = wait_written_locked(writer);
+    avs_mutex_unlock(writer->mutex);
+    return result;
+}
+
+int _anjay_fw_async_writer_flush(anjay_fw_update_async_writer_t *writer) {
+    avs_mutex_lock(writer->mutex);
+    int result = wait_written_locked(writer);
+    writer->result = 0;
+    avs_mutex_unlock(writer->mutex);
+    return result;
+}
+
+void _anjay_fw_async_writer_discard(anjay_fw_update_async_writer_t *writer) {
+    avs_mutex_lock(writer->mutex);
+    if (writer->write_in_progress) {
+        // keep only the buffer that is being written
+        writer->queued = 1;
+        while (writer->write_in_progress) {
+            wait_locked(writer);
+        }
+    }
+    writer->first = 0;
+    writer->queued = 0;
+    writer->result = 0;
+    avs_mutex_unlock(writer->mutex);
+}
+
+#ifdef ANJAY_TEST
+#include "test/async_writer.c"
+#endif // ANJAY_TEST
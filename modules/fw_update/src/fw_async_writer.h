@@ -0,0 +1,88 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FW_ASYNC_WRITER_H
+#define FW_ASYNC_WRITER_H
+#include <anjay_config.h>
+
+#include <anjay/fw_update.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Creates a ring of @p buffer_count buffers, @p buffer_size bytes each, through
+ * which data is passed to <c>handlers->stream_write</c>.
+ */
+anjay_fw_update_async_writer_t *
+_anjay_fw_async_writer_new(const anjay_fw_update_handlers_t *handlers,
+                           void *arg,
+                           size_t buffer_count,
+                           size_t buffer_size);
+
+/**
+ * Makes @ref anjay_fw_update_async_writer_run return, waits until it does and
+ * frees the writer. Queued data is discarded.
+ */
+void _anjay_fw_async_writer_delete(anjay_fw_update_async_writer_t **writer_ptr);
+
+/**
+ * Copies @p data into the ring. If there is not enough room, blocks until the
+ * worker makes some, or writes the oldest buffers from the calling thread if
+ * no worker is running.
+ *
+ * @returns 0 on success, or the result of the first failed
+ *          <c>stream_write</c> call since the last flush or discard.
+ */
+int _anjay_fw_async_writer_write(anjay_fw_update_async_writer_t *writer,
+                                 const void *data,
+                                 size_t length);
+
+/**
+ * @returns Number of bytes that may be passed to
+ *          @ref _anjay_fw_async_writer_write without blocking, or 0 if a write
+ *          has failed.
+ */
+size_t _anjay_fw_async_writer_available(anjay_fw_update_async_writer_t *writer);
+
+/**
+ * @returns True if a <c>stream_write</c> call failed since the last flush or
+ *          discard.
+ */
+bool _anjay_fw_async_writer_failed(anjay_fw_update_async_writer_t *writer);
+
+/**
+ * Waits until all queued data is written.
+ *
+ * @returns 0 on success, or the result of the first failed
+ *          <c>stream_write</c> call. The error is kept.
+ */
+int _anjay_fw_async_writer_wait(anjay_fw_update_async_writer_t *writer);
+
+/**
+ * Same as @ref _anjay_fw_async_writer_wait, but the error is cleared
+ * afterwards.
+ */
+int _anjay_fw_async_writer_flush(anjay_fw_update_async_writer_t *writer);
+
+/**
+ * Drops all queued data, waits for the write in progress (if any) to finish
+ * and clears the error.
+ */
+void _anjay_fw_async_writer_discard(anjay_fw_update_async_writer_t *writer);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* FW_ASYNC_WRITER_H */
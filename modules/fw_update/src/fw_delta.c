@@ -0,0 +1,265 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <assert.h>
+#include <string.h>
+
+#include <anjay/fw_update.h>
+
+#include <anjay_modules/utils_core.h>
+
+#include "fw_delta.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#define fw_log(level, ...) _anjay_log(fw_update, level, __VA_ARGS__)
+
+#define CONTROL_SIZE (3 * FW_DELTA_INT_SIZE)
+
+AVS_STATIC_ASSERT(sizeof(((fw_delta_decoder_t *) NULL)->header)
+                          >= CONTROL_SIZE,
+                  delta_header_buffer_holds_control_tuple);
+
+void _anjay_fw_delta_init(fw_delta_decoder_t *dec,
+                          fw_delta_read_old_t *read_old,
+                          fw_delta_write_new_t *write_new,
+                          void *arg) {
+    memset(dec, 0, offsetof(fw_delta_decoder_t, scratch));
+    dec->read_old = read_old;
+    dec->write_new = write_new;
+    dec->arg = arg;
+    dec->state = read_old ? FW_DELTA_DETECT : FW_DELTA_RAW;
+}
+
+/**
+ * Decodes the sign-magnitude little-endian integer used by bsdiff.
+ */
+static int64_t read_offtin(const uint8_t *buf) {
+    uint64_t magnitude = 0;
+    for (int i = FW_DELTA_INT_SIZE - 1; i >= 0; --i) {
+        magnitude = (magnitude << 8) | buf[i];
+    }
+    bool negative = (magnitude & UINT64_C(0x8000000000000000));
+    magnitude &= ~UINT64_C(0x8000000000000000);
+    return negative ? -(int64_t) magnitude : (int64_t) magnitude;
+}
+
+static int fail(fw_delta_decoder_t *dec, int result) {
+    dec->state = FW_DELTA_ERROR;
+    return result;
+}
+
+static int malformed(fw_delta_decoder_t *dec, const char *reason) {
+    fw_log(ERROR, "malformed delta package: %s", reason);
+    return fail(dec, ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE);
+}
+
+/**
+ * Buffers up to @p needed bytes of a header in <c>dec->header</c>.
+ *
+ * @returns Number of bytes consumed from @p data.
+ */
+static size_t collect_header(fw_delta_decoder_t *dec,
+                             size_t needed,
+                             const uint8_t *data,
+                             size_t length) {
+    assert(dec->header_size < needed);
+    size_t chunk = AVS_MIN(length, needed - dec->header_size);
+    memcpy(&dec->header[dec->header_size], data, chunk);
+    dec->header_size += chunk;
+    return chunk;
+}
+
+static void finish_entry(fw_delta_decoder_t *dec) {
+    dec->old_pos += dec->seek;
+    dec->state = (dec->new_pos == dec->new_size) ? FW_DELTA_DONE
+                                                 : FW_DELTA_CONTROL;
+}
+
+static int handle_detect(fw_delta_decoder_t *dec,
+                         const uint8_t *data,
+                         size_t length,
+                         size_t *out_consumed) {
+    *out_consumed = collect_header(dec, sizeof(dec->header), data, length);
+    size_t magic_bytes = AVS_MIN(dec->header_size, FW_DELTA_MAGIC_SIZE);
+    if (memcmp(dec->header, FW_DELTA_MAGIC, magic_bytes)) {
+        // not a delta package - pass everything through
+        dec->state = FW_DELTA_RAW;
+        int result = dec->write_new(dec->arg, dec->header, dec->header_size);
+        return result ? fail(dec, result) : 0;
+    }
+    if (dec->header_size < sizeof(dec->header)) {
+        return 0;
+    }
+    int64_t new_size = read_offtin(&dec->header[FW_DELTA_MAGIC_SIZE]);
+    if (new_size < 0) {
+        return malformed(dec, "negative image size");
+    }
+    fw_log(INFO, "applying delta package, new image size: %lu B",
+           (unsigned long) new_size);
+    dec->new_size = (uint64_t) new_size;
+    dec->header_size = 0;
+    dec->state = (dec->new_size > 0) ? FW_DELTA_CONTROL : FW_DELTA_DONE;
+    return 0;
+}
+
+static int handle_control(fw_delta_decoder_t *dec,
+                          const uint8_t *data,
+                          size_t length,
+                          size_t *out_consumed) {
+    *out_consumed = collect_header(dec, CONTROL_SIZE, data, length);
+    if (dec->header_size < CONTROL_SIZE) {
+        return 0;
+    }
+    dec->header_size = 0;
+
+    int64_t diff = read_offtin(&dec->header[0]);
+    int64_t extra = read_offtin(&dec->header[FW_DELTA_INT_SIZE]);
+    dec->seek = read_offtin(&dec->header[2 * FW_DELTA_INT_SIZE]);
+    uint64_t new_left = dec->new_size - dec->new_pos;
+    if (diff < 0 || extra < 0 || (uint64_t) diff > new_left
+            || (uint64_t) extra > new_left - (uint64_t) diff) {
+        return malformed(dec, "invalid control tuple");
+    }
+    dec->diff_left = (uint64_t) diff;
+    dec->extra_left = (uint64_t) extra;
+    if (dec->diff_left) {
+        dec->state = FW_DELTA_DIFF;
+    } else if (dec->extra_left) {
+        dec->state = FW_DELTA_EXTRA;
+    } else {
+        finish_entry(dec);
+    }
+    return 0;
+}
+
+static int handle_diff(fw_delta_decoder_t *dec,
+                       const uint8_t *data,
+                       size_t length,
+                       size_t *out_consumed) {
+    size_t chunk = (size_t) AVS_MIN((uint64_t) AVS_MIN(length,
+                                                       sizeof(dec->scratch)),
+                                    dec->diff_left);
+    if (dec->old_pos < 0 || (uint64_t) dec->old_pos > SIZE_MAX - chunk) {
+        return malformed(dec, "old image offset out of range");
+    }
+    int result = dec->read_old(dec->arg, (size_t) dec->old_pos,
+                               dec->scratch, chunk);
+    if (result) {
+        fw_log(ERROR, "could not read current image at offset %lu",
+               (unsigned long) dec->old_pos);
+        return fail(dec, result);
+    }
+    for (size_t i = 0; i < chunk; ++i) {
+        dec->scratch[i] = (uint8_t) (dec->scratch[i] + data[i]);
+    }
+    if ((result = dec->write_new(dec->arg, dec->scratch, chunk))) {
+        return fail(dec, result);
+    }
+    *out_consumed = chunk;
+    dec->old_pos += (int64_t) chunk;
+    dec->new_pos += chunk;
+    if (!(dec->diff_left -= chunk)) {
+        if (dec->extra_left) {
+            dec->state = FW_DELTA_EXTRA;
+        } else {
+            finish_entry(dec);
+        }
+    }
+    return 0;
+}
+
+static int handle_extra(fw_delta_decoder_t *dec,
+                        const uint8_t *data,
+                        size_t length,
+                        size_t *out_consumed) {
+    size_t chunk = (size_t) AVS_MIN((uint64_t) length, dec->extra_left);
+    int result = dec->write_new(dec->arg, data, chunk);
+    if (result) {
+        return fail(dec, result);
+    }
+    *out_consumed = chunk;
+    dec->new_pos += chunk;
+    if (!(dec->extra_left -= chunk)) {
+        finish_entry(dec);
+    }
+    return 0;
+}
+
+int _anjay_fw_delta_write(fw_delta_decoder_t *dec,
+                          const void *data,
+                          size_t length) {
+    const uint8_t *ptr = (const uint8_t *) data;
+    while (length > 0) {
+        size_t consumed = 0;
+        int result;
+        switch (dec->state) {
+        case FW_DELTA_DETECT:
+            result = handle_detect(dec, ptr, length, &consumed);
+            break;
+        case FW_DELTA_RAW:
+            result = dec->write_new(dec->arg, ptr, length);
+            consumed = length;
+            break;
+        case FW_DELTA_CONTROL:
+            result = handle_control(dec, ptr, length, &consumed);
+            break;
+        case FW_DELTA_DIFF:
+            result = handle_diff(dec, ptr, length, &consumed);
+            break;
+        case FW_DELTA_EXTRA:
+            result = handle_extra(dec, ptr, length, &consumed);
+            break;
+        case FW_DELTA_DONE:
+            return malformed(dec, "trailing data after the last entry");
+        default:
+            return ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE;
+        }
+        if (result) {
+            return result;
+        }
+        ptr += consumed;
+        length -= consumed;
+    }
+    return 0;
+}
+
+int _anjay_fw_delta_finish(fw_delta_decoder_t *dec) {
+    switch (dec->state) {
+    case FW_DELTA_DETECT: {
+        // package shorter than the delta header
+        dec->state = FW_DELTA_RAW;
+        int result = 0;
+        if (dec->header_size) {
+            result = dec->write_new(dec->arg, dec->header, dec->header_size);
+        }
+        return result ? fail(dec, result) : 0;
+    }
+    case FW_DELTA_RAW:
+    case FW_DELTA_DONE:
+        return 0;
+    default:
+        fw_log(ERROR, "delta package truncated at %lu of %lu B",
+               (unsigned long) dec->new_pos, (unsigned long) dec->new_size);
+        return fail(dec, ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE);
+    }
+}
+
+#ifdef ANJAY_TEST
+#include "test/delta.c"
+#endif // ANJAY_TEST
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FW_DELTA_H
+#define FW_DELTA_H
+#include <anjay_config.h>
+
+#include <stdint.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/** Magic header of the bsdiff 4.3 patch format, as used by mendsley/bsdiff */
+#define FW_DELTA_MAGIC "ENDSLEY/BSDIFF43"
+#define FW_DELTA_MAGIC_SIZE (sizeof(FW_DELTA_MAGIC) - 1)
+
+/** Size of a single bsdiff "offtin" encoded integer */
+#define FW_DELTA_INT_SIZE 8
+
+/** Bytes of the old image read at once while applying a diff block */
+#define FW_DELTA_SCRATCH_SIZE 256
+
+typedef int fw_delta_read_old_t(void *arg,
+                                size_t offset,
+                                void *buffer,
+                                size_t length);
+typedef int fw_delta_write_new_t(void *arg, const void *data, size_t length);
+
+typedef enum {
+    FW_DELTA_DETECT = 0,
+    FW_DELTA_RAW,
+    FW_DELTA_CONTROL,
+    FW_DELTA_DIFF,
+    FW_DELTA_EXTRA,
+    FW_DELTA_DONE,
+    FW_DELTA_ERROR
+} fw_delta_state_t;
+
+/**
+ * Streaming decoder of delta firmware packages.
+ *
+ * Packages that start with @ref FW_DELTA_MAGIC are treated as uncompressed
+ * bsdiff 4.3 patches: after the magic and the size of the new image, there is
+ * a series of entries, each consisting of a control tuple (diff length, extra
+ * length, old image seek), diff bytes that are added to the old image, and
+ * extra bytes that are copied verbatim. Any other package is passed through
+ * unchanged.
+ *
+ * Memory usage does not depend on the package or image size.
+ */
+typedef struct {
+    fw_delta_read_old_t *read_old;
+    fw_delta_write_new_t *write_new;
+    void *arg;
+
+    fw_delta_state_t state;
+    /** Partially received header or control tuple. */
+    uint8_t header[FW_DELTA_MAGIC_SIZE + FW_DELTA_INT_SIZE];
+    size_t header_size;
+
+    uint64_t new_size;
+    uint64_t new_pos;
+    int64_t old_pos;
+    uint64_t diff_left;
+    uint64_t extra_left;
+    int64_t seek;
+
+    uint8_t scratch[FW_DELTA_SCRATCH_SIZE];
+} fw_delta_decoder_t;
+
+/**
+ * Prepares @p dec for a new package. If @p read_old is NULL, delta packages
+ * are not recognized and all data is passed to @p write_new unchanged.
+ */
+void _anjay_fw_delta_init(fw_delta_decoder_t *dec,
+                          fw_delta_read_old_t *read_old,
+                          fw_delta_write_new_t *write_new,
+                          void *arg);
+
+/**
+ * Decodes the next chunk of the package, passing the resulting data to
+ * <c>write_new</c>.
+ *
+ * @returns 0 on success, @ref ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE if the
+ *          patch is malformed, or the error returned by one of the callbacks.
+ */
+int _anjay_fw_delta_write(fw_delta_decoder_t *dec,
+                          const void *data,
+                          size_t length);
+
+/**
+ * Finishes decoding of the package.
+ *
+ * @returns 0 on success, or @ref ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE if the
+ *          patch was truncated.
+ */
+int _anjay_fw_delta_finish(fw_delta_decoder_t *dec);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* FW_DELTA_H */
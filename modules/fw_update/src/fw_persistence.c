@@ -0,0 +1,345 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#ifdef WITH_AVS_PERSISTENCE
+#include <avsystem/commons/persistence.h>
+#endif // WITH_AVS_PERSISTENCE
+
+#include <anjay_modules/utils_core.h>
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "fw_async_writer.h"
+#include "mod_fw_update.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#define persistence_log(level, ...) \
+    _anjay_log(fw_update_persistence, level, __VA_ARGS__)
+
+#ifdef WITH_AVS_PERSISTENCE
+
+static const char MAGIC[] = { 'F', 'W', 'U', '\0' };
+
+/** Object state as stored in the persistence stream. */
+typedef struct {
+    uint16_t state;
+    uint16_t result;
+    char *package_uri;
+
+    /** Fields below are only stored in the Downloading state. */
+    uint64_t offset;
+    bool has_etag;
+    uint16_t etag_size;
+    uint8_t etag[UINT8_MAX];
+    fw_delta_decoder_t delta;
+} persisted_fw_t;
+
+static int handle_u64(avs_persistence_context_t *ctx, uint64_t *value) {
+    uint32_t high = (uint32_t) (*value >> 32);
+    uint32_t low = (uint32_t) *value;
+    int retval = 0;
+    (void) ((retval = avs_persistence_u32(ctx, &high))
+            || (retval = avs_persistence_u32(ctx, &low)));
+    *value = ((uint64_t) high << 32) | low;
+    return retval;
+}
+
+static int handle_i64(avs_persistence_context_t *ctx, int64_t *value) {
+    uint64_t u64 = (uint64_t) *value;
+    int retval = handle_u64(ctx, &u64);
+    *value = (int64_t) u64;
+    return retval;
+}
+
+static int handle_delta(avs_persistence_context_t *ctx,
+                        fw_delta_decoder_t *dec) {
+    uint16_t state = (uint16_t) dec->state;
+    uint32_t header_size = (uint32_t) dec->header_size;
+    int retval = 0;
+    (void) ((retval = avs_persistence_u16(ctx, &state))
+            || (retval = avs_persistence_u32(ctx, &header_size))
+            || (retval = avs_persistence_bytes(ctx, dec->header,
+                                               sizeof(dec->header)))
+            || (retval = handle_u64(ctx, &dec->new_size))
+            || (retval = handle_u64(ctx, &dec->new_pos))
+            || (retval = handle_i64(ctx, &dec->old_pos))
+            || (retval = handle_u64(ctx, &dec->diff_left))
+            || (retval = handle_u64(ctx, &dec->extra_left))
+            || (retval = handle_i64(ctx, &dec->seek)));
+    if (!retval && (state > FW_DELTA_ERROR
+                    || header_size > sizeof(dec->header))) {
+        persistence_log(ERROR, "Invalid delta decoder state");
+        retval = -1;
+    }
+    dec->state = (fw_delta_state_t) state;
+    dec->header_size = header_size;
+    return retval;
+}
+
+static int handle_fw(avs_persistence_context_t *ctx, persisted_fw_t *data) {
+    int retval = 0;
+    (void) ((retval = avs_persistence_u16(ctx, &data->state))
+            || (retval = avs_persistence_u16(ctx, &data->result))
+            || (retval = avs_persistence_string(ctx, &data->package_uri)));
+    if (retval || data->state != UPDATE_STATE_DOWNLOADING) {
+        return retval;
+    }
+    (void) ((retval = handle_u64(ctx, &data->offset))
+            || (retval = avs_persistence_bool(ctx, &data->has_etag)));
+    if (!retval && data->has_etag
+            && !(retval = avs_persistence_u16(ctx, &data->etag_size))) {
+        if (data->etag_size > sizeof(data->etag)) {
+            persistence_log(ERROR, "Invalid ETag size: %" PRIu16,
+                            data->etag_size);
+            return -1;
+        }
+        retval = avs_persistence_bytes(ctx, data->etag, data->etag_size);
+    }
+    if (!retval) {
+        retval = handle_delta(ctx, &data->delta);
+    }
+    return retval;
+}
+
+static int validate_persisted_fw(const persisted_fw_t *data) {
+    switch (data->state) {
+    case UPDATE_STATE_IDLE:
+    case UPDATE_STATE_DOWNLOADED:
+        break;
+    case UPDATE_STATE_DOWNLOADING:
+        if (!data->package_uri) {
+            persistence_log(ERROR, "Package URI not set while downloading");
+            return -1;
+        }
+        if (data->offset > SIZE_MAX) {
+            persistence_log(ERROR, "Download offset too large");
+            return -1;
+        }
+        if (data->delta.state == FW_DELTA_ERROR) {
+            persistence_log(ERROR, "Cannot resume a failed delta package");
+            return -1;
+        }
+        break;
+    default:
+        persistence_log(ERROR, "Invalid state: %" PRIu16, data->state);
+        return -1;
+    }
+    if (data->result > UPDATE_RESULT_UNSUPPORTED_PROTOCOL) {
+        persistence_log(ERROR, "Invalid update result: %" PRIu16,
+                        data->result);
+        return -1;
+    }
+    return 0;
+}
+
+int anjay_fw_update_persist(anjay_t *anjay,
+                            avs_stream_abstract_t *out_stream) {
+    assert(anjay);
+
+    fw_repr_t *fw = _anjay_fw_get(anjay);
+    if (!fw) {
+        persistence_log(ERROR, "Firmware Update object not installed");
+        return -1;
+    }
+    if (fw->user_state.writer
+            && _anjay_fw_async_writer_wait(fw->user_state.writer)) {
+        persistence_log(ERROR, "Writing the firmware failed, not persisting "
+                               "the download state");
+        return -1;
+    }
+
+    persisted_fw_t data;
+    memset(&data, 0, sizeof(data));
+    // after reboot, an interrupted upgrade is retried from the downloaded
+    // image unless the application reports its outcome instead
+    data.state = (uint16_t) (fw->state == UPDATE_STATE_UPDATING
+                                     ? UPDATE_STATE_DOWNLOADED
+                                     : fw->state);
+    data.result = (uint16_t) fw->result;
+    data.package_uri = (char *) (intptr_t) fw->package_uri;
+    if (fw->state == UPDATE_STATE_DOWNLOADING) {
+        data.offset = fw->bytes_downloaded;
+        if (fw->etag) {
+            data.has_etag = true;
+            data.etag_size = fw->etag->size;
+            memcpy(data.etag, fw->etag->value, fw->etag->size);
+        }
+        data.delta = fw->user_state.delta;
+    }
+
+    int retval = avs_stream_write(out_stream, MAGIC, sizeof(MAGIC));
+    if (retval) {
+        return retval;
+    }
+    avs_persistence_context_t *ctx =
+            avs_persistence_store_context_new(out_stream);
+    if (!ctx) {
+        persistence_log(ERROR, "Out of memory");
+        return -1;
+    }
+    retval = handle_fw(ctx, &data);
+    avs_persistence_context_delete(ctx);
+    if (!retval) {
+        persistence_log(INFO, "Firmware Update object state persisted");
+    }
+    return retval;
+}
+
+#ifdef WITH_DOWNLOADER
+static int restore_download(anjay_t *anjay,
+                            fw_repr_t *fw,
+                            const persisted_fw_t *data) {
+    if (data->offset == 0) {
+        // the download stream is opened when the first block arrives
+        return _anjay_fw_resume_download(anjay, fw, 0, NULL);
+    }
+
+    fw->user_state.state = UPDATE_STATE_DOWNLOADING;
+    _anjay_fw_user_state_reset_delta(&fw->user_state);
+    fw_delta_decoder_t *dec = &fw->user_state.delta;
+    dec->state = data->delta.state;
+    memcpy(dec->header, data->delta.header, sizeof(dec->header));
+    dec->header_size = data->delta.header_size;
+    dec->new_size = data->delta.new_size;
+    dec->new_pos = data->delta.new_pos;
+    dec->old_pos = data->delta.old_pos;
+    dec->diff_left = data->delta.diff_left;
+    dec->extra_left = data->delta.extra_left;
+    dec->seek = data->delta.seek;
+
+    anjay_etag_t *etag = NULL;
+    if (data->has_etag) {
+        // without the ETag, the download is restarted from the beginning
+        if (!(etag = (anjay_etag_t *) avs_malloc(
+                      offsetof(anjay_etag_t, value) + data->etag_size))) {
+            persistence_log(ERROR, "Out of memory");
+        } else {
+            etag->size = (uint8_t) data->etag_size;
+            memcpy(etag->value, data->etag, data->etag_size);
+        }
+    }
+    int retval = _anjay_fw_resume_download(anjay, fw, (size_t) data->offset,
+                                           etag);
+    avs_free(etag);
+    return retval;
+}
+#endif // WITH_DOWNLOADER
+
+int anjay_fw_update_restore(anjay_t *anjay,
+                            avs_stream_abstract_t *in_stream) {
+    assert(anjay);
+
+    fw_repr_t *fw = _anjay_fw_get(anjay);
+    if (!fw) {
+        persistence_log(ERROR, "Firmware Update object not installed");
+        return -1;
+    }
+    if (fw->state != UPDATE_STATE_IDLE
+            || fw->user_state.state != UPDATE_STATE_IDLE) {
+        persistence_log(ERROR, "Firmware Update object is not idle");
+        return -1;
+    }
+
+    char magic_header[sizeof(MAGIC)];
+    int retval = avs_stream_read_reliably(in_stream, magic_header,
+                                          sizeof(magic_header));
+    if (retval) {
+        persistence_log(ERROR, "Could not read Firmware Update object header");
+        return retval;
+    }
+
+    if (memcmp(magic_header, MAGIC, sizeof(MAGIC))) {
+        persistence_log(ERROR, "Header magic constant mismatch");
+        return -1;
+    }
+    avs_persistence_context_t *restore_ctx =
+            avs_persistence_restore_context_new(in_stream);
+    if (!restore_ctx) {
+        persistence_log(ERROR, "Cannot create persistence restore context");
+        return -1;
+    }
+    persisted_fw_t data;
+    memset(&data, 0, sizeof(data));
+    retval = handle_fw(restore_ctx, &data);
+    avs_persistence_context_delete(restore_ctx);
+    if (!retval) {
+        retval = validate_persisted_fw(&data);
+    }
+    if (!retval && data.state == UPDATE_STATE_DOWNLOADING) {
+#ifdef WITH_DOWNLOADER
+        if (!fw->user_state.handlers->read_current_image
+                && data.delta.state != FW_DELTA_DETECT
+                && data.delta.state != FW_DELTA_RAW) {
+            persistence_log(ERROR, "Cannot resume applying a delta package "
+                                   "without read_current_image handler");
+            retval = -1;
+        }
+#else // WITH_DOWNLOADER
+        persistence_log(ERROR,
+                        "Unable to resume download: PULL download not "
+                        "supported");
+        retval = -1;
+#endif // WITH_DOWNLOADER
+    }
+    if (retval) {
+        avs_free(data.package_uri);
+        return retval;
+    }
+
+    avs_free((void *) (intptr_t) fw->package_uri);
+    fw->package_uri = data.package_uri;
+    fw->result = (fw_update_result_t) data.result;
+    if (data.state == UPDATE_STATE_DOWNLOADED) {
+        fw->user_state.state = UPDATE_STATE_DOWNLOADED;
+        fw->state = UPDATE_STATE_DOWNLOADED;
+    }
+#ifdef WITH_DOWNLOADER
+    else if (data.state == UPDATE_STATE_DOWNLOADING
+             && restore_download(anjay, fw, &data)) {
+        persistence_log(WARNING, "Could not resume firmware download");
+    }
+#endif // WITH_DOWNLOADER
+    persistence_log(INFO, "Firmware Update object state restored");
+    return 0;
+}
+
+#ifdef ANJAY_TEST
+#include "test/persistence.c"
+#endif
+
+#else // WITH_AVS_PERSISTENCE
+
+int anjay_fw_update_persist(anjay_t *anjay,
+                            avs_stream_abstract_t *out_stream) {
+    (void) anjay; (void) out_stream;
+    persistence_log(ERROR, "Persistence not compiled in");
+    return -1;
+}
+
+int anjay_fw_update_restore(anjay_t *anjay,
+                            avs_stream_abstract_t *in_stream) {
+    (void) anjay; (void) in_stream;
+    persistence_log(ERROR, "Persistence not compiled in");
+    return -1;
+}
+
+#endif // WITH_AVS_PERSISTENCE
@@ -16,6 +16,8 @@
 
 #include <anjay_config.h>
 
+#include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <anjay/download.h>
@@ -30,6 +32,10 @@
 #include <avsystem/commons/errno.h>
 #include <avsystem/commons/utils.h>
 
+#include "fw_async_writer.h"
+#include "fw_delta.h"
+#include "mod_fw_update.h"
+
 VISIBILITY_SOURCE_BEGIN
 
 #define fw_log(level, ...) _anjay_log(fw_update, level, __VA_ARGS__)
@@ -46,50 +52,45 @@ VISIBILITY_SOURCE_BEGIN
 #define FW_RES_UPDATE_PROTOCOL_SUPPORT  8
 #define FW_RES_UPDATE_DELIVERY_METHOD   9
 
-typedef enum {
-    UPDATE_STATE_IDLE = 0,
-    UPDATE_STATE_DOWNLOADING,
-    UPDATE_STATE_DOWNLOADED,
-    UPDATE_STATE_UPDATING
-} fw_update_state_t;
-
-typedef enum {
-    UPDATE_RESULT_INITIAL = 0,
-    UPDATE_RESULT_SUCCESS = 1,
-    UPDATE_RESULT_NOT_ENOUGH_SPACE = 2,
-    UPDATE_RESULT_OUT_OF_MEMORY = 3,
-    UPDATE_RESULT_CONNECTION_LOST = 4,
-    UPDATE_RESULT_INTEGRITY_FAILURE = 5,
-    UPDATE_RESULT_UNSUPPORTED_PACKAGE_TYPE = 6,
-    UPDATE_RESULT_INVALID_URI = 7,
-    UPDATE_RESULT_FAILED = 8,
-    UPDATE_RESULT_UNSUPPORTED_PROTOCOL = 9
-} fw_update_result_t;
-
-typedef struct {
-    const anjay_fw_update_handlers_t *handlers;
-    void *arg;
-    fw_update_state_t state;
-} fw_user_state_t;
-
-typedef struct fw_repr {
-    const anjay_dm_object_def_t *def;
-
-    fw_user_state_t user_state;
-    avs_net_security_info_t *security_from_dm;
-
-    fw_update_state_t state;
-    fw_update_result_t result;
-    const char *package_uri;
-    bool retry_download_on_expired;
-    anjay_sched_handle_t update_job;
-} fw_repr_t;
+#define ASYNC_WRITE_POLL_INTERVAL_MS 20
 
 static inline fw_repr_t *get_fw(const anjay_dm_object_def_t *const *obj_ptr) {
     assert(obj_ptr);
     return AVS_CONTAINER_OF(obj_ptr, fw_repr_t, def);
 }
 
+static int user_state_write_image(void *user_,
+                                  const void *data,
+                                  size_t length) {
+    fw_user_state_t *user = (fw_user_state_t *) user_;
+    if (user->writer) {
+        return _anjay_fw_async_writer_write(user->writer, data, length);
+    }
+    return user->handlers->stream_write(user->arg, data, length);
+}
+
+static int user_state_read_current_image(void *user_,
+                                         size_t offset,
+                                         void *buffer,
+                                         size_t length) {
+    fw_user_state_t *user = (fw_user_state_t *) user_;
+    // the handler may not be called while the worker is inside stream_write
+    int result;
+    if (user->writer && (result = _anjay_fw_async_writer_wait(user->writer))) {
+        return result;
+    }
+    return user->handlers->read_current_image(user->arg, offset,
+                                              buffer, length);
+}
+
+void _anjay_fw_user_state_reset_delta(fw_user_state_t *user) {
+    _anjay_fw_delta_init(&user->delta,
+                         user->handlers->read_current_image
+                                 ? user_state_read_current_image
+                                 : NULL,
+                         user_state_write_image, user);
+}
+
 static int
 user_state_ensure_stream_open(fw_user_state_t *user,
                               const char *package_uri,
@@ -102,6 +103,7 @@ user_state_ensure_stream_open(fw_user_state_t *user,
                                              package_uri, package_etag);
     if (!result) {
         user->state = UPDATE_STATE_DOWNLOADING;
+        _anjay_fw_user_state_reset_delta(user);
     }
     return result;
 }
@@ -109,7 +111,7 @@ user_state_ensure_stream_open(fw_user_state_t *user,
 static int user_state_stream_write(fw_user_state_t *user,
                                    const void *data, size_t length) {
     assert(user->state == UPDATE_STATE_DOWNLOADING);
-    return user->handlers->stream_write(user->arg, data, length);
+    return _anjay_fw_delta_write(&user->delta, data, length);
 }
 
 static const char *user_state_get_name(fw_user_state_t *user) {
@@ -139,7 +141,20 @@ static int user_state_perform_upgrade(fw_user_state_t *user) {
 
 static int finish_user_stream(fw_repr_t *fw) {
     assert(fw->user_state.state == UPDATE_STATE_DOWNLOADING);
-    int result = fw->user_state.handlers->stream_finish(fw->user_state.arg);
+    int result = _anjay_fw_delta_finish(&fw->user_state.delta);
+    if (fw->user_state.writer) {
+        if (result) {
+            _anjay_fw_async_writer_discard(fw->user_state.writer);
+        } else {
+            result = _anjay_fw_async_writer_flush(fw->user_state.writer);
+        }
+    }
+    if (result) {
+        // the stream is still open after a failed write
+        fw->user_state.handlers->reset(fw->user_state.arg);
+    } else {
+        result = fw->user_state.handlers->stream_finish(fw->user_state.arg);
+    }
     if (result) {
         fw->user_state.state = UPDATE_STATE_IDLE;
         avs_free(fw->security_from_dm);
@@ -151,6 +166,9 @@ static int finish_user_stream(fw_repr_t *fw) {
 }
 
 static void reset_user_state(fw_repr_t *fw) {
+    if (fw->user_state.writer) {
+        _anjay_fw_async_writer_discard(fw->user_state.writer);
+    }
     fw->user_state.handlers->reset(fw->user_state.arg);
     fw->user_state.state = UPDATE_STATE_IDLE;
     avs_free(fw->security_from_dm);
@@ -328,14 +346,75 @@ static anjay_downloader_protocol_class_t classify_protocol(const char *uri) {
     return _anjay_downloader_classify_protocol(buf);
 }
 
+static int schedule_resume_download(anjay_t *anjay, fw_repr_t *fw);
+
+static void resume_download_job(anjay_t *anjay, void *fw_) {
+    fw_repr_t *fw = (fw_repr_t *) fw_;
+    anjay_fw_update_async_writer_t *writer = fw->user_state.writer;
+    assert(writer);
+    if (_anjay_fw_async_writer_failed(writer)
+            || _anjay_fw_async_writer_available(writer)
+                    >= fw->suspended_block_size) {
+        // a failed write is reported when handling the next block
+        anjay_download_resume(anjay, fw->download_handle);
+    } else if (schedule_resume_download(anjay, fw)) {
+        fw_log(WARNING, "could not schedule firmware download resumption");
+        anjay_download_resume(anjay, fw->download_handle);
+    }
+}
+
+static int schedule_resume_download(anjay_t *anjay, fw_repr_t *fw) {
+    return _anjay_sched(_anjay_sched_get(anjay), &fw->resume_download_job,
+                        avs_time_duration_from_scalar(
+                                ASYNC_WRITE_POLL_INTERVAL_MS, AVS_TIME_MS),
+                        resume_download_job, fw);
+}
+
+static void suspend_download(anjay_t *anjay,
+                             fw_repr_t *fw,
+                             size_t block_size) {
+    // wait until the writer has room for another block of the same size,
+    // instead of blocking the event loop in the next download_write_block()
+    fw->suspended_block_size = block_size;
+    if (anjay_download_suspend(anjay, fw->download_handle)) {
+        fw_log(WARNING, "could not suspend firmware download");
+    } else if (schedule_resume_download(anjay, fw)) {
+        fw_log(WARNING, "could not schedule firmware download resumption");
+        anjay_download_resume(anjay, fw->download_handle);
+    }
+}
+
+static bool etag_equal(const anjay_etag_t *left, const anjay_etag_t *right) {
+    if (!left || !right) {
+        return left == right;
+    }
+    return left->size == right->size
+            && memcmp(left->value, right->value, left->size) == 0;
+}
+
+static int set_etag(fw_repr_t *fw, const anjay_etag_t *etag) {
+    if (etag_equal(fw->etag, etag)) {
+        return 0;
+    }
+    anjay_etag_t *copy = NULL;
+    if (etag) {
+        size_t struct_size = offsetof(anjay_etag_t, value) + etag->size;
+        if (!(copy = (anjay_etag_t *) avs_malloc(struct_size))) {
+            fw_log(ERROR, "could not copy ETag");
+            return -1;
+        }
+        memcpy(copy, etag, struct_size);
+    }
+    avs_free(fw->etag);
+    fw->etag = copy;
+    return 0;
+}
+
 static int download_write_block(anjay_t *anjay,
                                 const uint8_t *data,
                                 size_t data_size,
                                 const anjay_etag_t *etag,
                                 void *fw_) {
-    (void) anjay;
-    (void) etag;
-
     fw_repr_t *fw = (fw_repr_t *) fw_;
     int result = user_state_ensure_stream_open(&fw->user_state,
                                                fw->package_uri, etag);
@@ -348,7 +427,18 @@ static int download_write_block(anjay_t *anjay,
                           UPDATE_RESULT_NOT_ENOUGH_SPACE);
         return -1;
     }
+    fw->bytes_downloaded += data_size;
+    if (set_etag(fw, etag)) {
+        // the download itself may go on, it just won't be resumable
+        avs_free(fw->etag);
+        fw->etag = NULL;
+    }
 
+    if (fw->user_state.writer
+            && _anjay_fw_async_writer_available(fw->user_state.writer)
+                    < data_size) {
+        suspend_download(anjay, fw, data_size);
+    }
     return 0;
 }
 
@@ -363,6 +453,10 @@ static void download_finished(anjay_t *anjay,
     (void) anjay;
 
     fw_repr_t *fw = (fw_repr_t *) fw_;
+    _anjay_sched_del(_anjay_sched_get(anjay), &fw->resume_download_job);
+    fw->download_handle = NULL;
+    avs_free(fw->etag);
+    fw->etag = NULL;
     if (fw->state != UPDATE_STATE_DOWNLOADING) {
         // something already failed in download_write_block()
         reset_user_state(fw);
@@ -425,7 +519,14 @@ static int schedule_background_anjay_download(anjay_t *anjay,
         }
     }
 
-    anjay_download_handle_t handle = anjay_download(anjay, &cfg);
+    anjay_download_handle_t handle = NULL;
+    if (set_etag(fw, etag)) {
+        errno = ENOMEM;
+    } else {
+        // fw->etag is passed, as etag may be the one being replaced
+        cfg.etag = fw->etag;
+        handle = anjay_download(anjay, &cfg);
+    }
     if (!handle) {
         fw_update_result_t update_result;
         if (errno == EADDRNOTAVAIL || errno == EINVAL) {
@@ -437,17 +538,44 @@ static int schedule_background_anjay_download(anjay_t *anjay,
         } else {
             update_result = UPDATE_RESULT_CONNECTION_LOST;
         }
+        avs_free(fw->etag);
+        fw->etag = NULL;
         reset_user_state(fw);
         set_update_result(anjay, fw, update_result);
         return -1;
     }
 
+    fw->download_handle = handle;
+    fw->bytes_downloaded = start_offset;
     fw->retry_download_on_expired = (etag != NULL);
     set_update_result(anjay, fw, UPDATE_RESULT_INITIAL);
     set_state(anjay, fw, UPDATE_STATE_DOWNLOADING);
     fw_log(INFO, "download started: %s", fw->package_uri);
     return 0;
 }
+
+int _anjay_fw_resume_download(anjay_t *anjay,
+                              fw_repr_t *fw,
+                              size_t resume_offset,
+                              const anjay_etag_t *etag) {
+    if (resume_offset > 0 && !etag) {
+        fw_log(WARNING, "ETag not set, need to start from the beginning");
+        reset_user_state(fw);
+        resume_offset = 0;
+    }
+    if (!schedule_background_anjay_download(anjay, fw, resume_offset, etag)) {
+        return 0;
+    }
+    fw_log(WARNING, "Could not resume firmware download");
+    reset_user_state(fw);
+    if (fw->result == UPDATE_RESULT_CONNECTION_LOST && etag) {
+        if (!schedule_background_anjay_download(anjay, fw, 0, NULL)) {
+            return 0;
+        }
+        fw_log(WARNING, "Could not retry firmware download");
+    }
+    return -1;
+}
 #endif // WITH_DOWNLOADER
 
 static int write_firmware_to_stream(anjay_t *anjay,
@@ -705,6 +833,9 @@ static void fw_delete(anjay_t *anjay, void *fw_) {
     (void) anjay;
     fw_repr_t *fw = (fw_repr_t *) fw_;
     _anjay_sched_del(_anjay_sched_get(anjay), &fw->update_job);
+    _anjay_sched_del(_anjay_sched_get(anjay), &fw->resume_download_job);
+    _anjay_fw_async_writer_delete(&fw->user_state.writer);
+    avs_free(fw->etag);
     avs_free(fw->security_from_dm);
     avs_free((void *) (intptr_t) fw->package_uri);
     avs_free(fw);
@@ -712,7 +843,10 @@ static void fw_delete(anjay_t *anjay, void *fw_) {
 
 static const anjay_dm_module_t FIRMWARE_UPDATE_MODULE = {
     .notify_callback = fw_on_notify,
-    .deleter = fw_delete
+    .deleter = fw_delete,
+    .snapshot_name = "fw_update",
+    .persist = anjay_fw_update_persist,
+    .restore = anjay_fw_update_restore
 };
 
 static int
@@ -735,9 +869,12 @@ initialize_fw_repr(anjay_t *anjay,
     case ANJAY_FW_UPDATE_INITIAL_DOWNLOADING: {
 #ifdef WITH_DOWNLOADER
         repr->user_state.state = UPDATE_STATE_DOWNLOADING;
+        _anjay_fw_user_state_reset_delta(&repr->user_state);
         size_t resume_offset = initial_state->resume_offset;
-        if (resume_offset > 0 && !initial_state->resume_etag) {
-            fw_log(WARNING, "ETag not set, need to start from the beginning");
+        if (resume_offset > 0
+                && repr->user_state.handlers->read_current_image) {
+            fw_log(WARNING, "state of delta patching is not known, need to "
+                            "start from the beginning");
             reset_user_state(repr);
             resume_offset = 0;
         }
@@ -747,16 +884,9 @@ initialize_fw_repr(anjay_t *anjay,
             fw_log(WARNING, "Could not copy the persisted Package URI, "
                             "not resuming firmware download");
             reset_user_state(repr);
-        } else if (schedule_background_anjay_download(
-                anjay, repr, resume_offset, initial_state->resume_etag)) {
-            fw_log(WARNING, "Could not resume firmware download");
-            reset_user_state(repr);
-            if (repr->result == UPDATE_RESULT_CONNECTION_LOST
-                    && initial_state->resume_etag
-                    && schedule_background_anjay_download(anjay, repr,
-                                                          0, NULL)) {
-                fw_log(WARNING, "Could not retry firmware download");
-            }
+        } else {
+            _anjay_fw_resume_download(anjay, repr, resume_offset,
+                                      initial_state->resume_etag);
         }
 #else // WITH_DOWNLOADER
         fw_log(WARNING,
@@ -809,3 +939,33 @@ anjay_fw_update_install(anjay_t *anjay,
 
     return 0;
 }
+
+fw_repr_t *_anjay_fw_get(anjay_t *anjay) {
+    return (fw_repr_t *) _anjay_dm_module_get_arg(anjay,
+                                                  &FIRMWARE_UPDATE_MODULE);
+}
+
+anjay_fw_update_async_writer_t *anjay_fw_update_async_write_enable(
+        anjay_t *anjay,
+        const anjay_fw_update_async_write_config_t *config) {
+    fw_repr_t *fw = _anjay_fw_get(anjay);
+    if (!fw) {
+        fw_log(ERROR, "Firmware Update object not installed");
+        return NULL;
+    }
+    if (!config || !config->buffer_count || !config->buffer_size
+            || config->buffer_size > SIZE_MAX / config->buffer_count) {
+        fw_log(ERROR, "invalid asynchronous write configuration");
+        return NULL;
+    }
+    if (fw->user_state.writer) {
+        fw_log(ERROR, "asynchronous write already enabled");
+        return NULL;
+    }
+    if (!(fw->user_state.writer = _anjay_fw_async_writer_new(
+                  fw->user_state.handlers, fw->user_state.arg,
+                  config->buffer_count, config->buffer_size))) {
+        fw_log(ERROR, "Out of memory");
+    }
+    return fw->user_state.writer;
+}
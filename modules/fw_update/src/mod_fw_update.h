@@ -0,0 +1,108 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FW_MOD_FW_UPDATE_H
+#define FW_MOD_FW_UPDATE_H
+#include <anjay_config.h>
+
+#include <anjay/download.h>
+#include <anjay/fw_update.h>
+
+#include <anjay_modules/sched.h>
+
+#include "fw_delta.h"
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+typedef enum {
+    UPDATE_STATE_IDLE = 0,
+    UPDATE_STATE_DOWNLOADING,
+    UPDATE_STATE_DOWNLOADED,
+    UPDATE_STATE_UPDATING
+} fw_update_state_t;
+
+typedef enum {
+    UPDATE_RESULT_INITIAL = 0,
+    UPDATE_RESULT_SUCCESS = 1,
+    UPDATE_RESULT_NOT_ENOUGH_SPACE = 2,
+    UPDATE_RESULT_OUT_OF_MEMORY = 3,
+    UPDATE_RESULT_CONNECTION_LOST = 4,
+    UPDATE_RESULT_INTEGRITY_FAILURE = 5,
+    UPDATE_RESULT_UNSUPPORTED_PACKAGE_TYPE = 6,
+    UPDATE_RESULT_INVALID_URI = 7,
+    UPDATE_RESULT_FAILED = 8,
+    UPDATE_RESULT_UNSUPPORTED_PROTOCOL = 9
+} fw_update_result_t;
+
+typedef struct {
+    const anjay_fw_update_handlers_t *handlers;
+    void *arg;
+    fw_update_state_t state;
+    anjay_fw_update_async_writer_t *writer;
+    fw_delta_decoder_t delta;
+} fw_user_state_t;
+
+typedef struct fw_repr {
+    const anjay_dm_object_def_t *def;
+
+    fw_user_state_t user_state;
+    avs_net_security_info_t *security_from_dm;
+
+    fw_update_state_t state;
+    fw_update_result_t result;
+    const char *package_uri;
+    bool retry_download_on_expired;
+    anjay_sched_handle_t update_job;
+
+    anjay_download_handle_t download_handle;
+    /** Size of the block after which the download was suspended. */
+    size_t suspended_block_size;
+    anjay_sched_handle_t resume_download_job;
+
+    /** Offset in the package up to which data has been received. */
+    size_t bytes_downloaded;
+    /** ETag of the package being downloaded, or NULL if unknown. */
+    anjay_etag_t *etag;
+} fw_repr_t;
+
+/**
+ * @returns Firmware Update object state, or NULL if the object is not
+ *          installed.
+ */
+fw_repr_t *_anjay_fw_get(anjay_t *anjay);
+
+/**
+ * Prepares the delta decoder for a new package, as done when the download
+ * stream is opened.
+ */
+void _anjay_fw_user_state_reset_delta(fw_user_state_t *user);
+
+/**
+ * Continues downloading <c>fw->package_uri</c>, starting at @p resume_offset .
+ * If it is not 0, the download stream shall already be open. If resumption is
+ * not possible, the stream is reset and the download is restarted from the
+ * beginning.
+ *
+ * @returns 0 if the download has been scheduled, negative value otherwise.
+ */
+int _anjay_fw_resume_download(anjay_t *anjay,
+                              fw_repr_t *fw,
+                              size_t resume_offset,
+                              const anjay_etag_t *etag);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* FW_MOD_FW_UPDATE_H */
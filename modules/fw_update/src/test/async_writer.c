@@ -0,0 +1,98 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/unit/test.h>
+
+typedef struct {
+    char data[64];
+    size_t size;
+    size_t calls;
+    size_t fail_at_call; // 1-based; 0 means never
+} test_sink_t;
+
+static int test_stream_write(void *sink_, const void *data, size_t length) {
+    test_sink_t *sink = (test_sink_t *) sink_;
+    if (++sink->calls == sink->fail_at_call) {
+        return ANJAY_FW_UPDATE_ERR_NOT_ENOUGH_SPACE;
+    }
+    AVS_UNIT_ASSERT_TRUE(sink->size + length <= sizeof(sink->data));
+    memcpy(&sink->data[sink->size], data, length);
+    sink->size += length;
+    return 0;
+}
+
+static const anjay_fw_update_handlers_t TEST_HANDLERS = {
+    .stream_write = test_stream_write
+};
+
+AVS_UNIT_TEST(fw_async_writer, inline_without_worker) {
+    test_sink_t sink = { .size = 0 };
+    anjay_fw_update_async_writer_t *writer =
+            _anjay_fw_async_writer_new(&TEST_HANDLERS, &sink, 2, 4);
+    AVS_UNIT_ASSERT_NOT_NULL(writer);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_fw_async_writer_available(writer), 8);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_fw_async_writer_write(writer, "abcde", 5));
+    AVS_UNIT_ASSERT_EQUAL(sink.calls, 0);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_fw_async_writer_available(writer), 3);
+
+    // ring is full, so the oldest buffer is written from the calling thread
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_fw_async_writer_write(writer, "fghij", 5));
+    AVS_UNIT_ASSERT_EQUAL(sink.calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(sink.size, 4);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_fw_async_writer_flush(writer));
+    AVS_UNIT_ASSERT_EQUAL(sink.calls, 3);
+    AVS_UNIT_ASSERT_EQUAL(sink.size, 10);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(sink.data, "abcdefghij", 10);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_fw_async_writer_available(writer), 8);
+
+    _anjay_fw_async_writer_delete(&writer);
+    AVS_UNIT_ASSERT_NULL(writer);
+}
+
+AVS_UNIT_TEST(fw_async_writer, error_is_sticky_until_flush) {
+    test_sink_t sink = {
+        .fail_at_call = 1
+    };
+    anjay_fw_update_async_writer_t *writer =
+            _anjay_fw_async_writer_new(&TEST_HANDLERS, &sink, 2, 4);
+    AVS_UNIT_ASSERT_NOT_NULL(writer);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_fw_async_writer_write(writer, "abcdefgh", 8));
+    AVS_UNIT_ASSERT_EQUAL(_anjay_fw_async_writer_write(writer, "i", 1),
+                          ANJAY_FW_UPDATE_ERR_NOT_ENOUGH_SPACE);
+    AVS_UNIT_ASSERT_TRUE(_anjay_fw_async_writer_failed(writer));
+    AVS_UNIT_ASSERT_EQUAL(_anjay_fw_async_writer_available(writer), 0);
+
+    // queued data is dropped and no more writes are attempted
+    AVS_UNIT_ASSERT_EQUAL(_anjay_fw_async_writer_write(writer, "j", 1),
+                          ANJAY_FW_UPDATE_ERR_NOT_ENOUGH_SPACE);
+    AVS_UNIT_ASSERT_EQUAL(sink.calls, 1);
+
+    AVS_UNIT_ASSERT_EQUAL(_anjay_fw_async_writer_flush(writer),
+                          ANJAY_FW_UPDATE_ERR_NOT_ENOUGH_SPACE);
+    AVS_UNIT_ASSERT_FALSE(_anjay_fw_async_writer_failed(writer));
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_fw_async_writer_write(writer, "xyz", 3));
+    _anjay_fw_async_writer_discard(writer);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_fw_async_writer_available(writer), 8);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_fw_async_writer_flush(writer));
+    AVS_UNIT_ASSERT_EQUAL(sink.calls, 1);
+
+    _anjay_fw_async_writer_delete(&writer);
+}
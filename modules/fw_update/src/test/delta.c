@@ -0,0 +1,189 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/unit/test.h>
+
+#define OLD_SIZE 256
+#define NEW_SIZE 170
+
+typedef struct {
+    uint8_t old_image[OLD_SIZE];
+    uint8_t new_image[NEW_SIZE];
+    uint8_t patch[512];
+    size_t patch_size;
+
+    uint8_t out[512];
+    size_t out_size;
+    bool fail_reads;
+} delta_test_env_t;
+
+static void put_offtin(delta_test_env_t *env, int64_t value) {
+    uint64_t magnitude = (uint64_t) (value < 0 ? -value : value);
+    for (size_t i = 0; i < FW_DELTA_INT_SIZE; ++i) {
+        env->patch[env->patch_size++] = (uint8_t) (magnitude >> (8 * i));
+    }
+    if (value < 0) {
+        env->patch[env->patch_size - 1] |= 0x80;
+    }
+}
+
+static void put_entry(delta_test_env_t *env,
+                      size_t *new_pos,
+                      size_t *old_pos,
+                      size_t diff,
+                      size_t extra,
+                      int64_t seek) {
+    put_offtin(env, (int64_t) diff);
+    put_offtin(env, (int64_t) extra);
+    put_offtin(env, seek);
+    for (size_t i = 0; i < diff; ++i) {
+        env->patch[env->patch_size++] =
+                (uint8_t) (env->new_image[*new_pos + i]
+                           - env->old_image[*old_pos + i]);
+    }
+    memcpy(&env->patch[env->patch_size], &env->new_image[*new_pos + diff],
+           extra);
+    env->patch_size += extra;
+    *new_pos += diff + extra;
+    *old_pos = (size_t) ((int64_t) (*old_pos + diff) + seek);
+}
+
+/**
+ * Generates a pair of images and a patch that turns one into the other,
+ * exercising empty entries, negative seeks and diff-only entries.
+ */
+static void generate_delta(delta_test_env_t *env) {
+    memset(env, 0, sizeof(*env));
+    for (size_t i = 0; i < OLD_SIZE; ++i) {
+        env->old_image[i] = (uint8_t) (i * 3);
+    }
+    memcpy(env->new_image, &env->old_image[10], 100);
+    env->new_image[5] ^= 0x5a;
+    env->new_image[99] = 0;
+    memcpy(&env->new_image[100], "extra bytes inserted", 20);
+    memcpy(&env->new_image[120], &env->old_image[10], 50);
+    env->new_image[150] = 0xff;
+
+    memcpy(env->patch, FW_DELTA_MAGIC, FW_DELTA_MAGIC_SIZE);
+    env->patch_size = FW_DELTA_MAGIC_SIZE;
+    put_offtin(env, NEW_SIZE);
+
+    size_t new_pos = 0;
+    size_t old_pos = 0;
+    put_entry(env, &new_pos, &old_pos, 0, 0, 10);
+    put_entry(env, &new_pos, &old_pos, 100, 20, -100);
+    put_entry(env, &new_pos, &old_pos, 50, 0, 0);
+    AVS_UNIT_ASSERT_EQUAL(new_pos, NEW_SIZE);
+}
+
+static int test_read_old(void *env_, size_t offset, void *buffer,
+                         size_t length) {
+    delta_test_env_t *env = (delta_test_env_t *) env_;
+    if (env->fail_reads || offset + length > OLD_SIZE) {
+        return -1;
+    }
+    memcpy(buffer, &env->old_image[offset], length);
+    return 0;
+}
+
+static int test_write_new(void *env_, const void *data, size_t length) {
+    delta_test_env_t *env = (delta_test_env_t *) env_;
+    AVS_UNIT_ASSERT_TRUE(env->out_size + length <= sizeof(env->out));
+    memcpy(&env->out[env->out_size], data, length);
+    env->out_size += length;
+    return 0;
+}
+
+static int feed(fw_delta_decoder_t *dec,
+                const uint8_t *data,
+                size_t length,
+                size_t chunk_size) {
+    for (size_t offset = 0; offset < length; offset += chunk_size) {
+        int result = _anjay_fw_delta_write(
+                dec, &data[offset], AVS_MIN(chunk_size, length - offset));
+        if (result) {
+            return result;
+        }
+    }
+    return 0;
+}
+
+AVS_UNIT_TEST(fw_delta, apply_in_chunks) {
+    static const size_t CHUNK_SIZES[] = { 1, 7, 24, 300, 512 };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(CHUNK_SIZES); ++i) {
+        delta_test_env_t env;
+        generate_delta(&env);
+        fw_delta_decoder_t dec;
+        _anjay_fw_delta_init(&dec, test_read_old, test_write_new, &env);
+        AVS_UNIT_ASSERT_SUCCESS(
+                feed(&dec, env.patch, env.patch_size, CHUNK_SIZES[i]));
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_fw_delta_finish(&dec));
+        AVS_UNIT_ASSERT_EQUAL(env.out_size, NEW_SIZE);
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.out, env.new_image, NEW_SIZE);
+    }
+}
+
+AVS_UNIT_TEST(fw_delta, full_image_passed_through) {
+    static const char IMAGE[] = "ENDSLEY/not a delta package";
+    static const char SHORT_IMAGE[] = "ENDS";
+    delta_test_env_t env;
+    generate_delta(&env);
+    fw_delta_decoder_t dec;
+
+    _anjay_fw_delta_init(&dec, test_read_old, test_write_new, &env);
+    AVS_UNIT_ASSERT_SUCCESS(feed(&dec, (const uint8_t *) IMAGE,
+                                 sizeof(IMAGE) - 1, 3));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_fw_delta_finish(&dec));
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, sizeof(IMAGE) - 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.out, IMAGE, sizeof(IMAGE) - 1);
+
+    env.out_size = 0;
+    _anjay_fw_delta_init(&dec, test_read_old, test_write_new, &env);
+    AVS_UNIT_ASSERT_SUCCESS(feed(&dec, (const uint8_t *) SHORT_IMAGE,
+                                 sizeof(SHORT_IMAGE) - 1, 1));
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, 0);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_fw_delta_finish(&dec));
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, sizeof(SHORT_IMAGE) - 1);
+
+    // without read-back support, delta packages are not recognized either
+    env.out_size = 0;
+    _anjay_fw_delta_init(&dec, NULL, test_write_new, &env);
+    AVS_UNIT_ASSERT_SUCCESS(feed(&dec, env.patch, env.patch_size, 64));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_fw_delta_finish(&dec));
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, env.patch_size);
+}
+
+AVS_UNIT_TEST(fw_delta, errors) {
+    delta_test_env_t env;
+    generate_delta(&env);
+    fw_delta_decoder_t dec;
+
+    _anjay_fw_delta_init(&dec, test_read_old, test_write_new, &env);
+    AVS_UNIT_ASSERT_SUCCESS(feed(&dec, env.patch, env.patch_size - 1, 16));
+    AVS_UNIT_ASSERT_EQUAL(_anjay_fw_delta_finish(&dec),
+                          ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE);
+
+    _anjay_fw_delta_init(&dec, test_read_old, test_write_new, &env);
+    AVS_UNIT_ASSERT_SUCCESS(feed(&dec, env.patch, env.patch_size, 16));
+    AVS_UNIT_ASSERT_EQUAL(_anjay_fw_delta_write(&dec, "x", 1),
+                          ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE);
+
+    env.fail_reads = true;
+    _anjay_fw_delta_init(&dec, test_read_old, test_write_new, &env);
+    AVS_UNIT_ASSERT_EQUAL(feed(&dec, env.patch, env.patch_size, 16), -1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_fw_delta_finish(&dec),
+                          ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE);
+}
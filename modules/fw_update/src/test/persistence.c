@@ -0,0 +1,251 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/stream.h>
+#include <avsystem/commons/stream/stream_membuf.h>
+#include <avsystem/commons/unit/test.h>
+
+#include <anjay_test/utils.h>
+
+static const anjay_configuration_t CONFIG = {
+    .endpoint_name = "test"
+};
+
+static int dummy_stream_open(void *user_ptr,
+                             const char *package_uri,
+                             const struct anjay_etag *package_etag) {
+    (void) user_ptr; (void) package_uri; (void) package_etag;
+    return 0;
+}
+
+static int dummy_stream_write(void *user_ptr, const void *data, size_t length) {
+    (void) user_ptr; (void) data; (void) length;
+    return 0;
+}
+
+static int dummy_stream_finish(void *user_ptr) {
+    (void) user_ptr;
+    return 0;
+}
+
+static void dummy_reset(void *user_ptr) {
+    (void) user_ptr;
+}
+
+static int dummy_perform_upgrade(void *user_ptr) {
+    (void) user_ptr;
+    return 0;
+}
+
+static const anjay_fw_update_handlers_t HANDLERS = {
+    .stream_open = dummy_stream_open,
+    .stream_write = dummy_stream_write,
+    .stream_finish = dummy_stream_finish,
+    .reset = dummy_reset,
+    .perform_upgrade = dummy_perform_upgrade
+};
+
+typedef struct {
+    anjay_t *anjay_stored;
+    anjay_t *anjay_restored;
+    fw_repr_t *stored;
+    fw_repr_t *restored;
+    avs_stream_abstract_t *stream;
+} fw_persistence_test_env_t;
+
+#define SCOPED_FW_PERSISTENCE_TEST_ENV(Name)                                  \
+    SCOPED_PTR(fw_persistence_test_env_t, fw_persistence_test_env_destroy) \
+    Name = fw_persistence_test_env_create();
+
+static fw_persistence_test_env_t *fw_persistence_test_env_create(void) {
+    fw_persistence_test_env_t *env =
+            (__typeof__(env)) avs_calloc(1, sizeof(*env));
+    AVS_UNIT_ASSERT_NOT_NULL(env);
+    env->anjay_stored = anjay_new(&CONFIG);
+    AVS_UNIT_ASSERT_NOT_NULL(env->anjay_stored);
+    env->anjay_restored = anjay_new(&CONFIG);
+    AVS_UNIT_ASSERT_NOT_NULL(env->anjay_restored);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_fw_update_install(env->anjay_stored,
+                                                    &HANDLERS, NULL, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_fw_update_install(env->anjay_restored,
+                                                    &HANDLERS, NULL, NULL));
+    env->stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(env->stream);
+    env->stored = _anjay_fw_get(env->anjay_stored);
+    AVS_UNIT_ASSERT_NOT_NULL(env->stored);
+    env->restored = _anjay_fw_get(env->anjay_restored);
+    AVS_UNIT_ASSERT_NOT_NULL(env->restored);
+    return env;
+}
+
+static void fw_persistence_test_env_destroy(fw_persistence_test_env_t **env) {
+    anjay_delete((*env)->anjay_stored);
+    anjay_delete((*env)->anjay_restored);
+    avs_stream_cleanup(&(*env)->stream);
+    avs_free(*env);
+}
+
+AVS_UNIT_TEST(fw_persistence, idle_store_restore) {
+    SCOPED_FW_PERSISTENCE_TEST_ENV(env);
+    env->stored->result = UPDATE_RESULT_INTEGRITY_FAILURE;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_fw_update_persist(env->anjay_stored, env->stream));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_fw_update_restore(env->anjay_restored, env->stream));
+    AVS_UNIT_ASSERT_EQUAL(env->restored->state, UPDATE_STATE_IDLE);
+    AVS_UNIT_ASSERT_EQUAL(env->restored->result,
+                          UPDATE_RESULT_INTEGRITY_FAILURE);
+    AVS_UNIT_ASSERT_NULL(env->restored->package_uri);
+}
+
+AVS_UNIT_TEST(fw_persistence, downloaded_store_restore) {
+    SCOPED_FW_PERSISTENCE_TEST_ENV(env);
+    env->stored->state = UPDATE_STATE_UPDATING;
+    env->stored->user_state.state = UPDATE_STATE_UPDATING;
+    env->stored->package_uri = avs_strdup("coap://127.0.0.1:5683/fw");
+    AVS_UNIT_ASSERT_NOT_NULL(env->stored->package_uri);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_fw_update_persist(env->anjay_stored, env->stream));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_fw_update_restore(env->anjay_restored, env->stream));
+    AVS_UNIT_ASSERT_EQUAL(env->restored->state, UPDATE_STATE_DOWNLOADED);
+    AVS_UNIT_ASSERT_EQUAL(env->restored->user_state.state,
+                          UPDATE_STATE_DOWNLOADED);
+    AVS_UNIT_ASSERT_EQUAL(env->restored->result, UPDATE_RESULT_INITIAL);
+    AVS_UNIT_ASSERT_EQUAL_STRING(env->restored->package_uri,
+                                 "coap://127.0.0.1:5683/fw");
+}
+
+AVS_UNIT_TEST(fw_persistence, restore_requires_idle) {
+    SCOPED_FW_PERSISTENCE_TEST_ENV(env);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_fw_update_persist(env->anjay_stored, env->stream));
+    env->restored->state = UPDATE_STATE_DOWNLOADED;
+    env->restored->user_state.state = UPDATE_STATE_DOWNLOADED;
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_fw_update_restore(env->anjay_restored, env->stream));
+    AVS_UNIT_ASSERT_EQUAL(env->restored->state, UPDATE_STATE_DOWNLOADED);
+}
+
+AVS_UNIT_TEST(fw_persistence, invalid_magic) {
+    SCOPED_FW_PERSISTENCE_TEST_ENV(env);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(env->stream, "SRV\0", 4));
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_fw_update_restore(env->anjay_restored, env->stream));
+}
+
+AVS_UNIT_TEST(fw_persistence, downloading_fields) {
+    avs_stream_abstract_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+
+    persisted_fw_t stored;
+    memset(&stored, 0, sizeof(stored));
+    stored.state = UPDATE_STATE_DOWNLOADING;
+    stored.package_uri = (char *) (intptr_t) "http://127.0.0.1/fw.bin";
+    stored.offset = UINT64_C(0x123456789);
+    stored.has_etag = true;
+    stored.etag_size = 3;
+    memcpy(stored.etag, "tag", 3);
+    stored.delta.state = FW_DELTA_DIFF;
+    stored.delta.header_size = 5;
+    memcpy(stored.delta.header, "abcde", 5);
+    stored.delta.new_size = 1000;
+    stored.delta.new_pos = 400;
+    stored.delta.old_pos = -17;
+    stored.delta.diff_left = 20;
+    stored.delta.extra_left = 30;
+    stored.delta.seek = -40;
+
+    avs_persistence_context_t *ctx = avs_persistence_store_context_new(stream);
+    AVS_UNIT_ASSERT_NOT_NULL(ctx);
+    AVS_UNIT_ASSERT_SUCCESS(handle_fw(ctx, &stored));
+    avs_persistence_context_delete(ctx);
+
+    persisted_fw_t restored;
+    memset(&restored, 0, sizeof(restored));
+    ctx = avs_persistence_restore_context_new(stream);
+    AVS_UNIT_ASSERT_NOT_NULL(ctx);
+    AVS_UNIT_ASSERT_SUCCESS(handle_fw(ctx, &restored));
+    avs_persistence_context_delete(ctx);
+    AVS_UNIT_ASSERT_SUCCESS(validate_persisted_fw(&restored));
+
+    AVS_UNIT_ASSERT_EQUAL(restored.state, UPDATE_STATE_DOWNLOADING);
+    AVS_UNIT_ASSERT_EQUAL_STRING(restored.package_uri, stored.package_uri);
+    AVS_UNIT_ASSERT_EQUAL(restored.offset, stored.offset);
+    AVS_UNIT_ASSERT_TRUE(restored.has_etag);
+    AVS_UNIT_ASSERT_EQUAL(restored.etag_size, 3);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(restored.etag, "tag", 3);
+    AVS_UNIT_ASSERT_EQUAL(restored.delta.state, FW_DELTA_DIFF);
+    AVS_UNIT_ASSERT_EQUAL(restored.delta.header_size, 5);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(restored.delta.header, "abcde", 5);
+    AVS_UNIT_ASSERT_EQUAL(restored.delta.new_size, 1000);
+    AVS_UNIT_ASSERT_EQUAL(restored.delta.new_pos, 400);
+    AVS_UNIT_ASSERT_EQUAL(restored.delta.old_pos, -17);
+    AVS_UNIT_ASSERT_EQUAL(restored.delta.diff_left, 20);
+    AVS_UNIT_ASSERT_EQUAL(restored.delta.extra_left, 30);
+    AVS_UNIT_ASSERT_EQUAL(restored.delta.seek, -40);
+
+    avs_free(restored.package_uri);
+    avs_stream_cleanup(&stream);
+}
+
+static void set_partial_download(fw_repr_t *fw, fw_delta_state_t delta_state) {
+    fw->state = UPDATE_STATE_DOWNLOADING;
+    fw->package_uri = avs_strdup("coap://127.0.0.1:5683/fw");
+    AVS_UNIT_ASSERT_NOT_NULL(fw->package_uri);
+    fw->bytes_downloaded = 1024;
+    fw->etag = (anjay_etag_t *) avs_malloc(offsetof(anjay_etag_t, value) + 3);
+    AVS_UNIT_ASSERT_NOT_NULL(fw->etag);
+    fw->etag->size = 3;
+    memcpy(fw->etag->value, "tag", 3);
+    fw->user_state.delta.state = delta_state;
+}
+
+#if defined(WITH_DOWNLOADER) && defined(WITH_BLOCK_DOWNLOAD)
+AVS_UNIT_TEST(fw_persistence, partial_download_resumed) {
+    SCOPED_FW_PERSISTENCE_TEST_ENV(env);
+    set_partial_download(env->stored, FW_DELTA_RAW);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_fw_update_persist(env->anjay_stored, env->stream));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_fw_update_restore(env->anjay_restored, env->stream));
+
+    AVS_UNIT_ASSERT_NOT_NULL(env->restored->download_handle);
+    AVS_UNIT_ASSERT_EQUAL(env->restored->state, UPDATE_STATE_DOWNLOADING);
+    AVS_UNIT_ASSERT_EQUAL(env->restored->user_state.state,
+                          UPDATE_STATE_DOWNLOADING);
+    AVS_UNIT_ASSERT_EQUAL(env->restored->user_state.delta.state, FW_DELTA_RAW);
+    AVS_UNIT_ASSERT_EQUAL_STRING(env->restored->package_uri,
+                                 "coap://127.0.0.1:5683/fw");
+    AVS_UNIT_ASSERT_EQUAL(env->restored->bytes_downloaded, 1024);
+    AVS_UNIT_ASSERT_NOT_NULL(env->restored->etag);
+    AVS_UNIT_ASSERT_EQUAL(env->restored->etag->size, 3);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(env->restored->etag->value, "tag", 3);
+    AVS_UNIT_ASSERT_TRUE(env->restored->retry_download_on_expired);
+}
+#endif // defined(WITH_DOWNLOADER) && defined(WITH_BLOCK_DOWNLOAD)
+
+AVS_UNIT_TEST(fw_persistence, failed_delta_rejected) {
+    SCOPED_FW_PERSISTENCE_TEST_ENV(env);
+    set_partial_download(env->stored, FW_DELTA_ERROR);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_fw_update_persist(env->anjay_stored, env->stream));
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_fw_update_restore(env->anjay_restored, env->stream));
+    AVS_UNIT_ASSERT_EQUAL(env->restored->state, UPDATE_STATE_IDLE);
+    AVS_UNIT_ASSERT_NULL(env->restored->download_handle);
+    AVS_UNIT_ASSERT_NULL(env->restored->package_uri);
+}
@@ -24,6 +24,7 @@
 
 #include <anjay_modules/io_utils.h>
 #include <anjay_modules/dm_utils.h>
+#include <anjay_modules/servers.h>
 
 #include "mod_security.h"
 #include "security_transaction.h"
@@ -149,6 +150,9 @@ static int add_instance(sec_repr_t *repr,
         new_instance->has_ssid = true;
     }
 
+    if (_anjay_sec_transaction_touch(repr, new_instance->iid)) {
+        goto error;
+    }
     AVS_LIST(sec_instance_t) *ptr;
     AVS_LIST_FOREACH_PTR(ptr, &repr->instances) {
         if ((*ptr)->iid > new_instance->iid) {
@@ -177,8 +181,9 @@ static int del_instance(sec_repr_t *repr, anjay_iid_t iid) {
     AVS_LIST(sec_instance_t) *it;
     AVS_LIST_FOREACH_PTR(it, &repr->instances) {
         if ((*it)->iid == iid) {
-            AVS_LIST(sec_instance_t) element = AVS_LIST_DETACH(it);
-            _anjay_sec_destroy_instances(&element);
+            if (_anjay_sec_transaction_remove(repr, it)) {
+                return ANJAY_ERR_INTERNAL;
+            }
             mark_modified(repr);
             return 0;
         }
@@ -286,6 +291,9 @@ static int sec_write(anjay_t *anjay,
     sec_instance_t *inst = find_instance(repr, iid);
     int retval;
     assert(inst);
+    if (_anjay_sec_transaction_touch(repr, iid)) {
+        return ANJAY_ERR_INTERNAL;
+    }
 
     mark_modified(repr);
 
@@ -382,6 +390,10 @@ static int sec_instance_create(anjay_t *anjay,
     if (!created) {
         return ANJAY_ERR_INTERNAL;
     }
+    if (_anjay_sec_transaction_touch(repr, *inout_iid)) {
+        AVS_LIST_CLEAR(&created);
+        return ANJAY_ERR_INTERNAL;
+    }
 
     created->iid = *inout_iid;
     created->ssid = *inout_iid;
@@ -438,12 +450,27 @@ sec_instance_reset(anjay_t *anjay,
                    const anjay_dm_object_def_t *const *obj_ptr,
                    anjay_iid_t iid) {
     (void) anjay;
-    sec_instance_t *inst = find_instance(_anjay_sec_get(obj_ptr), iid);
-    assert(inst);
+    sec_repr_t *repr = _anjay_sec_get(obj_ptr);
+    AVS_LIST(sec_instance_t) *inst_ptr;
+    AVS_LIST_FOREACH_PTR(inst_ptr, &repr->instances) {
+        if ((*inst_ptr)->iid >= iid) {
+            break;
+        }
+    }
+    assert(*inst_ptr && (*inst_ptr)->iid == iid);
 
-    _anjay_sec_destroy_instance_fields(inst);
-    memset(inst, 0, sizeof(sec_instance_t));
-    inst->iid = iid;
+    /* Replacing the whole element instead of clearing it in place allows the
+     * old one to be kept for a rollback without copying its key material */
+    AVS_LIST(sec_instance_t) reset = AVS_LIST_NEW_ELEMENT(sec_instance_t);
+    if (!reset) {
+        return ANJAY_ERR_INTERNAL;
+    }
+    reset->iid = iid;
+    if (_anjay_sec_transaction_remove(repr, inst_ptr)) {
+        AVS_LIST_CLEAR(&reset);
+        return ANJAY_ERR_INTERNAL;
+    }
+    AVS_LIST_INSERT(inst_ptr, reset);
     return 0;
 }
 
@@ -524,7 +551,7 @@ static void security_purge(sec_repr_t *repr) {
         mark_modified(repr);
     }
     _anjay_sec_destroy_instances(&repr->instances);
-    _anjay_sec_destroy_instances(&repr->saved_instances);
+    _anjay_sec_transaction_forget(repr);
 }
 
 static void security_delete(anjay_t *anjay, void *repr) {
@@ -541,6 +568,7 @@ void anjay_security_object_purge(anjay_t *anjay) {
     sec_repr_t *repr = _anjay_sec_get(sec_obj);
 
     security_purge(repr);
+    _anjay_servers_invalidate_security_cache(anjay, ANJAY_IID_INVALID);
 
     if (anjay_notify_instances_changed(anjay, SECURITY.oid)) {
         security_log(WARNING, "Could not schedule socket reload");
@@ -556,7 +584,10 @@ bool anjay_security_object_is_modified(anjay_t *anjay) {
 }
 
 static const anjay_dm_module_t SECURITY_MODULE = {
-    .deleter = security_delete
+    .deleter = security_delete,
+    .snapshot_name = "security",
+    .persist = anjay_security_object_persist,
+    .restore = anjay_security_object_restore
 };
 
 int anjay_security_object_install(anjay_t *anjay) {
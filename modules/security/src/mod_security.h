@@ -74,6 +74,17 @@ typedef struct {
 typedef struct {
     const anjay_dm_object_def_t *def;
     AVS_LIST(sec_instance_t) instances;
+    bool in_transaction;
+    /**
+     * IIDs of instances created, modified or removed during the current
+     * transaction, sorted.
+     */
+    AVS_LIST(anjay_iid_t) touched_iids;
+    /**
+     * Touched instances, as they were before the current transaction, sorted
+     * by IID. Touched IIDs without a saved instance refer to instances created
+     * within the transaction.
+     */
     AVS_LIST(sec_instance_t) saved_instances;
     bool modified_since_persist;
     bool saved_modified_since_persist;
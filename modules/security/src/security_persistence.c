@@ -21,6 +21,7 @@
 #endif // WITH_AVS_PERSISTENCE
 
 #include <anjay_modules/dm_utils.h>
+#include <anjay_modules/servers.h>
 
 #include <string.h>
 #include <inttypes.h>
@@ -189,10 +190,12 @@ int anjay_security_object_restore(anjay_t *anjay,
         repr->instances = backup.instances;
     } else {
         _anjay_sec_destroy_instances(&backup.instances);
+        _anjay_sec_transaction_forget(repr);
     }
     avs_persistence_context_delete(restore_ctx);
     if (!retval) {
         clear_modified(repr);
+        _anjay_servers_invalidate_security_cache(anjay, ANJAY_IID_INVALID);
         persistence_log(INFO, "Security Object state restored");
     }
     return retval;
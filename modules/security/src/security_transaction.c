@@ -162,17 +162,22 @@ finish:
 }
 
 int _anjay_sec_transaction_begin_impl(sec_repr_t *repr) {
+    assert(!repr->in_transaction);
+    assert(!repr->touched_iids);
     assert(!repr->saved_instances);
-    repr->saved_instances = _anjay_sec_clone_instances(repr);
-    if (!repr->saved_instances && repr->instances) {
-        return ANJAY_ERR_INTERNAL;
-    }
+    repr->in_transaction = true;
     repr->saved_modified_since_persist = repr->modified_since_persist;
     return 0;
 }
 
-int _anjay_sec_transaction_commit_impl(sec_repr_t *repr) {
+void _anjay_sec_transaction_forget(sec_repr_t *repr) {
+    AVS_LIST_CLEAR(&repr->touched_iids);
     _anjay_sec_destroy_instances(&repr->saved_instances);
+}
+
+int _anjay_sec_transaction_commit_impl(sec_repr_t *repr) {
+    _anjay_sec_transaction_forget(repr);
+    repr->in_transaction = false;
     return 0;
 }
 
@@ -181,9 +186,121 @@ int _anjay_sec_transaction_validate_impl(sec_repr_t *repr) {
 }
 
 int _anjay_sec_transaction_rollback_impl(sec_repr_t *repr) {
-    _anjay_sec_destroy_instances(&repr->instances);
-    repr->instances = repr->saved_instances;
-    repr->saved_instances = NULL;
+    /* both lists are sorted, so a single pass is enough to remove the current
+     * versions of all touched instances */
+    AVS_LIST(sec_instance_t) *it = &repr->instances;
+    AVS_LIST(anjay_iid_t) touched = repr->touched_iids;
+    while (*it && touched) {
+        if ((*it)->iid < *touched) {
+            AVS_LIST_ADVANCE_PTR(&it);
+        } else {
+            if ((*it)->iid == *touched) {
+                AVS_LIST(sec_instance_t) element = AVS_LIST_DETACH(it);
+                _anjay_sec_destroy_instances(&element);
+            }
+            AVS_LIST_ADVANCE(&touched);
+        }
+    }
+    /* now put the saved ones back in place */
+    it = &repr->instances;
+    while (repr->saved_instances) {
+        while (*it && (*it)->iid < repr->saved_instances->iid) {
+            AVS_LIST_ADVANCE_PTR(&it);
+        }
+        AVS_LIST_INSERT(it, AVS_LIST_DETACH(&repr->saved_instances));
+    }
+    AVS_LIST_CLEAR(&repr->touched_iids);
+    repr->in_transaction = false;
     repr->modified_since_persist = repr->saved_modified_since_persist;
     return 0;
 }
+
+/**
+ * @returns Pointer to the place in the list of touched IIDs at which @p iid is
+ *          or shall be inserted, or NULL if the change does not need to be
+ *          recorded at all.
+ */
+static AVS_LIST(anjay_iid_t) *find_touched_iid_ptr(sec_repr_t *repr,
+                                                   anjay_iid_t iid) {
+    if (!repr->in_transaction) {
+        return NULL;
+    }
+    AVS_LIST(anjay_iid_t) *touched_ptr;
+    AVS_LIST_FOREACH_PTR(touched_ptr, &repr->touched_iids) {
+        if (**touched_ptr == iid) {
+            return NULL;
+        } else if (**touched_ptr > iid) {
+            break;
+        }
+    }
+    return touched_ptr;
+}
+
+static AVS_LIST(anjay_iid_t) new_touched_iid(anjay_iid_t iid) {
+    AVS_LIST(anjay_iid_t) touched = AVS_LIST_NEW_ELEMENT(anjay_iid_t);
+    if (!touched) {
+        security_log(ERROR, "Out of memory");
+        return NULL;
+    }
+    *touched = iid;
+    return touched;
+}
+
+static void insert_saved_instance(sec_repr_t *repr,
+                                  AVS_LIST(sec_instance_t) instance) {
+    AVS_LIST(sec_instance_t) *saved_ptr;
+    AVS_LIST_FOREACH_PTR(saved_ptr, &repr->saved_instances) {
+        if ((*saved_ptr)->iid > instance->iid) {
+            break;
+        }
+    }
+    AVS_LIST_INSERT(saved_ptr, instance);
+}
+
+int _anjay_sec_transaction_touch(sec_repr_t *repr, anjay_iid_t iid) {
+    AVS_LIST(anjay_iid_t) *touched_ptr = find_touched_iid_ptr(repr, iid);
+    if (!touched_ptr) {
+        return 0;
+    }
+    AVS_LIST(anjay_iid_t) touched = new_touched_iid(iid);
+    if (!touched) {
+        return -1;
+    }
+    AVS_LIST(sec_instance_t) instance;
+    AVS_LIST_FOREACH(instance, repr->instances) {
+        if (instance->iid >= iid) {
+            break;
+        }
+    }
+    if (instance && instance->iid == iid) {
+        AVS_LIST(sec_instance_t) saved = AVS_LIST_NEW_ELEMENT(sec_instance_t);
+        if (!saved || _anjay_sec_clone_instance(saved, instance)) {
+            security_log(ERROR, "Cannot save Security Object Instance %u",
+                         (unsigned) iid);
+            _anjay_sec_destroy_instances(&saved);
+            AVS_LIST_CLEAR(&touched);
+            return -1;
+        }
+        insert_saved_instance(repr, saved);
+    }
+    AVS_LIST_INSERT(touched_ptr, touched);
+    return 0;
+}
+
+int _anjay_sec_transaction_remove(sec_repr_t *repr,
+                                  AVS_LIST(sec_instance_t) *instance_ptr) {
+    AVS_LIST(anjay_iid_t) *touched_ptr =
+            find_touched_iid_ptr(repr, (*instance_ptr)->iid);
+    AVS_LIST(anjay_iid_t) touched = NULL;
+    if (touched_ptr && !(touched = new_touched_iid((*instance_ptr)->iid))) {
+        return -1;
+    }
+    AVS_LIST(sec_instance_t) element = AVS_LIST_DETACH(instance_ptr);
+    if (touched) {
+        AVS_LIST_INSERT(touched_ptr, touched);
+        insert_saved_instance(repr, element);
+    } else {
+        _anjay_sec_destroy_instances(&element);
+    }
+    return 0;
+}
@@ -29,6 +29,29 @@ int _anjay_sec_transaction_commit_impl(sec_repr_t *repr);
 int _anjay_sec_transaction_validate_impl(sec_repr_t *repr);
 int _anjay_sec_transaction_rollback_impl(sec_repr_t *repr);
 
+/**
+ * Shall be called before creating or modifying the instance @p iid . During a
+ * transaction, saves a copy of the instance for a possible rollback, unless it
+ * has already been touched within that transaction. Does nothing outside of
+ * transactions.
+ */
+int _anjay_sec_transaction_touch(sec_repr_t *repr, anjay_iid_t iid);
+
+/**
+ * Detaches the instance pointed to by @p instance_ptr from its list. During a
+ * transaction, the instance is moved aside for a possible rollback (without
+ * copying its key material), unless it has already been touched within that
+ * transaction. Otherwise, it is destroyed.
+ */
+int _anjay_sec_transaction_remove(sec_repr_t *repr,
+                                  AVS_LIST(sec_instance_t) *instance_ptr);
+
+/**
+ * Forgets all changes recorded in the current transaction, so that they will
+ * not be undone by a rollback. Used when all instances are replaced at once.
+ */
+void _anjay_sec_transaction_forget(sec_repr_t *repr);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* SECURITY_TRANSACTION_H */
@@ -115,8 +115,7 @@ void _anjay_sec_destroy_instances(AVS_LIST(sec_instance_t) *instances_ptr) {
     }
 }
 
-static int _anjay_sec_clone_instance(sec_instance_t *dest,
-                                     const sec_instance_t *src) {
+int _anjay_sec_clone_instance(sec_instance_t *dest, const sec_instance_t *src) {
     *dest = *src;
     dest->public_cert_or_psk_identity = ANJAY_RAW_BUFFER_EMPTY;
     dest->private_cert_or_psk_key = ANJAY_RAW_BUFFER_EMPTY;
@@ -65,6 +65,13 @@ void _anjay_sec_destroy_instance_fields(sec_instance_t *instance);
  */
 void _anjay_sec_destroy_instances(AVS_LIST(sec_instance_t) *instances_ptr);
 
+/**
+ * Makes a deep copy of @p src into @p dest . In case of failure, @p dest may
+ * be partially filled and needs to be cleaned up using
+ * @ref _anjay_sec_destroy_instance_fields .
+ */
+int _anjay_sec_clone_instance(sec_instance_t *dest, const sec_instance_t *src);
+
 /**
  * Clones all instances of the given Security Object @p repr . Return NULL
  * if either there was nothing to clone or an error has occurred.
@@ -86,3 +86,58 @@ AVS_UNIT_TEST(security_object_api, add_instances_with_duplicated_ssids) {
     AVS_UNIT_ASSERT_FAILED(
             anjay_security_object_add_instance(env->anjay, &instance2, &iid));
 }
+
+AVS_UNIT_TEST(security_object_api, transaction_rollback) {
+    SCOPED_SERVER_TEST_ENV(env);
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_security_object_add_instance(env->anjay, &instance1, &iid));
+    iid = 2;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_security_object_add_instance(env->anjay, &instance2, &iid));
+
+    const anjay_dm_object_def_t *const *obj_ptr =
+            _anjay_dm_find_object_by_oid(env->anjay, ANJAY_DM_OID_SECURITY);
+    sec_repr_t *repr = _anjay_sec_get(obj_ptr);
+    AVS_LIST(sec_instance_t) first = repr->instances;
+    AVS_UNIT_ASSERT_SUCCESS(sec_transaction_begin(env->anjay, obj_ptr));
+    AVS_UNIT_ASSERT_NULL(repr->saved_instances);
+
+    AVS_UNIT_ASSERT_SUCCESS(sec_instance_reset(env->anjay, obj_ptr, 1));
+    // the original instance is moved aside, not copied
+    AVS_UNIT_ASSERT_TRUE(repr->saved_instances == first);
+    AVS_UNIT_ASSERT_SUCCESS(sec_instance_remove(env->anjay, obj_ptr, 1));
+    iid = 3;
+    AVS_UNIT_ASSERT_SUCCESS(sec_instance_create(env->anjay, obj_ptr, &iid, 1));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->touched_iids), 2);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->saved_instances), 1);
+
+    AVS_UNIT_ASSERT_SUCCESS(sec_transaction_rollback(env->anjay, obj_ptr));
+    AVS_UNIT_ASSERT_NULL(repr->touched_iids);
+    AVS_UNIT_ASSERT_NULL(repr->saved_instances);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->instances), 2);
+    AVS_UNIT_ASSERT_TRUE(repr->instances == first);
+    AVS_UNIT_ASSERT_EQUAL_STRING(repr->instances->server_uri,
+                                 instance1.server_uri);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_NEXT(repr->instances)->iid, 2);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_NEXT(repr->instances)->ssid, 1);
+}
+
+AVS_UNIT_TEST(security_object_api, transaction_commit) {
+    SCOPED_SERVER_TEST_ENV(env);
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_security_object_add_instance(env->anjay, &instance1, &iid));
+
+    const anjay_dm_object_def_t *const *obj_ptr =
+            _anjay_dm_find_object_by_oid(env->anjay, ANJAY_DM_OID_SECURITY);
+    sec_repr_t *repr = _anjay_sec_get(obj_ptr);
+    AVS_UNIT_ASSERT_SUCCESS(sec_transaction_begin(env->anjay, obj_ptr));
+    AVS_UNIT_ASSERT_SUCCESS(sec_instance_remove(env->anjay, obj_ptr, 1));
+    AVS_UNIT_ASSERT_NOT_NULL(repr->saved_instances);
+
+    AVS_UNIT_ASSERT_SUCCESS(sec_transaction_commit(env->anjay, obj_ptr));
+    AVS_UNIT_ASSERT_NULL(repr->touched_iids);
+    AVS_UNIT_ASSERT_NULL(repr->saved_instances);
+    AVS_UNIT_ASSERT_NULL(repr->instances);
+}
@@ -239,3 +239,59 @@ AVS_UNIT_TEST(security_persistence, modification_flag_purge) {
     anjay_security_object_purge(env->anjay_stored);
     AVS_UNIT_ASSERT_TRUE(anjay_security_object_is_modified(env->anjay_stored));
 }
+
+static anjay_security_instance_t psk_instance(const char *identity,
+                                              const char *key) {
+    anjay_security_instance_t instance = {
+        .ssid = 1,
+        .server_uri = "coaps://at.ease/eating?well",
+        .security_mode = ANJAY_UDP_SECURITY_PSK,
+        .client_holdoff_s = -1,
+        .bootstrap_timeout_s = -1,
+        .public_cert_or_psk_identity = (const uint8_t *) identity,
+        .public_cert_or_psk_identity_size = strlen(identity),
+        .private_cert_or_psk_key = (const uint8_t *) key,
+        .private_cert_or_psk_key_size = strlen(key)
+    };
+    return instance;
+}
+
+static void assert_security_info_identity(anjay_t *anjay,
+                                          anjay_iid_t iid,
+                                          const char *identity) {
+    avs_net_security_info_t security_info;
+    anjay_server_dtls_keys_t dtls_keys;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_get_security_info(
+            anjay, &security_info, &dtls_keys, iid, ANJAY_CONNECTION_UDP));
+    AVS_UNIT_ASSERT_EQUAL(dtls_keys.pk_or_identity_size, strlen(identity));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(dtls_keys.pk_or_identity, identity,
+                                      strlen(identity));
+}
+
+AVS_UNIT_TEST(security_persistence, restore_invalidates_cached_keys) {
+    SCOPED_SECURITY_PERSISTENCE_TEST_ENV(env);
+    anjay_iid_t iid = 1;
+    const anjay_security_instance_t old_instance =
+            psk_instance("old-identity", "old-key");
+    AVS_UNIT_ASSERT_SUCCESS(anjay_security_object_add_instance(
+            env->anjay_restored, &old_instance, &iid));
+    assert_security_info_identity(env->anjay_restored, iid, "old-identity");
+
+    const anjay_security_instance_t new_instance =
+            psk_instance("new-identity", "new-key");
+    AVS_UNIT_ASSERT_SUCCESS(anjay_security_object_add_instance(
+            env->anjay_stored, &new_instance, &iid));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_security_object_persist(env->anjay_stored, env->stream));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_security_object_restore(env->anjay_restored, env->stream));
+    // the next connection uses the restored keys
+    assert_security_info_identity(env->anjay_restored, iid, "new-identity");
+
+    anjay_security_object_purge(env->anjay_restored);
+    avs_net_security_info_t security_info;
+    anjay_server_dtls_keys_t dtls_keys;
+    AVS_UNIT_ASSERT_FAILED(_anjay_get_security_info(
+            env->anjay_restored, &security_info, &dtls_keys, iid,
+            ANJAY_CONNECTION_UDP));
+}
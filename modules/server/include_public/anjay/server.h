@@ -96,10 +96,75 @@ int anjay_server_object_persist(anjay_t *anjay,
 int anjay_server_object_restore(anjay_t *anjay,
                                 avs_stream_abstract_t *in_stream);
 
+/**
+ * Appends a record with changes made to the Server Object since the last
+ * successful restore or journal operation to the journal in
+ * @p out_stream . Only the Instances that were created, modified or removed in
+ * the meantime are written, so the cost of persisting e.g. a single Write is
+ * proportional to the size of one Instance rather than the whole Object. If
+ * nothing has changed, nothing is written.
+ *
+ * The journal is an alternative to @ref anjay_server_object_persist : the
+ * application is expected to append to the journal after every change (see
+ * @ref anjay_server_object_is_modified ) and periodically replace it with a
+ * compacted one (see @ref anjay_server_object_journal_compact ). After
+ * @ref anjay_server_object_restore , the next record contains all Instances.
+ * @ref anjay_server_object_persist (and so @ref anjay_snapshot_persist ) does
+ * not affect the journal, so both can be used by the same application.
+ *
+ * Every record is protected with a checksum, so a record that was not written
+ * completely, e.g. because of a power failure, is ignored when the journal is
+ * replayed.
+ *
+ * @param anjay      Anjay instance with Server Object installed.
+ * @param out_stream Stream to write to, positioned at the end of the journal.
+ * @return 0 in case of success, negative value in case of an error, including
+ *         the case when the last replayed journal ended with a damaged record
+ *         and has not been compacted yet.
+ */
+int anjay_server_object_journal_append(anjay_t *anjay,
+                                       avs_stream_abstract_t *out_stream);
+
+/**
+ * Writes a journal record that contains all Server Object Instances. It is
+ * meant to be written into an empty stream that replaces the journal once the
+ * write succeeds, which discards the history of changes accumulated in the
+ * journal.
+ *
+ * @param anjay      Anjay instance with Server Object installed.
+ * @param out_stream Stream to write to.
+ * @return 0 in case of success, negative value in case of an error.
+ */
+int anjay_server_object_journal_compact(anjay_t *anjay,
+                                        avs_stream_abstract_t *out_stream);
+
+/**
+ * Restores Server Object Instances by replaying all records of a journal
+ * written using @ref anjay_server_object_journal_append and
+ * @ref anjay_server_object_journal_compact , starting from an empty Object.
+ *
+ * A truncated or damaged record, e.g. one torn by a power failure, ends the
+ * replay, and the records before it are restored. Records appended after it
+ * would never be replayed, so in that case
+ * @ref anjay_server_object_journal_append fails until the state is written into
+ * a new stream using @ref anjay_server_object_journal_compact , which shall
+ * then replace the journal.
+ *
+ * Note: if replay fails, then Server Object will be left untouched, on
+ * success though all Instances stored within the Object will be purged.
+ *
+ * @param anjay     Anjay instance with Server Object installed.
+ * @param in_stream Stream to read from.
+ * @return 0 in case of success, 1 if the journal ended with a truncated or
+ *         damaged record (see above), negative value in case of an error.
+ */
+int anjay_server_object_journal_replay(anjay_t *anjay,
+                                       avs_stream_abstract_t *in_stream);
+
 /**
  * Checks whether the Server Object from Anjay instance has been modified since
- * last successful call to @ref anjay_server_object_persist or @ref
- * anjay_server_object_restore.
+ * last successful call to @ref anjay_server_object_persist,
+ * @ref anjay_server_object_restore or one of the journal functions.
  */
 bool anjay_server_object_is_modified(anjay_t *anjay);
 
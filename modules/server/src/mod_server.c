@@ -19,6 +19,7 @@
 #include <string.h>
 
 #include <anjay_modules/dm_utils.h>
+#include <anjay_modules/servers.h>
 
 #include "mod_server.h"
 #include "server_transaction.h"
@@ -66,6 +67,9 @@ static int assign_iid(server_repr_t *repr, anjay_iid_t *inout_iid) {
 
 static int insert_created_instance(server_repr_t *repr,
                                    AVS_LIST(server_instance_t) new_instance) {
+    if (_anjay_serv_transaction_touch(repr, new_instance->iid)) {
+        return -1;
+    }
     AVS_LIST(server_instance_t) *ptr;
     AVS_LIST_FOREACH_PTR(ptr, &repr->instances) {
         assert((*ptr)->iid != new_instance->iid);
@@ -73,7 +77,7 @@ static int insert_created_instance(server_repr_t *repr,
             break;
         }
     }
-    mark_modified(repr);
+    _anjay_serv_mark_instance_modified(repr, new_instance->iid);
     AVS_LIST_INSERT(ptr, new_instance);
     return 0;
 }
@@ -113,8 +117,11 @@ static int del_instance(server_repr_t *repr, anjay_iid_t iid) {
     AVS_LIST(server_instance_t) *it;
     AVS_LIST_FOREACH_PTR(it, &repr->instances) {
         if ((*it)->iid == iid) {
+            if (_anjay_serv_transaction_touch(repr, iid)) {
+                return ANJAY_ERR_INTERNAL;
+            }
             AVS_LIST_DELETE(it);
-            mark_modified(repr);
+            _anjay_serv_mark_instance_modified(repr, iid);
             return 0;
         } else if ((*it)->iid > iid) {
             break;
@@ -199,8 +206,12 @@ static int serv_instance_reset(anjay_t *anjay,
                                const anjay_dm_object_def_t *const *obj_ptr,
                                anjay_iid_t iid) {
     (void) anjay;
-    server_instance_t *inst = find_instance(_anjay_serv_get(obj_ptr), iid);
+    server_repr_t *repr = _anjay_serv_get(obj_ptr);
+    server_instance_t *inst = find_instance(repr, iid);
     assert(inst);
+    if (_anjay_serv_transaction_touch(repr, iid)) {
+        return ANJAY_ERR_INTERNAL;
+    }
 
     bool has_ssid = inst->has_ssid;
     anjay_ssid_t ssid = inst->data.ssid;
@@ -313,8 +324,11 @@ static int serv_write(anjay_t *anjay,
     server_instance_t *inst = find_instance(repr, iid);
     assert(inst);
     int retval;
+    if (_anjay_serv_transaction_touch(repr, iid)) {
+        return ANJAY_ERR_INTERNAL;
+    }
 
-    mark_modified(repr);
+    _anjay_serv_mark_instance_modified(repr, iid);
 
     switch ((server_rid_t) rid) {
     case SERV_RES_SSID:
@@ -475,7 +489,7 @@ int anjay_server_object_add_instance(
         (void) del_instance(repr, *inout_iid);
         if (!modified_since_persist) {
             /* validation failed and so in the end no instace is added */
-            clear_modified(repr);
+            repr->modified_since_persist = false;
         }
     }
 
@@ -493,12 +507,13 @@ static void server_purge(server_repr_t *repr) {
         mark_modified(repr);
     }
     _anjay_serv_destroy_instances(&repr->instances);
-    _anjay_serv_destroy_instances(&repr->saved_instances);
+    _anjay_serv_transaction_forget(repr);
 }
 
 static void server_delete(anjay_t *anjay, void *repr) {
     (void) anjay;
     server_purge((server_repr_t*) repr);
+    clear_modified((server_repr_t *) repr);
     avs_free(repr);
 }
 
@@ -510,6 +525,7 @@ void anjay_server_object_purge(anjay_t *anjay) {
     server_repr_t *repr = _anjay_serv_get(server_obj);
 
     server_purge(repr);
+    _anjay_servers_invalidate_config_cache(anjay);
 
     if (anjay_notify_instances_changed(anjay, SERVER.oid)) {
         server_log(WARNING, "Could not schedule socket reload");
@@ -525,7 +541,10 @@ bool anjay_server_object_is_modified(anjay_t *anjay) {
 }
 
 static const anjay_dm_module_t SERVER_MODULE = {
-    .deleter = server_delete
+    .deleter = server_delete,
+    .snapshot_name = "server",
+    .persist = anjay_server_object_persist,
+    .restore = anjay_server_object_restore
 };
 
 int anjay_server_object_install(anjay_t *anjay) {
@@ -50,17 +50,51 @@ typedef struct {
 typedef struct {
     const anjay_dm_object_def_t *def;
     AVS_LIST(server_instance_t) instances;
+    bool in_transaction;
+    /**
+     * IIDs of instances created, modified or removed during the current
+     * transaction, sorted.
+     */
+    AVS_LIST(anjay_iid_t) touched_iids;
+    /**
+     * Touched instances, as they were before the current transaction, sorted
+     * by IID. Touched IIDs without a saved instance refer to instances created
+     * within the transaction.
+     */
     AVS_LIST(server_instance_t) saved_instances;
     bool modified_since_persist;
     bool saved_modified_since_persist;
+    /**
+     * IIDs of instances created, modified or removed since the state was last
+     * persisted, sorted. These are written by the next journal append.
+     */
+    AVS_LIST(anjay_iid_t) dirty_iids;
+    /**
+     * Set if <c>dirty_iids</c> does not reflect all the changes, in which
+     * case the next journal record needs to contain the whole Object.
+     */
+    bool journal_checkpoint_needed;
+    /**
+     * Set if the last replayed journal ended with a damaged record. Records
+     * appended after it would never be replayed, so the journal needs to be
+     * compacted into a new stream first.
+     */
+    bool journal_damaged;
 } server_repr_t;
 
 static inline void mark_modified(server_repr_t *repr) {
     repr->modified_since_persist = true;
+    repr->journal_checkpoint_needed = true;
+}
+
+static inline void clear_journal_dirty(server_repr_t *repr) {
+    repr->journal_checkpoint_needed = false;
+    AVS_LIST_CLEAR(&repr->dirty_iids);
 }
 
 static inline void clear_modified(server_repr_t *repr) {
     repr->modified_since_persist = false;
+    clear_journal_dirty(repr);
 }
 
 #define server_log(level, ...) _anjay_log(server, level, __VA_ARGS__)
@@ -21,6 +21,8 @@
 #endif // WITH_AVS_PERSISTENCE
 
 #include <anjay_modules/dm_utils.h>
+#include <anjay_modules/journal.h>
+#include <anjay_modules/servers.h>
 #include <anjay_modules/utils_core.h>
 
 #include <string.h>
@@ -129,7 +131,9 @@ int anjay_server_object_persist(anjay_t *anjay,
                                   persist_instance, NULL, NULL);
     avs_persistence_context_delete(ctx);
     if (!retval) {
-        clear_modified(repr);
+        /* the journal is independent of the full state and still needs to
+         * receive the changes */
+        repr->modified_since_persist = false;
         persistence_log(INFO, "Server Object state persisted");
     }
     return retval;
@@ -175,15 +179,247 @@ int anjay_server_object_restore(anjay_t *anjay,
         repr->instances = backup.instances;
     } else {
         _anjay_serv_destroy_instances(&backup.instances);
+        _anjay_serv_transaction_forget(repr);
     }
     avs_persistence_context_delete(restore_ctx);
     if (!retval) {
         clear_modified(repr);
+        /* the restored state is not in the journal yet */
+        repr->journal_checkpoint_needed = true;
+        _anjay_servers_invalidate_config_cache(anjay);
         persistence_log(INFO, "Server Object state restored");
     }
     return retval;
 }
 
+static const char JOURNAL_MAGIC[ANJAY_JOURNAL_MAGIC_SIZE] = {
+    'S', 'R', 'V', 'J'
+};
+
+/*
+ * Journal record payload:
+ *
+ * - bool checkpoint - if set, all Instances not contained in the record are
+ *   removed
+ * - u32 number of entries
+ * - for each entry:
+ *   - bool present
+ *   - if present: the whole Instance, as in anjay_server_object_persist()
+ *   - otherwise: u16 IID of the removed Instance
+ */
+
+typedef struct {
+    server_repr_t *repr;
+    bool checkpoint;
+} journal_write_args_t;
+
+static int journal_write_entry(avs_persistence_context_t *ctx,
+                               server_instance_t *instance,
+                               anjay_iid_t iid) {
+    bool present = !!instance;
+    int retval = avs_persistence_bool(ctx, &present);
+    if (!retval) {
+        retval = present ? persist_instance(ctx, instance, NULL)
+                         : avs_persistence_u16(ctx, &iid);
+    }
+    return retval;
+}
+
+static int journal_write_record(avs_stream_abstract_t *out_stream,
+                                void *args_) {
+    journal_write_args_t *args = (journal_write_args_t *) args_;
+    avs_persistence_context_t *ctx =
+            avs_persistence_store_context_new(out_stream);
+    if (!ctx) {
+        persistence_log(ERROR, "Out of memory");
+        return -1;
+    }
+    uint32_t count = (uint32_t) (args->checkpoint
+                                 ? AVS_LIST_SIZE(args->repr->instances)
+                                 : AVS_LIST_SIZE(args->repr->dirty_iids));
+    int retval;
+    (void) ((retval = avs_persistence_bool(ctx, &args->checkpoint))
+            || (retval = avs_persistence_u32(ctx, &count)));
+    AVS_LIST(server_instance_t) instance = args->repr->instances;
+    if (args->checkpoint) {
+        for (; !retval && instance; instance = AVS_LIST_NEXT(instance)) {
+            retval = journal_write_entry(ctx, instance, instance->iid);
+        }
+    } else {
+        /* both lists are sorted by IID */
+        AVS_LIST(anjay_iid_t) dirty;
+        AVS_LIST_FOREACH(dirty, args->repr->dirty_iids) {
+            while (instance && instance->iid < *dirty) {
+                instance = AVS_LIST_NEXT(instance);
+            }
+            if ((retval = journal_write_entry(
+                         ctx,
+                         instance && instance->iid == *dirty ? instance : NULL,
+                         *dirty))) {
+                break;
+            }
+        }
+    }
+    avs_persistence_context_delete(ctx);
+    return retval;
+}
+
+static int journal_write(anjay_t *anjay,
+                         avs_stream_abstract_t *out_stream,
+                         bool checkpoint) {
+    assert(anjay);
+
+    const anjay_dm_object_def_t *const *server_obj =
+            _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_SERVER);
+    server_repr_t *repr = _anjay_serv_get(server_obj);
+    if (!repr) {
+        return -1;
+    }
+    if (repr->in_transaction) {
+        persistence_log(ERROR, "Cannot write the journal during a transaction");
+        return -1;
+    }
+    if (!checkpoint && repr->journal_damaged) {
+        persistence_log(ERROR, "The journal ends with a damaged record and "
+                               "needs to be compacted before appending");
+        return -1;
+    }
+    journal_write_args_t args = {
+        .repr = repr,
+        .checkpoint = checkpoint || repr->journal_checkpoint_needed
+    };
+    if (!args.checkpoint && !repr->dirty_iids) {
+        return 0;
+    }
+    int retval = _anjay_journal_append(out_stream, JOURNAL_MAGIC,
+                                       journal_write_record, &args);
+    if (!retval) {
+        clear_modified(repr);
+        if (checkpoint) {
+            repr->journal_damaged = false;
+        }
+        persistence_log(DEBUG, "Server Object %s appended to the journal",
+                        args.checkpoint ? "state" : "changes");
+    }
+    return retval;
+}
+
+int anjay_server_object_journal_append(anjay_t *anjay,
+                                       avs_stream_abstract_t *out_stream) {
+    return journal_write(anjay, out_stream, false);
+}
+
+int anjay_server_object_journal_compact(anjay_t *anjay,
+                                        avs_stream_abstract_t *out_stream) {
+    return journal_write(anjay, out_stream, true);
+}
+
+static int journal_apply_entry(avs_persistence_context_t *ctx,
+                               AVS_LIST(server_instance_t) *instances) {
+    bool present;
+    AVS_LIST(server_instance_t) instance = NULL;
+    anjay_iid_t iid = ANJAY_IID_INVALID;
+    int retval = avs_persistence_bool(ctx, &present);
+    if (!retval && present) {
+        if (!(instance = AVS_LIST_NEW_ELEMENT(server_instance_t))) {
+            persistence_log(ERROR, "Out of memory");
+            return -1;
+        }
+        if ((retval = restore_instance(ctx, instance, NULL))) {
+            AVS_LIST_CLEAR(&instance);
+            return retval;
+        }
+        iid = instance->iid;
+    } else if (!retval) {
+        retval = avs_persistence_u16(ctx, &iid);
+    }
+    if (retval) {
+        return retval;
+    }
+
+    AVS_LIST(server_instance_t) *it;
+    AVS_LIST_FOREACH_PTR(it, instances) {
+        if ((*it)->iid >= iid) {
+            break;
+        }
+    }
+    if (*it && (*it)->iid == iid) {
+        AVS_LIST_DELETE(it);
+    }
+    if (instance) {
+        AVS_LIST_INSERT(it, instance);
+    }
+    return 0;
+}
+
+static int journal_apply_record(avs_stream_abstract_t *in_stream,
+                                void *instances_) {
+    AVS_LIST(server_instance_t) *instances =
+            (AVS_LIST(server_instance_t) *) instances_;
+    avs_persistence_context_t *ctx =
+            avs_persistence_restore_context_new(in_stream);
+    if (!ctx) {
+        persistence_log(ERROR, "Cannot create persistence restore context");
+        return -1;
+    }
+    bool checkpoint;
+    uint32_t count;
+    int retval;
+    (void) ((retval = avs_persistence_bool(ctx, &checkpoint))
+            || (retval = avs_persistence_u32(ctx, &count)));
+    if (!retval && checkpoint) {
+        _anjay_serv_destroy_instances(instances);
+    }
+    while (!retval && count--) {
+        retval = journal_apply_entry(ctx, instances);
+    }
+    avs_persistence_context_delete(ctx);
+    return retval;
+}
+
+int anjay_server_object_journal_replay(anjay_t *anjay,
+                                       avs_stream_abstract_t *in_stream) {
+    assert(anjay);
+
+    const anjay_dm_object_def_t *const *server_obj =
+            _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_SERVER);
+    server_repr_t *repr = _anjay_serv_get(server_obj);
+    if (!repr) {
+        return -1;
+    }
+    server_repr_t backup = *repr;
+
+    repr->instances = NULL;
+    bool damaged_tail;
+    int retval = _anjay_journal_replay(in_stream, JOURNAL_MAGIC,
+                                       journal_apply_record,
+                                       &repr->instances, &damaged_tail);
+    int records = retval;
+    if (retval >= 0) {
+        retval = _anjay_serv_object_validate(repr);
+    }
+    if (retval) {
+        _anjay_serv_destroy_instances(&repr->instances);
+        repr->instances = backup.instances;
+        return retval;
+    }
+    _anjay_serv_destroy_instances(&backup.instances);
+    _anjay_serv_transaction_forget(repr);
+    clear_modified(repr);
+    _anjay_servers_invalidate_config_cache(anjay);
+    persistence_log(INFO, "Server Object state restored from %d journal "
+                          "records", records);
+    repr->journal_damaged = damaged_tail;
+    if (damaged_tail) {
+        /* the replayed state is only safe in a new journal */
+        repr->journal_checkpoint_needed = true;
+        persistence_log(WARNING, "The journal ends with a damaged record, it "
+                                 "needs to be compacted");
+        return 1;
+    }
+    return 0;
+}
+
 #ifdef ANJAY_TEST
 #include "test/persistence.c"
 #endif
@@ -204,4 +440,25 @@ int anjay_server_object_restore(anjay_t *anjay,
     return -1;
 }
 
+int anjay_server_object_journal_append(anjay_t *anjay,
+                                       avs_stream_abstract_t *out_stream) {
+    (void) anjay; (void) out_stream;
+    persistence_log(ERROR, "Persistence not compiled in");
+    return -1;
+}
+
+int anjay_server_object_journal_compact(anjay_t *anjay,
+                                        avs_stream_abstract_t *out_stream) {
+    (void) anjay; (void) out_stream;
+    persistence_log(ERROR, "Persistence not compiled in");
+    return -1;
+}
+
+int anjay_server_object_journal_replay(anjay_t *anjay,
+                                       avs_stream_abstract_t *in_stream) {
+    (void) anjay; (void) in_stream;
+    persistence_log(ERROR, "Persistence not compiled in");
+    return -1;
+}
+
 #endif // WITH_AVS_PERSISTENCE
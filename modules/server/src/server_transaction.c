@@ -124,17 +124,22 @@ int _anjay_serv_object_validate(server_repr_t *repr) {
 }
 
 int _anjay_serv_transaction_begin_impl(server_repr_t *repr) {
+    assert(!repr->in_transaction);
+    assert(!repr->touched_iids);
     assert(!repr->saved_instances);
-    repr->saved_instances = _anjay_serv_clone_instances(repr);
-    if (!repr->saved_instances && repr->instances) {
-        return ANJAY_ERR_INTERNAL;
-    }
+    repr->in_transaction = true;
     repr->saved_modified_since_persist = repr->modified_since_persist;
     return 0;
 }
 
-int _anjay_serv_transaction_commit_impl(server_repr_t *repr) {
+void _anjay_serv_transaction_forget(server_repr_t *repr) {
+    AVS_LIST_CLEAR(&repr->touched_iids);
     _anjay_serv_destroy_instances(&repr->saved_instances);
+}
+
+int _anjay_serv_transaction_commit_impl(server_repr_t *repr) {
+    _anjay_serv_transaction_forget(repr);
+    repr->in_transaction = false;
     return 0;
 }
 
@@ -143,9 +148,81 @@ int _anjay_serv_transaction_validate_impl(server_repr_t *repr) {
 }
 
 int _anjay_serv_transaction_rollback_impl(server_repr_t *repr) {
-    _anjay_serv_destroy_instances(&repr->instances);
-    repr->modified_since_persist = repr->saved_modified_since_persist;
-    repr->instances = repr->saved_instances;
-    repr->saved_instances = NULL;
+    /* both lists are sorted, so a single pass is enough to remove the current
+     * versions of all touched instances */
+    AVS_LIST(server_instance_t) *it = &repr->instances;
+    AVS_LIST(anjay_iid_t) touched = repr->touched_iids;
+    while (*it && touched) {
+        if ((*it)->iid < *touched) {
+            AVS_LIST_ADVANCE_PTR(&it);
+        } else {
+            if ((*it)->iid == *touched) {
+                AVS_LIST_DELETE(it);
+            }
+            AVS_LIST_ADVANCE(&touched);
+        }
+    }
+    /* now put the saved ones back in place */
+    it = &repr->instances;
+    while (repr->saved_instances) {
+        while (*it && (*it)->iid < repr->saved_instances->iid) {
+            AVS_LIST_ADVANCE_PTR(&it);
+        }
+        AVS_LIST_INSERT(it, AVS_LIST_DETACH(&repr->saved_instances));
+    }
+    AVS_LIST_CLEAR(&repr->touched_iids);
+    repr->in_transaction = false;
+    if (!repr->saved_modified_since_persist) {
+        /* nothing was dirty before the transaction; IIDs marked dirty for the
+         * journal are kept, as they may predate the transaction, and writing
+         * an unchanged Instance again is harmless */
+        repr->modified_since_persist = false;
+    }
+    return 0;
+}
+
+int _anjay_serv_transaction_touch(server_repr_t *repr, anjay_iid_t iid) {
+    if (!repr->in_transaction) {
+        return 0;
+    }
+    AVS_LIST(anjay_iid_t) *touched_ptr;
+    AVS_LIST_FOREACH_PTR(touched_ptr, &repr->touched_iids) {
+        if (**touched_ptr == iid) {
+            return 0;
+        } else if (**touched_ptr > iid) {
+            break;
+        }
+    }
+    AVS_LIST(anjay_iid_t) touched = AVS_LIST_NEW_ELEMENT(anjay_iid_t);
+    if (!touched) {
+        server_log(ERROR, "Out of memory");
+        return -1;
+    }
+    *touched = iid;
+
+    AVS_LIST(server_instance_t) instance;
+    AVS_LIST_FOREACH(instance, repr->instances) {
+        if (instance->iid >= iid) {
+            break;
+        }
+    }
+    if (instance && instance->iid == iid) {
+        AVS_LIST(server_instance_t) saved =
+                AVS_LIST_NEW_ELEMENT(server_instance_t);
+        if (!saved) {
+            server_log(ERROR, "Out of memory");
+            AVS_LIST_CLEAR(&touched);
+            return -1;
+        }
+        *saved = *instance;
+        AVS_LIST(server_instance_t) *saved_ptr;
+        AVS_LIST_FOREACH_PTR(saved_ptr, &repr->saved_instances) {
+            if ((*saved_ptr)->iid > iid) {
+                break;
+            }
+        }
+        AVS_LIST_INSERT(saved_ptr, saved);
+    }
+    AVS_LIST_INSERT(touched_ptr, touched);
     return 0;
 }
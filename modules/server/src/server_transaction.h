@@ -29,6 +29,20 @@ int _anjay_serv_transaction_commit_impl(server_repr_t *repr);
 int _anjay_serv_transaction_validate_impl(server_repr_t *repr);
 int _anjay_serv_transaction_rollback_impl(server_repr_t *repr);
 
+/**
+ * Shall be called before creating, modifying or removing the instance
+ * @p iid . During a transaction, saves the instance for a possible rollback,
+ * unless it has already been touched within that transaction. Does nothing
+ * outside of transactions.
+ */
+int _anjay_serv_transaction_touch(server_repr_t *repr, anjay_iid_t iid);
+
+/**
+ * Forgets all changes recorded in the current transaction, so that they will
+ * not be undone by a rollback. Used when all instances are replaced at once.
+ */
+void _anjay_serv_transaction_forget(server_repr_t *repr);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* SERVER_TRANSACTION_H */
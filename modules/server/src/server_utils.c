@@ -52,12 +52,31 @@ int _anjay_serv_fetch_binding(anjay_input_ctx_t *ctx,
     return 0;
 }
 
-AVS_LIST(server_instance_t)
-_anjay_serv_clone_instances(const server_repr_t *repr) {
-    return AVS_LIST_SIMPLE_CLONE(repr->instances);
-}
-
 void _anjay_serv_destroy_instances(AVS_LIST(server_instance_t) *instances) {
     AVS_LIST_CLEAR(instances);
 }
 
+void _anjay_serv_mark_instance_modified(server_repr_t *repr, anjay_iid_t iid) {
+    repr->modified_since_persist = true;
+    if (repr->journal_checkpoint_needed) {
+        return;
+    }
+    AVS_LIST(anjay_iid_t) *dirty_ptr;
+    AVS_LIST_FOREACH_PTR(dirty_ptr, &repr->dirty_iids) {
+        if (**dirty_ptr == iid) {
+            return;
+        } else if (**dirty_ptr > iid) {
+            break;
+        }
+    }
+    AVS_LIST(anjay_iid_t) dirty = AVS_LIST_NEW_ELEMENT(anjay_iid_t);
+    if (!dirty) {
+        server_log(WARNING, "Out of memory, the whole Server Object will be "
+                            "written to the journal");
+        repr->journal_checkpoint_needed = true;
+        AVS_LIST_CLEAR(&repr->dirty_iids);
+        return;
+    }
+    *dirty = iid;
+    AVS_LIST_INSERT(dirty_ptr, dirty);
+}
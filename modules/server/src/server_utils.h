@@ -38,10 +38,14 @@ int _anjay_serv_fetch_validated_i32(anjay_input_ctx_t *ctx,
 int _anjay_serv_fetch_binding(anjay_input_ctx_t *ctx,
                               anjay_binding_mode_t *out_binding);
 
-AVS_LIST(server_instance_t)
-_anjay_serv_clone_instances(const server_repr_t *repr);
 void _anjay_serv_destroy_instances(AVS_LIST(server_instance_t) * instances);
 
+/**
+ * Marks a single instance as created, modified or removed, so that it is
+ * written by the next journal append.
+ */
+void _anjay_serv_mark_instance_modified(server_repr_t *repr, anjay_iid_t iid);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* SERVER_UTILS_H */
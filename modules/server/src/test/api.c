@@ -88,3 +88,58 @@ AVS_UNIT_TEST(server_object_api, add_instances_with_duplicated_ssids) {
     AVS_UNIT_ASSERT_FAILED(
             anjay_server_object_add_instance(env->anjay, &instance2, &iid));
 }
+
+AVS_UNIT_TEST(server_object_api, transaction_rollback) {
+    SCOPED_SERVER_TEST_ENV(env);
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_add_instance(env->anjay, &instance1, &iid));
+    iid = 2;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_add_instance(env->anjay, &instance2, &iid));
+
+    const anjay_dm_object_def_t *const *obj_ptr =
+            _anjay_dm_find_object_by_oid(env->anjay, ANJAY_DM_OID_SERVER);
+    server_repr_t *repr = _anjay_serv_get(obj_ptr);
+    AVS_UNIT_ASSERT_SUCCESS(serv_transaction_begin(env->anjay, obj_ptr));
+    AVS_UNIT_ASSERT_NULL(repr->saved_instances);
+
+    AVS_UNIT_ASSERT_SUCCESS(serv_instance_remove(env->anjay, obj_ptr, 1));
+    iid = 3;
+    AVS_UNIT_ASSERT_SUCCESS(
+            serv_instance_create(env->anjay, obj_ptr, &iid, 1));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->touched_iids), 2);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->saved_instances), 1);
+    AVS_UNIT_ASSERT_EQUAL(repr->saved_instances->iid, 1);
+
+    AVS_UNIT_ASSERT_SUCCESS(serv_transaction_rollback(env->anjay, obj_ptr));
+    AVS_UNIT_ASSERT_NULL(repr->touched_iids);
+    AVS_UNIT_ASSERT_NULL(repr->saved_instances);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->instances), 2);
+    AVS_UNIT_ASSERT_EQUAL(repr->instances->iid, 1);
+    AVS_UNIT_ASSERT_EQUAL(repr->instances->data.lifetime, 42);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_NEXT(repr->instances)->iid, 2);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_NEXT(repr->instances)->data.lifetime, 424);
+}
+
+AVS_UNIT_TEST(server_object_api, transaction_commit) {
+    SCOPED_SERVER_TEST_ENV(env);
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_add_instance(env->anjay, &instance1, &iid));
+
+    const anjay_dm_object_def_t *const *obj_ptr =
+            _anjay_dm_find_object_by_oid(env->anjay, ANJAY_DM_OID_SERVER);
+    server_repr_t *repr = _anjay_serv_get(obj_ptr);
+    AVS_UNIT_ASSERT_SUCCESS(serv_transaction_begin(env->anjay, obj_ptr));
+    AVS_UNIT_ASSERT_SUCCESS(serv_instance_reset(env->anjay, obj_ptr, 1));
+    AVS_UNIT_ASSERT_SUCCESS(serv_instance_reset(env->anjay, obj_ptr, 1));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->saved_instances), 1);
+    AVS_UNIT_ASSERT_EQUAL(repr->saved_instances->data.lifetime, 42);
+
+    AVS_UNIT_ASSERT_SUCCESS(serv_transaction_commit(env->anjay, obj_ptr));
+    AVS_UNIT_ASSERT_NULL(repr->touched_iids);
+    AVS_UNIT_ASSERT_NULL(repr->saved_instances);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->instances), 1);
+    AVS_UNIT_ASSERT_EQUAL(repr->instances->data.lifetime, -1);
+}
@@ -193,3 +193,203 @@ AVS_UNIT_TEST(server_persistence, modification_flag_purge) {
     anjay_server_object_purge(env->anjay_stored);
     AVS_UNIT_ASSERT_TRUE(anjay_server_object_is_modified(env->anjay_stored));
 }
+
+AVS_UNIT_TEST(server_persistence, snapshot_store_restore) {
+    SCOPED_SERVER_PERSISTENCE_TEST_ENV(env);
+    const anjay_server_instance_t instance = {
+        .ssid = 42,
+        .lifetime = 9001,
+        .default_min_period = -1,
+        .default_max_period = -1,
+        .disable_timeout = -1,
+        .binding = ANJAY_BINDING_U,
+        .notification_storing = true
+    };
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_add_instance(env->anjay_stored, &instance, &iid));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_snapshot_persist(env->anjay_stored, env->stream));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_snapshot_restore(env->anjay_restored, env->stream));
+    AVS_UNIT_ASSERT_EQUAL(1, AVS_LIST_SIZE(env->restored_repr->instances));
+    const server_instance_t expected_server_instance = {
+        .iid = 1,
+        .data = instance,
+        .has_ssid = true,
+        .has_binding = true,
+        .has_lifetime = true,
+        .has_notification_storing = true
+    };
+    assert_instances_equal(&expected_server_instance, env->restored_repr->instances);
+}
+
+static void add_journal_test_instance(anjay_t *anjay, anjay_iid_t iid) {
+    const anjay_server_instance_t instance = {
+        .ssid = (anjay_ssid_t) (iid + 1),
+        .lifetime = 9001,
+        .default_min_period = -1,
+        .default_max_period = -1,
+        .disable_timeout = -1,
+        .binding = ANJAY_BINDING_U,
+        .notification_storing = true
+    };
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_add_instance(anjay, &instance, &iid));
+}
+
+static void assert_objects_equal(const server_repr_t *a,
+                                 const server_repr_t *b) {
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(a->instances),
+                          AVS_LIST_SIZE(b->instances));
+    AVS_LIST(server_instance_t) a_it = a->instances;
+    AVS_LIST(server_instance_t) b_it = b->instances;
+    for (; a_it; a_it = AVS_LIST_NEXT(a_it), b_it = AVS_LIST_NEXT(b_it)) {
+        assert_instances_equal(a_it, b_it);
+    }
+}
+
+AVS_UNIT_TEST(server_persistence, journal_append_replay) {
+    SCOPED_SERVER_PERSISTENCE_TEST_ENV(env);
+    add_journal_test_instance(env->anjay_stored, 1);
+    add_journal_test_instance(env->anjay_stored, 2);
+    add_journal_test_instance(env->anjay_stored, 3);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(env->stored_repr->dirty_iids), 3);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_append(
+            env->anjay_stored, env->stream));
+    AVS_UNIT_ASSERT_FALSE(anjay_server_object_is_modified(env->anjay_stored));
+    AVS_UNIT_ASSERT_NULL(env->stored_repr->dirty_iids);
+
+    /* only the touched instances are written */
+    AVS_LIST(server_instance_t) second =
+            AVS_LIST_NEXT(env->stored_repr->instances);
+    second->data.lifetime = 42;
+    _anjay_serv_mark_instance_modified(env->stored_repr, second->iid);
+    AVS_LIST_DELETE(&env->stored_repr->instances);
+    _anjay_serv_mark_instance_modified(env->stored_repr, 1);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(env->stored_repr->dirty_iids), 2);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_append(
+            env->anjay_stored, env->stream));
+
+    /* nothing changed, nothing is written */
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_append(
+            env->anjay_stored, env->stream));
+
+    add_journal_test_instance(env->anjay_restored, 7);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_replay(
+            env->anjay_restored, env->stream));
+    AVS_UNIT_ASSERT_FALSE(
+            anjay_server_object_is_modified(env->anjay_restored));
+    assert_objects_equal(env->stored_repr, env->restored_repr);
+    AVS_UNIT_ASSERT_EQUAL(env->restored_repr->instances->iid, 2);
+    AVS_UNIT_ASSERT_EQUAL(env->restored_repr->instances->data.lifetime, 42);
+}
+
+AVS_UNIT_TEST(server_persistence, journal_compact) {
+    SCOPED_SERVER_PERSISTENCE_TEST_ENV(env);
+    add_journal_test_instance(env->anjay_stored, 1);
+    add_journal_test_instance(env->anjay_stored, 2);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_append(
+            env->anjay_stored, env->stream));
+    anjay_server_object_purge(env->anjay_stored);
+    add_journal_test_instance(env->anjay_stored, 5);
+    /* purge requires the whole object to be written */
+    AVS_UNIT_ASSERT_TRUE(env->stored_repr->journal_checkpoint_needed);
+    AVS_UNIT_ASSERT_NULL(env->stored_repr->dirty_iids);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_append(
+            env->anjay_stored, env->stream));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_replay(
+            env->anjay_restored, env->stream));
+    assert_objects_equal(env->stored_repr, env->restored_repr);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_compact(
+            env->anjay_stored, env->stream));
+    anjay_server_object_purge(env->anjay_restored);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_replay(
+            env->anjay_restored, env->stream));
+    assert_objects_equal(env->stored_repr, env->restored_repr);
+}
+
+AVS_UNIT_TEST(server_persistence, journal_after_restore) {
+    SCOPED_SERVER_PERSISTENCE_TEST_ENV(env);
+    add_journal_test_instance(env->anjay_stored, 1);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_persist(env->anjay_stored, env->stream));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_restore(env->anjay_restored, env->stream));
+    /* the restored instance is not in the journal, so it is written anyway */
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_append(
+            env->anjay_restored, env->stream));
+    anjay_server_object_purge(env->anjay_stored);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_replay(
+            env->anjay_stored, env->stream));
+    assert_objects_equal(env->restored_repr, env->stored_repr);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(env->stored_repr->instances), 1);
+}
+
+AVS_UNIT_TEST(server_persistence, journal_damaged_tail) {
+    SCOPED_SERVER_PERSISTENCE_TEST_ENV(env);
+    add_journal_test_instance(env->anjay_stored, 1);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_append(
+            env->anjay_stored, env->stream));
+    add_journal_test_instance(env->anjay_stored, 2);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_append(
+            env->anjay_stored, env->stream));
+    /* a record torn by a power failure */
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(env->stream, "SRVJ\0\0", 6));
+    /* appended after the torn record, so it is never replayed */
+    add_journal_test_instance(env->anjay_stored, 3);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_append(
+            env->anjay_stored, env->stream));
+
+    AVS_UNIT_ASSERT_EQUAL(anjay_server_object_journal_replay(
+                                  env->anjay_restored, env->stream),
+                          1);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(env->restored_repr->instances), 2);
+    AVS_UNIT_ASSERT_TRUE(env->restored_repr->journal_checkpoint_needed);
+
+    /* appending to the damaged journal would lose the change */
+    add_journal_test_instance(env->anjay_restored, 4);
+    AVS_UNIT_ASSERT_FAILED(anjay_server_object_journal_append(
+            env->anjay_restored, env->stream));
+
+    avs_stream_abstract_t *journal = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(journal);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_compact(
+            env->anjay_restored, journal));
+    add_journal_test_instance(env->anjay_restored, 5);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_append(
+            env->anjay_restored, journal));
+
+    anjay_server_object_purge(env->anjay_stored);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_journal_replay(env->anjay_stored, journal));
+    avs_stream_cleanup(&journal);
+    assert_objects_equal(env->restored_repr, env->stored_repr);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(env->stored_repr->instances), 4);
+}
+
+AVS_UNIT_TEST(server_persistence, journal_mixed_with_snapshot) {
+    SCOPED_SERVER_PERSISTENCE_TEST_ENV(env);
+    add_journal_test_instance(env->anjay_stored, 1);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_append(
+            env->anjay_stored, env->stream));
+    add_journal_test_instance(env->anjay_stored, 2);
+
+    avs_stream_abstract_t *snapshot = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(snapshot);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_persist(env->anjay_stored, snapshot));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_snapshot_persist(env->anjay_stored, snapshot));
+    avs_stream_cleanup(&snapshot);
+    AVS_UNIT_ASSERT_FALSE(anjay_server_object_is_modified(env->anjay_stored));
+
+    /* the Instance added before the snapshot still goes to the journal */
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(env->stored_repr->dirty_iids), 1);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_append(
+            env->anjay_stored, env->stream));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_replay(
+            env->anjay_restored, env->stream));
+    assert_objects_equal(env->stored_repr, env->restored_repr);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(env->restored_repr->instances), 2);
+}
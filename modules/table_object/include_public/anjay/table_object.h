@@ -0,0 +1,236 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_TABLE_OBJECT_H
+#define ANJAY_INCLUDE_ANJAY_TABLE_OBJECT_H
+
+#include <anjay/dm.h>
+
+#include <avsystem/commons/stream.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Type of values stored in a column of a table Object. */
+typedef enum {
+    ANJAY_TABLE_COLUMN_I64,
+    ANJAY_TABLE_COLUMN_DOUBLE,
+    ANJAY_TABLE_COLUMN_BOOL,
+    ANJAY_TABLE_COLUMN_STRING
+} anjay_table_column_type_t;
+
+/** Definition of a single Resource (column) of a table Object. */
+typedef struct {
+    /** Resource ID */
+    anjay_rid_t rid;
+    /** Type of the Resource value */
+    anjay_table_column_type_t type;
+    /**
+     * Operations allowed on the Resource - a combination of
+     * @ref ANJAY_DM_RESOURCE_OP_BIT_R and @ref ANJAY_DM_RESOURCE_OP_BIT_W .
+     * Executable Resources are not supported, and a definition containing
+     * @ref ANJAY_DM_RESOURCE_OP_BIT_E is rejected.
+     */
+    anjay_dm_resource_op_mask_t operations;
+    /**
+     * For @ref ANJAY_TABLE_COLUMN_STRING columns: size of the buffer reserved
+     * for the value, including the terminating nullbyte. Ignored otherwise.
+     */
+    size_t max_length;
+} anjay_table_column_def_t;
+
+/**
+ * Declarative definition of a multi-instance Object whose Instances all share
+ * the same set of single-instance Resources.
+ */
+typedef struct {
+    /** Object ID */
+    anjay_oid_t oid;
+    /** Object version, see @ref anjay_dm_object_def_t::version */
+    const char *version;
+    /**
+     * Array of column definitions, sorted by Resource ID in strictly
+     * ascending order. The array is copied during installation.
+     */
+    const anjay_table_column_def_t *columns;
+    /** Number of elements in <c>columns</c> */
+    size_t column_count;
+    /**
+     * Maximum number of Object Instances. Instance IDs are allocated from the
+     * range [0, <c>max_instances</c>). Storage for all of them is reserved
+     * during installation, so that Instance lookup takes constant time.
+     */
+    anjay_iid_t max_instances;
+} anjay_table_object_def_t;
+
+/**
+ * Installs a table Object in an Anjay instance. The Object implements all the
+ * data model handlers, including Create, Delete and transactions, on top of
+ * a dense store indexed by Instance ID.
+ *
+ * Every Resource defined in @p def is present in every Object Instance. Newly
+ * created Instances have all numeric values set to zero, booleans set to
+ * false and strings empty.
+ *
+ * Any number of table Objects with different Object IDs may be installed.
+ * They do not require explicit cleanup; all resources will be automatically
+ * freed up during the call to @ref anjay_delete.
+ *
+ * @param anjay Anjay instance to install the Object in.
+ * @param def   Object definition. It may be safely freed after this function
+ *              finishes.
+ *
+ * @returns 0 on success, or a negative value in case of error.
+ */
+int anjay_table_object_install(anjay_t *anjay,
+                               const anjay_table_object_def_t *def);
+
+/**
+ * Adds a new Instance to a table Object.
+ *
+ * @param anjay     Anjay instance with the table Object installed.
+ * @param oid       Object ID of the table Object.
+ * @param inout_iid Instance ID to use, or @ref ANJAY_IID_INVALID to allocate
+ *                  the lowest free one. On success, set to the ID of the
+ *                  created Instance.
+ *
+ * @returns 0 on success, negative value in case of an error, if the Instance
+ *          already exists or if there is no room for a new Instance.
+ */
+int anjay_table_object_add_instance(anjay_t *anjay,
+                                    anjay_oid_t oid,
+                                    anjay_iid_t *inout_iid);
+
+/**
+ * Removes an Instance of a table Object.
+ *
+ * @returns 0 on success, negative value if the Instance does not exist.
+ */
+int anjay_table_object_remove_instance(anjay_t *anjay,
+                                       anjay_oid_t oid,
+                                       anjay_iid_t iid);
+
+/**
+ * Sets the value of an @ref ANJAY_TABLE_COLUMN_I64 Resource and notifies the
+ * library about the change.
+ *
+ * @returns 0 on success, negative value if the Resource does not exist or is
+ *          of a different type.
+ */
+int anjay_table_object_set_i64(anjay_t *anjay,
+                               anjay_oid_t oid,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               int64_t value);
+
+/** Same as @ref anjay_table_object_set_i64, for double values. */
+int anjay_table_object_set_double(anjay_t *anjay,
+                                  anjay_oid_t oid,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  double value);
+
+/** Same as @ref anjay_table_object_set_i64, for boolean values. */
+int anjay_table_object_set_bool(anjay_t *anjay,
+                                anjay_oid_t oid,
+                                anjay_iid_t iid,
+                                anjay_rid_t rid,
+                                bool value);
+
+/**
+ * Same as @ref anjay_table_object_set_i64, for string values. Fails if
+ * @p value does not fit in the column's <c>max_length</c>.
+ */
+int anjay_table_object_set_string(anjay_t *anjay,
+                                  anjay_oid_t oid,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  const char *value);
+
+/**
+ * Reads the value of an @ref ANJAY_TABLE_COLUMN_I64 Resource.
+ *
+ * @returns 0 on success, negative value if the Resource does not exist or is
+ *          of a different type.
+ */
+int anjay_table_object_get_i64(anjay_t *anjay,
+                               anjay_oid_t oid,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               int64_t *out_value);
+
+/** Same as @ref anjay_table_object_get_i64, for double values. */
+int anjay_table_object_get_double(anjay_t *anjay,
+                                  anjay_oid_t oid,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  double *out_value);
+
+/** Same as @ref anjay_table_object_get_i64, for boolean values. */
+int anjay_table_object_get_bool(anjay_t *anjay,
+                                anjay_oid_t oid,
+                                anjay_iid_t iid,
+                                anjay_rid_t rid,
+                                bool *out_value);
+
+/**
+ * Same as @ref anjay_table_object_get_i64, for string values.
+ *
+ * @returns 0 on success, ANJAY_BUFFER_TOO_SHORT if @p out_buf is too small
+ *          (in which case it is left untouched), negative value if the
+ *          Resource does not exist or is of a different type.
+ */
+int anjay_table_object_get_string(anjay_t *anjay,
+                                  anjay_oid_t oid,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  char *out_buf,
+                                  size_t buf_size);
+
+/**
+ * Dumps all Instances of a table Object into the @p out_stream .
+ *
+ * @returns 0 in case of success, negative value in case of an error.
+ */
+int anjay_table_object_persist(anjay_t *anjay,
+                               anjay_oid_t oid,
+                               avs_stream_abstract_t *out_stream);
+
+/**
+ * Attempts to restore Instances of a table Object from @p in_stream . The
+ * data must have been persisted by an Object with the same set of columns.
+ *
+ * Note: if restore fails, the Object is left untouched; on success, all
+ * previously existing Instances are replaced.
+ *
+ * @returns 0 in case of success, negative value in case of an error.
+ */
+int anjay_table_object_restore(anjay_t *anjay,
+                               anjay_oid_t oid,
+                               avs_stream_abstract_t *in_stream);
+
+/**
+ * Checks whether a table Object has been modified since last successful call
+ * to @ref anjay_table_object_persist or @ref anjay_table_object_restore .
+ */
+bool anjay_table_object_is_modified(anjay_t *anjay, anjay_oid_t oid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANJAY_INCLUDE_ANJAY_TABLE_OBJECT_H */
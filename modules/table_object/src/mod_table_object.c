@@ -0,0 +1,645 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <avsystem/commons/memory.h>
+
+#include <anjay_modules/dm_utils.h>
+
+#include "mod_table_object.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#define CELL_ALIGNMENT sizeof(double)
+
+static size_t align_cell_offset(size_t offset) {
+    return (offset + CELL_ALIGNMENT - 1) / CELL_ALIGNMENT * CELL_ALIGNMENT;
+}
+
+static table_t *get_table(const anjay_dm_object_def_t *const *obj_ptr) {
+    return AVS_CONTAINER_OF(obj_ptr, table_t, def_ptr);
+}
+
+static const table_column_t *find_column(const table_t *table,
+                                         anjay_rid_t rid) {
+    size_t lo = 0;
+    size_t hi = table->column_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (table->columns[mid].def.rid < rid) {
+            lo = mid + 1;
+        } else if (table->columns[mid].def.rid > rid) {
+            hi = mid;
+        } else {
+            return &table->columns[mid];
+        }
+    }
+    return NULL;
+}
+
+static inline bool instance_present(const table_t *table, anjay_iid_t iid) {
+    return iid < table->max_instances && table->store.present[iid];
+}
+
+int _anjay_table_store_init(const table_t *table, table_store_t *store) {
+    store->present = (bool *) avs_calloc(table->max_instances, sizeof(bool));
+    store->rows = (char *) avs_calloc(table->max_instances, table->row_size);
+    if (!store->present || !store->rows) {
+        table_log(ERROR, "Out of memory");
+        _anjay_table_store_free(store);
+        return -1;
+    }
+    return 0;
+}
+
+void _anjay_table_store_free(table_store_t *store) {
+    avs_free(store->present);
+    avs_free(store->rows);
+    store->present = NULL;
+    store->rows = NULL;
+}
+
+/**
+ * Shall be called before each change of the table contents. Within
+ * a transaction, the first call takes a snapshot of the whole store, so that
+ * it can be restored on rollback.
+ */
+static int begin_modification(table_t *table) {
+    if (table->in_transaction && !table->saved_store.present) {
+        if (_anjay_table_store_init(table, &table->saved_store)) {
+            return ANJAY_ERR_INTERNAL;
+        }
+        memcpy(table->saved_store.present, table->store.present,
+               table->max_instances * sizeof(bool));
+        memcpy(table->saved_store.rows, table->store.rows,
+               table->max_instances * table->row_size);
+    }
+    table->modified_since_persist = true;
+    return 0;
+}
+
+static int create_instance(table_t *table, anjay_iid_t *inout_iid) {
+    if (*inout_iid == ANJAY_IID_INVALID) {
+        anjay_iid_t iid = 0;
+        while (iid < table->max_instances && table->store.present[iid]) {
+            ++iid;
+        }
+        if (iid >= table->max_instances) {
+            table_log(ERROR, "No free Instance IDs in /%u", table->def.oid);
+            return ANJAY_ERR_INTERNAL;
+        }
+        *inout_iid = iid;
+    } else if (*inout_iid >= table->max_instances
+            || table->store.present[*inout_iid]) {
+        return ANJAY_ERR_BAD_REQUEST;
+    }
+    int result = begin_modification(table);
+    if (result) {
+        return result;
+    }
+    memset(table->store.rows + (size_t) *inout_iid * table->row_size, 0,
+           table->row_size);
+    table->store.present[*inout_iid] = true;
+    return 0;
+}
+
+static int remove_instance(table_t *table, anjay_iid_t iid) {
+    if (!instance_present(table, iid)) {
+        return ANJAY_ERR_NOT_FOUND;
+    }
+    int result = begin_modification(table);
+    if (!result) {
+        table->store.present[iid] = false;
+    }
+    return result;
+}
+
+static int table_instance_it(anjay_t *anjay,
+                             const anjay_dm_object_def_t *const *obj_ptr,
+                             anjay_iid_t *out,
+                             void **cookie) {
+    (void) anjay;
+    const table_t *table = get_table(obj_ptr);
+    // the cookie is the lowest Instance ID not yet returned
+    uintptr_t next = (uintptr_t) *cookie;
+    while (next < table->max_instances && !table->store.present[next]) {
+        ++next;
+    }
+    if (next < table->max_instances) {
+        *out = (anjay_iid_t) next;
+        *cookie = (void *) (next + 1);
+    } else {
+        *out = ANJAY_IID_INVALID;
+    }
+    return 0;
+}
+
+static int table_instance_present(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj_ptr,
+                                  anjay_iid_t iid) {
+    (void) anjay;
+    return instance_present(get_table(obj_ptr), iid);
+}
+
+static int table_instance_create(anjay_t *anjay,
+                                 const anjay_dm_object_def_t *const *obj_ptr,
+                                 anjay_iid_t *inout_iid,
+                                 anjay_ssid_t ssid) {
+    (void) anjay;
+    (void) ssid;
+    return create_instance(get_table(obj_ptr), inout_iid);
+}
+
+static int table_instance_remove(anjay_t *anjay,
+                                 const anjay_dm_object_def_t *const *obj_ptr,
+                                 anjay_iid_t iid) {
+    (void) anjay;
+    return remove_instance(get_table(obj_ptr), iid);
+}
+
+static int table_instance_reset(anjay_t *anjay,
+                                const anjay_dm_object_def_t *const *obj_ptr,
+                                anjay_iid_t iid) {
+    (void) anjay;
+    table_t *table = get_table(obj_ptr);
+    int result = begin_modification(table);
+    if (!result) {
+        memset(table->store.rows + (size_t) iid * table->row_size, 0,
+               table->row_size);
+    }
+    return result;
+}
+
+static int
+table_resource_operations(anjay_t *anjay,
+                          const anjay_dm_object_def_t *const *obj_ptr,
+                          anjay_rid_t rid,
+                          anjay_dm_resource_op_mask_t *out) {
+    (void) anjay;
+    const table_column_t *column = find_column(get_table(obj_ptr), rid);
+    *out = column ? column->def.operations : ANJAY_DM_RESOURCE_OP_NONE;
+    return 0;
+}
+
+static int ret_cell(anjay_output_ctx_t *ctx,
+                    const table_t *table,
+                    anjay_iid_t iid,
+                    const table_column_t *column) {
+    const char *cell = table_cell(table, &table->store, iid, column);
+    switch (column->def.type) {
+    case ANJAY_TABLE_COLUMN_I64:
+        return anjay_ret_i64(ctx, *(const int64_t *) cell);
+    case ANJAY_TABLE_COLUMN_DOUBLE:
+        return anjay_ret_double(ctx, *(const double *) cell);
+    case ANJAY_TABLE_COLUMN_BOOL:
+        return anjay_ret_bool(ctx, *(const bool *) cell);
+    case ANJAY_TABLE_COLUMN_STRING:
+        return anjay_ret_string(ctx, cell);
+    }
+    AVS_UNREACHABLE("invalid column type");
+    return ANJAY_ERR_INTERNAL;
+}
+
+static int table_resource_read(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    const table_t *table = get_table(obj_ptr);
+    const table_column_t *column = find_column(table, rid);
+    if (!column) {
+        return ANJAY_ERR_NOT_FOUND;
+    }
+    return ret_cell(ctx, table, iid, column);
+}
+
+static int table_instance_read(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    const table_t *table = get_table(obj_ptr);
+    for (size_t i = 0; i < table->column_count; ++i) {
+        const table_column_t *column = &table->columns[i];
+        if (!(column->def.operations & ANJAY_DM_RESOURCE_OP_BIT_R)) {
+            continue;
+        }
+        int result;
+        if ((result = anjay_ret_resource_id(ctx, column->def.rid))
+                || (result = ret_cell(ctx, table, iid, column))) {
+            return result;
+        }
+    }
+    return 0;
+}
+
+static int get_cell(anjay_input_ctx_t *ctx,
+                    const table_column_t *column,
+                    char *cell) {
+    switch (column->def.type) {
+    case ANJAY_TABLE_COLUMN_I64:
+        return anjay_get_i64(ctx, (int64_t *) cell);
+    case ANJAY_TABLE_COLUMN_DOUBLE:
+        return anjay_get_double(ctx, (double *) cell);
+    case ANJAY_TABLE_COLUMN_BOOL:
+        return anjay_get_bool(ctx, (bool *) cell);
+    case ANJAY_TABLE_COLUMN_STRING:
+        return anjay_get_string(ctx, cell, column->def.max_length);
+    }
+    AVS_UNREACHABLE("invalid column type");
+    return ANJAY_ERR_INTERNAL;
+}
+
+static int table_resource_write(anjay_t *anjay,
+                                const anjay_dm_object_def_t *const *obj_ptr,
+                                anjay_iid_t iid,
+                                anjay_rid_t rid,
+                                anjay_input_ctx_t *ctx) {
+    (void) anjay;
+    table_t *table = get_table(obj_ptr);
+    const table_column_t *column = find_column(table, rid);
+    if (!column) {
+        return ANJAY_ERR_NOT_FOUND;
+    }
+    int result = begin_modification(table);
+    if (result) {
+        return result;
+    }
+    // in case of failure, the previous value is restored by the rollback
+    if (get_cell(ctx, column, table_cell(table, &table->store, iid, column))) {
+        return ANJAY_ERR_BAD_REQUEST;
+    }
+    return 0;
+}
+
+static int table_transaction_begin(anjay_t *anjay,
+                                   const anjay_dm_object_def_t *const *obj_ptr) {
+    (void) anjay;
+    table_t *table = get_table(obj_ptr);
+    assert(!table->in_transaction);
+    assert(!table->saved_store.present);
+    table->in_transaction = true;
+    table->saved_modified_since_persist = table->modified_since_persist;
+    return 0;
+}
+
+static int
+table_transaction_commit(anjay_t *anjay,
+                         const anjay_dm_object_def_t *const *obj_ptr) {
+    (void) anjay;
+    table_t *table = get_table(obj_ptr);
+    _anjay_table_store_free(&table->saved_store);
+    table->in_transaction = false;
+    return 0;
+}
+
+static int
+table_transaction_rollback(anjay_t *anjay,
+                           const anjay_dm_object_def_t *const *obj_ptr) {
+    (void) anjay;
+    table_t *table = get_table(obj_ptr);
+    if (table->saved_store.present) {
+        _anjay_table_store_free(&table->store);
+        table->store = table->saved_store;
+        table->saved_store.present = NULL;
+        table->saved_store.rows = NULL;
+        table->modified_since_persist = table->saved_modified_since_persist;
+    }
+    table->in_transaction = false;
+    return 0;
+}
+
+static const anjay_dm_handlers_t TABLE_HANDLERS = {
+    .instance_it = table_instance_it,
+    .instance_present = table_instance_present,
+    .instance_create = table_instance_create,
+    .instance_remove = table_instance_remove,
+    .instance_reset = table_instance_reset,
+    .resource_present = anjay_dm_resource_present_TRUE,
+    .resource_operations = table_resource_operations,
+    .resource_read = table_resource_read,
+    .instance_read = table_instance_read,
+    .resource_write = table_resource_write,
+    .transaction_begin = table_transaction_begin,
+    .transaction_validate = anjay_dm_transaction_NOOP,
+    .transaction_commit = table_transaction_commit,
+    .transaction_rollback = table_transaction_rollback
+};
+
+table_t *_anjay_table_get(anjay_t *anjay, anjay_oid_t oid) {
+    assert(anjay);
+    const anjay_dm_object_def_t *const *obj_ptr =
+            _anjay_dm_find_object_by_oid(anjay, oid);
+    if (!obj_ptr || (*obj_ptr)->handlers.instance_it != table_instance_it) {
+        table_log(ERROR, "/%u is not a table Object", oid);
+        return NULL;
+    }
+    return get_table(obj_ptr);
+}
+
+static void table_cleanup(table_t *table) {
+    _anjay_table_store_free(&table->store);
+    _anjay_table_store_free(&table->saved_store);
+    avs_free(table->columns);
+    avs_free(table->rids);
+}
+
+static void registry_delete(anjay_t *anjay, void *registry_) {
+    (void) anjay;
+    table_registry_t *registry = (table_registry_t *) registry_;
+    AVS_LIST_CLEAR(&registry->tables) {
+        table_cleanup(registry->tables);
+    }
+    avs_free(registry);
+}
+
+static const anjay_dm_module_t TABLE_OBJECT_MODULE = {
+    .deleter = registry_delete
+};
+
+static table_registry_t *get_registry(anjay_t *anjay) {
+    table_registry_t *registry = (table_registry_t *)
+            _anjay_dm_module_get_arg(anjay, &TABLE_OBJECT_MODULE);
+    if (!registry) {
+        registry = (table_registry_t *) avs_calloc(1, sizeof(*registry));
+        if (!registry) {
+            table_log(ERROR, "Out of memory");
+            return NULL;
+        }
+        if (_anjay_dm_module_install(anjay, &TABLE_OBJECT_MODULE, registry)) {
+            avs_free(registry);
+            return NULL;
+        }
+    }
+    return registry;
+}
+
+static int validate_def(const anjay_table_object_def_t *def) {
+    if (!def->columns || !def->column_count) {
+        table_log(ERROR, "/%u: no columns defined", def->oid);
+        return -1;
+    }
+    if (!def->max_instances || def->max_instances == ANJAY_IID_INVALID) {
+        table_log(ERROR, "/%u: invalid max_instances", def->oid);
+        return -1;
+    }
+    for (size_t i = 0; i < def->column_count; ++i) {
+        const anjay_table_column_def_t *column = &def->columns[i];
+        if (i > 0 && column->rid <= def->columns[i - 1].rid) {
+            table_log(ERROR, "/%u: columns not sorted by Resource ID",
+                      def->oid);
+            return -1;
+        }
+        if (column->operations & ~(ANJAY_DM_RESOURCE_OP_BIT_R
+                                   | ANJAY_DM_RESOURCE_OP_BIT_W)) {
+            // there is no resource_execute handler
+            table_log(ERROR, "/%u/*/%u: only Read and Write operations are "
+                      "supported", def->oid, column->rid);
+            return -1;
+        }
+        if (column->type == ANJAY_TABLE_COLUMN_STRING && !column->max_length) {
+            table_log(ERROR, "/%u/*/%u: max_length not set", def->oid,
+                      column->rid);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static size_t column_size(const anjay_table_column_def_t *def) {
+    switch (def->type) {
+    case ANJAY_TABLE_COLUMN_I64:
+        return sizeof(int64_t);
+    case ANJAY_TABLE_COLUMN_DOUBLE:
+        return sizeof(double);
+    case ANJAY_TABLE_COLUMN_BOOL:
+        return sizeof(bool);
+    case ANJAY_TABLE_COLUMN_STRING:
+        return def->max_length;
+    }
+    return 0;
+}
+
+static int table_init(table_t *table, const anjay_table_object_def_t *def) {
+    table->columns = (table_column_t *)
+            avs_calloc(def->column_count, sizeof(table_column_t));
+    table->rids = (uint16_t *) avs_calloc(def->column_count, sizeof(uint16_t));
+    if (!table->columns || !table->rids) {
+        table_log(ERROR, "Out of memory");
+        return -1;
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < def->column_count; ++i) {
+        size_t size = column_size(&def->columns[i]);
+        if (!size) {
+            table_log(ERROR, "/%u/*/%u: invalid column type", def->oid,
+                      def->columns[i].rid);
+            return -1;
+        }
+        table->columns[i].def = def->columns[i];
+        table->columns[i].offset = align_cell_offset(offset);
+        table->rids[i] = def->columns[i].rid;
+        offset = table->columns[i].offset + size;
+    }
+    table->column_count = def->column_count;
+    table->row_size = align_cell_offset(offset);
+    table->max_instances = def->max_instances;
+    if (table->row_size > SIZE_MAX / table->max_instances) {
+        table_log(ERROR, "/%u: table too large", def->oid);
+        return -1;
+    }
+
+    table->def.oid = def->oid;
+    table->def.version = def->version;
+    table->def.supported_rids.count = def->column_count;
+    table->def.supported_rids.rids = table->rids;
+    table->def.handlers = TABLE_HANDLERS;
+    table->def_ptr = &table->def;
+    return _anjay_table_store_init(table, &table->store);
+}
+
+int anjay_table_object_install(anjay_t *anjay,
+                               const anjay_table_object_def_t *def) {
+    assert(anjay);
+    assert(def);
+    if (validate_def(def)) {
+        return -1;
+    }
+    table_registry_t *registry = get_registry(anjay);
+    if (!registry) {
+        return -1;
+    }
+    AVS_LIST(table_t) table = AVS_LIST_NEW_ELEMENT(table_t);
+    if (!table) {
+        table_log(ERROR, "Out of memory");
+        return -1;
+    }
+    if (table_init(table, def) || anjay_register_object(anjay, &table->def_ptr)) {
+        table_cleanup(table);
+        AVS_LIST_DELETE(&table);
+        return -1;
+    }
+    AVS_LIST_INSERT(&registry->tables, table);
+    return 0;
+}
+
+int anjay_table_object_add_instance(anjay_t *anjay,
+                                    anjay_oid_t oid,
+                                    anjay_iid_t *inout_iid) {
+    table_t *table = _anjay_table_get(anjay, oid);
+    if (!table) {
+        return -1;
+    }
+    int result = create_instance(table, inout_iid);
+    if (!result) {
+        (void) anjay_notify_instances_changed(anjay, oid);
+    }
+    return result;
+}
+
+int anjay_table_object_remove_instance(anjay_t *anjay,
+                                       anjay_oid_t oid,
+                                       anjay_iid_t iid) {
+    table_t *table = _anjay_table_get(anjay, oid);
+    if (!table) {
+        return -1;
+    }
+    int result = remove_instance(table, iid);
+    if (!result) {
+        (void) anjay_notify_instances_changed(anjay, oid);
+    }
+    return result;
+}
+
+typedef struct {
+    table_t *table;
+    const table_column_t *column;
+    char *cell;
+} cell_ref_t;
+
+static int find_cell(anjay_t *anjay,
+                     anjay_oid_t oid,
+                     anjay_iid_t iid,
+                     anjay_rid_t rid,
+                     anjay_table_column_type_t type,
+                     cell_ref_t *out_ref) {
+    if (!(out_ref->table = _anjay_table_get(anjay, oid))) {
+        return -1;
+    }
+    if (!instance_present(out_ref->table, iid)) {
+        table_log(ERROR, "/%u/%u does not exist", oid, iid);
+        return -1;
+    }
+    out_ref->column = find_column(out_ref->table, rid);
+    if (!out_ref->column || out_ref->column->def.type != type) {
+        table_log(ERROR, "/%u/%u/%u does not exist or has a different type",
+                  oid, iid, rid);
+        return -1;
+    }
+    out_ref->cell = table_cell(out_ref->table, &out_ref->table->store, iid,
+                               out_ref->column);
+    return 0;
+}
+
+#define DEF_ACCESSORS(Name, Type, ColumnType) \
+int anjay_table_object_set_##Name(anjay_t *anjay, \
+                                  anjay_oid_t oid, \
+                                  anjay_iid_t iid, \
+                                  anjay_rid_t rid, \
+                                  Type value) { \
+    cell_ref_t ref; \
+    int result = find_cell(anjay, oid, iid, rid, ColumnType, &ref); \
+    if (!result && !(result = begin_modification(ref.table))) { \
+        *(Type *) ref.cell = value; \
+        (void) anjay_notify_changed(anjay, oid, iid, rid); \
+    } \
+    return result; \
+} \
+\
+int anjay_table_object_get_##Name(anjay_t *anjay, \
+                                  anjay_oid_t oid, \
+                                  anjay_iid_t iid, \
+                                  anjay_rid_t rid, \
+                                  Type *out_value) { \
+    cell_ref_t ref; \
+    int result = find_cell(anjay, oid, iid, rid, ColumnType, &ref); \
+    if (!result) { \
+        *out_value = *(const Type *) ref.cell; \
+    } \
+    return result; \
+}
+
+DEF_ACCESSORS(i64, int64_t, ANJAY_TABLE_COLUMN_I64)
+DEF_ACCESSORS(double, double, ANJAY_TABLE_COLUMN_DOUBLE)
+DEF_ACCESSORS(bool, bool, ANJAY_TABLE_COLUMN_BOOL)
+
+int anjay_table_object_set_string(anjay_t *anjay,
+                                  anjay_oid_t oid,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  const char *value) {
+    cell_ref_t ref;
+    int result = find_cell(anjay, oid, iid, rid, ANJAY_TABLE_COLUMN_STRING,
+                           &ref);
+    if (result) {
+        return result;
+    }
+    size_t size = strlen(value) + 1;
+    if (size > ref.column->def.max_length) {
+        table_log(ERROR, "value too long for /%u/%u/%u", oid, iid, rid);
+        return -1;
+    }
+    if (!(result = begin_modification(ref.table))) {
+        memcpy(ref.cell, value, size);
+        (void) anjay_notify_changed(anjay, oid, iid, rid);
+    }
+    return result;
+}
+
+int anjay_table_object_get_string(anjay_t *anjay,
+                                  anjay_oid_t oid,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  char *out_buf,
+                                  size_t buf_size) {
+    cell_ref_t ref;
+    int result = find_cell(anjay, oid, iid, rid, ANJAY_TABLE_COLUMN_STRING,
+                           &ref);
+    if (result) {
+        return result;
+    }
+    size_t size = strlen(ref.cell) + 1;
+    if (size > buf_size) {
+        return ANJAY_BUFFER_TOO_SHORT;
+    }
+    memcpy(out_buf, ref.cell, size);
+    return 0;
+}
+
+bool anjay_table_object_is_modified(anjay_t *anjay, anjay_oid_t oid) {
+    table_t *table = _anjay_table_get(anjay, oid);
+    return table && table->modified_since_persist;
+}
+
+#ifdef ANJAY_TEST
+#include "test/api.c"
+#endif
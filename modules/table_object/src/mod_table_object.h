@@ -0,0 +1,86 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TABLE_OBJECT_MOD_TABLE_OBJECT_H
+#define TABLE_OBJECT_MOD_TABLE_OBJECT_H
+#include <anjay_config.h>
+
+#include <anjay/core.h>
+#include <anjay/table_object.h>
+
+#include <anjay_modules/utils_core.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+typedef struct {
+    anjay_table_column_def_t def;
+    /** Offset of the value within a row */
+    size_t offset;
+} table_column_t;
+
+/**
+ * Contents of a table Object: a presence flag and a fixed-size row of values
+ * for each possible Instance ID.
+ */
+typedef struct {
+    bool *present;
+    char *rows;
+} table_store_t;
+
+typedef struct {
+    /** Pointer registered in the data model; points to <c>def</c> */
+    const anjay_dm_object_def_t *def_ptr;
+    anjay_dm_object_def_t def;
+    uint16_t *rids;
+
+    table_column_t *columns;
+    size_t column_count;
+    size_t row_size;
+    anjay_iid_t max_instances;
+
+    table_store_t store;
+
+    bool in_transaction;
+    /**
+     * Copy of <c>store</c> taken before the first modification within the
+     * current transaction, if any.
+     */
+    table_store_t saved_store;
+    bool saved_modified_since_persist;
+    bool modified_since_persist;
+} table_t;
+
+typedef struct {
+    AVS_LIST(table_t) tables;
+} table_registry_t;
+
+table_t *_anjay_table_get(anjay_t *anjay, anjay_oid_t oid);
+
+int _anjay_table_store_init(const table_t *table, table_store_t *store);
+void _anjay_table_store_free(table_store_t *store);
+
+static inline char *table_cell(const table_t *table,
+                               const table_store_t *store,
+                               anjay_iid_t iid,
+                               const table_column_t *column) {
+    return store->rows + (size_t) iid * table->row_size + column->offset;
+}
+
+#define table_log(level, ...) _anjay_log(table_object, level, __VA_ARGS__)
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* TABLE_OBJECT_MOD_TABLE_OBJECT_H */
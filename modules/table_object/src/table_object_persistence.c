@@ -0,0 +1,256 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#ifdef WITH_AVS_PERSISTENCE
+#include <avsystem/commons/persistence.h>
+#endif // WITH_AVS_PERSISTENCE
+
+#include <anjay_modules/dm_utils.h>
+#include <anjay_modules/utils_core.h>
+
+#include <string.h>
+#include <inttypes.h>
+
+#include "mod_table_object.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#define persistence_log(level, ...) \
+    _anjay_log(table_object_persistence, level, __VA_ARGS__)
+
+#ifdef WITH_AVS_PERSISTENCE
+
+static const char MAGIC[] = { 'T', 'B', 'L', '\0' };
+
+/**
+ * Stores the column layout, or verifies that the stored one matches the
+ * table, so that data is never restored into an incompatible Object.
+ */
+static int handle_schema(avs_persistence_context_t *ctx, const table_t *table) {
+    uint16_t oid = table->def.oid;
+    uint16_t column_count = (uint16_t) table->column_count;
+    int retval = 0;
+    if ((retval = avs_persistence_u16(ctx, &oid))
+            || (retval = avs_persistence_u16(ctx, &column_count))) {
+        return retval;
+    }
+    if (oid != table->def.oid || column_count != table->column_count) {
+        persistence_log(ERROR, "Stored table layout does not match /%u",
+                        table->def.oid);
+        return -1;
+    }
+    for (size_t i = 0; i < table->column_count; ++i) {
+        const anjay_table_column_def_t *column = &table->columns[i].def;
+        uint16_t rid = column->rid;
+        uint16_t type = (uint16_t) column->type;
+        uint32_t max_length = (uint32_t) column->max_length;
+        if ((retval = avs_persistence_u16(ctx, &rid))
+                || (retval = avs_persistence_u16(ctx, &type))
+                || (retval = avs_persistence_u32(ctx, &max_length))) {
+            return retval;
+        }
+        if (rid != column->rid || type != (uint16_t) column->type
+                || (column->type == ANJAY_TABLE_COLUMN_STRING
+                    && max_length != column->max_length)) {
+            persistence_log(ERROR, "Stored table layout does not match /%u",
+                            table->def.oid);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int handle_i64(avs_persistence_context_t *ctx, int64_t *value) {
+    uint32_t high = (uint32_t) ((uint64_t) *value >> 32);
+    uint32_t low = (uint32_t) (uint64_t) *value;
+    int retval = 0;
+    (void) ((retval = avs_persistence_u32(ctx, &high))
+            || (retval = avs_persistence_u32(ctx, &low)));
+    if (!retval) {
+        *value = (int64_t) (((uint64_t) high << 32) | low);
+    }
+    return retval;
+}
+
+static int handle_row(avs_persistence_context_t *ctx,
+                      const table_t *table,
+                      const table_store_t *store,
+                      anjay_iid_t iid) {
+    int retval = 0;
+    for (size_t i = 0; !retval && i < table->column_count; ++i) {
+        const table_column_t *column = &table->columns[i];
+        char *cell = table_cell(table, store, iid, column);
+        switch (column->def.type) {
+        case ANJAY_TABLE_COLUMN_I64:
+            retval = handle_i64(ctx, (int64_t *) cell);
+            break;
+        case ANJAY_TABLE_COLUMN_DOUBLE:
+            retval = avs_persistence_double(ctx, (double *) cell);
+            break;
+        case ANJAY_TABLE_COLUMN_BOOL:
+            retval = avs_persistence_bool(ctx, (bool *) cell);
+            break;
+        case ANJAY_TABLE_COLUMN_STRING:
+            retval = avs_persistence_bytes(ctx, cell, column->def.max_length);
+            // never trust the stream to contain a terminated string
+            cell[column->def.max_length - 1] = '\0';
+            break;
+        }
+    }
+    return retval;
+}
+
+static int persist_rows(avs_persistence_context_t *ctx, const table_t *table) {
+    uint16_t count = 0;
+    for (anjay_iid_t iid = 0; iid < table->max_instances; ++iid) {
+        count = (uint16_t) (count + table->store.present[iid]);
+    }
+    int retval = avs_persistence_u16(ctx, &count);
+    for (anjay_iid_t iid = 0; !retval && iid < table->max_instances; ++iid) {
+        if (table->store.present[iid]) {
+            uint16_t stored_iid = iid;
+            (void) ((retval = avs_persistence_u16(ctx, &stored_iid))
+                    || (retval = handle_row(ctx, table, &table->store, iid)));
+        }
+    }
+    return retval;
+}
+
+static int restore_rows(avs_persistence_context_t *ctx,
+                        const table_t *table,
+                        table_store_t *store) {
+    uint16_t count;
+    int retval = avs_persistence_u16(ctx, &count);
+    for (uint16_t i = 0; !retval && i < count; ++i) {
+        uint16_t iid;
+        if ((retval = avs_persistence_u16(ctx, &iid))) {
+            break;
+        }
+        if (iid >= table->max_instances || store->present[iid]) {
+            persistence_log(ERROR, "Invalid or duplicate Instance ID: %" PRIu16,
+                            iid);
+            return -1;
+        }
+        store->present[iid] = true;
+        retval = handle_row(ctx, table, store, iid);
+    }
+    return retval;
+}
+
+int anjay_table_object_persist(anjay_t *anjay,
+                               anjay_oid_t oid,
+                               avs_stream_abstract_t *out_stream) {
+    assert(anjay);
+
+    table_t *table = _anjay_table_get(anjay, oid);
+    if (!table) {
+        return -1;
+    }
+    int retval = avs_stream_write(out_stream, MAGIC, sizeof(MAGIC));
+    if (retval) {
+        return retval;
+    }
+    avs_persistence_context_t *ctx =
+            avs_persistence_store_context_new(out_stream);
+    if (!ctx) {
+        persistence_log(ERROR, "Out of memory");
+        return -1;
+    }
+    (void) ((retval = handle_schema(ctx, table))
+            || (retval = persist_rows(ctx, table)));
+    avs_persistence_context_delete(ctx);
+    if (!retval) {
+        table->modified_since_persist = false;
+        persistence_log(INFO, "Table Object /%u state persisted", oid);
+    }
+    return retval;
+}
+
+int anjay_table_object_restore(anjay_t *anjay,
+                               anjay_oid_t oid,
+                               avs_stream_abstract_t *in_stream) {
+    assert(anjay);
+
+    table_t *table = _anjay_table_get(anjay, oid);
+    if (!table) {
+        return -1;
+    }
+
+    char magic_header[sizeof(MAGIC)];
+    int retval = avs_stream_read_reliably(in_stream, magic_header,
+                                          sizeof(magic_header));
+    if (retval) {
+        persistence_log(ERROR, "Could not read table Object header");
+        return retval;
+    }
+
+    if (memcmp(magic_header, MAGIC, sizeof(MAGIC))) {
+        persistence_log(ERROR, "Header magic constant mismatch");
+        return -1;
+    }
+    avs_persistence_context_t *restore_ctx =
+            avs_persistence_restore_context_new(in_stream);
+    if (!restore_ctx) {
+        persistence_log(ERROR, "Cannot create persistence restore context");
+        return -1;
+    }
+    table_store_t restored;
+    if (_anjay_table_store_init(table, &restored)) {
+        avs_persistence_context_delete(restore_ctx);
+        return -1;
+    }
+    (void) ((retval = handle_schema(restore_ctx, table))
+            || (retval = restore_rows(restore_ctx, table, &restored)));
+    if (retval) {
+        _anjay_table_store_free(&restored);
+    } else {
+        _anjay_table_store_free(&table->store);
+        _anjay_table_store_free(&table->saved_store);
+        table->store = restored;
+    }
+    avs_persistence_context_delete(restore_ctx);
+    if (!retval) {
+        table->modified_since_persist = false;
+        persistence_log(INFO, "Table Object /%u state restored", oid);
+    }
+    return retval;
+}
+
+#ifdef ANJAY_TEST
+#include "test/persistence.c"
+#endif
+
+#else // WITH_AVS_PERSISTENCE
+
+int anjay_table_object_persist(anjay_t *anjay,
+                               anjay_oid_t oid,
+                               avs_stream_abstract_t *out_stream) {
+    (void) anjay; (void) oid; (void) out_stream;
+    persistence_log(ERROR, "Persistence not compiled in");
+    return -1;
+}
+
+int anjay_table_object_restore(anjay_t *anjay,
+                               anjay_oid_t oid,
+                               avs_stream_abstract_t *in_stream) {
+    (void) anjay; (void) oid; (void) in_stream;
+    persistence_log(ERROR, "Persistence not compiled in");
+    return -1;
+}
+
+#endif // WITH_AVS_PERSISTENCE
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/unit/test.h>
+
+#include <anjay_test/utils.h>
+
+static const anjay_configuration_t CONFIG = {
+    .endpoint_name = "test"
+};
+
+#define TEST_OID 1234
+
+static const anjay_table_column_def_t TEST_COLUMNS[] = {
+    { 0, ANJAY_TABLE_COLUMN_I64,
+      ANJAY_DM_RESOURCE_OP_BIT_R | ANJAY_DM_RESOURCE_OP_BIT_W, 0 },
+    { 1, ANJAY_TABLE_COLUMN_DOUBLE, ANJAY_DM_RESOURCE_OP_BIT_R, 0 },
+    { 2, ANJAY_TABLE_COLUMN_BOOL,
+      ANJAY_DM_RESOURCE_OP_BIT_R | ANJAY_DM_RESOURCE_OP_BIT_W, 0 },
+    { 5, ANJAY_TABLE_COLUMN_STRING,
+      ANJAY_DM_RESOURCE_OP_BIT_R | ANJAY_DM_RESOURCE_OP_BIT_W, 8 }
+};
+
+static const anjay_table_object_def_t TEST_DEF = {
+    .oid = TEST_OID,
+    .columns = TEST_COLUMNS,
+    .column_count = AVS_ARRAY_SIZE(TEST_COLUMNS),
+    .max_instances = 4
+};
+
+typedef struct {
+    anjay_t *anjay;
+} table_test_env_t;
+
+#define SCOPED_TABLE_TEST_ENV(Name)                      \
+    SCOPED_PTR(table_test_env_t, table_test_env_destroy) \
+    Name = table_test_env_create();
+
+static table_test_env_t *table_test_env_create(void) {
+    table_test_env_t *env = (__typeof__(env)) avs_calloc(1, sizeof(*env));
+    AVS_UNIT_ASSERT_NOT_NULL(env);
+    env->anjay = anjay_new(&CONFIG);
+    AVS_UNIT_ASSERT_NOT_NULL(env->anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_install(env->anjay, &TEST_DEF));
+    return env;
+}
+
+static void table_test_env_destroy(table_test_env_t **env) {
+    anjay_delete((*env)->anjay);
+    avs_free(*env);
+}
+
+AVS_UNIT_TEST(table_object_api, install) {
+    SCOPED_TABLE_TEST_ENV(env);
+    // same Object ID twice
+    AVS_UNIT_ASSERT_FAILED(anjay_table_object_install(env->anjay, &TEST_DEF));
+
+    anjay_table_object_def_t def = TEST_DEF;
+    def.oid = TEST_OID + 1;
+    def.max_instances = 0;
+    AVS_UNIT_ASSERT_FAILED(anjay_table_object_install(env->anjay, &def));
+
+    static const anjay_table_column_def_t UNSORTED[] = {
+        { 1, ANJAY_TABLE_COLUMN_I64, ANJAY_DM_RESOURCE_OP_BIT_R, 0 },
+        { 1, ANJAY_TABLE_COLUMN_BOOL, ANJAY_DM_RESOURCE_OP_BIT_R, 0 }
+    };
+    def.max_instances = 1;
+    def.columns = UNSORTED;
+    def.column_count = AVS_ARRAY_SIZE(UNSORTED);
+    AVS_UNIT_ASSERT_FAILED(anjay_table_object_install(env->anjay, &def));
+
+    static const anjay_table_column_def_t EXECUTABLE[] = {
+        { 1, ANJAY_TABLE_COLUMN_I64,
+          ANJAY_DM_RESOURCE_OP_BIT_R | ANJAY_DM_RESOURCE_OP_BIT_E, 0 }
+    };
+    def.columns = EXECUTABLE;
+    def.column_count = AVS_ARRAY_SIZE(EXECUTABLE);
+    AVS_UNIT_ASSERT_FAILED(anjay_table_object_install(env->anjay, &def));
+
+    def.columns = TEST_COLUMNS;
+    def.column_count = AVS_ARRAY_SIZE(TEST_COLUMNS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_install(env->anjay, &def));
+    AVS_UNIT_ASSERT_NOT_NULL(_anjay_table_get(env->anjay, TEST_OID + 1));
+}
+
+AVS_UNIT_TEST(table_object_api, add_remove_instances) {
+    SCOPED_TABLE_TEST_ENV(env);
+    anjay_iid_t iid = 2;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_add_instance(env->anjay, TEST_OID, &iid));
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_table_object_add_instance(env->anjay, TEST_OID, &iid));
+    iid = 4;
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_table_object_add_instance(env->anjay, TEST_OID, &iid));
+
+    // automatic allocation picks the lowest free Instance IDs
+    static const anjay_iid_t EXPECTED_IIDS[] = { 0, 1, 3 };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(EXPECTED_IIDS); ++i) {
+        iid = ANJAY_IID_INVALID;
+        AVS_UNIT_ASSERT_SUCCESS(
+                anjay_table_object_add_instance(env->anjay, TEST_OID, &iid));
+        AVS_UNIT_ASSERT_EQUAL(iid, EXPECTED_IIDS[i]);
+    }
+    iid = ANJAY_IID_INVALID;
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_table_object_add_instance(env->anjay, TEST_OID, &iid));
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_remove_instance(env->anjay, TEST_OID, 1));
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_table_object_remove_instance(env->anjay, TEST_OID, 1));
+
+    const anjay_dm_object_def_t *const *obj =
+            _anjay_dm_find_object_by_oid(env->anjay, TEST_OID);
+    AVS_UNIT_ASSERT_NOT_NULL(obj);
+    void *cookie = NULL;
+    static const anjay_iid_t ITERATED_IIDS[] = { 0, 2, 3, ANJAY_IID_INVALID };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(ITERATED_IIDS); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(
+                table_instance_it(env->anjay, obj, &iid, &cookie));
+        AVS_UNIT_ASSERT_EQUAL(iid, ITERATED_IIDS[i]);
+    }
+    AVS_UNIT_ASSERT_FALSE(table_instance_present(env->anjay, obj, 1));
+    AVS_UNIT_ASSERT_TRUE(table_instance_present(env->anjay, obj, 2));
+    AVS_UNIT_ASSERT_FALSE(
+            table_instance_present(env->anjay, obj, ANJAY_IID_INVALID));
+}
+
+AVS_UNIT_TEST(table_object_api, set_get) {
+    SCOPED_TABLE_TEST_ENV(env);
+    anjay_iid_t iid = ANJAY_IID_INVALID;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_add_instance(env->anjay, TEST_OID, &iid));
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_set_i64(env->anjay, TEST_OID, iid, 0, -42));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_set_double(env->anjay, TEST_OID, iid, 1, 2.5));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_set_bool(env->anjay, TEST_OID, iid, 2, true));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_set_string(
+            env->anjay, TEST_OID, iid, 5, "1234567"));
+
+    int64_t i64;
+    double d;
+    bool b;
+    char buf[8];
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_get_i64(env->anjay, TEST_OID, iid, 0, &i64));
+    AVS_UNIT_ASSERT_EQUAL(i64, -42);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_get_double(env->anjay, TEST_OID, iid, 1, &d));
+    AVS_UNIT_ASSERT_EQUAL(d, 2.5);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_get_bool(env->anjay, TEST_OID, iid, 2, &b));
+    AVS_UNIT_ASSERT_TRUE(b);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_get_string(
+            env->anjay, TEST_OID, iid, 5, buf, sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, "1234567");
+    AVS_UNIT_ASSERT_EQUAL(anjay_table_object_get_string(env->anjay, TEST_OID,
+                                                        iid, 5, buf, 4),
+                          ANJAY_BUFFER_TOO_SHORT);
+
+    // string too long for the column
+    AVS_UNIT_ASSERT_FAILED(anjay_table_object_set_string(
+            env->anjay, TEST_OID, iid, 5, "12345678"));
+    // type mismatch, nonexistent Resource and Instance
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_table_object_set_i64(env->anjay, TEST_OID, iid, 1, 1));
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_table_object_set_i64(env->anjay, TEST_OID, iid, 3, 1));
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_table_object_set_i64(env->anjay, TEST_OID, 3, 0, 1));
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_table_object_set_i64(env->anjay, TEST_OID + 1, iid, 0, 1));
+}
+
+AVS_UNIT_TEST(table_object_api, transaction_rollback) {
+    SCOPED_TABLE_TEST_ENV(env);
+    anjay_iid_t iid = 0;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_add_instance(env->anjay, TEST_OID, &iid));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_set_i64(env->anjay, TEST_OID, iid, 0, 7));
+    table_t *table = _anjay_table_get(env->anjay, TEST_OID);
+    table->modified_since_persist = false;
+
+    const anjay_dm_object_def_t *const *obj = &table->def_ptr;
+    AVS_UNIT_ASSERT_SUCCESS(table_transaction_begin(env->anjay, obj));
+    // no snapshot is taken until something is actually modified
+    AVS_UNIT_ASSERT_NULL(table->saved_store.present);
+    anjay_iid_t new_iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(
+            table_instance_create(env->anjay, obj, &new_iid, 1));
+    AVS_UNIT_ASSERT_SUCCESS(table_instance_reset(env->anjay, obj, iid));
+    AVS_UNIT_ASSERT_NOT_NULL(table->saved_store.present);
+    AVS_UNIT_ASSERT_SUCCESS(table_transaction_rollback(env->anjay, obj));
+
+    AVS_UNIT_ASSERT_FALSE(table_instance_present(env->anjay, obj, new_iid));
+    int64_t value;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_get_i64(env->anjay, TEST_OID, iid, 0, &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 7);
+    AVS_UNIT_ASSERT_FALSE(anjay_table_object_is_modified(env->anjay, TEST_OID));
+}
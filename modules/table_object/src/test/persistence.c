@@ -0,0 +1,154 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/stream.h>
+#include <avsystem/commons/stream/stream_membuf.h>
+#include <avsystem/commons/unit/test.h>
+
+#include <anjay_test/utils.h>
+
+static const anjay_configuration_t CONFIG = {
+    .endpoint_name = "test"
+};
+
+#define TEST_OID 1234
+
+static const anjay_table_column_def_t TEST_COLUMNS[] = {
+    { 0, ANJAY_TABLE_COLUMN_I64, ANJAY_DM_RESOURCE_OP_BIT_R, 0 },
+    { 1, ANJAY_TABLE_COLUMN_DOUBLE, ANJAY_DM_RESOURCE_OP_BIT_R, 0 },
+    { 2, ANJAY_TABLE_COLUMN_BOOL, ANJAY_DM_RESOURCE_OP_BIT_R, 0 },
+    { 3, ANJAY_TABLE_COLUMN_STRING, ANJAY_DM_RESOURCE_OP_BIT_R, 16 }
+};
+
+static const anjay_table_object_def_t TEST_DEF = {
+    .oid = TEST_OID,
+    .columns = TEST_COLUMNS,
+    .column_count = AVS_ARRAY_SIZE(TEST_COLUMNS),
+    .max_instances = 8
+};
+
+typedef struct {
+    anjay_t *anjay_stored;
+    anjay_t *anjay_restored;
+    avs_stream_abstract_t *stream;
+} table_persistence_test_env_t;
+
+#define SCOPED_TABLE_PERSISTENCE_TEST_ENV(Name)    \
+    SCOPED_PTR(table_persistence_test_env_t,       \
+               table_persistence_test_env_destroy) \
+    Name = table_persistence_test_env_create();
+
+static table_persistence_test_env_t *table_persistence_test_env_create(void) {
+    table_persistence_test_env_t *env =
+            (__typeof__(env)) avs_calloc(1, sizeof(*env));
+    AVS_UNIT_ASSERT_NOT_NULL(env);
+    env->anjay_stored = anjay_new(&CONFIG);
+    AVS_UNIT_ASSERT_NOT_NULL(env->anjay_stored);
+    env->anjay_restored = anjay_new(&CONFIG);
+    AVS_UNIT_ASSERT_NOT_NULL(env->anjay_restored);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_install(env->anjay_stored, &TEST_DEF));
+    env->stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(env->stream);
+    return env;
+}
+
+static void
+table_persistence_test_env_destroy(table_persistence_test_env_t **env) {
+    anjay_delete((*env)->anjay_stored);
+    anjay_delete((*env)->anjay_restored);
+    avs_stream_cleanup(&(*env)->stream);
+    avs_free(*env);
+}
+
+AVS_UNIT_TEST(table_object_persistence, roundtrip) {
+    SCOPED_TABLE_PERSISTENCE_TEST_ENV(env);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_install(env->anjay_restored, &TEST_DEF));
+    for (anjay_iid_t iid = 1; iid < 8; iid = (anjay_iid_t) (iid + 3)) {
+        AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_add_instance(
+                env->anjay_stored, TEST_OID, &iid));
+        AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_set_i64(
+                env->anjay_stored, TEST_OID, iid, 0, INT64_MIN + iid));
+        AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_set_double(
+                env->anjay_stored, TEST_OID, iid, 1, iid * 0.5));
+        AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_set_bool(
+                env->anjay_stored, TEST_OID, iid, 2, iid % 2));
+        AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_set_string(
+                env->anjay_stored, TEST_OID, iid, 3, "value"));
+    }
+    AVS_UNIT_ASSERT_TRUE(
+            anjay_table_object_is_modified(env->anjay_stored, TEST_OID));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_persist(env->anjay_stored,
+                                                       TEST_OID, env->stream));
+    AVS_UNIT_ASSERT_FALSE(
+            anjay_table_object_is_modified(env->anjay_stored, TEST_OID));
+
+    // pre-existing Instances are replaced
+    anjay_iid_t iid = 0;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_add_instance(env->anjay_restored, TEST_OID,
+                                            &iid));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_restore(env->anjay_restored,
+                                                       TEST_OID, env->stream));
+    AVS_UNIT_ASSERT_FALSE(
+            anjay_table_object_is_modified(env->anjay_restored, TEST_OID));
+
+    const table_t *stored = _anjay_table_get(env->anjay_stored, TEST_OID);
+    const table_t *restored = _anjay_table_get(env->anjay_restored, TEST_OID);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(restored->store.present,
+                                      stored->store.present,
+                                      TEST_DEF.max_instances * sizeof(bool));
+    for (anjay_iid_t i = 0; i < TEST_DEF.max_instances; ++i) {
+        if (!stored->store.present[i]) {
+            continue;
+        }
+        int64_t i64;
+        AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_get_i64(
+                env->anjay_restored, TEST_OID, i, 0, &i64));
+        AVS_UNIT_ASSERT_EQUAL(i64, INT64_MIN + i);
+        char buf[16];
+        AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_get_string(
+                env->anjay_restored, TEST_OID, i, 3, buf, sizeof(buf)));
+        AVS_UNIT_ASSERT_EQUAL_STRING(buf, "value");
+    }
+}
+
+AVS_UNIT_TEST(table_object_persistence, layout_mismatch) {
+    SCOPED_TABLE_PERSISTENCE_TEST_ENV(env);
+    static const anjay_table_column_def_t OTHER_COLUMNS[] = {
+        { 0, ANJAY_TABLE_COLUMN_I64, ANJAY_DM_RESOURCE_OP_BIT_R, 0 },
+        { 1, ANJAY_TABLE_COLUMN_DOUBLE, ANJAY_DM_RESOURCE_OP_BIT_R, 0 },
+        { 2, ANJAY_TABLE_COLUMN_BOOL, ANJAY_DM_RESOURCE_OP_BIT_R, 0 },
+        { 3, ANJAY_TABLE_COLUMN_STRING, ANJAY_DM_RESOURCE_OP_BIT_R, 32 }
+    };
+    anjay_table_object_def_t def = TEST_DEF;
+    def.columns = OTHER_COLUMNS;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_install(env->anjay_restored, &def));
+    anjay_iid_t iid = 0;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_table_object_add_instance(env->anjay_restored, TEST_OID,
+                                            &iid));
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_table_object_persist(env->anjay_stored,
+                                                       TEST_OID, env->stream));
+    AVS_UNIT_ASSERT_FAILED(anjay_table_object_restore(env->anjay_restored,
+                                                      TEST_OID, env->stream));
+    // the Object is left untouched
+    const table_t *restored = _anjay_table_get(env->anjay_restored, TEST_OID);
+    AVS_UNIT_ASSERT_TRUE(restored->store.present[iid]);
+}
@@ -237,6 +237,7 @@ bool _anjay_access_control_action_allowed(anjay_t *anjay,
     anjay_access_mask_t mask = access_control_mask(anjay, info);
     switch (info->action) {
     case ANJAY_ACTION_READ:
+    case ANJAY_ACTION_READ_COMPOSITE:
     case ANJAY_ACTION_DISCOVER:
         return mask & ANJAY_ACCESS_MASK_READ;
     case ANJAY_ACTION_WRITE:
@@ -112,8 +112,14 @@ static int init(anjay_t *anjay,
         return -1;
     }
 
-    if (_anjay_observe_init(&anjay->observe,
-                            config->confirmable_notifications)) {
+    if (_anjay_observe_init(
+                &anjay->observe, anjay->sched,
+                config->confirmable_notifications,
+                &(const anjay_observe_store_config_t) {
+                    .memory_limit = config->stored_notifications_limit,
+                    .spill_path = config->stored_notifications_spill_path,
+                    .coalesce = config->coalesce_stored_notifications
+                })) {
         return -1;
     }
 
@@ -183,6 +189,9 @@ static void anjay_delete_impl(anjay_t *anjay, bool deregister) {
     // we want to clear this now so that notifications won't be sent during
     // _anjay_sched_delete()
     _anjay_observe_cleanup(&anjay->observe, anjay->sched);
+#ifdef WITH_SEND
+    _anjay_send_cleanup(&anjay->send, anjay->sched);
+#endif // WITH_SEND
 
     _anjay_sched_del(anjay->sched, &anjay->reload_servers_sched_job_handle);
     _anjay_sched_del(anjay->sched, &anjay->scheduled_notify.handle);
@@ -364,6 +373,7 @@ static int parse_attributes(const avs_coap_msg_t *msg,
 static const char *action_to_string(anjay_request_action_t action) {
     switch (action) {
     case ANJAY_ACTION_READ:             return "Read";
+    case ANJAY_ACTION_READ_COMPOSITE:   return "Read-Composite";
     case ANJAY_ACTION_DISCOVER:         return "Discover";
     case ANJAY_ACTION_WRITE:            return "Write";
     case ANJAY_ACTION_WRITE_UPDATE:     return "Write (Update)";
@@ -420,6 +430,9 @@ static int code_to_action(uint8_t code,
     case AVS_COAP_CODE_DELETE:
         *out_action = ANJAY_ACTION_DELETE;
         return 0;
+    case ANJAY_COAP_CODE_FETCH:
+        *out_action = ANJAY_ACTION_READ_COMPOSITE;
+        return 0;
     default:
         anjay_log(ERROR, "unrecognized CoAP method: %s",
                   AVS_COAP_CODE_STRING(code));
@@ -631,6 +644,7 @@ static bool critical_option_validator(uint8_t msg_code, uint32_t optnum) {
     /* Note: BLOCK Options are handled inside stream.c */
     switch (msg_code) {
     case AVS_COAP_CODE_GET:
+    case ANJAY_COAP_CODE_FETCH:
         return optnum == AVS_COAP_OPT_URI_PATH
             || optnum == AVS_COAP_OPT_ACCEPT;
     case AVS_COAP_CODE_PUT:
@@ -876,6 +890,30 @@ void anjay_download_abort(anjay_t *anjay,
 #endif // WITH_DOWNLOADER
 }
 
+int anjay_download_suspend(anjay_t *anjay,
+                           anjay_download_handle_t handle) {
+#ifdef WITH_DOWNLOADER
+    return _anjay_downloader_suspend(&anjay->downloader, handle);
+#else // WITH_DOWNLOADER
+    (void) anjay;
+    (void) handle;
+    anjay_log(ERROR, "CoAP download support disabled");
+    return -1;
+#endif // WITH_DOWNLOADER
+}
+
+int anjay_download_resume(anjay_t *anjay,
+                          anjay_download_handle_t handle) {
+#ifdef WITH_DOWNLOADER
+    return _anjay_downloader_resume(&anjay->downloader, handle);
+#else // WITH_DOWNLOADER
+    (void) anjay;
+    (void) handle;
+    anjay_log(ERROR, "CoAP download support disabled");
+    return -1;
+#endif // WITH_DOWNLOADER
+}
+
 void anjay_smsdrv_cleanup(anjay_smsdrv_t **smsdrv_ptr) {
     if (*smsdrv_ptr) {
         AVS_UNREACHABLE("SMS drivers not supported by this version of Anjay");
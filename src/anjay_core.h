@@ -23,6 +23,7 @@
 
 #include "dm_core.h"
 #include "observe/observe_core.h"
+#include "send/send_core.h"
 
 #include "servers.h"
 #include "utils_core.h"
@@ -55,6 +56,9 @@ struct anjay_struct {
 #endif
 #ifdef WITH_BOOTSTRAP
     anjay_bootstrap_t bootstrap;
+#endif
+#ifdef WITH_SEND
+    anjay_send_state_t send;
 #endif
     avs_coap_tx_params_t udp_tx_params;
     avs_coap_ctx_t *coap_ctx;
@@ -27,6 +27,9 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 
 #define ANJAY_COAP_STREAM_EXTENSION 0x436F4150UL /* CoAP */
 
+/** FETCH method (RFC 8132), used for Read-Composite and Observe-Composite */
+#define ANJAY_COAP_CODE_FETCH ((uint8_t) ((0 << 5) | 5))
+
 int _anjay_coap_stream_create(avs_stream_abstract_t **stream_,
                               avs_coap_ctx_t *coap_ctx,
                               uint8_t *in_buffer,
@@ -30,6 +30,7 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 #define ANJAY_COAP_FORMAT_OPAQUE 42
 #define ANJAY_COAP_FORMAT_TLV 11542
 #define ANJAY_COAP_FORMAT_JSON 11543
+#define ANJAY_COAP_FORMAT_SENML_JSON 110
 
 #ifdef WITH_LEGACY_CONTENT_FORMAT_SUPPORT
 #define ANJAY_COAP_FORMAT_LEGACY_PLAINTEXT 1541
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <ctype.h>
+
+#include "composite.h"
+
+#include "../anjay_core.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+typedef struct {
+    avs_stream_abstract_t *stream;
+    char ch;
+    bool eof;
+} path_reader_t;
+
+static int next_char(path_reader_t *reader) {
+    size_t bytes_read = 0;
+    char message_finished = 0;
+    while (!bytes_read && !message_finished) {
+        if (avs_stream_read(reader->stream, &bytes_read, &message_finished,
+                            &reader->ch, 1)) {
+            return -1;
+        }
+    }
+    reader->eof = !bytes_read;
+    return 0;
+}
+
+static int skip_whitespace(path_reader_t *reader) {
+    while (!reader->eof && isspace((unsigned char) reader->ch)) {
+        if (next_char(reader)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int parse_segment(path_reader_t *reader,
+                         uint16_t *out_id,
+                         uint16_t max_valid_id) {
+    uint32_t value = 0;
+    size_t digits = 0;
+    while (!reader->eof && isdigit((unsigned char) reader->ch)) {
+        value = 10 * value + (uint32_t) (reader->ch - '0');
+        if (value > max_valid_id) {
+            return ANJAY_ERR_BAD_REQUEST;
+        }
+        ++digits;
+        if (next_char(reader)) {
+            return -1;
+        }
+    }
+    if (!digits) {
+        return ANJAY_ERR_BAD_REQUEST;
+    }
+    *out_id = (uint16_t) value;
+    return 0;
+}
+
+static int parse_link(path_reader_t *reader, anjay_uri_path_t *out_path) {
+    struct {
+        uint16_t *id;
+        anjay_uri_path_type_t type;
+        uint16_t max_valid_value;
+    } ids[] = {
+        { &out_path->oid, ANJAY_PATH_OBJECT, UINT16_MAX },
+        { &out_path->iid, ANJAY_PATH_INSTANCE, UINT16_MAX - 1 },
+        { &out_path->rid, ANJAY_PATH_RESOURCE, UINT16_MAX }
+    };
+
+    if (reader->eof || reader->ch != '<') {
+        return ANJAY_ERR_BAD_REQUEST;
+    }
+    out_path->type = ANJAY_PATH_ROOT;
+    int result = next_char(reader);
+    for (size_t i = 0; !result && i < AVS_ARRAY_SIZE(ids); ++i) {
+        if (reader->eof || reader->ch != '/') {
+            break;
+        }
+        if (!(result = next_char(reader))
+                && !(result = parse_segment(reader, ids[i].id,
+                                            ids[i].max_valid_value))) {
+            out_path->type = ids[i].type;
+        }
+    }
+    if (result) {
+        return result;
+    }
+    if (reader->eof || reader->ch != '>'
+            || out_path->type == ANJAY_PATH_ROOT) {
+        return ANJAY_ERR_BAD_REQUEST;
+    }
+    // skip link parameters, if any
+    do {
+        if (next_char(reader)) {
+            return -1;
+        }
+    } while (!reader->eof && reader->ch != ',');
+    return 0;
+}
+
+int _anjay_composite_parse_paths(avs_stream_abstract_t *stream,
+                                 AVS_LIST(anjay_uri_path_t) *out_paths) {
+    assert(!*out_paths);
+    path_reader_t reader = {
+        .stream = stream
+    };
+    AVS_LIST(anjay_uri_path_t) *tail = out_paths;
+    size_t count = 0;
+    int result = next_char(&reader);
+    while (!result) {
+        if ((result = skip_whitespace(&reader))) {
+            break;
+        }
+        if (++count > ANJAY_COMPOSITE_MAX_PATHS) {
+            anjay_log(ERROR, "too many paths in a composite request");
+            result = ANJAY_ERR_BAD_REQUEST;
+            break;
+        }
+        if (!(*tail = AVS_LIST_NEW_ELEMENT(anjay_uri_path_t))) {
+            anjay_log(ERROR, "Out of memory");
+            result = ANJAY_ERR_INTERNAL;
+            break;
+        }
+        if ((result = parse_link(&reader, *tail))) {
+            break;
+        }
+        tail = AVS_LIST_NEXT_PTR(tail);
+        if (reader.eof) {
+            break;
+        }
+        assert(reader.ch == ',');
+        result = next_char(&reader);
+    }
+
+    if (result) {
+        anjay_log(ERROR, "could not parse the list of composite paths");
+        AVS_LIST_CLEAR(out_paths);
+    }
+    return result;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANJAY_DM_COMPOSITE_H
+#define ANJAY_DM_COMPOSITE_H
+
+#include <avsystem/commons/list.h>
+#include <avsystem/commons/stream.h>
+
+#include <anjay_modules/dm_utils.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Maximum number of paths accepted in a single Read-Composite or
+ * Observe-Composite request.
+ */
+#define ANJAY_COMPOSITE_MAX_PATHS 64
+
+/**
+ * Parses the payload of a Read-Composite or Observe-Composite request, i.e.
+ * a CoRE Link Format list of data model paths, e.g. <c></3/0/1>,</1/0></c>.
+ * Link parameters, if any, are ignored. The root path is not allowed.
+ *
+ * @param stream    Stream to read the payload from.
+ * @param out_paths Pointer to a NULL list that will be filled with the paths,
+ *                  in the order of appearance.
+ *
+ * @returns 0 on success, ANJAY_ERR_BAD_REQUEST if the payload is malformed,
+ *          empty or contains more than ANJAY_COMPOSITE_MAX_PATHS paths, or
+ *          another negative value in case of an error. On failure,
+ *          @p out_paths is left empty.
+ */
+int _anjay_composite_parse_paths(avs_stream_abstract_t *stream,
+                                 AVS_LIST(anjay_uri_path_t) *out_paths);
+
+/**
+ * Checks whether @p left and @p right refer to overlapping parts of the data
+ * model, i.e. whether one of them is equal to, or a prefix of, the other.
+ */
+static inline bool _anjay_uri_path_overlap(const anjay_uri_path_t *left,
+                                           const anjay_uri_path_t *right) {
+    return (!_anjay_uri_path_has_oid(left) || !_anjay_uri_path_has_oid(right)
+                    || left->oid == right->oid)
+            && (!_anjay_uri_path_has_iid(left)
+                    || !_anjay_uri_path_has_iid(right)
+                    || left->iid == right->iid)
+            && (!_anjay_uri_path_has_rid(left)
+                    || !_anjay_uri_path_has_rid(right)
+                    || left->rid == right->rid);
+}
+
+static inline bool
+_anjay_composite_paths_equal(AVS_LIST(const anjay_uri_path_t) left,
+                             AVS_LIST(const anjay_uri_path_t) right) {
+    while (left && right && _anjay_uri_path_equal(left, right)) {
+        left = AVS_LIST_NEXT(left);
+        right = AVS_LIST_NEXT(right);
+    }
+    return !left && !right;
+}
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_DM_COMPOSITE_H */
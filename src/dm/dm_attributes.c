@@ -79,12 +79,25 @@ static int read_period(anjay_t *anjay,
 static int read_combined_period(anjay_t *anjay,
                                 anjay_iid_t server_iid,
                                 anjay_rid_t rid,
+                                anjay_server_cached_period_t *cached,
                                 int32_t *out) {
-    if (*out < 0) {
-        return read_period(anjay, server_iid, rid, out);
-    } else {
+    if (*out >= 0) {
         return 0;
+    } else if (cached && cached->valid) {
+        *out = cached->value;
+        return 0;
+    }
+    int result = read_period(anjay, server_iid, rid, out);
+    if (!result && cached) {
+        cached->valid = true;
+        cached->value = *out;
     }
+    return result;
+}
+
+static bool period_needs_read(const anjay_server_cached_period_t *cached,
+                              int32_t value) {
+    return value < 0 && !(cached && cached->valid);
 }
 
 int _anjay_dm_read_combined_server_attrs(anjay_t *anjay,
@@ -93,8 +106,17 @@ int _anjay_dm_read_combined_server_attrs(anjay_t *anjay,
     if (out->standard.min_period >= 0 && out->standard.max_period >= 0) {
         return 0;
     }
+    anjay_server_config_cache_t *cache =
+            _anjay_servers_config_cache(anjay, ssid);
+    anjay_server_cached_period_t *cached_pmin =
+            cache ? &cache->default_min_period : NULL;
+    anjay_server_cached_period_t *cached_pmax =
+            cache ? &cache->default_max_period : NULL;
+
     anjay_iid_t server_iid = ANJAY_IID_INVALID;
-    if (_anjay_find_server_iid(anjay, ssid, &server_iid)) {
+    if ((period_needs_read(cached_pmin, out->standard.min_period)
+                || period_needs_read(cached_pmax, out->standard.max_period))
+            && _anjay_find_server_iid(anjay, ssid, &server_iid)) {
         anjay_log(WARNING,
                   "Could not find Server IID for Short Server ID: %" PRIu16,
                   ssid);
@@ -102,9 +124,11 @@ int _anjay_dm_read_combined_server_attrs(anjay_t *anjay,
         int result;
         if ((result = read_combined_period(anjay, server_iid,
                                            ANJAY_DM_RID_SERVER_DEFAULT_PMIN,
+                                           cached_pmin,
                                            &out->standard.min_period))
             || (result = read_combined_period(anjay, server_iid,
                                               ANJAY_DM_RID_SERVER_DEFAULT_PMAX,
+                                              cached_pmax,
                                               &out->standard.max_period))) {
             return result;
         }
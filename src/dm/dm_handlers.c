@@ -285,6 +285,16 @@ int _anjay_dm_resource_read(anjay_t *anjay,
                               resource_read, anjay, obj_ptr, iid, rid, ctx);
 }
 
+int _anjay_dm_instance_read(anjay_t *anjay,
+                            const anjay_dm_object_def_t *const *obj_ptr,
+                            anjay_iid_t iid,
+                            anjay_output_ctx_t *ctx,
+                            const anjay_dm_module_t *current_module) {
+    anjay_log(TRACE, "instance_read /%u/%u", (*obj_ptr)->oid, iid);
+    CHECKED_TAIL_CALL_HANDLER(anjay, obj_ptr, current_module,
+                              instance_read, anjay, obj_ptr, iid, ctx);
+}
+
 int _anjay_dm_resource_write(anjay_t *anjay,
                              const anjay_dm_object_def_t *const *obj_ptr,
                              anjay_iid_t iid,
@@ -19,6 +19,7 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <math.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdio.h>
 
@@ -35,6 +36,7 @@
 #include "coap/content_format.h"
 
 #include "dm_core.h"
+#include "dm/composite.h"
 #include "dm/discover.h"
 #include "dm/dm_execute.h"
 #include "dm/query.h"
@@ -245,6 +247,7 @@ input_ctx_for_action(anjay_request_action_t action) {
 static uint8_t make_success_response_code(anjay_request_action_t action) {
     switch (action) {
     case ANJAY_ACTION_READ:             return AVS_COAP_CODE_CONTENT;
+    case ANJAY_ACTION_READ_COMPOSITE:   return AVS_COAP_CODE_CONTENT;
     case ANJAY_ACTION_DISCOVER:         return AVS_COAP_CODE_CONTENT;
     case ANJAY_ACTION_WRITE:            return AVS_COAP_CODE_CHANGED;
     case ANJAY_ACTION_WRITE_UPDATE:     return AVS_COAP_CODE_CHANGED;
@@ -388,6 +391,11 @@ static int read_instance(anjay_t *anjay,
                          const anjay_dm_object_def_t *const *obj,
                          anjay_iid_t iid,
                          anjay_output_ctx_t *out_ctx) {
+    if (_anjay_dm_handler_implemented(anjay, obj, NULL,
+                                      offsetof(anjay_dm_handlers_t,
+                                               instance_read))) {
+        return _anjay_dm_instance_read(anjay, obj, iid, out_ctx, NULL);
+    }
     for (size_t i = 0; i < (*obj)->supported_rids.count; ++i) {
         int result = ensure_resource_present(anjay, obj, iid,
                                              (*obj)->supported_rids.rids[i]);
@@ -657,6 +665,235 @@ static int dm_read_or_observe(anjay_t *anjay,
     }
 }
 
+#ifdef WITH_JSON
+static int read_composite_path(anjay_t *anjay,
+                               anjay_ssid_t ssid,
+                               const anjay_uri_path_t *path,
+                               anjay_output_ctx_t *out_ctx) {
+    assert(_anjay_uri_path_has_oid(path));
+    const anjay_dm_object_def_t *const *obj =
+            _anjay_dm_find_object_by_oid(anjay, path->oid);
+    if (!obj || !*obj) {
+        return ANJAY_ERR_NOT_FOUND;
+    }
+    int result = _anjay_output_set_id(out_ctx, ANJAY_ID_OID, path->oid);
+    if (result) {
+        return result;
+    }
+    if (!_anjay_uri_path_has_iid(path)) {
+        return read_object(anjay, obj,
+                           &(const anjay_dm_read_args_t) {
+                               .ssid = ssid,
+                               .uri = *path
+                           }, out_ctx);
+    }
+
+    const anjay_action_info_t info = {
+        .iid = path->iid,
+        .oid = path->oid,
+        .ssid = ssid,
+        .action = ANJAY_ACTION_READ
+    };
+    if ((result = ensure_instance_present(anjay, obj, path->iid))) {
+        return result;
+    }
+    if (!_anjay_access_control_action_allowed(anjay, &info)) {
+        return ANJAY_ERR_UNAUTHORIZED;
+    }
+    if (!_anjay_uri_path_has_rid(path)) {
+        return read_instance_wrapped(anjay, obj, path->iid, out_ctx);
+    }
+    if ((result = _anjay_output_set_id(out_ctx, ANJAY_ID_IID, path->iid))) {
+        return result;
+    }
+    return read_resource(anjay, obj, path->iid, path->rid, out_ctx);
+}
+
+/**
+ * Reads all of @p paths into a single output context, which is destroyed
+ * afterwards. Paths that do not exist are skipped.
+ */
+static int dm_read_composite(anjay_t *anjay,
+                             anjay_ssid_t ssid,
+                             AVS_LIST(const anjay_uri_path_t) paths,
+                             anjay_output_ctx_t *out_ctx) {
+    int result = 0;
+    AVS_LIST(const anjay_uri_path_t) path;
+    AVS_LIST_FOREACH(path, paths) {
+        anjay_log(DEBUG, "Read-Composite %s", ANJAY_DEBUG_MAKE_PATH(path));
+        result = read_composite_path(anjay, ssid, path, out_ctx);
+        if (result == ANJAY_ERR_NOT_FOUND) {
+            anjay_log(DEBUG, "%s not found, skipping",
+                      ANJAY_DEBUG_MAKE_PATH(path));
+            result = 0;
+        } else if (result) {
+            break;
+        }
+    }
+    int finish_result = _anjay_output_ctx_destroy(&out_ctx);
+    return result ? result : finish_result;
+}
+
+static anjay_output_ctx_t *
+dm_read_composite_spawn_ctx(avs_stream_abstract_t *stream,
+                            int *errno_ptr,
+                            uint16_t requested_format,
+                            bool observe_serial) {
+    uint16_t format = requested_format;
+    if ((*errno_ptr = _anjay_handle_requested_format(&format,
+                                                     ANJAY_COAP_FORMAT_JSON))) {
+        anjay_log(ERROR,
+                  "Got option: Accept: %" PRIu16 ", but composite reads only "
+                  "support JSON format", requested_format);
+        return NULL;
+    }
+
+    anjay_msg_details_t msg_details = {
+        .msg_type = AVS_COAP_MSG_ACKNOWLEDGEMENT,
+        .format = format,
+        .msg_code = make_success_response_code(ANJAY_ACTION_READ_COMPOSITE),
+        .observe_serial = observe_serial
+    };
+    // element names in the response are absolute paths
+    return _anjay_output_json_create(stream, errno_ptr, &msg_details,
+                                     &(const anjay_uri_path_t) {
+                                         .type = ANJAY_PATH_ROOT
+                                     });
+}
+#endif // WITH_JSON
+
+#ifdef WITH_OBSERVE
+ssize_t
+_anjay_dm_read_composite_for_observe(anjay_t *anjay,
+                                     anjay_ssid_t ssid,
+                                     AVS_LIST(const anjay_uri_path_t) paths,
+                                     uint16_t requested_format,
+                                     anjay_msg_details_t *out_details,
+                                     char *buffer,
+                                     size_t size) {
+#ifdef WITH_JSON
+    anjay_observe_stream_t out = _anjay_new_observe_stream(out_details);
+    avs_stream_outbuf_set_buffer(&out.outbuf, buffer, size);
+    int out_ctx_errno = 0;
+    anjay_output_ctx_t *out_ctx =
+            dm_read_composite_spawn_ctx((avs_stream_abstract_t *) &out,
+                                        &out_ctx_errno, requested_format, true);
+    if (!out_ctx) {
+        return out_ctx_errno ? out_ctx_errno : ANJAY_ERR_INTERNAL;
+    }
+    int result = dm_read_composite(anjay, ssid, paths, out_ctx);
+    if (out_ctx_errno < 0) {
+        return (ssize_t) out_ctx_errno;
+    } else if (result < 0) {
+        return (ssize_t) result;
+    }
+    return (ssize_t) avs_stream_outbuf_offset(&out.outbuf);
+#else // WITH_JSON
+    (void) anjay; (void) ssid; (void) paths; (void) requested_format;
+    (void) out_details; (void) buffer; (void) size;
+    return ANJAY_ERR_NOT_IMPLEMENTED;
+#endif // WITH_JSON
+}
+#endif // WITH_OBSERVE
+
+#ifdef WITH_JSON
+#ifdef WITH_OBSERVE
+static void build_composite_observe_key(anjay_t *anjay,
+                                        anjay_observe_key_t *result,
+                                        const anjay_request_t *request) {
+    memset(result, 0, sizeof(*result));
+    result->connection.ssid = _anjay_dm_current_ssid(anjay);
+    result->connection.type = anjay->current_connection.conn_type;
+    result->format = request->requested_format;
+}
+
+static int dm_observe_composite(anjay_t *anjay,
+                                const avs_coap_msg_identity_t *request_identity,
+                                const anjay_request_t *request,
+                                AVS_LIST(anjay_uri_path_t) *paths_ptr) {
+    anjay_log(DEBUG, "Observe-Composite");
+    char buf[ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE];
+    anjay_msg_details_t observe_details;
+    ssize_t size = _anjay_dm_read_composite_for_observe(
+            anjay, _anjay_dm_current_ssid(anjay), *paths_ptr,
+            request->requested_format, &observe_details, buf, sizeof(buf));
+    if (size < 0) {
+        return (int) size;
+    }
+    anjay_observe_key_t key;
+    build_composite_observe_key(anjay, &key, request);
+    int put_entry_result = _anjay_observe_put_composite_entry(
+            anjay, &key, paths_ptr, &observe_details, request_identity,
+            buf, (size_t) size);
+    if (put_entry_result) {
+        // see dm_observe()
+        observe_details.observe_serial = false;
+    }
+    int result;
+    if ((result = _anjay_coap_stream_setup_response(anjay->comm_stream,
+                                                    &observe_details))
+            || (result = avs_stream_write(anjay->comm_stream,
+                                          buf, (size_t) size))) {
+        if (!put_entry_result) {
+            _anjay_observe_remove_entry(anjay, &key);
+        }
+    }
+    return result;
+}
+#else // WITH_OBSERVE
+#define dm_observe_composite(...) \
+        (anjay_log(ERROR, "Observe support disabled"), ANJAY_ERR_BAD_OPTION)
+#endif // WITH_OBSERVE
+
+static int
+dm_read_or_observe_composite(anjay_t *anjay,
+                             const avs_coap_msg_identity_t *request_identity,
+                             const anjay_request_t *request) {
+    if (request->content_format != ANJAY_COAP_FORMAT_APPLICATION_LINK) {
+        anjay_log(ERROR, "list of composite paths shall be sent in "
+                         "application/link-format");
+        return ANJAY_ERR_UNSUPPORTED_CONTENT_FORMAT;
+    }
+    AVS_LIST(anjay_uri_path_t) paths = NULL;
+    int result = _anjay_composite_parse_paths(anjay->comm_stream, &paths);
+    if (result) {
+        return result;
+    }
+
+    if (request->observe == ANJAY_COAP_OBSERVE_REGISTER) {
+        result = dm_observe_composite(anjay, request_identity, request,
+                                      &paths);
+    } else {
+#ifdef WITH_OBSERVE
+        if (request->observe == ANJAY_COAP_OBSERVE_DEREGISTER) {
+            anjay_observe_key_t key;
+            build_composite_observe_key(anjay, &key, request);
+            _anjay_observe_remove_composite_entry(anjay, &key, paths);
+        }
+#endif // WITH_OBSERVE
+        int out_ctx_errno = 0;
+        anjay_output_ctx_t *out_ctx = dm_read_composite_spawn_ctx(
+                anjay->comm_stream, &out_ctx_errno, request->requested_format,
+                false);
+        if (!out_ctx) {
+            result = out_ctx_errno ? out_ctx_errno : ANJAY_ERR_INTERNAL;
+        } else {
+            result = dm_read_composite(anjay, _anjay_dm_current_ssid(anjay),
+                                       paths, out_ctx);
+            if (out_ctx_errno) {
+                result = out_ctx_errno;
+            }
+        }
+    }
+    AVS_LIST_CLEAR(&paths);
+    return result;
+}
+#else // WITH_JSON
+#define dm_read_or_observe_composite(...) \
+        (anjay_log(ERROR, "Read-Composite requires JSON support"), \
+         ANJAY_ERR_NOT_IMPLEMENTED)
+#endif // WITH_JSON
+
 static inline bool resource_specific_request_attrs_empty(
         const anjay_request_attributes_t *attrs) {
     return !attrs->has_greater_than
@@ -1292,6 +1529,8 @@ static int invoke_action(anjay_t *anjay,
     switch (request->action) {
     case ANJAY_ACTION_READ:
         return dm_read_or_observe(anjay, obj, request_identity, request);
+    case ANJAY_ACTION_READ_COMPOSITE:
+        return dm_read_or_observe_composite(anjay, request_identity, request);
     case ANJAY_ACTION_DISCOVER:
         return dm_discover(anjay, obj, request);
     case ANJAY_ACTION_WRITE:
@@ -1316,7 +1555,13 @@ int _anjay_dm_perform_action(anjay_t *anjay,
                              const avs_coap_msg_identity_t *request_identity,
                              const anjay_request_t *request) {
     const anjay_dm_object_def_t *const *obj = NULL;
-    if (_anjay_uri_path_has_oid(&request->uri)) {
+    if (request->action == ANJAY_ACTION_READ_COMPOSITE) {
+        if (request->uri.type != ANJAY_PATH_ROOT) {
+            anjay_log(ERROR, "Read-Composite paths shall be listed in the "
+                             "payload, not in Uri-Path");
+            return ANJAY_ERR_BAD_REQUEST;
+        }
+    } else if (_anjay_uri_path_has_oid(&request->uri)) {
         if (!(obj = _anjay_dm_find_object_by_oid(anjay, request->uri.oid))
                 || !*obj) {
             anjay_log(ERROR, "Object not found: %u", request->uri.oid);
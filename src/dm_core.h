@@ -173,6 +173,20 @@ ssize_t _anjay_dm_read_for_observe(anjay_t *anjay,
                                    double *out_numeric,
                                    char *buffer,
                                    size_t size);
+
+/**
+ * Reads all of @p paths, as for an Observe-Composite request, into @p buffer.
+ *
+ * @returns Number of bytes written, or a negative value in case of an error.
+ */
+ssize_t
+_anjay_dm_read_composite_for_observe(anjay_t *anjay,
+                                     anjay_ssid_t ssid,
+                                     AVS_LIST(const anjay_uri_path_t) paths,
+                                     uint16_t requested_format,
+                                     anjay_msg_details_t *out_details,
+                                     char *buffer,
+                                     size_t size);
 #endif // WITH_OBSERVE
 
 int _anjay_dm_perform_action(anjay_t *anjay,
@@ -107,6 +107,17 @@ int _anjay_downloader_handle_packet(anjay_downloader_t *dl,
 void _anjay_downloader_abort(anjay_downloader_t *dl,
                              anjay_download_handle_t handle);
 
+/**
+ * Marks the download as suspended: its socket is no longer reported by
+ * @ref _anjay_downloader_get_sockets and no further requests are sent until
+ * @ref _anjay_downloader_resume is called.
+ */
+int _anjay_downloader_suspend(anjay_downloader_t *dl,
+                              anjay_download_handle_t handle);
+
+int _anjay_downloader_resume(anjay_downloader_t *dl,
+                             anjay_download_handle_t handle);
+
 int _anjay_downloader_sched_reconnect_all(anjay_downloader_t *dl);
 
 VISIBILITY_PRIVATE_HEADER_END
@@ -391,6 +391,10 @@ static void handle_coap_response(const avs_coap_msg_t *msg,
     if (!block2.has_more) {
         dl_log(INFO, "transfer id = %" PRIuPTR " finished", ctx->common.id);
         _anjay_downloader_abort_transfer(dl, ctx_ptr, 0, 0);
+    } else if (ctx->common.suspended) {
+        // next block will be requested by resume_coap_transfer()
+        dl_log(TRACE, "transfer id = %" PRIuPTR " suspended after %lu B",
+               ctx->common.id, (unsigned long) ctx->bytes_downloaded);
     } else if (!request_next_coap_block(dl, ctx_ptr)) {
         dl_log(TRACE, "transfer id = %" PRIuPTR ": %lu B downloaded",
                ctx->common.id, (unsigned long) ctx->bytes_downloaded);
@@ -531,7 +535,7 @@ static int reconnect_coap_transfer(anjay_downloader_t *dl,
         dl_log(WARNING, "could not reconnect socket for download "
                "id = %" PRIuPTR, ctx->common.id);
         return -avs_net_socket_errno(ctx->socket);
-    } else {
+    } else if (!ctx->common.suspended) {
         anjay_t *anjay = _anjay_downloader_get_anjay(dl);
         _anjay_sched_del(anjay->sched, &ctx->sched_job);
         if (_anjay_sched_now(anjay->sched, &ctx->sched_job,
@@ -545,6 +549,29 @@ static int reconnect_coap_transfer(anjay_downloader_t *dl,
     return 0;
 }
 
+static void suspend_coap_transfer(anjay_downloader_t *dl,
+                                  anjay_download_ctx_t *ctx) {
+    // stop retransmissions; any response that arrives in the meantime will be
+    // ignored because of a token mismatch after resumption
+    _anjay_sched_del(_anjay_downloader_get_anjay(dl)->sched,
+                     &((anjay_coap_download_ctx_t *) ctx)->sched_job);
+}
+
+static int resume_coap_transfer(anjay_downloader_t *dl,
+                                anjay_download_ctx_t *ctx_) {
+    anjay_coap_download_ctx_t *ctx = (anjay_coap_download_ctx_t *) ctx_;
+    anjay_t *anjay = _anjay_downloader_get_anjay(dl);
+    _anjay_sched_del(anjay->sched, &ctx->sched_job);
+    if (_anjay_sched_now(anjay->sched, &ctx->sched_job,
+                         request_next_coap_block_job,
+                         (void *) ctx->common.id)) {
+        dl_log(WARNING, "could not schedule resumption for download "
+               "id = %" PRIuPTR, ctx->common.id);
+        return -ENOMEM;
+    }
+    return 0;
+}
+
 #ifdef ANJAY_TEST
 #include "test/downloader_mock.h"
 #endif // ANJAY_TEST
@@ -568,7 +595,9 @@ int _anjay_downloader_coap_ctx_new(anjay_downloader_t *dl,
         .get_socket = get_coap_socket,
         .handle_packet = handle_coap_message,
         .cleanup = cleanup_coap_transfer,
-        .reconnect = reconnect_coap_transfer
+        .reconnect = reconnect_coap_transfer,
+        .suspend = suspend_coap_transfer,
+        .resume = resume_coap_transfer
     };
     ctx->common.vtable = &VTABLE;
 
@@ -154,7 +154,8 @@ int _anjay_downloader_get_sockets(anjay_downloader_t *dl,
     AVS_LIST_FOREACH(dl_ctx, dl->downloads) {
         avs_net_abstract_socket_t *socket = NULL;
         anjay_socket_transport_t transport;
-        if (!get_ctx_socket(dl, dl_ctx, &socket, &transport)) {
+        if (!dl_ctx->common.suspended
+                && !get_ctx_socket(dl, dl_ctx, &socket, &transport)) {
             AVS_LIST(anjay_socket_entry_t) elem =
                     AVS_LIST_NEW_ELEMENT(anjay_socket_entry_t);
             if (!elem) {
@@ -200,6 +201,10 @@ int _anjay_downloader_handle_packet(anjay_downloader_t *dl,
 
     assert(*ctx);
     assert((*ctx)->common.vtable);
+    if ((*ctx)->common.suspended) {
+        // data will be read after the download is resumed
+        return 0;
+    }
     (*ctx)->common.vtable->handle_packet(dl, ctx);
     return 0;
 }
@@ -299,6 +304,47 @@ void _anjay_downloader_abort(anjay_downloader_t *dl,
     }
 }
 
+int _anjay_downloader_suspend(anjay_downloader_t *dl,
+                              anjay_download_handle_t handle) {
+    uintptr_t id = (uintptr_t) handle;
+
+    AVS_LIST(anjay_download_ctx_t) *ctx =
+            _anjay_downloader_find_ctx_ptr_by_id(dl, id);
+    if (!ctx) {
+        dl_log(DEBUG, "download id = %" PRIuPTR " not found (expired?)", id);
+        return -1;
+    }
+    if (!(*ctx)->common.suspended) {
+        dl_log(TRACE, "suspending download id = %" PRIuPTR, id);
+        (*ctx)->common.suspended = true;
+        (*ctx)->common.vtable->suspend(dl, *ctx);
+    }
+    return 0;
+}
+
+int _anjay_downloader_resume(anjay_downloader_t *dl,
+                             anjay_download_handle_t handle) {
+    uintptr_t id = (uintptr_t) handle;
+
+    AVS_LIST(anjay_download_ctx_t) *ctx =
+            _anjay_downloader_find_ctx_ptr_by_id(dl, id);
+    if (!ctx) {
+        dl_log(DEBUG, "download id = %" PRIuPTR " not found (expired?)", id);
+        return -1;
+    }
+    if (!(*ctx)->common.suspended) {
+        return 0;
+    }
+    dl_log(TRACE, "resuming download id = %" PRIuPTR, id);
+    (*ctx)->common.suspended = false;
+    int result = (*ctx)->common.vtable->resume(dl, *ctx);
+    if (result) {
+        _anjay_downloader_abort_transfer(dl, ctx, ANJAY_DOWNLOAD_ERR_FAILED,
+                                         -result);
+    }
+    return result;
+}
+
 static void reconnect_all_job(anjay_t *anjay, void *dummy) {
     (void) dummy;
     AVS_LIST(anjay_download_ctx_t) *ctx_ptr;
@@ -38,6 +38,7 @@ typedef struct {
     avs_url_t *parsed_url;
     avs_stream_abstract_t *stream;
     anjay_sched_handle_t send_request_job;
+    anjay_sched_handle_t resume_job;
 
     // State related to download resumption:
     anjay_etag_t *etag;
@@ -236,7 +237,7 @@ static void handle_http_packet(anjay_downloader_t *dl,
                                              ANJAY_DOWNLOAD_ERR_FAILED, EIO);
             return;
         }
-    } while (nonblock_read_ready > 0);
+    } while (nonblock_read_ready > 0 && !ctx->common.suspended);
 }
 
 static void cleanup_http_transfer(anjay_downloader_t *dl,
@@ -245,6 +246,8 @@ static void cleanup_http_transfer(anjay_downloader_t *dl,
     anjay_http_download_ctx_t *ctx = (anjay_http_download_ctx_t *) *ctx_ptr;
     _anjay_sched_del(_anjay_downloader_get_anjay(dl)->sched,
                      &ctx->send_request_job);
+    _anjay_sched_del(_anjay_downloader_get_anjay(dl)->sched,
+                     &ctx->resume_job);
     avs_free(ctx->etag);
     avs_stream_cleanup(&ctx->stream);
     avs_url_free(ctx->parsed_url);
@@ -266,6 +269,44 @@ static int reconnect_http_transfer(anjay_downloader_t *dl,
     return 0;
 }
 
+static void suspend_http_transfer(anjay_downloader_t *dl,
+                                  anjay_download_ctx_t *ctx) {
+    (void) dl;
+    (void) ctx;
+    // TCP flow control takes care of the rest
+}
+
+static void resume_http_job(anjay_t *anjay, void *id_) {
+    uintptr_t id = (uintptr_t) id_;
+    AVS_LIST(anjay_download_ctx_t) *ctx_ptr =
+            _anjay_downloader_find_ctx_ptr_by_id(&anjay->downloader, id);
+    if (!ctx_ptr) {
+        dl_log(DEBUG, "download id = %" PRIuPTR "expired", id);
+        return;
+    }
+
+    anjay_http_download_ctx_t *ctx = (anjay_http_download_ctx_t *) *ctx_ptr;
+    // data buffered inside the stream is not signalled by the socket, so it
+    // needs to be consumed explicitly
+    if (!ctx->common.suspended && ctx->stream
+            && avs_stream_nonblock_read_ready(ctx->stream) > 0) {
+        handle_http_packet(&anjay->downloader, ctx_ptr);
+    }
+}
+
+static int resume_http_transfer(anjay_downloader_t *dl,
+                                anjay_download_ctx_t *ctx_) {
+    anjay_http_download_ctx_t *ctx = (anjay_http_download_ctx_t *) ctx_;
+    anjay_t *anjay = _anjay_downloader_get_anjay(dl);
+    _anjay_sched_del(anjay->sched, &ctx->resume_job);
+    if (_anjay_sched_now(anjay->sched, &ctx->resume_job, resume_http_job,
+                         (void *) ctx->common.id)) {
+        dl_log(ERROR, "could not schedule download job");
+        return -ENOMEM;
+    }
+    return 0;
+}
+
 int _anjay_downloader_http_ctx_new(anjay_downloader_t *dl,
                                    AVS_LIST(anjay_download_ctx_t) *out_dl_ctx,
                                    const anjay_download_config_t *cfg,
@@ -281,7 +322,9 @@ int _anjay_downloader_http_ctx_new(anjay_downloader_t *dl,
         .get_socket = get_http_socket,
         .handle_packet = handle_http_packet,
         .cleanup = cleanup_http_transfer,
-        .reconnect = reconnect_http_transfer
+        .reconnect = reconnect_http_transfer,
+        .suspend = suspend_http_transfer,
+        .resume = resume_http_transfer
     };
     ctx->common.vtable = &VTABLE;
 
@@ -39,6 +39,8 @@ typedef struct {
                     AVS_LIST(anjay_download_ctx_t) *ctx_ptr);
     int (*reconnect)(anjay_downloader_t *dl,
                      AVS_LIST(anjay_download_ctx_t) *ctx_ptr);
+    void (*suspend)(anjay_downloader_t *dl, anjay_download_ctx_t *ctx);
+    int (*resume)(anjay_downloader_t *dl, anjay_download_ctx_t *ctx);
 } anjay_download_ctx_vtable_t;
 
 typedef struct {
@@ -49,6 +51,9 @@ typedef struct {
     anjay_download_next_block_handler_t *on_next_block;
     anjay_download_finished_handler_t *on_download_finished;
     void *user_data;
+
+    /** True if @ref _anjay_downloader_suspend has been called. */
+    bool suspended;
 } anjay_download_ctx_common_t;
 
 static inline anjay_t *_anjay_downloader_get_anjay(anjay_downloader_t *dl) {
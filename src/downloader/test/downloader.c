@@ -354,6 +354,74 @@ AVS_UNIT_TEST(downloader, coap_download_multiple_blocks) {
     teardown_simple();
 }
 
+static anjay_download_handle_t SUSPENDED_HANDLE;
+
+static int on_next_block_suspend(anjay_t *anjay,
+                                 const uint8_t *data,
+                                 size_t data_size,
+                                 const anjay_etag_t *etag,
+                                 void *user_data) {
+    int result = on_next_block(anjay, data, data_size, etag, user_data);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_suspend(&anjay->downloader,
+                                                      SUSPENDED_HANDLE));
+    return result;
+}
+
+AVS_UNIT_TEST(downloader, coap_download_suspend_resume) {
+    setup_simple("coap://127.0.0.1:5683");
+    SIMPLE_ENV.cfg.on_next_block = on_next_block_suspend;
+
+    const avs_coap_msg_t *req1 = COAP_MSG(CON, GET, ID(0), BLOCK2(0, 1024));
+    const avs_coap_msg_t *res1 = COAP_MSG(ACK, CONTENT, ID(0),
+                                          BLOCK2(0, 64, DESPAIR));
+    const avs_coap_msg_t *req2 = COAP_MSG(CON, GET, ID(1), BLOCK2(1, 64));
+    const avs_coap_msg_t *res2 = COAP_MSG(ACK, CONTENT, ID(1),
+                                          BLOCK2(1, 64, DESPAIR));
+
+    avs_unit_mocksock_expect_connect(SIMPLE_ENV.mocksock, "127.0.0.1", "5683");
+    avs_unit_mocksock_expect_output(SIMPLE_ENV.mocksock,
+                                    &req1->content, req1->length);
+    avs_unit_mocksock_input(SIMPLE_ENV.mocksock, &res1->content, res1->length);
+
+    on_next_block_args_t args = {
+        .data_size = 64,
+        .result = 0
+    };
+    memcpy(args.data, DESPAIR, 64);
+    expect_next_block(&SIMPLE_ENV.data, args);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_download(
+            &SIMPLE_ENV.base->anjay.downloader, &SUSPENDED_HANDLE,
+            &SIMPLE_ENV.cfg));
+    AVS_UNIT_ASSERT_NOT_NULL(SUSPENDED_HANDLE);
+    _anjay_sched_run(SIMPLE_ENV.base->anjay.sched);
+    AVS_UNIT_ASSERT_SUCCESS(handle_packet());
+    avs_unit_mocksock_assert_expects_met(SIMPLE_ENV.mocksock);
+
+    // suspended: no socket to poll, no retransmissions
+    AVS_UNIT_ASSERT_FAILED(handle_packet());
+    avs_time_duration_t delay;
+    AVS_UNIT_ASSERT_FAILED(_anjay_sched_time_to_next(
+            SIMPLE_ENV.base->anjay.sched, &delay));
+
+    avs_unit_mocksock_expect_output(SIMPLE_ENV.mocksock,
+                                    &req2->content, req2->length);
+    avs_unit_mocksock_input(SIMPLE_ENV.mocksock, &res2->content, res2->length);
+
+    args.data_size = sizeof(DESPAIR) - 1 - 64;
+    memcpy(args.data, &DESPAIR[64], args.data_size);
+    expect_next_block(&SIMPLE_ENV.data, args);
+    expect_download_finished(&SIMPLE_ENV.data, 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_resume(
+            &SIMPLE_ENV.base->anjay.downloader, SUSPENDED_HANDLE));
+    _anjay_sched_run(SIMPLE_ENV.base->anjay.sched);
+    AVS_UNIT_ASSERT_SUCCESS(handle_packet());
+    avs_unit_mocksock_assert_expects_met(SIMPLE_ENV.mocksock);
+
+    teardown_simple();
+}
+
 AVS_UNIT_TEST(downloader, download_abort_on_cleanup) {
     setup_simple("coap://127.0.0.1:5683");
 
@@ -107,6 +107,9 @@ static void abort_bootstrap(anjay_t *anjay) {
         _anjay_dm_transaction_rollback(anjay);
         anjay->bootstrap.in_progress = false;
         resume_connections(anjay);
+        if (_anjay_notify_schedule_deferred(anjay)) {
+            anjay_log(WARNING, "could not schedule deferred notifications");
+        }
     }
 }
 
@@ -542,8 +545,13 @@ static int bootstrap_finish_impl(anjay_t *anjay, bool perform_timeout) {
                   "Bootstrap configuration could not be committed, rejecting");
         return retval;
     }
-    if ((retval = _anjay_notify_perform(anjay,
-                                        anjay->bootstrap.notification_queue))) {
+    // changes reported through anjay_notify_*() during the Bootstrap Sequence
+    // have been deferred; process them in the same pass as the bootstrap ones
+    if ((retval = _anjay_notify_queue_merge(
+                    &anjay->bootstrap.notification_queue,
+                    &anjay->scheduled_notify.queue))
+            || (retval = _anjay_notify_perform(
+                    anjay, anjay->bootstrap.notification_queue))) {
         anjay_log(ERROR, "Could not post-process data model after bootstrap");
     } else {
         _anjay_notify_clear_queue(&anjay->bootstrap.notification_queue);
@@ -805,6 +813,10 @@ int _anjay_bootstrap_update_reconnected(anjay_t *anjay) {
     return 0;
 }
 
+bool _anjay_bootstrap_in_progress(anjay_t *anjay) {
+    return anjay->bootstrap.in_progress;
+}
+
 void _anjay_bootstrap_cleanup(anjay_t *anjay) {
     cancel_client_initiated_bootstrap(anjay);
     abort_bootstrap(anjay);
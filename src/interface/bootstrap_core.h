@@ -46,6 +46,12 @@ int _anjay_bootstrap_update_reconnected(anjay_t *anjay);
 
 void _anjay_bootstrap_cleanup(anjay_t *anjay);
 
+/**
+ * Returns true between the first request of a Bootstrap Sequence and
+ * Bootstrap-Finish (or the end of the sequence for any other reason).
+ */
+bool _anjay_bootstrap_in_progress(anjay_t *anjay);
+
 #else
 
 #define _anjay_bootstrap_notify_regular_connection_available(anjay) ((void) 0)
@@ -58,6 +64,8 @@ void _anjay_bootstrap_cleanup(anjay_t *anjay);
 
 #define _anjay_bootstrap_cleanup(anjay) ((void) 0)
 
+#define _anjay_bootstrap_in_progress(anjay) ((void) (anjay), false)
+
 #endif
 
 VISIBILITY_PRIVATE_HEADER_END
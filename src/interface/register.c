@@ -130,6 +130,13 @@ static int send_objects_list(avs_stream_abstract_t *stream,
 static int get_server_lifetime(anjay_t *anjay,
                                anjay_ssid_t ssid,
                                int64_t *out_lifetime) {
+    anjay_server_config_cache_t *cache =
+            _anjay_servers_config_cache(anjay, ssid);
+    if (cache && cache->lifetime_valid) {
+        *out_lifetime = cache->lifetime;
+        return 0;
+    }
+
     anjay_iid_t server_iid;
     if (_anjay_find_server_iid(anjay, ssid, &server_iid)) {
         return -1;
@@ -149,6 +156,10 @@ static int get_server_lifetime(anjay_t *anjay,
         return -1;
     }
     *out_lifetime = lifetime;
+    if (cache) {
+        cache->lifetime_valid = true;
+        cache->lifetime = lifetime;
+    }
 
     return 0;
 }
@@ -635,6 +635,60 @@ AVS_UNIT_TEST(bootstrap_finish, error) {
     DM_TEST_FINISH;
 }
 
+static int merged_notify_perform(anjay_t *anjay,
+                                 anjay_notify_queue_t queue) {
+    (void) anjay;
+    // /42/514/4 written by the Bootstrap Server and /42/514/5 reported by the
+    // application are processed together
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(queue), 1);
+    AVS_UNIT_ASSERT_EQUAL(queue->oid, 42);
+    AVS_UNIT_ASSERT_TRUE(queue->instance_set_changes.instance_set_changed);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(queue->resources_changed), 2);
+    AVS_UNIT_ASSERT_EQUAL(queue->resources_changed->rid, 4);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_NEXT(queue->resources_changed)->rid, 5);
+    return -1;
+}
+
+AVS_UNIT_TEST(bootstrap_finish, deferred_notify) {
+    AVS_UNIT_MOCK(_anjay_notify_perform) = merged_notify_perform;
+    DM_TEST_INIT_WITH_SSIDS(ANJAY_SSID_BOOTSTRAP);
+
+    static const char REQUEST1[] =
+            "\x40\x03\xFA\x3E" // CoAP header
+            "\xB2" "42" // OID
+            "\x03" "514" // IID
+            "\x01" "4" // RID
+            "\x10" // Content-Format
+            "\xFF"
+            "Hello";
+    avs_unit_mocksock_input(mocksocks[0], REQUEST1, sizeof(REQUEST1) - 1);
+    _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 514, 0);
+    _anjay_mock_dm_expect_instance_create(anjay, &OBJ, 514,
+                                          ANJAY_SSID_BOOTSTRAP, 0, 514);
+    _anjay_mock_dm_expect_resource_write(anjay, &OBJ, 514, 4,
+                                         ANJAY_MOCK_DM_STRING(0, "Hello"), 0);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], "\x60\x44\xFA\x3E");
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    // not processed until Bootstrap Finish
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 514, 5));
+    AVS_UNIT_ASSERT_NOT_NULL(anjay->scheduled_notify.queue);
+    AVS_UNIT_ASSERT_NULL(anjay->scheduled_notify.handle);
+
+    static const char REQUEST2[] =
+            "\x40\x02\xFA\x3E" // CoAP header
+            "\xB2" "bs"; // OID
+    avs_unit_mocksock_input(mocksocks[0], REQUEST2, sizeof(REQUEST2) - 1);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], "\x60\xA0\xFA\x3E");
+    AVS_UNIT_ASSERT_FAILED(anjay_serve(anjay, mocksocks[0]));
+    AVS_UNIT_ASSERT_EQUAL(AVS_UNIT_MOCK_INVOCATIONS(_anjay_notify_perform), 1);
+    // kept for the next Bootstrap Finish attempt
+    AVS_UNIT_ASSERT_NULL(anjay->scheduled_notify.queue);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay->bootstrap.notification_queue);
+
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(bootstrap_invalid, invalid) {
     DM_TEST_INIT_WITH_SSIDS(ANJAY_SSID_BOOTSTRAP);
      static const char REQUEST[] =
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <assert.h>
+
+#include "base64_bulk.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+static const char BASE64_CHARS[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// both markers have at least one of two most significant bits set, so that
+// a group can be validated with a single check of ORed values
+#define XX 0xFF /* invalid character */
+#define PD 0xFE /* padding */
+
+static const uint8_t BASE64_VALUES[256] = {
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, 62, XX, XX, XX, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, XX, XX, XX, PD, XX, XX,
+    XX,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, XX, XX, XX, XX, XX,
+    XX, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX
+};
+
+size_t _anjay_base64_encode_groups(char *out,
+                                   const uint8_t *in,
+                                   size_t in_size) {
+    assert(in_size % 3 == 0);
+    char *ptr = out;
+    for (const uint8_t *end = in + in_size; in < end; in += 3) {
+        const uint32_t group = ((uint32_t) in[0] << 16)
+                               | ((uint32_t) in[1] << 8)
+                               | (uint32_t) in[2];
+        ptr[0] = BASE64_CHARS[group >> 18];
+        ptr[1] = BASE64_CHARS[(group >> 12) & 0x3F];
+        ptr[2] = BASE64_CHARS[(group >> 6) & 0x3F];
+        ptr[3] = BASE64_CHARS[group & 0x3F];
+        ptr += 4;
+    }
+    return (size_t) (ptr - out);
+}
+
+static int decode_padded_group(uint8_t *out,
+                               size_t *out_size,
+                               uint8_t a,
+                               uint8_t b,
+                               uint8_t c,
+                               uint8_t d) {
+    if ((a | b) & 0xC0) {
+        return -1;
+    }
+    if (c == PD && d == PD) {
+        out[0] = (uint8_t) ((a << 2) | (b >> 4));
+        *out_size = 1;
+        return 0;
+    } else if (!(c & 0xC0) && d == PD) {
+        out[0] = (uint8_t) ((a << 2) | (b >> 4));
+        out[1] = (uint8_t) ((b << 4) | (c >> 2));
+        *out_size = 2;
+        return 0;
+    }
+    return -1;
+}
+
+int _anjay_base64_decode_groups(uint8_t *out,
+                                size_t *out_size,
+                                const char *in,
+                                size_t in_size,
+                                bool allow_padding) {
+    assert(in_size % 4 == 0);
+    uint8_t *const out_begin = out;
+    for (const char *end = in + in_size; in < end; in += 4) {
+        const uint8_t a = BASE64_VALUES[(uint8_t) in[0]];
+        const uint8_t b = BASE64_VALUES[(uint8_t) in[1]];
+        const uint8_t c = BASE64_VALUES[(uint8_t) in[2]];
+        const uint8_t d = BASE64_VALUES[(uint8_t) in[3]];
+        if ((a | b | c | d) & 0xC0) {
+            size_t last_size;
+            if (!allow_padding || in + 4 != end
+                    || decode_padded_group(out, &last_size, a, b, c, d)) {
+                return -1;
+            }
+            out += last_size;
+            break;
+        }
+        const uint32_t group = ((uint32_t) a << 18) | ((uint32_t) b << 12)
+                               | ((uint32_t) c << 6) | (uint32_t) d;
+        out[0] = (uint8_t) (group >> 16);
+        out[1] = (uint8_t) (group >> 8);
+        out[2] = (uint8_t) group;
+        out += 3;
+    }
+    *out_size = (size_t) (out - out_begin);
+    return 0;
+}
+
+#ifdef ANJAY_TEST
+#include "test/base64_bulk.c"
+#endif
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANJAY_IO_BASE64_BULK_H
+#define ANJAY_IO_BASE64_BULK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Encodes @p in_size bytes of @p in as Base64, without padding and without
+ * a terminating nullbyte.
+ *
+ * @param out     Output buffer, at least (4 * in_size / 3) bytes long.
+ * @param in      Input data.
+ * @param in_size Number of input bytes; MUST be a multiple of 3.
+ *
+ * @returns Number of characters written to @p out.
+ */
+size_t _anjay_base64_encode_groups(char *out,
+                                   const uint8_t *in,
+                                   size_t in_size);
+
+/**
+ * Decodes @p in_size characters of strict Base64 (no whitespace allowed).
+ *
+ * @p out MAY be the same buffer as @p in - the input is processed front to
+ * back, and each 4-character group is read before its 3 bytes are written, so
+ * the data can be decoded in place.
+ *
+ * @param out            Output buffer, at least (3 * in_size / 4) bytes long.
+ * @param out_size       Set to the number of decoded bytes on success.
+ * @param in             Encoded data.
+ * @param in_size        Number of characters; MUST be a multiple of 4.
+ * @param allow_padding  If true, the last group is allowed to be padded with
+ *                       '=' characters. Padding is never allowed anywhere else.
+ *
+ * @returns 0 on success, negative value if the input is not valid Base64.
+ */
+int _anjay_base64_decode_groups(uint8_t *out,
+                                size_t *out_size,
+                                const char *in,
+                                size_t in_size,
+                                bool allow_padding);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_IO_BASE64_BULK_H */
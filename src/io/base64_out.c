@@ -21,6 +21,7 @@
 #include <anjay/core.h>
 
 #include "../utils_core.h"
+#include "base64_bulk.h"
 #include "base64_out.h"
 #include "vtable.h"
 
@@ -34,7 +35,7 @@ typedef struct base64_ret_bytes_ctx {
     size_t num_bytes_left;
 } base64_ret_bytes_ctx_t;
 
-#define TEXT_CHUNK_SIZE (3 * 64u)
+#define TEXT_CHUNK_SIZE (3 * 128u)
 AVS_STATIC_ASSERT(TEXT_CHUNK_SIZE % 3 == 0, chunk_must_be_a_multiple_of_3);
 
 static int base64_ret_encode_and_write(base64_ret_bytes_ctx_t *ctx,
@@ -53,27 +54,25 @@ static int base64_ret_encode_and_write(base64_ret_bytes_ctx_t *ctx,
     return avs_stream_write(ctx->stream, encoded, encoded_size - 1);
 }
 
+/**
+ * Encodes all full 3-byte groups from @p dataptr directly from the caller's
+ * buffer, without copying them into an intermediate chunk first.
+ */
 static int base64_ret_bytes_flush(base64_ret_bytes_ctx_t *ctx,
                                   const uint8_t **dataptr,
-                                  size_t bytes_to_write) {
-    uint8_t chunk[TEXT_CHUNK_SIZE];
-    while (bytes_to_write > 0) {
-        memcpy(chunk, ctx->bytes_cached, ctx->num_bytes_cached);
-        size_t new_bytes_written =
-                AVS_MIN(TEXT_CHUNK_SIZE - ctx->num_bytes_cached,
-                          bytes_to_write);
-        assert(new_bytes_written <= TEXT_CHUNK_SIZE);
-        memcpy(&chunk[ctx->num_bytes_cached], *dataptr, new_bytes_written);
-        *dataptr += new_bytes_written;
-
-        int retval;
-        if ((retval = base64_ret_encode_and_write(
-                     ctx, chunk, new_bytes_written + ctx->num_bytes_cached))) {
+                                  size_t *inout_size) {
+    char encoded[4 * (TEXT_CHUNK_SIZE / 3)];
+    while (*inout_size >= 3) {
+        const size_t chunk_size =
+                AVS_MIN(*inout_size / 3 * 3, (size_t) TEXT_CHUNK_SIZE);
+        const size_t encoded_size =
+                _anjay_base64_encode_groups(encoded, *dataptr, chunk_size);
+        int retval = avs_stream_write(ctx->stream, encoded, encoded_size);
+        if (retval) {
             return retval;
         }
-        bytes_to_write -= new_bytes_written;
-        ctx->num_bytes_left -= new_bytes_written;
-        ctx->num_bytes_cached = 0;
+        *dataptr += chunk_size;
+        *inout_size -= chunk_size;
     }
     return 0;
 }
@@ -85,24 +84,42 @@ static int base64_ret_bytes_append(anjay_ret_bytes_ctx_t *ctx_,
     if (size > ctx->num_bytes_left) {
         return -1;
     }
+    ctx->num_bytes_left -= size;
     const uint8_t *dataptr = (const uint8_t *) data;
-    size_t bytes_to_store;
-    if (size + ctx->num_bytes_cached < 3) {
-        bytes_to_store = size;
-    } else {
-        bytes_to_store = (ctx->num_bytes_cached + size) % 3;
+
+    if (ctx->num_bytes_cached) {
+        // complete the group started by a previous call
+        uint8_t group[3];
+        const size_t bytes_to_take =
+                AVS_MIN(sizeof(group) - ctx->num_bytes_cached, size);
+        memcpy(group, ctx->bytes_cached, ctx->num_bytes_cached);
+        memcpy(&group[ctx->num_bytes_cached], dataptr, bytes_to_take);
+        if (ctx->num_bytes_cached + bytes_to_take < sizeof(group)) {
+            memcpy(ctx->bytes_cached, group,
+                   ctx->num_bytes_cached + bytes_to_take);
+            ctx->num_bytes_cached += bytes_to_take;
+            return 0;
+        }
+        dataptr += bytes_to_take;
+        size -= bytes_to_take;
+        ctx->num_bytes_cached = 0;
+
+        char encoded[4];
+        int retval = avs_stream_write(
+                ctx->stream, encoded,
+                _anjay_base64_encode_groups(encoded, group, sizeof(group)));
+        if (retval) {
+            return retval;
+        }
     }
-    assert(bytes_to_store <= 2);
 
-    int retval = base64_ret_bytes_flush(ctx, &dataptr, size - bytes_to_store);
+    int retval = base64_ret_bytes_flush(ctx, &dataptr, &size);
     if (retval) {
         return retval;
     }
-    assert(ctx->num_bytes_cached + bytes_to_store
-               <= sizeof(ctx->bytes_cached));
-    memcpy(&ctx->bytes_cached[ctx->num_bytes_cached], dataptr, bytes_to_store);
-    ctx->num_bytes_cached += bytes_to_store;
-    ctx->num_bytes_left -= bytes_to_store;
+    assert(size <= sizeof(ctx->bytes_cached));
+    memcpy(ctx->bytes_cached, dataptr, size);
+    ctx->num_bytes_cached = size;
     return 0;
 }
 
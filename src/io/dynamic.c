@@ -221,6 +221,29 @@ static anjay_output_ctx_t *dynamic_ret_array_start(anjay_output_ctx_t *ctx_) {
     return NULL;
 }
 
+static int dynamic_ret_i64_array(anjay_output_ctx_t *ctx_,
+                                 const int64_t *values,
+                                 size_t count) {
+    dynamic_out_t *ctx = (dynamic_out_t *) ctx_;
+    if (ensure_backend(ctx, ANJAY_COAP_FORMAT_TLV)) {
+        return process_errno(ctx, "ret_i64_array",
+                             anjay_ret_i64_array(ctx->backend, values, count));
+    }
+    return -1;
+}
+
+static int dynamic_ret_double_array(anjay_output_ctx_t *ctx_,
+                                    const double *values,
+                                    size_t count) {
+    dynamic_out_t *ctx = (dynamic_out_t *) ctx_;
+    if (ensure_backend(ctx, ANJAY_COAP_FORMAT_TLV)) {
+        return process_errno(ctx, "ret_double_array",
+                             anjay_ret_double_array(ctx->backend, values,
+                                                    count));
+    }
+    return -1;
+}
+
 static anjay_output_ctx_t *dynamic_ret_object_start(anjay_output_ctx_t *ctx_) {
     dynamic_out_t *ctx = (dynamic_out_t *) ctx_;
     if (ensure_backend(ctx, ANJAY_COAP_FORMAT_TLV)) {
@@ -274,7 +297,9 @@ static const anjay_output_ctx_vtable_t DYNAMIC_OUT_VTABLE = {
     .array_start = dynamic_ret_array_start,
     .object_start = dynamic_ret_object_start,
     .set_id = dynamic_set_id,
-    .close = dynamic_close
+    .close = dynamic_close,
+    .i64_array = dynamic_ret_i64_array,
+    .f64_array = dynamic_ret_double_array
 };
 
 anjay_output_ctx_t *
@@ -0,0 +1,680 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <avsystem/commons/defs.h>
+
+#include "fp_conv.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+/////////////////////////////////////////////////////////////////// FORMATTING
+
+/*
+ * Shortest round-trip formatting is implemented using the Grisu2 algorithm
+ * (Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately
+ * with Integers", PLDI 2010). The generated digits are guaranteed to parse back
+ * to the original value, and are the shortest possible representation in the
+ * vast majority of cases.
+ */
+
+typedef struct {
+    uint64_t f;
+    int e;
+} diy_fp_t;
+
+#define DOUBLE_SIGNIFICAND_BITS 52
+#define DOUBLE_EXPONENT_BIAS (1023 + DOUBLE_SIGNIFICAND_BITS)
+#define FLOAT_SIGNIFICAND_BITS 23
+#define FLOAT_EXPONENT_BIAS (127 + FLOAT_SIGNIFICAND_BITS)
+
+static diy_fp_t diy_fp_sub(diy_fp_t a, diy_fp_t b) {
+    assert(a.e == b.e);
+    assert(a.f >= b.f);
+    diy_fp_t result = { a.f - b.f, a.e };
+    return result;
+}
+
+static diy_fp_t diy_fp_mul(diy_fp_t a, diy_fp_t b) {
+    const uint64_t M32 = UINT32_MAX;
+    const uint64_t ah = a.f >> 32;
+    const uint64_t al = a.f & M32;
+    const uint64_t bh = b.f >> 32;
+    const uint64_t bl = b.f & M32;
+    const uint64_t hh = ah * bh;
+    const uint64_t lh = al * bh;
+    const uint64_t hl = ah * bl;
+    const uint64_t ll = al * bl;
+    uint64_t tmp = (ll >> 32) + (hl & M32) + (lh & M32);
+    tmp += UINT64_C(1) << 31; // round to nearest
+    diy_fp_t result = {
+        hh + (hl >> 32) + (lh >> 32) + (tmp >> 32),
+        a.e + b.e + 64
+    };
+    return result;
+}
+
+static diy_fp_t diy_fp_normalize(diy_fp_t x) {
+    assert(x.f);
+    static const int SHIFTS[] = { 32, 16, 8, 4, 2, 1 };
+    for (size_t i = 0; i < sizeof(SHIFTS) / sizeof(SHIFTS[0]); ++i) {
+        if (!(x.f >> (64 - SHIFTS[i]))) {
+            x.f <<= SHIFTS[i];
+            x.e -= SHIFTS[i];
+        }
+    }
+    return x;
+}
+
+/**
+ * Calculates the boundaries m- and m+ of the rounding interval of @p v, i.e.
+ * the range of real numbers that are rounded to @p v when parsed. Both
+ * boundaries are returned with the same, normalized exponent.
+ */
+static void normalized_boundaries(diy_fp_t v,
+                                  uint64_t hidden_bit,
+                                  diy_fp_t *out_minus,
+                                  diy_fp_t *out_plus) {
+    diy_fp_t plus = { (v.f << 1) + 1, v.e - 1 };
+    plus = diy_fp_normalize(plus);
+
+    diy_fp_t minus;
+    if (v.f == hidden_bit) {
+        // the distance to the predecessor is only half of the distance to the
+        // successor if v is a power of two
+        minus.f = (v.f << 2) - 1;
+        minus.e = v.e - 2;
+    } else {
+        minus.f = (v.f << 1) - 1;
+        minus.e = v.e - 1;
+    }
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    *out_minus = minus;
+    *out_plus = plus;
+}
+
+/**
+ * Normalized 64-bit approximations of 10^k for k = -348, -340, ..., 340.
+ */
+static const diy_fp_t CACHED_POWERS[] = {
+    { UINT64_C(0xfa8fd5a0081c0288), -1220 },
+    { UINT64_C(0xbaaee17fa23ebf76), -1193 },
+    { UINT64_C(0x8b16fb203055ac76), -1166 },
+    { UINT64_C(0xcf42894a5dce35ea), -1140 },
+    { UINT64_C(0x9a6bb0aa55653b2d), -1113 },
+    { UINT64_C(0xe61acf033d1a45df), -1087 },
+    { UINT64_C(0xab70fe17c79ac6ca), -1060 },
+    { UINT64_C(0xff77b1fcbebcdc4f), -1034 },
+    { UINT64_C(0xbe5691ef416bd60c), -1007 },
+    { UINT64_C(0x8dd01fad907ffc3c), -980 },
+    { UINT64_C(0xd3515c2831559a83), -954 },
+    { UINT64_C(0x9d71ac8fada6c9b5), -927 },
+    { UINT64_C(0xea9c227723ee8bcb), -901 },
+    { UINT64_C(0xaecc49914078536d), -874 },
+    { UINT64_C(0x823c12795db6ce57), -847 },
+    { UINT64_C(0xc21094364dfb5637), -821 },
+    { UINT64_C(0x9096ea6f3848984f), -794 },
+    { UINT64_C(0xd77485cb25823ac7), -768 },
+    { UINT64_C(0xa086cfcd97bf97f4), -741 },
+    { UINT64_C(0xef340a98172aace5), -715 },
+    { UINT64_C(0xb23867fb2a35b28e), -688 },
+    { UINT64_C(0x84c8d4dfd2c63f3b), -661 },
+    { UINT64_C(0xc5dd44271ad3cdba), -635 },
+    { UINT64_C(0x936b9fcebb25c996), -608 },
+    { UINT64_C(0xdbac6c247d62a584), -582 },
+    { UINT64_C(0xa3ab66580d5fdaf6), -555 },
+    { UINT64_C(0xf3e2f893dec3f126), -529 },
+    { UINT64_C(0xb5b5ada8aaff80b8), -502 },
+    { UINT64_C(0x87625f056c7c4a8b), -475 },
+    { UINT64_C(0xc9bcff6034c13053), -449 },
+    { UINT64_C(0x964e858c91ba2655), -422 },
+    { UINT64_C(0xdff9772470297ebd), -396 },
+    { UINT64_C(0xa6dfbd9fb8e5b88f), -369 },
+    { UINT64_C(0xf8a95fcf88747d94), -343 },
+    { UINT64_C(0xb94470938fa89bcf), -316 },
+    { UINT64_C(0x8a08f0f8bf0f156b), -289 },
+    { UINT64_C(0xcdb02555653131b6), -263 },
+    { UINT64_C(0x993fe2c6d07b7fac), -236 },
+    { UINT64_C(0xe45c10c42a2b3b06), -210 },
+    { UINT64_C(0xaa242499697392d3), -183 },
+    { UINT64_C(0xfd87b5f28300ca0e), -157 },
+    { UINT64_C(0xbce5086492111aeb), -130 },
+    { UINT64_C(0x8cbccc096f5088cc), -103 },
+    { UINT64_C(0xd1b71758e219652c), -77 },
+    { UINT64_C(0x9c40000000000000), -50 },
+    { UINT64_C(0xe8d4a51000000000), -24 },
+    { UINT64_C(0xad78ebc5ac620000), 3 },
+    { UINT64_C(0x813f3978f8940984), 30 },
+    { UINT64_C(0xc097ce7bc90715b3), 56 },
+    { UINT64_C(0x8f7e32ce7bea5c70), 83 },
+    { UINT64_C(0xd5d238a4abe98068), 109 },
+    { UINT64_C(0x9f4f2726179a2245), 136 },
+    { UINT64_C(0xed63a231d4c4fb27), 162 },
+    { UINT64_C(0xb0de65388cc8ada8), 189 },
+    { UINT64_C(0x83c7088e1aab65db), 216 },
+    { UINT64_C(0xc45d1df942711d9a), 242 },
+    { UINT64_C(0x924d692ca61be758), 269 },
+    { UINT64_C(0xda01ee641a708dea), 295 },
+    { UINT64_C(0xa26da3999aef774a), 322 },
+    { UINT64_C(0xf209787bb47d6b85), 348 },
+    { UINT64_C(0xb454e4a179dd1877), 375 },
+    { UINT64_C(0x865b86925b9bc5c2), 402 },
+    { UINT64_C(0xc83553c5c8965d3d), 428 },
+    { UINT64_C(0x952ab45cfa97a0b3), 455 },
+    { UINT64_C(0xde469fbd99a05fe3), 481 },
+    { UINT64_C(0xa59bc234db398c25), 508 },
+    { UINT64_C(0xf6c69a72a3989f5c), 534 },
+    { UINT64_C(0xb7dcbf5354e9bece), 561 },
+    { UINT64_C(0x88fcf317f22241e2), 588 },
+    { UINT64_C(0xcc20ce9bd35c78a5), 614 },
+    { UINT64_C(0x98165af37b2153df), 641 },
+    { UINT64_C(0xe2a0b5dc971f303a), 667 },
+    { UINT64_C(0xa8d9d1535ce3b396), 694 },
+    { UINT64_C(0xfb9b7cd9a4a7443c), 720 },
+    { UINT64_C(0xbb764c4ca7a44410), 747 },
+    { UINT64_C(0x8bab8eefb6409c1a), 774 },
+    { UINT64_C(0xd01fef10a657842c), 800 },
+    { UINT64_C(0x9b10a4e5e9913129), 827 },
+    { UINT64_C(0xe7109bfba19c0c9d), 853 },
+    { UINT64_C(0xac2820d9623bf429), 880 },
+    { UINT64_C(0x80444b5e7aa7cf85), 907 },
+    { UINT64_C(0xbf21e44003acdd2d), 933 },
+    { UINT64_C(0x8e679c2f5e44ff8f), 960 },
+    { UINT64_C(0xd433179d9c8cb841), 986 },
+    { UINT64_C(0x9e19db92b4e31ba9), 1013 },
+    { UINT64_C(0xeb96bf6ebadf77d9), 1039 },
+    { UINT64_C(0xaf87023b9bf0ee6b), 1066 }
+};
+
+#define CACHED_POWERS_MIN_DEC_EXP (-348)
+#define CACHED_POWERS_DEC_EXP_STEP 8
+
+/**
+ * Returns a cached power of ten c = 10^-k, such that the binary exponent of
+ * c * 2^e is in range [-60, -32]. This allows the digit generation loop to
+ * operate on 32-bit integral parts.
+ */
+static diy_fp_t get_cached_power(int e, int *out_k) {
+    // log10(2) ~= 0.30102999566398114; 347 = 1 - CACHED_POWERS_MIN_DEC_EXP
+    const double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = (int) dk;
+    if (dk - k > 0.0) {
+        ++k;
+    }
+    const size_t index = (size_t) ((k >> 3) + 1);
+    assert(index < sizeof(CACHED_POWERS) / sizeof(CACHED_POWERS[0]));
+    *out_k = -(CACHED_POWERS_MIN_DEC_EXP
+               + (int) index * CACHED_POWERS_DEC_EXP_STEP);
+    return CACHED_POWERS[index];
+}
+
+static const uint64_t POWERS_OF_TEN_U64[] = {
+    UINT64_C(1),
+    UINT64_C(10),
+    UINT64_C(100),
+    UINT64_C(1000),
+    UINT64_C(10000),
+    UINT64_C(100000),
+    UINT64_C(1000000),
+    UINT64_C(10000000),
+    UINT64_C(100000000),
+    UINT64_C(1000000000),
+    UINT64_C(10000000000),
+    UINT64_C(100000000000),
+    UINT64_C(1000000000000),
+    UINT64_C(10000000000000),
+    UINT64_C(100000000000000),
+    UINT64_C(1000000000000000),
+    UINT64_C(10000000000000000),
+    UINT64_C(100000000000000000),
+    UINT64_C(1000000000000000000),
+    UINT64_C(10000000000000000000)
+};
+
+#define POWERS_OF_TEN_U64_COUNT \
+        (int) (sizeof(POWERS_OF_TEN_U64) / sizeof(POWERS_OF_TEN_U64[0]))
+
+static int count_decimal_digits(uint32_t n) {
+    int result = 1;
+    while (result < 10 && n >= POWERS_OF_TEN_U64[result]) {
+        ++result;
+    }
+    return result;
+}
+
+static void grisu_round(char *buffer,
+                        int length,
+                        uint64_t delta,
+                        uint64_t rest,
+                        uint64_t ten_kappa,
+                        uint64_t wp_w) {
+    // move the last digit towards the exact value, as long as it stays within
+    // the rounding interval
+    while (rest < wp_w && delta - rest >= ten_kappa
+            && (rest + ten_kappa < wp_w
+                || wp_w - rest > rest + ten_kappa - wp_w)) {
+        --buffer[length - 1];
+        rest += ten_kappa;
+    }
+}
+
+static void digit_gen(diy_fp_t w,
+                      diy_fp_t mp,
+                      uint64_t delta,
+                      char *buffer,
+                      int *inout_length,
+                      int *inout_k) {
+    const int one_e = -mp.e;
+    const uint64_t one_f = UINT64_C(1) << one_e;
+    const diy_fp_t wp_w = diy_fp_sub(mp, w);
+    uint32_t p1 = (uint32_t) (mp.f >> one_e);
+    uint64_t p2 = mp.f & (one_f - 1);
+    int kappa = count_decimal_digits(p1);
+    int length = 0;
+
+    while (kappa > 0) {
+        const uint32_t divisor = (uint32_t) POWERS_OF_TEN_U64[kappa - 1];
+        const uint32_t d = p1 / divisor;
+        p1 %= divisor;
+        if (d || length) {
+            buffer[length++] = (char) ('0' + d);
+        }
+        --kappa;
+        const uint64_t rest = ((uint64_t) p1 << one_e) + p2;
+        if (rest <= delta) {
+            *inout_k += kappa;
+            grisu_round(buffer, length, delta, rest,
+                        POWERS_OF_TEN_U64[kappa] << one_e, wp_w.f);
+            *inout_length = length;
+            return;
+        }
+    }
+
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        const char d = (char) (p2 >> one_e);
+        if (d || length) {
+            buffer[length++] = (char) ('0' + d);
+        }
+        p2 &= one_f - 1;
+        --kappa;
+        if (p2 < delta) {
+            *inout_k += kappa;
+            grisu_round(buffer, length, delta, p2, one_f,
+                        -kappa < POWERS_OF_TEN_U64_COUNT
+                                ? wp_w.f * POWERS_OF_TEN_U64[-kappa]
+                                : 0);
+            *inout_length = length;
+            return;
+        }
+    }
+}
+
+/**
+ * Generates the shortest digit string (without leading or trailing zeros) for
+ * a positive value v, such that v ~= buffer * 10^(*out_k).
+ */
+static void grisu2(diy_fp_t v,
+                   uint64_t hidden_bit,
+                   char *buffer,
+                   int *out_length,
+                   int *out_k) {
+    diy_fp_t w_minus;
+    diy_fp_t w_plus;
+    normalized_boundaries(v, hidden_bit, &w_minus, &w_plus);
+
+    const diy_fp_t c_mk = get_cached_power(w_plus.e, out_k);
+    const diy_fp_t w = diy_fp_mul(diy_fp_normalize(v), c_mk);
+    diy_fp_t wp = diy_fp_mul(w_plus, c_mk);
+    diy_fp_t wm = diy_fp_mul(w_minus, c_mk);
+    // account for the imprecision of the multiplications above
+    ++wm.f;
+    --wp.f;
+    digit_gen(w, wp, wp.f - wm.f, buffer, out_length, out_k);
+}
+
+static size_t write_exponent(char *out, int exponent) {
+    size_t length = 0;
+    out[length++] = 'e';
+    if (exponent < 0) {
+        out[length++] = '-';
+        exponent = -exponent;
+    } else {
+        out[length++] = '+';
+    }
+    // at least two digits, for consistency with printf("%g")
+    if (exponent >= 100) {
+        out[length++] = (char) ('0' + exponent / 100);
+        exponent %= 100;
+    }
+    out[length++] = (char) ('0' + exponent / 10);
+    out[length++] = (char) ('0' + exponent % 10);
+    return length;
+}
+
+/**
+ * Lays out the digits of value = digits * 10^k in @p out. @p out initially
+ * contains the digits themselves and needs to be large enough to hold the
+ * formatted value.
+ */
+static size_t format_digits(char *out, int length, int k) {
+    // kk is the position of the decimal point relative to the first digit,
+    // i.e. 10^(kk - 1) <= value < 10^kk
+    const int kk = length + k;
+
+    if (length <= kk && kk <= 21) {
+        // integer: 1234e7 -> 12340000000
+        memset(out + length, '0', (size_t) (kk - length));
+        return (size_t) kk;
+    } else if (0 < kk && kk <= 21) {
+        // 1234e-2 -> 12.34
+        memmove(out + kk + 1, out + kk, (size_t) (length - kk));
+        out[kk] = '.';
+        return (size_t) length + 1;
+    } else if (-6 < kk && kk <= 0) {
+        // 1234e-6 -> 0.001234
+        const size_t offset = (size_t) (2 - kk);
+        memmove(out + offset, out, (size_t) length);
+        out[0] = '0';
+        out[1] = '.';
+        memset(out + 2, '0', (size_t) -kk);
+        return (size_t) length + offset;
+    } else if (length == 1) {
+        // 1e30 -> 1e+30
+        return 1 + write_exponent(out + 1, kk - 1);
+    } else {
+        // 1234e30 -> 1.234e+33
+        memmove(out + 2, out + 1, (size_t) (length - 1));
+        out[1] = '.';
+        return (size_t) length + 1
+               + write_exponent(out + length + 1, kk - 1);
+    }
+}
+
+static size_t format_special(char *out_buf, bool negative, bool is_zero,
+                             bool is_nan) {
+    size_t length = 0;
+    if (negative && !is_nan) {
+        out_buf[length++] = '-';
+    }
+    const char *str = is_nan ? "nan" : (is_zero ? "0" : "inf");
+    const size_t str_length = strlen(str);
+    memcpy(out_buf + length, str, str_length + 1);
+    return length + str_length;
+}
+
+size_t _anjay_fp_format_double(char *out_buf, double value) {
+    uint64_t bits;
+    AVS_STATIC_ASSERT(sizeof(bits) == sizeof(value), double_is_64bit);
+    memcpy(&bits, &value, sizeof(bits));
+
+    const bool negative = !!(bits >> 63);
+    const uint64_t hidden_bit = UINT64_C(1) << DOUBLE_SIGNIFICAND_BITS;
+    const unsigned biased_e = (unsigned) (bits >> DOUBLE_SIGNIFICAND_BITS)
+                              & 0x7FF;
+    diy_fp_t v = { bits & (hidden_bit - 1), 0 };
+
+    if (biased_e == 0x7FF || (biased_e == 0 && v.f == 0)) {
+        return format_special(out_buf, negative, biased_e == 0,
+                              biased_e == 0x7FF && v.f != 0);
+    }
+    if (biased_e) {
+        v.f += hidden_bit;
+        v.e = (int) biased_e - DOUBLE_EXPONENT_BIAS;
+    } else {
+        v.e = 1 - DOUBLE_EXPONENT_BIAS;
+    }
+
+    char *digits = out_buf + (negative ? 1 : 0);
+    int length;
+    int k;
+    grisu2(v, hidden_bit, digits, &length, &k);
+    if (negative) {
+        out_buf[0] = '-';
+    }
+    const size_t result = (size_t) (digits - out_buf)
+                          + format_digits(digits, length, k);
+    assert(result < ANJAY_FP_STRING_BUFFER_SIZE);
+    out_buf[result] = '\0';
+    return result;
+}
+
+size_t _anjay_fp_format_float(char *out_buf, float value) {
+    uint32_t bits;
+    AVS_STATIC_ASSERT(sizeof(bits) == sizeof(value), float_is_32bit);
+    memcpy(&bits, &value, sizeof(bits));
+
+    const bool negative = !!(bits >> 31);
+    const uint32_t hidden_bit = UINT32_C(1) << FLOAT_SIGNIFICAND_BITS;
+    const unsigned biased_e = (unsigned) (bits >> FLOAT_SIGNIFICAND_BITS)
+                              & 0xFF;
+    diy_fp_t v = { bits & (hidden_bit - 1), 0 };
+
+    if (biased_e == 0xFF || (biased_e == 0 && v.f == 0)) {
+        return format_special(out_buf, negative, biased_e == 0,
+                              biased_e == 0xFF && v.f != 0);
+    }
+    if (biased_e) {
+        v.f += hidden_bit;
+        v.e = (int) biased_e - FLOAT_EXPONENT_BIAS;
+    } else {
+        v.e = 1 - FLOAT_EXPONENT_BIAS;
+    }
+
+    char *digits = out_buf + (negative ? 1 : 0);
+    int length;
+    int k;
+    grisu2(v, hidden_bit, digits, &length, &k);
+    if (negative) {
+        out_buf[0] = '-';
+    }
+    const size_t result = (size_t) (digits - out_buf)
+                          + format_digits(digits, length, k);
+    assert(result < ANJAY_FP_STRING_BUFFER_SIZE);
+    out_buf[result] = '\0';
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////// PARSING
+
+typedef struct {
+    uint64_t mantissa;
+    int exponent;
+    bool negative;
+} decimal_t;
+
+#define MAX_FAST_PATH_DIGITS 19
+#define MAX_FAST_PATH_EXPONENT_DIGITS_VALUE 9999
+
+static bool is_digit(char c) {
+    // isdigit() might be locale-dependent
+    return c >= '0' && c <= '9';
+}
+
+static const char *parse_digits(const char *ptr,
+                                decimal_t *inout_dec,
+                                int *inout_significant_digits,
+                                bool fractional,
+                                bool *out_any_digits) {
+    for (; is_digit(*ptr); ++ptr) {
+        *out_any_digits = true;
+        if (inout_dec->mantissa || *ptr != '0') {
+            if (++*inout_significant_digits > MAX_FAST_PATH_DIGITS) {
+                return NULL;
+            }
+            inout_dec->mantissa =
+                    10 * inout_dec->mantissa + (uint64_t) (*ptr - '0');
+        }
+        if (fractional) {
+            --inout_dec->exponent;
+        }
+    }
+    return ptr;
+}
+
+/**
+ * Parses a plain decimal number, so that value = mantissa * 10^exponent.
+ * Fails for anything that is not fully consumed, has too many significant
+ * digits, or uses a syntax other than plain decimal (e.g. "inf" or hex).
+ */
+static int parse_decimal(const char *in, decimal_t *out_dec) {
+    const char *ptr = in;
+    decimal_t dec = { 0, 0, false };
+    if (*ptr == '+' || *ptr == '-') {
+        dec.negative = (*ptr++ == '-');
+    }
+
+    int significant_digits = 0;
+    bool any_digits = false;
+    if (!(ptr = parse_digits(ptr, &dec, &significant_digits, false,
+                             &any_digits))) {
+        return -1;
+    }
+    if (*ptr == '.'
+            && !(ptr = parse_digits(ptr + 1, &dec, &significant_digits, true,
+                                    &any_digits))) {
+        return -1;
+    }
+    if (!any_digits) {
+        return -1;
+    }
+
+    if (*ptr == 'e' || *ptr == 'E') {
+        ++ptr;
+        bool exponent_negative = false;
+        if (*ptr == '+' || *ptr == '-') {
+            exponent_negative = (*ptr++ == '-');
+        }
+        if (!is_digit(*ptr)) {
+            return -1;
+        }
+        int exponent = 0;
+        for (; is_digit(*ptr); ++ptr) {
+            if (exponent > MAX_FAST_PATH_EXPONENT_DIGITS_VALUE) {
+                return -1;
+            }
+            exponent = 10 * exponent + (*ptr - '0');
+        }
+        dec.exponent += exponent_negative ? -exponent : exponent;
+    }
+
+    if (*ptr) {
+        return -1;
+    }
+    *out_dec = dec;
+    return 0;
+}
+
+/**
+ * Powers of ten that are exactly representable as double.
+ */
+static const double EXACT_POWERS_OF_TEN[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define MAX_EXACT_DOUBLE_POWER_OF_TEN 22
+#define MAX_EXACT_DOUBLE_MANTISSA (UINT64_C(1) << 53)
+#define MAX_EXACT_FLOAT_POWER_OF_TEN 10
+#define MAX_EXACT_FLOAT_MANTISSA (UINT64_C(1) << 24)
+
+/**
+ * Moves the excess positive exponent into the mantissa, as long as it remains
+ * exactly representable, e.g. 12e25 -> 120000e22.
+ */
+static int shift_exponent_into_mantissa(decimal_t *dec,
+                                        int max_exponent,
+                                        uint64_t max_mantissa) {
+    while (dec->exponent > max_exponent) {
+        if (dec->mantissa > max_mantissa / 10) {
+            return -1;
+        }
+        dec->mantissa *= 10;
+        --dec->exponent;
+    }
+    return 0;
+}
+
+/*
+ * Both fast paths below rely on IEEE 754 guarantee that a single
+ * multiplication or division of exactly representable operands is correctly
+ * rounded (Clinger's fast path). This does not hold if intermediate results
+ * are calculated in extended precision, hence the double_t/float_t checks.
+ */
+
+int _anjay_fp_parse_double_fast(const char *in, double *out_value) {
+    decimal_t dec;
+    if (sizeof(double_t) != sizeof(double) || parse_decimal(in, &dec)) {
+        return -1;
+    }
+    if (dec.mantissa == 0) {
+        *out_value = dec.negative ? -0.0 : 0.0;
+        return 0;
+    }
+    if (shift_exponent_into_mantissa(&dec, MAX_EXACT_DOUBLE_POWER_OF_TEN,
+                                     MAX_EXACT_DOUBLE_MANTISSA)
+            || dec.mantissa > MAX_EXACT_DOUBLE_MANTISSA
+            || dec.exponent < -MAX_EXACT_DOUBLE_POWER_OF_TEN) {
+        return -1;
+    }
+    double value = (double) dec.mantissa;
+    if (dec.exponent < 0) {
+        value /= EXACT_POWERS_OF_TEN[-dec.exponent];
+    } else {
+        value *= EXACT_POWERS_OF_TEN[dec.exponent];
+    }
+    *out_value = dec.negative ? -value : value;
+    return 0;
+}
+
+int _anjay_fp_parse_float_fast(const char *in, float *out_value) {
+    decimal_t dec;
+    if (sizeof(float_t) != sizeof(float) || parse_decimal(in, &dec)) {
+        return -1;
+    }
+    if (dec.mantissa == 0) {
+        *out_value = dec.negative ? -0.0f : 0.0f;
+        return 0;
+    }
+    if (shift_exponent_into_mantissa(&dec, MAX_EXACT_FLOAT_POWER_OF_TEN,
+                                     MAX_EXACT_FLOAT_MANTISSA)
+            || dec.mantissa > MAX_EXACT_FLOAT_MANTISSA
+            || dec.exponent < -MAX_EXACT_FLOAT_POWER_OF_TEN) {
+        return -1;
+    }
+    float value = (float) dec.mantissa;
+    if (dec.exponent < 0) {
+        value /= (float) EXACT_POWERS_OF_TEN[-dec.exponent];
+    } else {
+        value *= (float) EXACT_POWERS_OF_TEN[dec.exponent];
+    }
+    *out_value = dec.negative ? -value : value;
+    return 0;
+}
+
+#ifdef ANJAY_TEST
+#include "test/fp_conv.c"
+#endif
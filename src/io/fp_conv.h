@@ -0,0 +1,74 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANJAY_IO_FP_CONV_H
+#define ANJAY_IO_FP_CONV_H
+
+#include <stddef.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Size of a buffer large enough to hold any value formatted by
+ * @ref _anjay_fp_format_double or @ref _anjay_fp_format_float, including the
+ * terminating nullbyte.
+ */
+#define ANJAY_FP_STRING_BUFFER_SIZE 32
+
+/**
+ * Formats @p value as the shortest decimal string that parses back to exactly
+ * the same double. The output is locale-independent and uses plain decimal
+ * notation for values in range [1e-6, 1e21), and printf-like exponential
+ * notation ("1.5e+300") otherwise. NaN and infinities are formatted as "nan",
+ * "inf" and "-inf".
+ *
+ * @param out_buf Buffer of at least @ref ANJAY_FP_STRING_BUFFER_SIZE bytes.
+ * @param value   Value to format.
+ *
+ * @returns Length of the formatted string, not including the nullbyte.
+ */
+size_t _anjay_fp_format_double(char *out_buf, double value);
+
+/**
+ * Same as @ref _anjay_fp_format_double, but the result is the shortest string
+ * that round-trips when parsed as a single-precision float.
+ */
+size_t _anjay_fp_format_float(char *out_buf, float value);
+
+/**
+ * Attempts to parse @p in as a plain decimal number ([+-]digits[.digits]
+ * [e[+-]digits]) in a way that is guaranteed to be correctly rounded.
+ *
+ * Only inputs that can be converted exactly using a single floating-point
+ * operation are handled (at most 19 significant digits, with the mantissa and
+ * power of ten both exactly representable). This covers virtually all values
+ * produced by @ref _anjay_fp_format_double and typical human-written input.
+ *
+ * @returns 0 on success, or a negative value if the input is not handled by
+ *          the fast path - in that case, the caller shall fall back to
+ *          strtod(). Note that a negative value does NOT mean that @p in is
+ *          not a valid number.
+ */
+int _anjay_fp_parse_double_fast(const char *in, double *out_value);
+
+/**
+ * Single-precision counterpart of @ref _anjay_fp_parse_double_fast.
+ */
+int _anjay_fp_parse_float_fast(const char *in, float *out_value);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_IO_FP_CONV_H */
@@ -29,6 +29,7 @@
 
 #include "../io_core.h"
 #include "base64_out.h"
+#include "fp_conv.h"
 #include "vtable.h"
 
 #define json_log(level, ...) _anjay_log(json, level, __VA_ARGS__)
@@ -161,7 +162,7 @@ update_node_path(json_out_t *ctx, anjay_id_type_t type, uint16_t id) {
     }
 }
 
-#define MAX_CHILD_PATH_LEN sizeof("/65535/65535/65535")
+#define MAX_CHILD_PATH_LEN sizeof("/65535/65535/65535/65535")
 
 static size_t
 count_child_path_elems(json_out_t *ctx) {
@@ -182,6 +183,14 @@ static ssize_t child_path_to_string(json_out_t *ctx, char *dest, size_t size) {
                                    ctx->path[ctx->num_base_path_elems].id,
                                    ctx->path[ctx->num_base_path_elems + 1].id,
                                    ctx->path[ctx->num_base_path_elems + 2].id);
+    case 4:
+        // only possible for composite responses, where the base is the root
+        return avs_simple_snprintf(dest, size,
+                                   "/%"PRId32"/%"PRId32"/%"PRId32"/%"PRId32,
+                                   ctx->path[ctx->num_base_path_elems].id,
+                                   ctx->path[ctx->num_base_path_elems + 1].id,
+                                   ctx->path[ctx->num_base_path_elems + 2].id,
+                                   ctx->path[ctx->num_base_path_elems + 3].id);
     default:
         return -1;
     }
@@ -250,15 +259,20 @@ static int write_variable(avs_stream_abstract_t *stream,
         return retval;
     }
 
+    char fp_buf[ANJAY_FP_STRING_BUFFER_SIZE];
     switch (type) {
     case JSON_DATA_I32:
         return avs_stream_write_f(stream, "%" PRIi32, *(const int32_t *) value);
     case JSON_DATA_I64:
         return avs_stream_write_f(stream, "%" PRIi64, *(const int64_t *) value);
     case JSON_DATA_F32:
-        return avs_stream_write_f(stream, "%f", *(const float *) value);
+        return avs_stream_write(
+                stream, fp_buf,
+                _anjay_fp_format_float(fp_buf, *(const float *) value));
     case JSON_DATA_F64:
-        return avs_stream_write_f(stream, "%f", *(const double *) value);
+        return avs_stream_write(
+                stream, fp_buf,
+                _anjay_fp_format_double(fp_buf, *(const double *) value));
     case JSON_DATA_BOOL:
         return avs_stream_write_f(stream, "%s",
                                   (*(const bool *) value) ? "true" : "false");
@@ -278,6 +292,11 @@ static int write_variable(avs_stream_abstract_t *stream,
 
 static int write_uri(avs_stream_abstract_t *stream,
                      const anjay_uri_path_t *path) {
+    if (!_anjay_uri_path_has_oid(path)) {
+        // the root path is represented by an empty base name, so that the
+        // element names, which always start with a slash, are absolute paths
+        return 0;
+    }
     int retval = avs_stream_write_f(stream, "/%d", path->oid);
     if (!retval &&  _anjay_uri_path_has_iid(path)) {
         retval = avs_stream_write_f(stream, "/%d", path->iid);
@@ -489,6 +508,59 @@ static int json_ret_array_finish(anjay_output_ctx_t *ctx_) {
     return 0;
 }
 
+static int json_ret_numeric_array(json_out_t *ctx,
+                                  json_data_type_t type,
+                                  const void *values,
+                                  size_t value_size,
+                                  size_t count) {
+    if (ctx->returning_array || ctx->bytes) {
+        json_log(ERROR, "cannot return an array in the current state");
+        return -1;
+    }
+    // the element names differ only in the last segment, so the part common
+    // to all of them is formatted only once
+    update_node_path(ctx, ANJAY_ID_RIID, 0);
+    char prefix[MAX_CHILD_PATH_LEN] = "";
+    --ctx->num_path_elems;
+    ssize_t prefix_result = count_child_path_elems(ctx)
+            ? child_path_to_string(ctx, prefix, sizeof(prefix))
+            : 0;
+    ++ctx->num_path_elems;
+    if (prefix_result < 0) {
+        return -1;
+    }
+
+    int retval = 0;
+    for (size_t i = 0; !retval && i < count; ++i) {
+        (void) ((retval = maybe_write_separator(ctx))
+                || (retval = avs_stream_write_f(ctx->stream,
+                                                "{\"n\":\"%s/%u\",", prefix,
+                                                (unsigned) i))
+                || (retval = write_variable(ctx->stream, type,
+                                            (const char *) values
+                                                    + i * value_size))
+                || (retval = avs_stream_write(ctx->stream, "}", 1)));
+    }
+    if (count) {
+        last_path_elem(ctx)->id = (int32_t) (count - 1);
+    }
+    return retval;
+}
+
+static int json_ret_i64_array(anjay_output_ctx_t *ctx,
+                              const int64_t *values,
+                              size_t count) {
+    return json_ret_numeric_array((json_out_t *) ctx, JSON_DATA_I64, values,
+                                  sizeof(*values), count);
+}
+
+static int json_ret_double_array(anjay_output_ctx_t *ctx,
+                                 const double *values,
+                                 size_t count) {
+    return json_ret_numeric_array((json_out_t *) ctx, JSON_DATA_F64, values,
+                                  sizeof(*values), count);
+}
+
 static anjay_output_ctx_t *json_ret_object_start(anjay_output_ctx_t *ctx) {
     return ctx;
 }
@@ -549,7 +621,9 @@ static const anjay_output_ctx_vtable_t JSON_OUT_VTABLE = {
     json_ret_object_start,
     json_ret_object_finish,
     json_set_id,
-    json_output_close
+    json_output_close,
+    json_ret_i64_array,
+    json_ret_double_array
 };
 
 static int write_response_preamble(avs_stream_abstract_t *stream,
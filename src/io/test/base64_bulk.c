@@ -0,0 +1,90 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <string.h>
+
+#include <avsystem/commons/base64.h>
+#include <avsystem/commons/unit/test.h>
+
+AVS_UNIT_TEST(base64_bulk, encode_matches_reference) {
+    uint8_t data[3 * 100];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = (uint8_t) (i * 7 + 13);
+    }
+    for (size_t size = 0; size <= sizeof(data); size += 3) {
+        char reference[4 * sizeof(data) / 3 + 1];
+        AVS_UNIT_ASSERT_SUCCESS(avs_base64_encode(
+                reference, sizeof(reference), data, size));
+
+        char encoded[4 * sizeof(data) / 3];
+        size_t encoded_size =
+                _anjay_base64_encode_groups(encoded, data, size);
+        AVS_UNIT_ASSERT_EQUAL(encoded_size, strlen(reference));
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(encoded, reference, encoded_size);
+    }
+}
+
+AVS_UNIT_TEST(base64_bulk, decode_in_place) {
+    uint8_t data[3 * 100];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = (uint8_t) (i * 11 + 5);
+    }
+    char buf[4 * sizeof(data) / 3];
+    size_t encoded_size =
+            _anjay_base64_encode_groups(buf, data, sizeof(data));
+
+    size_t decoded_size;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_base64_decode_groups(
+            (uint8_t *) buf, &decoded_size, buf, encoded_size, false));
+    AVS_UNIT_ASSERT_EQUAL(decoded_size, sizeof(data));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, data, sizeof(data));
+}
+
+#define TEST_DECODE(Encoded, Padding, Expected) do { \
+    uint8_t out[sizeof(Encoded)]; \
+    size_t out_size; \
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_base64_decode_groups( \
+            out, &out_size, (Encoded), sizeof(Encoded) - 1, (Padding))); \
+    AVS_UNIT_ASSERT_EQUAL(out_size, sizeof(Expected) - 1); \
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(out, (Expected), out_size); \
+} while (false)
+
+#define TEST_DECODE_FAIL(Encoded, Padding) do { \
+    uint8_t out[sizeof(Encoded)]; \
+    size_t out_size; \
+    AVS_UNIT_ASSERT_FAILED(_anjay_base64_decode_groups( \
+            out, &out_size, (Encoded), sizeof(Encoded) - 1, (Padding))); \
+} while (false)
+
+AVS_UNIT_TEST(base64_bulk, decode) {
+    TEST_DECODE("", false, "");
+    TEST_DECODE("Zm9v", false, "foo");
+    TEST_DECODE("Zm9vYg==", true, "foob");
+    TEST_DECODE("Zm9vYmE=", true, "fooba");
+    TEST_DECODE("Zm9vYmFy", true, "foobar");
+
+    TEST_DECODE_FAIL("Zm9vYg==", false);
+    TEST_DECODE_FAIL("Zg==Zm9v", true);
+    TEST_DECODE_FAIL("Z===", true);
+    TEST_DECODE_FAIL("Zm=v", true);
+    TEST_DECODE_FAIL("Zm9 ", true);
+    TEST_DECODE_FAIL("Zm9\xc3", true);
+}
+
+#undef TEST_DECODE_FAIL
+#undef TEST_DECODE
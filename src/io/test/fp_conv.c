@@ -0,0 +1,210 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <avsystem/commons/unit/test.h>
+
+#include "../../utils_core.h"
+
+#define TEST_FORMAT_DOUBLE(Val, Expected) do { \
+    char buf[ANJAY_FP_STRING_BUFFER_SIZE]; \
+    size_t length = _anjay_fp_format_double(buf, (Val)); \
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, (Expected)); \
+    AVS_UNIT_ASSERT_EQUAL(length, strlen(Expected)); \
+} while (false)
+
+#define TEST_FORMAT_FLOAT(Val, Expected) do { \
+    char buf[ANJAY_FP_STRING_BUFFER_SIZE]; \
+    size_t length = _anjay_fp_format_float(buf, (Val)); \
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, (Expected)); \
+    AVS_UNIT_ASSERT_EQUAL(length, strlen(Expected)); \
+} while (false)
+
+AVS_UNIT_TEST(fp_conv, format_double) {
+    TEST_FORMAT_DOUBLE(0.0, "0");
+    TEST_FORMAT_DOUBLE(-0.0, "-0");
+    TEST_FORMAT_DOUBLE(1.0, "1");
+    TEST_FORMAT_DOUBLE(-1.5, "-1.5");
+    TEST_FORMAT_DOUBLE(0.1, "0.1");
+    TEST_FORMAT_DOUBLE(1.2, "1.2");
+    TEST_FORMAT_DOUBLE(0.000001, "0.000001");
+    TEST_FORMAT_DOUBLE(1e-7, "1e-07");
+    TEST_FORMAT_DOUBLE(1e20, "100000000000000000000");
+    TEST_FORMAT_DOUBLE(1e21, "1e+21");
+    TEST_FORMAT_DOUBLE(10000000000000.5, "10000000000000.5");
+    TEST_FORMAT_DOUBLE(3.26e+218, "3.26e+218");
+    TEST_FORMAT_DOUBLE(5e-324, "5e-324");
+    TEST_FORMAT_DOUBLE(1.7976931348623157e308, "1.7976931348623157e+308");
+    TEST_FORMAT_DOUBLE(-2.2250738585072014e-308, "-2.2250738585072014e-308");
+    TEST_FORMAT_DOUBLE(52.2296756, "52.2296756");
+    TEST_FORMAT_DOUBLE(NAN, "nan");
+    TEST_FORMAT_DOUBLE(INFINITY, "inf");
+    TEST_FORMAT_DOUBLE(-INFINITY, "-inf");
+}
+
+AVS_UNIT_TEST(fp_conv, format_float) {
+    TEST_FORMAT_FLOAT(0.0f, "0");
+    TEST_FORMAT_FLOAT(1.0f, "1");
+    TEST_FORMAT_FLOAT(0.1f, "0.1");
+    TEST_FORMAT_FLOAT(1.3125f, "1.3125");
+    TEST_FORMAT_FLOAT(-10000.5f, "-10000.5");
+    TEST_FORMAT_FLOAT(4.223e+37f, "4.223e+37");
+    TEST_FORMAT_FLOAT(1e-45f, "1e-45");
+    TEST_FORMAT_FLOAT(3.4028235e+38f, "3.4028235e+38");
+    TEST_FORMAT_FLOAT((float) NAN, "nan");
+}
+
+#undef TEST_FORMAT_FLOAT
+#undef TEST_FORMAT_DOUBLE
+
+#define TEST_PARSE_DOUBLE(Str, Expected) do { \
+    double value; \
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_fp_parse_double_fast((Str), &value)); \
+    AVS_UNIT_ASSERT_EQUAL(value, (Expected)); \
+} while (false)
+
+#define TEST_PARSE_DOUBLE_SLOW(Str) do { \
+    double value; \
+    AVS_UNIT_ASSERT_FAILED(_anjay_fp_parse_double_fast((Str), &value)); \
+} while (false)
+
+AVS_UNIT_TEST(fp_conv, parse_double_fast) {
+    TEST_PARSE_DOUBLE("0", 0.0);
+    TEST_PARSE_DOUBLE("-0", -0.0);
+    TEST_PARSE_DOUBLE("+1", 1.0);
+    TEST_PARSE_DOUBLE("1.", 1.0);
+    TEST_PARSE_DOUBLE(".5", 0.5);
+    TEST_PARSE_DOUBLE("1.3125000", 1.3125);
+    TEST_PARSE_DOUBLE("-10000.5", -10000.5);
+    TEST_PARSE_DOUBLE("0.1", 0.1);
+    TEST_PARSE_DOUBLE("4.223e+37", 4.223e+37);
+    TEST_PARSE_DOUBLE("12e25", 12e25);
+    TEST_PARSE_DOUBLE("1E-22", 1e-22);
+
+    // not handled by the fast path, but still valid
+    TEST_PARSE_DOUBLE_SLOW("3.26e+218");
+    TEST_PARSE_DOUBLE_SLOW("123456789012345678901");
+    TEST_PARSE_DOUBLE_SLOW("nan");
+    TEST_PARSE_DOUBLE_SLOW("0x10");
+    // invalid
+    TEST_PARSE_DOUBLE_SLOW("");
+    TEST_PARSE_DOUBLE_SLOW(" 1");
+    TEST_PARSE_DOUBLE_SLOW("1 ");
+    TEST_PARSE_DOUBLE_SLOW(".");
+    TEST_PARSE_DOUBLE_SLOW("1e");
+    TEST_PARSE_DOUBLE_SLOW("1e+");
+    TEST_PARSE_DOUBLE_SLOW("wat");
+}
+
+#undef TEST_PARSE_DOUBLE_SLOW
+#undef TEST_PARSE_DOUBLE
+
+AVS_UNIT_TEST(fp_conv, parse_float_fast) {
+    float value;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_fp_parse_float_fast("1.3125", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 1.3125f);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_fp_parse_float_fast("0.1", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 0.1f);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_fp_parse_float_fast("-2.5e10", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, -2.5e10f);
+    AVS_UNIT_ASSERT_FAILED(_anjay_fp_parse_float_fast("4.223e+37", &value));
+    AVS_UNIT_ASSERT_FAILED(_anjay_fp_parse_float_fast("16777217", &value));
+}
+
+static uint64_t xorshift64(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void assert_double_round_trip(double value) {
+    char buf[ANJAY_FP_STRING_BUFFER_SIZE];
+    _anjay_fp_format_double(buf, value);
+
+    double parsed;
+    // strtod() family reports ERANGE for subnormals, which we treat as error
+    if (isnormal(value)) {
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtod(buf, &parsed));
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(&parsed, &value, sizeof(value));
+    }
+    // cross-check against the C library
+    parsed = strtod(buf, NULL);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(&parsed, &value, sizeof(value));
+}
+
+static void assert_float_round_trip(float value) {
+    char buf[ANJAY_FP_STRING_BUFFER_SIZE];
+    _anjay_fp_format_float(buf, value);
+
+    float parsed;
+    if (isnormal(value)) {
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtof(buf, &parsed));
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(&parsed, &value, sizeof(value));
+    }
+    parsed = strtof(buf, NULL);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(&parsed, &value, sizeof(value));
+}
+
+AVS_UNIT_TEST(fp_conv, double_round_trip_random) {
+    uint64_t state = UINT64_C(88172645463325252);
+    for (size_t i = 0; i < 200000; ++i) {
+        uint64_t bits = xorshift64(&state);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isnan(value) && !isinf(value)) {
+            assert_double_round_trip(value);
+        }
+    }
+}
+
+AVS_UNIT_TEST(fp_conv, double_round_trip_boundaries) {
+    // powers of two are the asymmetric-interval corner case of Grisu
+    for (int exp2 = -1074; exp2 <= 1023; ++exp2) {
+        double value = ldexp(1.0, exp2);
+        assert_double_round_trip(value);
+        assert_double_round_trip(nextafter(value, 0.0));
+        assert_double_round_trip(nextafter(value, INFINITY));
+    }
+    for (int exp10 = -323; exp10 <= 308; ++exp10) {
+        char buf[16];
+        sprintf(buf, "1e%d", exp10);
+        assert_double_round_trip(strtod(buf, NULL));
+    }
+}
+
+AVS_UNIT_TEST(fp_conv, float_round_trip_sweep) {
+    // every 4093rd bit pattern (a prime stride, so that all mantissa residues
+    // are visited) across the whole positive and negative range
+    for (uint64_t bits = 0; bits <= UINT32_MAX; bits += 4093) {
+        uint32_t bits32 = (uint32_t) bits;
+        float value;
+        memcpy(&value, &bits32, sizeof(value));
+        if (!isnan(value) && !isinf(value)) {
+            assert_float_round_trip(value);
+        }
+    }
+    for (int exp2 = -149; exp2 <= 127; ++exp2) {
+        float value = ldexpf(1.0f, exp2);
+        assert_float_round_trip(value);
+        assert_float_round_trip(nextafterf(value, 0.0f));
+        assert_float_round_trip(nextafterf(value, INFINITY));
+    }
+}
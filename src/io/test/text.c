@@ -16,6 +16,7 @@
 
 #include <anjay_config.h>
 
+#include <avsystem/commons/base64.h>
 #include <avsystem/commons/stream.h>
 #include <avsystem/commons/unit/memstream.h>
 #include <avsystem/commons/unit/test.h>
@@ -382,3 +383,73 @@ AVS_UNIT_TEST(text_in, objlnk) {
 #undef TEST_OBJLNK_COMMON
 #undef TEST_TEARDOWN
 #undef TEST_ENV
+
+///////////////////////////////////////////////////////////////////////// BYTES
+
+#define BULK_BYTES_SIZE (64 * 1024)
+
+static void fill_bulk_bytes(uint8_t *data) {
+    for (size_t i = 0; i < BULK_BYTES_SIZE; ++i) {
+        data[i] = (uint8_t) ((i * 2654435761u) >> 13);
+    }
+}
+
+AVS_UNIT_TEST(text_bytes, bulk_64k_round_trip) {
+    static uint8_t data[BULK_BYTES_SIZE];
+    static char encoded[4 * ((BULK_BYTES_SIZE + 2) / 3) + 1];
+    static char reference[sizeof(encoded)];
+    fill_bulk_bytes(data);
+    AVS_UNIT_ASSERT_SUCCESS(avs_base64_encode(reference, sizeof(reference),
+                                              data, sizeof(data)));
+
+    // encode, using deliberately unaligned chunk sizes
+    avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+    avs_stream_outbuf_set_buffer(&outbuf, encoded, sizeof(encoded));
+    anjay_ret_bytes_ctx_t *bytes = _anjay_base64_ret_bytes_ctx_new(
+            (avs_stream_abstract_t *) &outbuf, sizeof(data));
+    AVS_UNIT_ASSERT_NOT_NULL(bytes);
+    static const size_t OUT_CHUNKS[] = { 1, 1, 5, 4096, 7, 1000 };
+    size_t offset = 0;
+    for (size_t i = 0; offset < sizeof(data); ++i) {
+        size_t chunk = AVS_MIN(OUT_CHUNKS[i % AVS_ARRAY_SIZE(OUT_CHUNKS)],
+                               sizeof(data) - offset);
+        AVS_UNIT_ASSERT_SUCCESS(
+                anjay_ret_bytes_append(bytes, &data[offset], chunk));
+        offset += chunk;
+    }
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_base64_ret_bytes_ctx_close(bytes));
+    _anjay_base64_ret_bytes_ctx_delete(&bytes);
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf),
+                          strlen(reference));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(encoded, reference, strlen(reference));
+
+    // decode, also with buffers smaller than a single encoded group
+    avs_stream_abstract_t *stream = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_unit_memstream_alloc(&stream, strlen(reference)));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_write(stream, reference, strlen(reference)));
+    anjay_input_ctx_t *in;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_input_text_create(&in, &stream, false));
+
+    // one spare byte, so that the end of message is always reported
+    static uint8_t decoded[BULK_BYTES_SIZE + 1];
+    static const size_t IN_CHUNKS[] = { 1, 2, 3, 4093, 5, 8192 };
+    offset = 0;
+    bool finished = false;
+    for (size_t i = 0; !finished; ++i) {
+        size_t bytes_read;
+        size_t chunk = AVS_MIN(IN_CHUNKS[i % AVS_ARRAY_SIZE(IN_CHUNKS)],
+                               sizeof(decoded) - offset);
+        AVS_UNIT_ASSERT_SUCCESS(anjay_get_bytes(in, &bytes_read, &finished,
+                                                &decoded[offset], chunk));
+        offset += bytes_read;
+    }
+    AVS_UNIT_ASSERT_EQUAL(offset, sizeof(data));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(decoded, data, sizeof(data));
+
+    _anjay_input_ctx_destroy(&in);
+    avs_stream_cleanup(&stream);
+}
+
+#undef BULK_BYTES_SIZE
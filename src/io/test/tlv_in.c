@@ -212,6 +212,48 @@ AVS_UNIT_TEST(tlv_in_bytes, no_data) {
     TEST_TEARDOWN;
 }
 
+#define TLV_I64_ARRAY "\x88\x01\x09" \
+                      "\x41\x00\x01" \
+                      "\x41\x01\x02" \
+                      "\x41\x05\xFD"
+
+AVS_UNIT_TEST(tlv_in_array, i64_array) {
+    TEST_ENV(sizeof(TLV_I64_ARRAY));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, TLV_I64_ARRAY,
+                                             sizeof(TLV_I64_ARRAY) - 1));
+    int64_t values[4];
+    anjay_riid_t riids[4];
+    size_t count;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_i64_array(in, values, riids,
+                                                AVS_ARRAY_SIZE(values),
+                                                &count));
+    AVS_UNIT_ASSERT_EQUAL(count, 3);
+    AVS_UNIT_ASSERT_EQUAL(values[0], 1);
+    AVS_UNIT_ASSERT_EQUAL(values[1], 2);
+    AVS_UNIT_ASSERT_EQUAL(values[2], -3);
+    AVS_UNIT_ASSERT_EQUAL(riids[0], 0);
+    AVS_UNIT_ASSERT_EQUAL(riids[1], 1);
+    AVS_UNIT_ASSERT_EQUAL(riids[2], 5);
+    TEST_TEARDOWN;
+}
+
+AVS_UNIT_TEST(tlv_in_array, i64_array_too_long) {
+    TEST_ENV(sizeof(TLV_I64_ARRAY));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, TLV_I64_ARRAY,
+                                             sizeof(TLV_I64_ARRAY) - 1));
+    int64_t values[2];
+    size_t count;
+    AVS_UNIT_ASSERT_EQUAL(anjay_get_i64_array(in, values, NULL,
+                                              AVS_ARRAY_SIZE(values), &count),
+                          ANJAY_BUFFER_TOO_SHORT);
+    AVS_UNIT_ASSERT_EQUAL(count, 2);
+    AVS_UNIT_ASSERT_EQUAL(values[0], 1);
+    AVS_UNIT_ASSERT_EQUAL(values[1], 2);
+    TEST_TEARDOWN;
+}
+
+#undef TLV_I64_ARRAY
+
 #undef TEST_TEARDOWN
 #undef TEST_ENV
 
@@ -329,3 +329,91 @@ AVS_UNIT_TEST(tlv_out, object_with_empty_bytes) {
 
     AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
 }
+
+#define BULK_ARRAY_SIZE 4096
+#define BULK_BUFFER_SIZE (BULK_ARRAY_SIZE * TLV_MAX_NUMERIC_ENTRY_SIZE + 64)
+
+static void fill_bulk_arrays(int64_t *ints, double *doubles) {
+    for (size_t i = 0; i < BULK_ARRAY_SIZE; ++i) {
+        // spread the values over all the encoded lengths
+        ints[i] = (int64_t) (UINT64_C(1) << (i % 63)) * ((i % 2) ? -1 : 1);
+        doubles[i] = (i % 2) ? (double) i * 0.5 : (double) i * 0.1;
+    }
+}
+
+static size_t write_bulk_arrays(char *buf, bool bulk,
+                                const int64_t *ints, const double *doubles) {
+    avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+    avs_stream_outbuf_set_buffer(&outbuf, buf, BULK_BUFFER_SIZE);
+    anjay_output_ctx_t *out = new_tlv_out((avs_stream_abstract_t *) &outbuf);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(out, ANJAY_ID_IID, 1));
+    anjay_output_ctx_t *obj = _anjay_output_object_start(out);
+    AVS_UNIT_ASSERT_NOT_NULL(obj);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(obj, ANJAY_ID_RID, 0));
+    if (bulk) {
+        AVS_UNIT_ASSERT_SUCCESS(
+                anjay_ret_i64_array(obj, ints, BULK_ARRAY_SIZE));
+    } else {
+        anjay_output_ctx_t *array = anjay_ret_array_start(obj);
+        AVS_UNIT_ASSERT_NOT_NULL(array);
+        for (size_t i = 0; i < BULK_ARRAY_SIZE; ++i) {
+            AVS_UNIT_ASSERT_SUCCESS(
+                    anjay_ret_array_index(array, (anjay_riid_t) i));
+            AVS_UNIT_ASSERT_SUCCESS(anjay_ret_i64(array, ints[i]));
+        }
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ret_array_finish(array));
+    }
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_object_finish(obj));
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(out, ANJAY_ID_RID, 1));
+    if (bulk) {
+        AVS_UNIT_ASSERT_SUCCESS(
+                anjay_ret_double_array(out, doubles, BULK_ARRAY_SIZE));
+    } else {
+        anjay_output_ctx_t *array = anjay_ret_array_start(out);
+        AVS_UNIT_ASSERT_NOT_NULL(array);
+        for (size_t i = 0; i < BULK_ARRAY_SIZE; ++i) {
+            AVS_UNIT_ASSERT_SUCCESS(
+                    anjay_ret_array_index(array, (anjay_riid_t) i));
+            AVS_UNIT_ASSERT_SUCCESS(anjay_ret_double(array, doubles[i]));
+        }
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ret_array_finish(array));
+    }
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    return avs_stream_outbuf_offset(&outbuf);
+}
+
+AVS_UNIT_TEST(tlv_out_array, bulk_same_as_per_element) {
+    int64_t *ints = (int64_t *) avs_calloc(BULK_ARRAY_SIZE, sizeof(int64_t));
+    double *doubles = (double *) avs_calloc(BULK_ARRAY_SIZE, sizeof(double));
+    char *expected = (char *) avs_malloc(BULK_BUFFER_SIZE);
+    char *actual = (char *) avs_malloc(BULK_BUFFER_SIZE);
+    AVS_UNIT_ASSERT_NOT_NULL(ints);
+    AVS_UNIT_ASSERT_NOT_NULL(doubles);
+    AVS_UNIT_ASSERT_NOT_NULL(expected);
+    AVS_UNIT_ASSERT_NOT_NULL(actual);
+    fill_bulk_arrays(ints, doubles);
+
+    size_t expected_size = write_bulk_arrays(expected, false, ints, doubles);
+    size_t actual_size = write_bulk_arrays(actual, true, ints, doubles);
+    AVS_UNIT_ASSERT_EQUAL(actual_size, expected_size);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(actual, expected, expected_size);
+
+    avs_free(actual);
+    avs_free(expected);
+    avs_free(doubles);
+    avs_free(ints);
+}
+
+AVS_UNIT_TEST(tlv_out_array, bulk_without_rid) {
+    static const int64_t VALUES[] = { 1, 2, 3 };
+    TEST_ENV(32);
+    AVS_UNIT_ASSERT_FAILED(anjay_ret_i64_array(out, VALUES, 3));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(out, ANJAY_ID_RID, 1));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ret_i64_array(out, VALUES, 3));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    VERIFY_BYTES("\x88\x01\x09"
+                 "\x41\x00\x01"
+                 "\x41\x01\x02"
+                 "\x41\x02\x03");
+}
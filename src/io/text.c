@@ -16,6 +16,7 @@
 
 #include <anjay_config.h>
 
+#include <assert.h>
 #include <ctype.h>
 #include <errno.h>
 #include <inttypes.h>
@@ -23,14 +24,15 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include <avsystem/commons/base64.h>
 #include <avsystem/commons/stream.h>
 
 #include <anjay/core.h>
 
 #include "../coap/content_format.h"
 #include "../utils_core.h"
+#include "base64_bulk.h"
 #include "base64_out.h"
+#include "fp_conv.h"
 #include "vtable.h"
 
 VISIBILITY_SOURCE_BEGIN
@@ -101,30 +103,34 @@ static int text_ret_i64(anjay_output_ctx_t *ctx_, int64_t value) {
     return retval;
 }
 
-static inline int text_ret_floating_point(text_out_t *ctx, double value,
-                                          int precision) {
+static inline int text_ret_floating_point(text_out_t *ctx,
+                                          const char *value,
+                                          size_t length) {
     if (ctx->bytes) {
         return -1;
     }
     int retval = -1;
-    // FIXME: The spec calls for a "decimal" representation, which, in my
-    // understanding, excludes exponential representation.
-    // As printing floating-point numbers in C as pure decimal with sane
-    // precision is tricky, let's take the spec a bit loosely for now.
+    // NOTE: The spec calls for a "decimal" representation, which, in my
+    // understanding, excludes exponential representation. The formatter
+    // uses plain decimal notation for all but very large or very small
+    // values; it's still taking the spec a bit loosely.
     if (!ctx->finished
-            && !(retval = avs_stream_write_f(ctx->stream, "%.*g",
-                                             precision, value))) {
+            && !(retval = avs_stream_write(ctx->stream, value, length))) {
         ctx->finished = true;
     }
     return retval;
 }
 
 static int text_ret_float(anjay_output_ctx_t *ctx, float value) {
-    return text_ret_floating_point((text_out_t *) ctx, value, 9);
+    char buf[ANJAY_FP_STRING_BUFFER_SIZE];
+    size_t length = _anjay_fp_format_float(buf, value);
+    return text_ret_floating_point((text_out_t *) ctx, buf, length);
 }
 
 static int text_ret_double(anjay_output_ctx_t *ctx, double value) {
-    return text_ret_floating_point((text_out_t *) ctx, value, 17);
+    char buf[ANJAY_FP_STRING_BUFFER_SIZE];
+    size_t length = _anjay_fp_format_double(buf, value);
+    return text_ret_floating_point((text_out_t *) ctx, buf, length);
 }
 
 static int text_ret_bool(anjay_output_ctx_t *ctx, bool value) {
@@ -200,18 +206,9 @@ typedef struct {
     bool bytes_mode;
     uint8_t bytes_cached[3];
     size_t num_bytes_cached;
-    char msg_finished;
+    bool msg_finished;
 } text_in_t;
 
-static int has_valid_padding(const char *buffer,
-                             size_t size,
-                             bool msg_finished) {
-    const char *last = buffer + size;
-    /* Note: buffer is size+1 in length. Last byte is a NULL terminator though. */
-    assert(!*last);
-    return last - 1 >= buffer && *(last - 1) == '=' && !msg_finished ? -1 : 0;
-}
-
 static void text_get_some_bytes_cache_flush(text_in_t *ctx,
                                             uint8_t **out_buf,
                                             size_t *buf_size) {
@@ -224,6 +221,72 @@ static void text_get_some_bytes_cache_flush(text_in_t *ctx,
     *out_buf += bytes_to_copy;
 }
 
+/**
+ * Reads up to @p size Base64 characters, stopping early only at the end of
+ * message. Fails if the number of characters read is not a multiple of 4.
+ */
+static int text_read_encoded(text_in_t *ctx,
+                             char *out_buf,
+                             size_t size,
+                             size_t *out_bytes_read) {
+    assert(size % 4 == 0);
+    size_t bytes_read = 0;
+    char stream_msg_finished = 0;
+    while (bytes_read < size && !stream_msg_finished) {
+        size_t chunk_bytes_read;
+        if (avs_stream_read(ctx->stream, &chunk_bytes_read,
+                            &stream_msg_finished, out_buf + bytes_read,
+                            size - bytes_read)) {
+            return -1;
+        }
+        bytes_read += chunk_bytes_read;
+    }
+    ctx->msg_finished = !!stream_msg_finished;
+    *out_bytes_read = bytes_read;
+    return bytes_read % 4 ? -1 : 0;
+}
+
+/**
+ * Reads as many full Base64 groups as will fit after decoding, and decodes
+ * them in place, directly in the user-provided buffer.
+ */
+static int text_get_bytes_in_place(text_in_t *ctx,
+                                   uint8_t **inout_buf,
+                                   size_t *inout_buf_size) {
+    size_t encoded_size;
+    size_t decoded_size;
+    if (text_read_encoded(ctx, (char *) *inout_buf,
+                          *inout_buf_size / 4 * 4, &encoded_size)
+            || _anjay_base64_decode_groups(*inout_buf, &decoded_size,
+                                           (const char *) *inout_buf,
+                                           encoded_size, ctx->msg_finished)) {
+        return -1;
+    }
+    *inout_buf += decoded_size;
+    *inout_buf_size -= decoded_size;
+    return 0;
+}
+
+/**
+ * Used when the remaining space is too small to hold a whole encoded group:
+ * decodes a single group into the cache and returns as much as possible.
+ */
+static int text_get_bytes_cached(text_in_t *ctx,
+                                 uint8_t **inout_buf,
+                                 size_t *inout_buf_size) {
+    assert(ctx->num_bytes_cached == 0);
+    char encoded[4];
+    size_t encoded_size;
+    if (text_read_encoded(ctx, encoded, sizeof(encoded), &encoded_size)
+            || _anjay_base64_decode_groups(ctx->bytes_cached,
+                                           &ctx->num_bytes_cached, encoded,
+                                           encoded_size, ctx->msg_finished)) {
+        return -1;
+    }
+    text_get_some_bytes_cache_flush(ctx, inout_buf, inout_buf_size);
+    return 0;
+}
+
 static int text_get_some_bytes(anjay_input_ctx_t *ctx_,
                                size_t *out_bytes_read,
                                bool *out_msg_finished,
@@ -236,38 +299,14 @@ static int text_get_some_bytes(anjay_input_ctx_t *ctx_,
     *out_bytes_read = 0;
 
     text_get_some_bytes_cache_flush(ctx, &current, &buf_size);
-    // 4bytes + null terminator
-    char encoded[5];
-    size_t stream_bytes_read;
-    char stream_msg_finished = 0;
-
-    while (buf_size > 0) {
-        if (avs_stream_read(ctx->stream, &stream_bytes_read, &stream_msg_finished,
-                            encoded, sizeof(encoded) - 1)) {
-            return -1;
-        }
-        encoded[stream_bytes_read] = '\0';
-        if (stream_bytes_read % 4) {
-            return -1;
-        }
-        if (has_valid_padding(encoded, stream_bytes_read,
-                              !!stream_msg_finished)) {
-            return -1;
-        }
-        assert(ctx->num_bytes_cached == 0);
-        ssize_t num_decoded =
-                avs_base64_decode_strict((uint8_t *) ctx->bytes_cached,
-                                         sizeof(ctx->bytes_cached), encoded);
-        if (num_decoded < 0) {
-            return (int) num_decoded;
-        }
-        ctx->num_bytes_cached = (size_t) num_decoded;
-        text_get_some_bytes_cache_flush(ctx, &current, &buf_size);
-        if (stream_msg_finished) {
-            break;
+    while (buf_size > 0 && !ctx->msg_finished) {
+        int retval = buf_size >= 4
+                ? text_get_bytes_in_place(ctx, &current, &buf_size)
+                : text_get_bytes_cached(ctx, &current, &buf_size);
+        if (retval) {
+            return retval;
         }
     }
-    ctx->msg_finished = !!stream_msg_finished;
     *out_msg_finished = ctx->msg_finished && !ctx->num_bytes_cached;
     *out_bytes_read = (size_t) (current - (uint8_t *) out_buf);
     return 0;
@@ -304,6 +343,9 @@ static int map_str_conversion_result(const char *input, const char *endptr) {
 }
 
 int _anjay_safe_strtof(const char *in, float *value) {
+    if (!_anjay_fp_parse_float_fast(in, value)) {
+        return 0;
+    }
     errno = 0;
     char *endptr = NULL;
     *value = strtof(in, &endptr);
@@ -318,6 +360,9 @@ int _anjay_safe_strtoll(const char *in, long long *value) {
 }
 
 int _anjay_safe_strtod(const char *in, double *value) {
+    if (!_anjay_fp_parse_double_fast(in, value)) {
+        return 0;
+    }
     errno = 0;
     char *endptr = NULL;
     *value = strtod(in, &endptr);
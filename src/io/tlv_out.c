@@ -289,6 +289,107 @@ static int tlv_ret_objlnk(anjay_output_ctx_t *ctx,
     return anjay_ret_bytes(ctx, &portable, sizeof(portable));
 }
 
+/* type byte + 16-bit ID + 8-bit length + 64-bit value */
+#define TLV_MAX_NUMERIC_ENTRY_SIZE 12
+
+typedef size_t tlv_numeric_encoder_t(char *out, const void *values,
+                                     size_t index);
+
+static size_t encode_i64(char *out, const void *values, size_t index) {
+    int64_t value = ((const int64_t *) values)[index];
+    size_t length = sizeof(value);
+    if (value == (int8_t) value) {
+        length = 1;
+    } else if (value == (int16_t) value) {
+        length = 2;
+    } else if (value == (int32_t) value) {
+        length = 4;
+    }
+    uint64_t portable = avs_convert_be64((uint64_t) value);
+    memcpy(out, (const char *) &portable + (sizeof(portable) - length), length);
+    return length;
+}
+
+static size_t encode_double(char *out, const void *values, size_t index) {
+    double value = ((const double *) values)[index];
+    if (((double) ((float) value)) == value) {
+        uint32_t portable = _anjay_htonf((float) value);
+        memcpy(out, &portable, sizeof(portable));
+        return sizeof(portable);
+    } else {
+        uint64_t portable = _anjay_htond(value);
+        memcpy(out, &portable, sizeof(portable));
+        return sizeof(portable);
+    }
+}
+
+static size_t encode_riid_entry(char *out,
+                                size_t index,
+                                tlv_numeric_encoder_t *encoder,
+                                const void *values) {
+    char value[sizeof(uint64_t)];
+    size_t length = encoder(value, values, index);
+    char *ptr = out;
+    *ptr++ = (char) (((TLV_ID_RIID & 3) << 6)
+                     | ((index > UINT8_MAX) ? 0x20 : 0)
+                     | typefield_length((uint32_t) length));
+    if (index > UINT8_MAX) {
+        *ptr++ = (char) (index >> 8);
+    }
+    *ptr++ = (char) index;
+    if (length > 7) {
+        *ptr++ = (char) length;
+    }
+    memcpy(ptr, value, length);
+    return (size_t) (ptr - out) + length;
+}
+
+/**
+ * Encodes a whole Multiple Resource in one pass, producing the same output as
+ * tlv_ret_array_start() followed by a series of numeric anjay_ret_* calls,
+ * without allocating a list entry per element.
+ */
+static int tlv_ret_numeric_array(tlv_out_t *ctx,
+                                 tlv_numeric_encoder_t *encoder,
+                                 const void *values,
+                                 size_t count) {
+    if (ctx->slave
+            || ctx->next_id.type != TLV_ID_RID
+            || ctx->next_id.id < 0
+            || count > UINT16_MAX) {
+        return -1;
+    }
+    char *buffer = NULL;
+    if (count
+            && !(buffer = (char *) avs_malloc(count
+                                              * TLV_MAX_NUMERIC_ENTRY_SIZE))) {
+        return -1;
+    }
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i) {
+        length += encode_riid_entry(buffer + length, i, encoder, values);
+    }
+    ctx->next_id.type = TLV_ID_RID_ARRAY;
+    anjay_ret_bytes_ctx_t *bytes = add_entry(ctx, length);
+    int retval = !bytes ? -1 : anjay_ret_bytes_append(bytes, buffer, length);
+    ctx->next_id.type = TLV_ID_RID;
+    avs_free(buffer);
+    return retval;
+}
+
+static int tlv_ret_i64_array(anjay_output_ctx_t *ctx,
+                             const int64_t *values,
+                             size_t count) {
+    return tlv_ret_numeric_array((tlv_out_t *) ctx, encode_i64, values, count);
+}
+
+static int tlv_ret_double_array(anjay_output_ctx_t *ctx,
+                                const double *values,
+                                size_t count) {
+    return tlv_ret_numeric_array((tlv_out_t *) ctx, encode_double, values,
+                                 count);
+}
+
 static anjay_output_ctx_t *tlv_slave_start(tlv_out_t *ctx,
                                            tlv_id_type_t expected_type,
                                            tlv_id_type_t new_type,
@@ -407,7 +508,9 @@ static const anjay_output_ctx_vtable_t TLV_OUT_VTABLE = {
     tlv_ret_object_start,
     tlv_ret_object_finish,
     tlv_set_id,
-    tlv_output_close
+    tlv_output_close,
+    tlv_ret_i64_array,
+    tlv_ret_double_array
 };
 
 static anjay_output_ctx_t *tlv_slave_start(tlv_out_t *ctx,
@@ -44,6 +44,10 @@ typedef int (*anjay_output_ctx_object_finish_t)(anjay_output_ctx_t *);
 typedef int (*anjay_output_ctx_set_id_t)(anjay_output_ctx_t *,
                                          anjay_id_type_t, uint16_t);
 typedef int (*anjay_output_ctx_close_t)(anjay_output_ctx_t *);
+typedef int (*anjay_output_ctx_i64_array_t)(anjay_output_ctx_t *,
+                                            const int64_t *, size_t);
+typedef int (*anjay_output_ctx_f64_array_t)(anjay_output_ctx_t *,
+                                            const double *, size_t);
 
 typedef struct {
     anjay_output_ctx_errno_ptr_t errno_ptr;
@@ -61,6 +65,9 @@ typedef struct {
     anjay_output_ctx_object_finish_t object_finish;
     anjay_output_ctx_set_id_t set_id;
     anjay_output_ctx_close_t close;
+    /* optional; anjay_ret_*_array() fall back to per-element calls if NULL */
+    anjay_output_ctx_i64_array_t i64_array;
+    anjay_output_ctx_f64_array_t f64_array;
 } anjay_output_ctx_vtable_t;
 
 typedef int (*anjay_ret_bytes_ctx_append_t)(anjay_ret_bytes_ctx_t *,
@@ -228,6 +228,10 @@ int anjay_ret_array_index(anjay_output_ctx_t *array_ctx, anjay_riid_t index) {
     return _anjay_output_set_id(array_ctx, ANJAY_ID_RIID, index);
 }
 
+int anjay_ret_resource_id(anjay_output_ctx_t *ctx, anjay_rid_t rid) {
+    return _anjay_output_set_id(ctx, ANJAY_ID_RID, rid);
+}
+
 int anjay_ret_array_finish(anjay_output_ctx_t *array_ctx) {
     if (!array_ctx->vtable->array_finish) {
         set_errno_not_implemented(array_ctx);
@@ -236,6 +240,31 @@ int anjay_ret_array_finish(anjay_output_ctx_t *array_ctx) {
     return array_ctx->vtable->array_finish(array_ctx);
 }
 
+#define DEF_RET_ARRAY(Name, Type, VtableField, RetValue) \
+int Name(anjay_output_ctx_t *ctx, const Type *values, size_t count) { \
+    if (count > UINT16_MAX) { \
+        return -1; \
+    } \
+    if (ctx->vtable->VtableField) { \
+        return ctx->vtable->VtableField(ctx, values, count); \
+    } \
+    anjay_output_ctx_t *array_ctx = anjay_ret_array_start(ctx); \
+    if (!array_ctx) { \
+        return -1; \
+    } \
+    for (size_t i = 0; i < count; ++i) { \
+        int result; \
+        if ((result = anjay_ret_array_index(array_ctx, (anjay_riid_t) i)) \
+                || (result = RetValue(array_ctx, values[i]))) { \
+            return result; \
+        } \
+    } \
+    return anjay_ret_array_finish(array_ctx); \
+}
+
+DEF_RET_ARRAY(anjay_ret_i64_array, int64_t, i64_array, anjay_ret_i64)
+DEF_RET_ARRAY(anjay_ret_double_array, double, f64_array, anjay_ret_double)
+
 anjay_output_ctx_t * _anjay_output_object_start(anjay_output_ctx_t *ctx) {
     if (!ctx->vtable->object_start) {
         set_errno_not_implemented(ctx);
@@ -473,6 +502,67 @@ int anjay_get_array_index(anjay_input_ctx_t *ctx, anjay_riid_t *out_index) {
     return (type == ANJAY_ID_RIID) ? 0 : -1;
 }
 
+typedef int get_array_value_t(anjay_input_ctx_t *ctx, void *out);
+
+static int get_array_i64(anjay_input_ctx_t *ctx, void *out) {
+    return anjay_get_i64(ctx, (int64_t *) out);
+}
+
+static int get_array_double(anjay_input_ctx_t *ctx, void *out) {
+    return anjay_get_double(ctx, (double *) out);
+}
+
+static int get_array(anjay_input_ctx_t *ctx,
+                     get_array_value_t *get_value,
+                     void *out_values,
+                     size_t value_size,
+                     anjay_riid_t *out_riids,
+                     size_t capacity,
+                     size_t *out_count) {
+    *out_count = 0;
+    anjay_input_ctx_t *array_ctx = anjay_get_array(ctx);
+    if (!array_ctx) {
+        return ANJAY_ERR_BAD_REQUEST;
+    }
+    while (true) {
+        anjay_riid_t riid;
+        int result = anjay_get_array_index(array_ctx, &riid);
+        if (result == ANJAY_GET_INDEX_END) {
+            return 0;
+        } else if (result) {
+            return result;
+        } else if (*out_count >= capacity) {
+            return ANJAY_BUFFER_TOO_SHORT;
+        }
+        void *out_value = (char *) out_values + *out_count * value_size;
+        if ((result = get_value(array_ctx, out_value))) {
+            return result;
+        }
+        if (out_riids) {
+            out_riids[*out_count] = riid;
+        }
+        ++*out_count;
+    }
+}
+
+int anjay_get_i64_array(anjay_input_ctx_t *ctx,
+                        int64_t *out_values,
+                        anjay_riid_t *out_riids,
+                        size_t capacity,
+                        size_t *out_count) {
+    return get_array(ctx, get_array_i64, out_values, sizeof(*out_values),
+                     out_riids, capacity, out_count);
+}
+
+int anjay_get_double_array(anjay_input_ctx_t *ctx,
+                           double *out_values,
+                           anjay_riid_t *out_riids,
+                           size_t capacity,
+                           size_t *out_count) {
+    return get_array(ctx, get_array_double, out_values, sizeof(*out_values),
+                     out_riids, capacity, out_count);
+}
+
 int _anjay_input_ctx_destroy(anjay_input_ctx_t **ctx_ptr) {
     int retval = 0;
     anjay_input_ctx_t *ctx = *ctx_ptr;
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <avsystem/commons/stream/stream_inbuf.h>
+#include <avsystem/commons/stream/stream_membuf.h>
+#include <avsystem/commons/utils.h>
+
+#include <anjay_modules/journal.h>
+#include <anjay_modules/raw_buffer.h>
+
+#include "anjay_core.h"
+#include "utils_core.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+/*
+ * Record layout (all integers are big-endian):
+ *
+ * - magic (ANJAY_JOURNAL_MAGIC_SIZE bytes)
+ * - u32 payload size
+ * - payload
+ * - u32 CRC-32 of all the preceding bytes of the record
+ */
+#define RECORD_HEADER_SIZE (ANJAY_JOURNAL_MAGIC_SIZE + sizeof(uint32_t))
+
+int _anjay_journal_append(avs_stream_abstract_t *out_stream,
+                          const char *magic,
+                          anjay_journal_record_writer_t *writer,
+                          void *arg) {
+    avs_stream_abstract_t *payload = avs_stream_membuf_create();
+    if (!payload) {
+        anjay_log(ERROR, "out of memory");
+        return -1;
+    }
+    anjay_raw_buffer_t record = ANJAY_RAW_BUFFER_EMPTY;
+    const uint32_t size_placeholder = 0;
+    int retval = writer(payload, arg);
+    if (!retval
+            && (_anjay_raw_buffer_append(&record, magic,
+                                         ANJAY_JOURNAL_MAGIC_SIZE)
+                || _anjay_raw_buffer_append(&record, &size_placeholder,
+                                            sizeof(size_placeholder))
+                || _anjay_raw_buffer_append_stream(&record, payload))) {
+        anjay_log(ERROR, "could not assemble journal record");
+        retval = -1;
+    }
+    avs_stream_cleanup(&payload);
+    if (!retval && record.size - RECORD_HEADER_SIZE > UINT32_MAX) {
+        anjay_log(ERROR, "journal record too large");
+        retval = -1;
+    }
+    if (!retval) {
+        const uint32_t size_be =
+                avs_convert_be32((uint32_t) (record.size - RECORD_HEADER_SIZE));
+        memcpy((char *) record.data + ANJAY_JOURNAL_MAGIC_SIZE, &size_be,
+               sizeof(size_be));
+        const uint32_t crc_be =
+                avs_convert_be32(_anjay_crc32(0, record.data, record.size));
+        if (_anjay_raw_buffer_append(&record, &crc_be, sizeof(crc_be))) {
+            anjay_log(ERROR, "out of memory");
+            retval = -1;
+        } else {
+            retval = avs_stream_write(out_stream, record.data, record.size);
+        }
+    }
+    _anjay_raw_buffer_clear(&record);
+    return retval;
+}
+
+static int read_fully(avs_stream_abstract_t *stream,
+                      void *buffer,
+                      size_t size,
+                      size_t *out_bytes_read) {
+    char message_finished = 0;
+    *out_bytes_read = 0;
+    while (*out_bytes_read < size && !message_finished) {
+        size_t bytes_read;
+        int retval = avs_stream_read(stream, &bytes_read, &message_finished,
+                                     (char *) buffer + *out_bytes_read,
+                                     size - *out_bytes_read);
+        if (retval) {
+            return retval;
+        }
+        *out_bytes_read += bytes_read;
+    }
+    return 0;
+}
+
+/**
+ * Payloads are read in chunks of this size, so that memory is only allocated
+ * for data that is actually present in the stream, even if the size field of
+ * a record is damaged.
+ */
+#define READ_CHUNK_SIZE 1024
+
+/**
+ * Reads up to @p payload_size bytes into @p out_payload . If the stream ends
+ * earlier, succeeds with <c>out_payload->size</c> smaller than requested.
+ */
+static int read_payload(avs_stream_abstract_t *in_stream,
+                        uint32_t payload_size,
+                        anjay_raw_buffer_t *out_payload) {
+    out_payload->size = 0;
+    while (out_payload->size < payload_size) {
+        char chunk[READ_CHUNK_SIZE];
+        size_t chunk_size =
+                AVS_MIN(sizeof(chunk), payload_size - out_payload->size);
+        size_t bytes_read;
+        int retval = read_fully(in_stream, chunk, chunk_size, &bytes_read);
+        if (retval) {
+            return retval;
+        }
+        if (bytes_read
+                && _anjay_raw_buffer_append(out_payload, chunk, bytes_read)) {
+            anjay_log(ERROR, "out of memory");
+            return -1;
+        }
+        if (bytes_read < chunk_size) {
+            break;
+        }
+    }
+    return 0;
+}
+
+typedef enum {
+    RECORD_VALID,
+    RECORD_END_OF_STREAM,
+    RECORD_DAMAGED
+} record_status_t;
+
+/**
+ * Reads the next record into @p out_payload and classifies it in
+ * <c>*out_status</c>. A truncated record is reported as damaged.
+ */
+static int read_record(avs_stream_abstract_t *in_stream,
+                       const char *magic,
+                       anjay_raw_buffer_t *out_payload,
+                       record_status_t *out_status) {
+    *out_status = RECORD_END_OF_STREAM;
+    char header[RECORD_HEADER_SIZE];
+    uint32_t payload_size;
+    uint32_t crc;
+    size_t bytes_read;
+    int retval = read_fully(in_stream, header, sizeof(header), &bytes_read);
+    if (retval || !bytes_read) {
+        return retval;
+    }
+    *out_status = RECORD_DAMAGED;
+    if (bytes_read < sizeof(header)) {
+        anjay_log(WARNING, "ignoring truncated journal record");
+        return 0;
+    }
+    memcpy(&payload_size, header + ANJAY_JOURNAL_MAGIC_SIZE,
+           sizeof(payload_size));
+    payload_size = avs_convert_be32(payload_size);
+    if ((retval = read_payload(in_stream, payload_size, out_payload))) {
+        return retval;
+    }
+    bytes_read = 0;
+    if (out_payload->size == payload_size
+            && (retval = read_fully(in_stream, &crc, sizeof(crc),
+                                    &bytes_read))) {
+        return retval;
+    }
+    if (bytes_read < sizeof(crc)) {
+        anjay_log(WARNING, "ignoring truncated journal record");
+        return 0;
+    }
+    if (avs_convert_be32(crc)
+            != _anjay_crc32(_anjay_crc32(0, header, sizeof(header)),
+                            out_payload->data, out_payload->size)) {
+        anjay_log(WARNING, "ignoring damaged journal record");
+        return 0;
+    }
+    if (memcmp(header, magic, ANJAY_JOURNAL_MAGIC_SIZE)) {
+        anjay_log(ERROR, "unexpected journal record type");
+        return -1;
+    }
+    *out_status = RECORD_VALID;
+    return 0;
+}
+
+int _anjay_journal_replay(avs_stream_abstract_t *in_stream,
+                          const char *magic,
+                          anjay_journal_record_handler_t *handler,
+                          void *arg,
+                          bool *out_damaged_tail) {
+    anjay_raw_buffer_t payload = ANJAY_RAW_BUFFER_EMPTY;
+    int count = 0;
+    int retval;
+    record_status_t status;
+    while (!(retval = read_record(in_stream, magic, &payload, &status))
+            && status == RECORD_VALID) {
+        avs_stream_inbuf_t inbuf = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+        avs_stream_inbuf_set_buffer(&inbuf, payload.data, payload.size);
+        if ((retval = handler((avs_stream_abstract_t *) &inbuf, arg))) {
+            anjay_log(ERROR, "could not apply journal record %d", count);
+            break;
+        }
+        ++count;
+    }
+    _anjay_raw_buffer_clear(&payload);
+    *out_damaged_tail = (!retval && status == RECORD_DAMAGED);
+    return retval ? retval : count;
+}
+
+#ifdef ANJAY_TEST
+#include "test/journal.c"
+#endif // ANJAY_TEST
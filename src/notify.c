@@ -62,8 +62,26 @@ static int observe_notify(anjay_t *anjay,
 #define observe_notify(anjay, queue) (0)
 #endif // WITH_OBSERVE
 
+static void
+invalidate_security_cache(anjay_t *anjay,
+                          anjay_notify_queue_object_entry_t *security) {
+    if (security->instance_set_changes.instance_set_changed) {
+        _anjay_servers_invalidate_security_cache(anjay, ANJAY_IID_INVALID);
+        return;
+    }
+    int32_t last_iid = -1;
+    AVS_LIST(anjay_notify_queue_resource_entry_t) it;
+    AVS_LIST_FOREACH(it, security->resources_changed) {
+        if (it->iid != last_iid) {
+            _anjay_servers_invalidate_security_cache(anjay, it->iid);
+            last_iid = it->iid;
+        }
+    }
+}
+
 static int security_modified_notify(
         anjay_t *anjay, anjay_notify_queue_object_entry_t *security) {
+    invalidate_security_cache(anjay, security);
     if (anjay_is_offline(anjay)) {
         return 0;
     }
@@ -85,6 +103,7 @@ static int security_modified_notify(
 
 static int server_modified_notify(anjay_t *anjay,
                                   anjay_notify_queue_object_entry_t *server) {
+    _anjay_servers_invalidate_config_cache(anjay);
     int ret = 0;
     AVS_LIST(anjay_notify_queue_resource_entry_t) it;
     AVS_LIST_FOREACH(it, server->resources_changed) {
@@ -307,6 +326,41 @@ int _anjay_notify_queue_resource_change(anjay_notify_queue_t *out_queue,
     return 0;
 }
 
+int _anjay_notify_queue_merge(anjay_notify_queue_t *out_queue,
+                              anjay_notify_queue_t *queue_ptr) {
+    int result = 0;
+    AVS_LIST(anjay_notify_queue_object_entry_t) obj;
+    AVS_LIST_FOREACH(obj, *queue_ptr) {
+        AVS_LIST(anjay_iid_t) iid;
+        AVS_LIST_FOREACH(iid, obj->instance_set_changes.known_removed_iids) {
+            if ((result = _anjay_notify_queue_instance_removed(
+                    out_queue, obj->oid, *iid))) {
+                return result;
+            }
+        }
+        AVS_LIST_FOREACH(iid, obj->instance_set_changes.known_added_iids) {
+            if ((result = _anjay_notify_queue_instance_created(
+                    out_queue, obj->oid, *iid))) {
+                return result;
+            }
+        }
+        if (obj->instance_set_changes.instance_set_changed
+                && (result = _anjay_notify_queue_instance_set_unknown_change(
+                        out_queue, obj->oid))) {
+            return result;
+        }
+        AVS_LIST(anjay_notify_queue_resource_entry_t) res;
+        AVS_LIST_FOREACH(res, obj->resources_changed) {
+            if ((result = _anjay_notify_queue_resource_change(
+                    out_queue, obj->oid, res->iid, res->rid))) {
+                return result;
+            }
+        }
+    }
+    _anjay_notify_clear_queue(queue_ptr);
+    return 0;
+}
+
 void _anjay_notify_clear_queue(anjay_notify_queue_t *out_queue) {
     AVS_LIST_CLEAR(out_queue) {
         AVS_LIST_CLEAR(&(*out_queue)->instance_set_changes.known_added_iids);
@@ -317,17 +371,32 @@ void _anjay_notify_clear_queue(anjay_notify_queue_t *out_queue) {
 
 static void notify_clb(anjay_t *anjay, void *dummy) {
     (void) dummy;
+    if (_anjay_bootstrap_in_progress(anjay)) {
+        // the job might have been scheduled before the Bootstrap Sequence
+        // started; the queue is processed at Bootstrap-Finish
+        return;
+    }
     _anjay_notify_flush(anjay, &anjay->scheduled_notify.queue);
 }
 
 static int reschedule_notify(anjay_t *anjay) {
-    if (anjay->scheduled_notify.handle) {
+    if (anjay->scheduled_notify.handle
+            || _anjay_bootstrap_in_progress(anjay)) {
         return 0;
     }
     return _anjay_sched_now(anjay->sched, &anjay->scheduled_notify.handle,
                             notify_clb, NULL);
 }
 
+int _anjay_notify_schedule_deferred(anjay_t *anjay) {
+    // anjay->sched is already gone if the Bootstrap Sequence is aborted
+    // during anjay_delete()
+    if (!anjay->scheduled_notify.queue || !anjay->sched) {
+        return 0;
+    }
+    return reschedule_notify(anjay);
+}
+
 int _anjay_notify_instance_created(anjay_t *anjay,
                                    anjay_oid_t oid,
                                    anjay_iid_t iid) {
@@ -356,3 +425,20 @@ int anjay_notify_instances_changed(anjay_t *anjay, anjay_oid_t oid) {
             || (retval = reschedule_notify(anjay)));
     return retval;
 }
+
+int anjay_notify_set_priority(anjay_t *anjay,
+                              anjay_oid_t oid,
+                              anjay_notify_priority_t priority) {
+    if (priority < ANJAY_NOTIFY_PRIORITY_LOW
+            || priority > ANJAY_NOTIFY_PRIORITY_HIGH) {
+        anjay_log(ERROR, "invalid notification priority: %d", (int) priority);
+        return -1;
+    }
+#ifdef WITH_OBSERVE
+    return _anjay_observe_set_priority(&anjay->observe, oid, priority);
+#else // WITH_OBSERVE
+    (void) anjay; (void) oid;
+    anjay_log(ERROR, "Observe support not compiled in");
+    return -1;
+#endif // WITH_OBSERVE
+}
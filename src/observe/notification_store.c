@@ -0,0 +1,145 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <avsystem/commons/stream/stream_file.h>
+#include <avsystem/commons/utils.h>
+
+#include "../anjay_core.h"
+
+#include "notification_store.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#define VALUE_HEADER_SIZE offsetof(anjay_observe_resource_value_t, value)
+
+static int open_for_writing(anjay_observe_spill_t *spill,
+                            const char *path_prefix,
+                            const anjay_connection_key_t *connection,
+                            unsigned lane) {
+    assert(!spill->path);
+    assert(!spill->records);
+    size_t size = strlen(path_prefix)
+                  + sizeof(".65535.-2147483648.4294967295");
+    if (!(spill->path = (char *) avs_malloc(size))) {
+        anjay_log(ERROR, "Out of memory");
+        return -1;
+    }
+    if (avs_simple_snprintf(spill->path, size, "%s.%" PRIu16 ".%d.%u",
+                            path_prefix, connection->ssid,
+                            (int) connection->type, lane) < 0
+            || !(spill->out = avs_stream_file_create(spill->path,
+                                                     AVS_STREAM_FILE_WRITE))) {
+        anjay_log(ERROR, "could not create notification spill file");
+        avs_free(spill->path);
+        spill->path = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int _anjay_observe_spill_append(anjay_observe_spill_t *spill,
+                                const char *path_prefix,
+                                unsigned lane,
+                                const anjay_observe_key_t *key,
+                                const anjay_observe_resource_value_t *value) {
+    if (!spill->path) {
+        if (open_for_writing(spill, path_prefix, &key->connection, lane)) {
+            return -1;
+        }
+    } else if (!spill->out) {
+        // a previous write failed, so the end of the file may contain a
+        // partial record; the file is only usable for reading until drained
+        return -1;
+    }
+    int result;
+    (void) ((result = avs_stream_write(spill->out, key, sizeof(*key)))
+            || (result = avs_stream_write(spill->out, value,
+                                          VALUE_HEADER_SIZE
+                                                  + value->value_length))
+            || (result = avs_stream_finish_message(spill->out)));
+    if (result) {
+        anjay_log(ERROR, "could not write to notification spill file %s",
+                  spill->path);
+        avs_stream_cleanup(&spill->out);
+        if (!spill->records) {
+            _anjay_observe_spill_discard(spill);
+        }
+        return -1;
+    }
+    ++spill->records;
+    return 0;
+}
+
+AVS_LIST(anjay_observe_resource_value_t)
+_anjay_observe_spill_read(anjay_observe_spill_t *spill,
+                          anjay_observe_key_t *out_key) {
+    assert(spill->records);
+    AVS_LIST(anjay_observe_resource_value_t) result = NULL;
+    anjay_observe_resource_value_t header;
+    if (!spill->in
+            && !(spill->in = avs_stream_file_create(spill->path,
+                                                    AVS_STREAM_FILE_READ))) {
+        anjay_log(ERROR, "could not open notification spill file %s",
+                  spill->path);
+        goto error;
+    }
+    if (avs_stream_read_reliably(spill->in, out_key, sizeof(*out_key))
+            || avs_stream_read_reliably(spill->in, &header,
+                                        VALUE_HEADER_SIZE)) {
+        goto read_error;
+    }
+    if (!(result = (anjay_observe_resource_value_t *) AVS_LIST_NEW_BUFFER(
+                  VALUE_HEADER_SIZE + header.value_length))) {
+        anjay_log(ERROR, "Out of memory");
+        goto error;
+    }
+    memcpy(result, &header, VALUE_HEADER_SIZE);
+    if (avs_stream_read_reliably(spill->in, result->value,
+                                 header.value_length)) {
+        goto read_error;
+    }
+    result->ref = NULL;
+    if (!--spill->records) {
+        _anjay_observe_spill_discard(spill);
+    }
+    return result;
+
+read_error:
+    anjay_log(ERROR, "could not read notification spill file %s", spill->path);
+error:
+    AVS_LIST_CLEAR(&result);
+    _anjay_observe_spill_discard(spill);
+    return NULL;
+}
+
+void _anjay_observe_spill_discard(anjay_observe_spill_t *spill) {
+    avs_stream_cleanup(&spill->in);
+    avs_stream_cleanup(&spill->out);
+    if (spill->path) {
+        if (remove(spill->path)) {
+            anjay_log(WARNING, "could not remove notification spill file %s",
+                      spill->path);
+        }
+        avs_free(spill->path);
+    }
+    memset(spill, 0, sizeof(*spill));
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANJAY_OBSERVE_NOTIFICATION_STORE_H
+#define ANJAY_OBSERVE_NOTIFICATION_STORE_H
+
+#include <avsystem/commons/list.h>
+#include <avsystem/commons/stream.h>
+
+#include "observe_core.h"
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Append-only file holding the oldest unsent notifications of a single
+ * connection that did not fit in the memory budget. Records are read back in
+ * the order they were written; the file is removed as soon as it is drained.
+ *
+ * The records are stored in the in-memory representation, so the file is only
+ * meaningful to the process that wrote it.
+ */
+typedef struct {
+    char *path;
+    avs_stream_abstract_t *out;
+    avs_stream_abstract_t *in;
+    // number of records written, but not read back yet
+    size_t records;
+} anjay_observe_spill_t;
+
+static inline size_t
+_anjay_observe_spill_records(const anjay_observe_spill_t *spill) {
+    return spill->records;
+}
+
+/**
+ * Appends @p value, stored for the observation identified by @p key, to the
+ * spill file. The file is created as <c>@p path_prefix.SSID.CONN_TYPE.LANE</c>
+ * if it is not open yet.
+ *
+ * @returns 0 on success, or a negative value in case of an I/O error. In the
+ *          latter case, records written earlier may still be read, but no new
+ *          ones are accepted until the file is drained.
+ */
+int _anjay_observe_spill_append(anjay_observe_spill_t *spill,
+                                const char *path_prefix,
+                                unsigned lane,
+                                const anjay_observe_key_t *key,
+                                const anjay_observe_resource_value_t *value);
+
+/**
+ * Reads the oldest record from the spill file. The <c>ref</c> field of the
+ * returned value is NULL; the observation it belongs to shall be looked up by
+ * @p out_key.
+ *
+ * @returns Newly allocated value, or NULL in case of an error. In the latter
+ *          case, all records are discarded, as the file can no longer be
+ *          trusted to be consistent.
+ */
+AVS_LIST(anjay_observe_resource_value_t)
+_anjay_observe_spill_read(anjay_observe_spill_t *spill,
+                          anjay_observe_key_t *out_key);
+
+/**
+ * Discards all records and removes the spill file.
+ */
+void _anjay_observe_spill_discard(anjay_observe_spill_t *spill);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_OBSERVE_NOTIFICATION_STORE_H */
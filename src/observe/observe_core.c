@@ -14,17 +14,24 @@
  * limitations under the License.
  */
 
+#if defined(ANJAY_TEST) && !defined(_POSIX_C_SOURCE) && !defined(__APPLE__)
+// mkstemp() is used by the notification store tests
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <anjay_config.h>
 
 #include <inttypes.h>
 #include <math.h>
 
 #include <avsystem/commons/stream_v_table.h>
+#include <avsystem/commons/utils.h>
 
 #include <anjay_modules/time_defs.h>
 
 #include "../coap/content_format.h"
 #include "../anjay_core.h"
+#include "../dm/composite.h"
 #include "../dm/query.h"
 
 #include "observe_internal.h"
@@ -79,18 +86,51 @@ int _anjay_observe_entry_cmp(const void *left, const void *right) {
             &((const anjay_observe_entry_t *) right)->key);
 }
 
+static void notify_timer_fired(anjay_t *anjay, anjay_observe_timer_t *timer);
+
 int _anjay_observe_init(anjay_observe_state_t *observe,
-                        bool confirmable_notifications) {
+                        anjay_sched_t *sched,
+                        bool confirmable_notifications,
+                        const anjay_observe_store_config_t *store_config) {
     if (!(observe->connection_entries =
             AVS_RBTREE_NEW(anjay_observe_connection_entry_t,
                            connection_state_cmp))) {
         anjay_log(ERROR, "Could not initialize Observe structures");
         return -1;
     }
+    if (store_config) {
+        if (store_config->spill_path
+                && !(observe->store_spill_path =
+                        avs_strdup(store_config->spill_path))) {
+            anjay_log(ERROR, "Out of memory");
+            AVS_RBTREE_DELETE(&observe->connection_entries);
+            return -1;
+        }
+        observe->store_memory_limit = store_config->memory_limit;
+        observe->store_coalesce = store_config->coalesce;
+    }
+    _anjay_observe_timer_wheel_init(&observe->timers, sched,
+                                    notify_timer_fired);
     observe->confirmable_notifications = confirmable_notifications;
     return 0;
 }
 
+/**
+ * Forgets about the spilled values of entries that use @p lane, or of all
+ * entries if @p lane is NULL.
+ */
+static void forget_spilled_values(anjay_observe_connection_entry_t *conn,
+                                  const anjay_observe_lane_t *lane) {
+    AVS_RBTREE_ELEM(anjay_observe_entry_t) entry;
+    AVS_RBTREE_FOREACH(entry, conn->entries) {
+        if (!lane || _anjay_observe_lane(conn, entry) == lane) {
+            AVS_LIST_CLEAR(&entry->last_spilled);
+            entry->spilled_values = 0;
+            entry->superseded_spilled_values = 0;
+        }
+    }
+}
+
 void _anjay_observe_cleanup_connection(anjay_sched_t *sched,
                                        anjay_observe_connection_entry_t *conn) {
     /*
@@ -101,15 +141,18 @@ void _anjay_observe_cleanup_connection(anjay_sched_t *sched,
      * must be NULL.
      */
     AVS_RBTREE_DELETE(&conn->entries) {
-        if ((*conn->entries)->notify_task) {
-            _anjay_sched_del(sched, &(*conn->entries)->notify_task);
-        }
+        _anjay_observe_timer_cancel(&(*conn->entries)->notify_timer);
         AVS_LIST_CLEAR(&(*conn->entries)->last_sent);
+        AVS_LIST_CLEAR(&(*conn->entries)->last_spilled);
+        AVS_LIST_CLEAR(&(*conn->entries)->composite_paths);
     }
     if (conn->flush_task) {
         _anjay_sched_del(sched, &conn->flush_task);
     }
-    AVS_LIST_CLEAR(&conn->unsent);
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(conn->lanes); ++i) {
+        AVS_LIST_CLEAR(&conn->lanes[i].unsent);
+        _anjay_observe_spill_discard(&conn->lanes[i].spill);
+    }
 }
 
 void _anjay_observe_cleanup(anjay_observe_state_t *observe,
@@ -117,6 +160,10 @@ void _anjay_observe_cleanup(anjay_observe_state_t *observe,
     AVS_RBTREE_DELETE(&observe->connection_entries) {
         _anjay_observe_cleanup_connection(sched, *observe->connection_entries);
     }
+    _anjay_observe_timer_wheel_cleanup(&observe->timers);
+    AVS_LIST_CLEAR(&observe->object_priorities);
+    avs_free(observe->store_spill_path);
+    observe->store_spill_path = NULL;
 }
 
 static int observe_setup_for_sending(avs_stream_abstract_t *stream,
@@ -153,25 +200,43 @@ const anjay_observe_stream_t *_anjay_observe_stream_initializer__(void) {
     return &initializer;
 }
 
+static inline bool is_error_value(const anjay_observe_resource_value_t *value) {
+    return avs_coap_msg_code_get_class(value->details.msg_code) >= 4;
+}
+
+static size_t value_size(const anjay_observe_resource_value_t *value) {
+    return offsetof(anjay_observe_resource_value_t, value)
+           + value->value_length;
+}
+
 static void clear_entry(anjay_t *anjay,
                         anjay_observe_connection_entry_t *connection,
                         anjay_observe_entry_t *entry) {
-    _anjay_sched_del(anjay->sched, &entry->notify_task);
+    (void) anjay;
+    _anjay_observe_timer_cancel(&entry->notify_timer);
     AVS_LIST_CLEAR(&entry->last_sent);
+    // values left in the spill file are skipped when read back
+    AVS_LIST_CLEAR(&entry->last_spilled);
+    entry->spilled_values = 0;
+    entry->superseded_spilled_values = 0;
 
     if (entry->last_unsent) {
+        anjay_observe_lane_t *lane = _anjay_observe_lane(connection, entry);
         anjay_observe_resource_value_t **unsent_ptr;
         anjay_observe_resource_value_t *helper;
         anjay_observe_resource_value_t *server_last_unsent = NULL;
-        AVS_LIST_DELETABLE_FOREACH_PTR(unsent_ptr, helper,
-                                       &connection->unsent) {
+        AVS_LIST_DELETABLE_FOREACH_PTR(unsent_ptr, helper, &lane->unsent) {
             if ((*unsent_ptr)->ref != entry) {
                 server_last_unsent = *unsent_ptr;
             } else {
+                if (unsent_ptr == &lane->unsent) {
+                    lane->unsent_head_restored = false;
+                }
+                connection->unsent_size -= value_size(*unsent_ptr);
                 AVS_LIST_DELETE(unsent_ptr);
             }
         }
-        connection->unsent_last = server_last_unsent;
+        lane->unsent_last = server_last_unsent;
         entry->last_unsent = NULL;
     }
 }
@@ -187,51 +252,90 @@ static void delete_connection_if_empty(
         anjay_t *anjay,
         AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) *conn_ptr) {
     if (!AVS_RBTREE_FIRST((*conn_ptr)->entries)) {
-        assert(!(*conn_ptr)->unsent);
-        assert(!(*conn_ptr)->unsent_last);
+        for (size_t i = 0; i < AVS_ARRAY_SIZE((*conn_ptr)->lanes); ++i) {
+            assert(!(*conn_ptr)->lanes[i].unsent);
+            assert(!(*conn_ptr)->lanes[i].unsent_last);
+        }
         delete_connection(anjay, conn_ptr);
     }
 }
 
-static void trigger_observe(anjay_t *anjay, void *entry_);
+static void trigger_observe(anjay_t *anjay, anjay_observe_entry_t *entry);
 
 static const anjay_observe_resource_value_t *
 newest_value(const anjay_observe_entry_t *entry) {
     if (entry->last_unsent) {
         return entry->last_unsent;
+    } else if (entry->last_spilled) {
+        return entry->last_spilled;
     } else {
         assert(entry->last_sent);
         return entry->last_sent;
     }
 }
 
+/**
+ * Notifications forced by pmax may be sent up to 1/ANJAY_PMAX_SLACK_DIVISOR of
+ * the (pmax - pmin) interval earlier, so that they can share a wakeup with
+ * other scheduled jobs.
+ */
+#define ANJAY_PMAX_SLACK_DIVISOR 4
+
+static int32_t pmax_slack_s(const anjay_dm_attributes_t *attrs) {
+    int32_t min_period = attrs->min_period > 0 ? attrs->min_period : 0;
+    if (attrs->max_period <= min_period) {
+        return 0;
+    }
+    return (attrs->max_period - min_period) / ANJAY_PMAX_SLACK_DIVISOR;
+}
+
+/**
+ * Arms the entry's timer so that trigger_observe() runs @p period seconds after
+ * the newest value, or up to @p slack_s seconds earlier.
+ */
 static int schedule_trigger(anjay_t *anjay,
                             anjay_observe_entry_t *entry,
-                            int32_t period) {
+                            int32_t period,
+                            int32_t slack_s) {
     if (period < 0) {
         return 0;
     }
 
-    avs_time_duration_t delay =
+    avs_time_duration_t deadline =
             avs_time_real_diff(newest_value(entry)->timestamp,
                                avs_time_real_now());
-    delay = avs_time_duration_add(
-            delay, avs_time_duration_from_scalar(period, AVS_TIME_S));
+    deadline = avs_time_duration_add(
+            deadline, avs_time_duration_from_scalar(period, AVS_TIME_S));
+    if (avs_time_duration_less(deadline, AVS_TIME_DURATION_ZERO)) {
+        deadline = AVS_TIME_DURATION_ZERO;
+    }
+    avs_time_duration_t delay = avs_time_duration_diff(
+            deadline, avs_time_duration_from_scalar(slack_s, AVS_TIME_S));
     if (avs_time_duration_less(delay, AVS_TIME_DURATION_ZERO)) {
         delay = AVS_TIME_DURATION_ZERO;
     }
 
     anjay_log(TRACE, "Notify %s (format %" PRIu16 ", SSID %" PRIu16 ", "
-              "connection type %d) scheduled: +%ld.%09lds",
+              "connection type %d) scheduled: +%ld.%09lds..+%ld.%09lds",
               ANJAY_DEBUG_MAKE_PATH(&MAKE_INSTANCE_OR_RESOURCE_PATH(
                       entry->key.oid, entry->key.iid, entry->key.rid)),
               entry->key.format, entry->key.connection.ssid,
               (int) entry->key.connection.type,
-              (long) delay.seconds, (long) delay.nanoseconds);
+              (long) delay.seconds, (long) delay.nanoseconds,
+              (long) deadline.seconds, (long) deadline.nanoseconds);
+
+    avs_time_monotonic_t now = avs_time_monotonic_now();
+    return _anjay_observe_timer_arm(&anjay->observe.timers,
+                                    &entry->notify_timer,
+                                    avs_time_monotonic_add(now, delay),
+                                    avs_time_monotonic_add(now, deadline));
+}
 
-    _anjay_sched_del(anjay->sched, &entry->notify_task);
-    return _anjay_sched(anjay->sched, &entry->notify_task, delay,
-                        trigger_observe, entry);
+static int schedule_pmax_trigger(anjay_t *anjay,
+                                 anjay_observe_entry_t *entry,
+                                 const anjay_dm_attributes_t *attrs) {
+    return schedule_trigger(anjay, entry, attrs->max_period,
+                            pmax_slack_s(attrs));
 }
 
 static AVS_LIST(anjay_observe_resource_value_t)
@@ -262,7 +366,109 @@ create_resource_value(const anjay_msg_details_t *details,
     return result;
 }
 
-static int insert_new_value(anjay_observe_connection_entry_t *conn_state,
+/**
+ * Removes the unsent value of @p entry that is superseded by @p new_value, if
+ * it is still kept in memory, and marks all values of @p entry in the spill
+ * file as superseded. Error values are never dropped, and neither is the value
+ * read back from the spill file, which may be in the middle of being retried.
+ */
+static void
+drop_superseded_value(anjay_observe_connection_entry_t *conn_state,
+                      anjay_observe_entry_t *entry,
+                      const anjay_observe_resource_value_t *new_value) {
+    anjay_observe_lane_t *lane = _anjay_observe_lane(conn_state, entry);
+    if (!is_error_value(new_value)) {
+        // spilled error values are kept when read back
+        entry->superseded_spilled_values = entry->spilled_values;
+    }
+    if (!entry->last_unsent
+            || is_error_value(entry->last_unsent)
+            || is_error_value(new_value)
+            || (lane->unsent_head_restored
+                    && entry->last_unsent == lane->unsent)) {
+        return;
+    }
+    AVS_LIST(anjay_observe_resource_value_t) *value_ptr = &lane->unsent;
+    AVS_LIST(anjay_observe_resource_value_t) previous = NULL;
+    while (*value_ptr != entry->last_unsent) {
+        assert(*value_ptr);
+        previous = *value_ptr;
+        value_ptr = AVS_LIST_NEXT_PTR(value_ptr);
+    }
+    if (lane->unsent_last == *value_ptr) {
+        lane->unsent_last = previous;
+    }
+    conn_state->unsent_size -= value_size(*value_ptr);
+    AVS_LIST_DELETE(value_ptr);
+    entry->last_unsent = NULL;
+}
+
+/**
+ * Moves the value pointed to by @p value_ptr, which shall be either the first
+ * or the second element of the unsent list of @p lane, to the spill file - or
+ * drops it if that is not possible. The newest value of an entry is still kept
+ * in memory as last_spilled, as it is necessary to decide about future
+ * notifications.
+ */
+static void evict_value(anjay_t *anjay,
+                        anjay_observe_connection_entry_t *conn_state,
+                        anjay_observe_lane_t *lane,
+                        AVS_LIST(anjay_observe_resource_value_t) *value_ptr) {
+    assert(value_ptr == &lane->unsent
+           || value_ptr == AVS_LIST_NEXT_PTR(&lane->unsent));
+    AVS_LIST(anjay_observe_resource_value_t) value = AVS_LIST_DETACH(value_ptr);
+    if (lane->unsent_last == value) {
+        lane->unsent_last = value_ptr == &lane->unsent ? NULL : lane->unsent;
+    }
+    conn_state->unsent_size -= value_size(value);
+
+    anjay_observe_entry_t *entry = value->ref;
+    bool spilled = anjay->observe.store_spill_path
+                   && !_anjay_observe_spill_append(
+                              &lane->spill, anjay->observe.store_spill_path,
+                              (unsigned) (lane - conn_state->lanes),
+                              &entry->key, value);
+    if (spilled) {
+        ++entry->spilled_values;
+    } else {
+        anjay_log(WARNING, "stored notifications limit exceeded, dropping "
+                  "value of %s (SSID %" PRIu16 ")",
+                  ANJAY_DEBUG_MAKE_PATH(&MAKE_INSTANCE_OR_RESOURCE_PATH(
+                          entry->key.oid, entry->key.iid, entry->key.rid)),
+                  entry->key.connection.ssid);
+    }
+    if (entry->last_unsent == value) {
+        entry->last_unsent = NULL;
+        if (spilled) {
+            assert(!entry->last_spilled);
+            entry->last_spilled = value;
+            return;
+        }
+    }
+    AVS_LIST_DELETE(&value);
+}
+
+static void enforce_store_limit(anjay_t *anjay,
+                                anjay_observe_connection_entry_t *conn_state) {
+    size_t limit = anjay->observe.store_memory_limit;
+    if (!limit) {
+        return;
+    }
+    // values of the lowest priority are evicted first
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(conn_state->lanes); ++i) {
+        anjay_observe_lane_t *lane = &conn_state->lanes[i];
+        AVS_LIST(anjay_observe_resource_value_t) *value_ptr = &lane->unsent;
+        if (lane->unsent_head_restored) {
+            value_ptr = AVS_LIST_NEXT_PTR(value_ptr);
+        }
+        while (conn_state->unsent_size > limit && *value_ptr) {
+            evict_value(anjay, conn_state, lane, value_ptr);
+        }
+    }
+}
+
+static int insert_new_value(anjay_t *anjay,
+                            anjay_observe_connection_entry_t *conn_state,
                             anjay_observe_entry_t *entry,
                             const anjay_msg_details_t *details,
                             const avs_coap_msg_identity_t *identity,
@@ -275,12 +481,21 @@ static int insert_new_value(anjay_observe_connection_entry_t *conn_state,
     if (!res_value) {
         return -1;
     }
-    AVS_LIST_APPEND(&conn_state->unsent_last, res_value);
-    conn_state->unsent_last = res_value;
-    if (!conn_state->unsent) {
-        conn_state->unsent = res_value;
+    // identity may point into one of the values dropped below, so this is only
+    // done after it has been copied
+    if (anjay->observe.store_coalesce) {
+        drop_superseded_value(conn_state, entry, res_value);
+    }
+    AVS_LIST_CLEAR(&entry->last_spilled);
+    anjay_observe_lane_t *lane = _anjay_observe_lane(conn_state, entry);
+    AVS_LIST_APPEND(&lane->unsent_last, res_value);
+    lane->unsent_last = res_value;
+    if (!lane->unsent) {
+        lane->unsent = res_value;
     }
+    conn_state->unsent_size += value_size(res_value);
     entry->last_unsent = res_value;
+    enforce_store_limit(anjay, conn_state);
     return 0;
 }
 
@@ -289,13 +504,13 @@ static int insert_error(anjay_t *anjay,
                         anjay_observe_entry_t *entry,
                         const avs_coap_msg_identity_t *identity,
                         int outer_result) {
-    _anjay_sched_del(anjay->sched, &entry->notify_task);
+    _anjay_observe_timer_cancel(&entry->notify_timer);
     const anjay_msg_details_t details = {
         .msg_type = AVS_COAP_MSG_CONFIRMABLE,
         .msg_code = _anjay_make_error_response_code(outer_result),
         .format = AVS_COAP_FORMAT_NONE
     };
-    return insert_new_value(conn_state, entry, &details, identity,
+    return insert_new_value(anjay, conn_state, entry, &details, identity,
                             NAN, NULL, 0);
 }
 
@@ -356,8 +571,8 @@ int _anjay_observe_schedule_trigger(anjay_t *anjay,
     int result;
 
     (void)((result = get_attrs(anjay, &attrs, &entry->key))
-            || (result = schedule_trigger(anjay, entry,
-                                          attrs.standard.common.max_period)));
+            || (result = schedule_pmax_trigger(anjay, entry,
+                                               &attrs.standard.common)));
 
     return result;
 }
@@ -429,14 +644,75 @@ find_or_create_connection_state(anjay_t *anjay,
     return conn;
 }
 
-int _anjay_observe_put_entry(anjay_t *anjay,
-                             const anjay_observe_key_t *key,
-                             const anjay_msg_details_t *details,
-                             const avs_coap_msg_identity_t *identity,
-                             double numeric,
-                             const void *data,
-                             size_t size) {
+static anjay_notify_priority_t
+object_priority(const anjay_observe_state_t *observe, anjay_oid_t oid) {
+    AVS_LIST(const anjay_observe_object_priority_t) it;
+    AVS_LIST_FOREACH(it, observe->object_priorities) {
+        if (it->oid == oid) {
+            return it->priority;
+        }
+    }
+    return ANJAY_NOTIFY_PRIORITY_NORMAL;
+}
+
+int _anjay_observe_set_priority(anjay_observe_state_t *observe,
+                                anjay_oid_t oid,
+                                anjay_notify_priority_t priority) {
+    AVS_LIST(anjay_observe_object_priority_t) *it_ptr;
+    AVS_LIST_FOREACH_PTR(it_ptr, &observe->object_priorities) {
+        if ((*it_ptr)->oid == oid) {
+            break;
+        }
+    }
+    if (priority == ANJAY_NOTIFY_PRIORITY_NORMAL) {
+        if (*it_ptr) {
+            AVS_LIST_DELETE(it_ptr);
+        }
+        return 0;
+    }
+    if (!*it_ptr) {
+        *it_ptr = AVS_LIST_NEW_ELEMENT(anjay_observe_object_priority_t);
+        if (!*it_ptr) {
+            anjay_log(ERROR, "Out of memory");
+            return -1;
+        }
+        (*it_ptr)->oid = oid;
+    }
+    (*it_ptr)->priority = priority;
+    return 0;
+}
+
+/**
+ * Composite observations use the highest priority of all the observed Objects.
+ */
+static anjay_notify_priority_t
+entry_priority(const anjay_observe_state_t *observe,
+               const anjay_observe_key_t *key,
+               AVS_LIST(const anjay_uri_path_t) composite_paths) {
+    if (!composite_paths) {
+        return object_priority(observe, key->oid);
+    }
+    anjay_notify_priority_t result = ANJAY_NOTIFY_PRIORITY_LOW;
+    AVS_LIST(const anjay_uri_path_t) path;
+    AVS_LIST_FOREACH(path, composite_paths) {
+        anjay_notify_priority_t priority = object_priority(observe, path->oid);
+        if (priority > result) {
+            result = priority;
+        }
+    }
+    return result;
+}
+
+static int put_entry(anjay_t *anjay,
+                     const anjay_observe_key_t *key,
+                     AVS_LIST(anjay_uri_path_t) *composite_paths_ptr,
+                     const anjay_msg_details_t *details,
+                     const avs_coap_msg_identity_t *identity,
+                     double numeric,
+                     const void *data,
+                     size_t size) {
     assert(key->rid >= -1 && key->rid <= UINT16_MAX);
+    assert(!composite_paths_ptr == (key->oid != ANJAY_OBSERVE_COMPOSITE_OID));
     AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) conn =
             find_or_create_connection_state(anjay, &key->connection);
     if (!conn) {
@@ -451,9 +727,18 @@ int _anjay_observe_put_entry(anjay_t *anjay,
     }
 
     clear_entry(anjay, conn, entry);
+    AVS_LIST_CLEAR(&entry->composite_paths);
+    // the entry has no unsent values now, so it may safely change lanes
+    entry->priority = entry_priority(
+            &anjay->observe, key,
+            composite_paths_ptr ? *composite_paths_ptr : NULL);
     int result = insert_initial_value(anjay, conn, entry, details, identity,
                                       numeric, data, size);
     if (!result) {
+        if (composite_paths_ptr) {
+            entry->composite_paths = *composite_paths_ptr;
+            *composite_paths_ptr = NULL;
+        }
         return 0;
     }
 
@@ -463,11 +748,88 @@ int _anjay_observe_put_entry(anjay_t *anjay,
     return result;
 }
 
+int _anjay_observe_put_entry(anjay_t *anjay,
+                             const anjay_observe_key_t *key,
+                             const anjay_msg_details_t *details,
+                             const avs_coap_msg_identity_t *identity,
+                             double numeric,
+                             const void *data,
+                             size_t size) {
+    return put_entry(anjay, key, NULL, details, identity, numeric, data, size);
+}
+
+static AVS_RBTREE_ELEM(anjay_observe_entry_t)
+first_composite_entry(anjay_observe_connection_entry_t *conn) {
+    const anjay_observe_key_t lower_bound = {
+        .connection = conn->key,
+        .oid = ANJAY_OBSERVE_COMPOSITE_OID,
+        .iid = ANJAY_IID_INVALID,
+        .rid = INT32_MIN,
+        .format = 0
+    };
+    // composite entries sort after all the others, see _anjay_observe_key_cmp()
+    return AVS_RBTREE_LOWER_BOUND(conn->entries,
+                                  _anjay_observe_entry_query(&lower_bound));
+}
+
+static AVS_RBTREE_ELEM(anjay_observe_entry_t)
+find_composite_entry(anjay_observe_connection_entry_t *conn,
+                     uint16_t format,
+                     AVS_LIST(const anjay_uri_path_t) paths) {
+    AVS_RBTREE_ELEM(anjay_observe_entry_t) it;
+    for (it = first_composite_entry(conn); it; it = AVS_RBTREE_ELEM_NEXT(it)) {
+        if (it->key.format == format
+                && _anjay_composite_paths_equal(it->composite_paths, paths)) {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Returns the lowest RID not used by any composite entry of @p conn.
+ */
+static int32_t unused_composite_rid(anjay_observe_connection_entry_t *conn) {
+    int32_t result = 0;
+    AVS_RBTREE_ELEM(anjay_observe_entry_t) it;
+    for (it = first_composite_entry(conn); it; it = AVS_RBTREE_ELEM_NEXT(it)) {
+        if (it->key.rid > result) {
+            break;
+        } else if (it->key.rid == result) {
+            ++result;
+        }
+    }
+    return result;
+}
+
+int _anjay_observe_put_composite_entry(anjay_t *anjay,
+                                       anjay_observe_key_t *inout_key,
+                                       AVS_LIST(anjay_uri_path_t) *paths_ptr,
+                                       const anjay_msg_details_t *details,
+                                       const avs_coap_msg_identity_t *identity,
+                                       const void *data,
+                                       size_t size) {
+    assert(*paths_ptr);
+    AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) conn =
+            AVS_RBTREE_FIND(anjay->observe.connection_entries,
+                            connection_query(&inout_key->connection));
+    AVS_RBTREE_ELEM(anjay_observe_entry_t) existing =
+            conn ? find_composite_entry(conn, inout_key->format, *paths_ptr)
+                 : NULL;
+    inout_key->oid = ANJAY_OBSERVE_COMPOSITE_OID;
+    inout_key->iid = ANJAY_IID_INVALID;
+    inout_key->rid = existing ? existing->key.rid
+                              : (conn ? unused_composite_rid(conn) : 0);
+    return put_entry(anjay, inout_key, paths_ptr, details, identity, NAN,
+                     data, size);
+}
+
 static void
 delete_entry(anjay_t *anjay,
              AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) *conn_ptr,
              AVS_RBTREE_ELEM(anjay_observe_entry_t) *entry_ptr) {
     clear_entry(anjay, *conn_ptr, *entry_ptr);
+    AVS_LIST_CLEAR(&(*entry_ptr)->composite_paths);
     AVS_RBTREE_DELETE_ELEM((*conn_ptr)->entries, entry_ptr);
     delete_connection_if_empty(anjay, conn_ptr);
 }
@@ -486,6 +848,22 @@ void _anjay_observe_remove_entry(anjay_t *anjay,
     }
 }
 
+void _anjay_observe_remove_composite_entry(
+        anjay_t *anjay,
+        const anjay_observe_key_t *key,
+        AVS_LIST(const anjay_uri_path_t) paths) {
+    AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) conn =
+            AVS_RBTREE_FIND(anjay->observe.connection_entries,
+                            connection_query(&key->connection));
+    if (conn) {
+        AVS_RBTREE_ELEM(anjay_observe_entry_t) entry =
+                find_composite_entry(conn, key->format, paths);
+        if (entry) {
+            delete_entry(anjay, &conn, &entry);
+        }
+    }
+}
+
 void _anjay_observe_remove_by_msg_id(anjay_t *anjay,
                                      uint16_t notify_id) {
     AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) conn;
@@ -530,9 +908,10 @@ void _anjay_observe_gc(anjay_t *anjay) {
 
 static bool has_pmax_expired(const anjay_observe_resource_value_t *value,
                              const anjay_dm_attributes_t *attrs) {
+    // the slack window is treated as already expired, see pmax_slack_s()
     return attrs->max_period >= 0
             && avs_time_real_diff(avs_time_real_now(), value->timestamp).seconds
-                    >= attrs->max_period;
+                    >= attrs->max_period - pmax_slack_s(attrs);
 }
 
 static bool process_step(const anjay_observe_resource_value_t *previous,
@@ -582,6 +961,11 @@ static inline ssize_t read_new_value(anjay_t *anjay,
                                      double *out_numeric,
                                      char *buffer,
                                      size_t size) {
+    if (entry->composite_paths) {
+        return _anjay_dm_read_composite_for_observe(
+                anjay, entry->key.connection.ssid, entry->composite_paths,
+                entry->key.format, out_details, buffer, size);
+    }
     anjay_uri_path_type_t path_type = ANJAY_PATH_OBJECT;
     if (entry->key.rid >= 0) {
         path_type = ANJAY_PATH_RESOURCE;
@@ -615,32 +999,6 @@ static int get_conn_ref(anjay_t *anjay,
     return 0;
 }
 
-static int ensure_conn_online(anjay_t *anjay, anjay_connection_ref_t ref) {
-    if (_anjay_connection_current_mode(ref) == ANJAY_CONNECTION_QUEUE
-            && !_anjay_connection_get_online_socket(ref)) {
-        bool session_resumed;
-        if (_anjay_connection_bring_online(anjay, ref, &session_resumed)) {
-            anjay_log(ERROR, "broken socket for server %" PRIu16,
-                      _anjay_server_ssid(ref.server));
-            if (_anjay_schedule_server_reconnect(anjay, ref.server)) {
-                anjay_log(ERROR,
-                          "could not schedule reconnect for server %" PRIu16,
-                          _anjay_server_ssid(ref.server));
-            }
-            return -1;
-        }
-        if (!session_resumed) {
-            if (_anjay_schedule_reregister(anjay, ref.server)) {
-                anjay_log(ERROR,
-                          "could not schedule reregister for server %" PRIu16,
-                          _anjay_server_ssid(ref.server));
-           }
-            return AVS_COAP_CTX_ERR_NETWORK;
-        }
-    }
-    return 0;
-}
-
 static bool confirmable_required(const avs_time_real_t now,
                                  const anjay_observe_entry_t *entry) {
     return !avs_time_duration_less(
@@ -649,24 +1007,103 @@ static bool confirmable_required(const avs_time_real_t now,
 }
 
 static anjay_observe_resource_value_t *
-detach_first_unsent_value(anjay_observe_connection_entry_t *conn_state) {
-    assert(conn_state->unsent);
-    anjay_observe_entry_t *entry = conn_state->unsent->ref;
-    if (entry->last_unsent == conn_state->unsent) {
+detach_first_unsent_value(anjay_observe_connection_entry_t *conn_state,
+                          anjay_observe_lane_t *lane) {
+    assert(lane->unsent);
+    anjay_observe_entry_t *entry = lane->unsent->ref;
+    if (entry->last_unsent == lane->unsent) {
         entry->last_unsent = NULL;
     }
-    anjay_observe_resource_value_t *result =
-            AVS_LIST_DETACH(&conn_state->unsent);
-    if (conn_state->unsent_last == result) {
-        assert(!conn_state->unsent);
-        conn_state->unsent_last = NULL;
+    anjay_observe_resource_value_t *result = AVS_LIST_DETACH(&lane->unsent);
+    if (lane->unsent_last == result) {
+        assert(!lane->unsent);
+        lane->unsent_last = NULL;
     }
+    conn_state->unsent_size -= value_size(result);
+    lane->unsent_head_restored = false;
     return result;
 }
 
-static void value_sent(anjay_observe_connection_entry_t *conn_state) {
+static bool token_equal(const avs_coap_token_t *left,
+                        const avs_coap_token_t *right) {
+    return left->size == right->size
+           && !memcmp(left->bytes, right->bytes, left->size);
+}
+
+/**
+ * Makes sure that the oldest unsent value of @p lane is the first element of
+ * its unsent list, reading it back from the spill file if necessary. Values of
+ * entries that have been cleared in the meantime, and non-error values
+ * superseded by a newer one, are skipped.
+ */
+static void restore_spilled_value(anjay_observe_connection_entry_t *conn_state,
+                                  anjay_observe_lane_t *lane) {
+    while (!lane->unsent_head_restored
+            && _anjay_observe_spill_records(&lane->spill)) {
+        anjay_observe_key_t key;
+        AVS_LIST(anjay_observe_resource_value_t) value =
+                _anjay_observe_spill_read(&lane->spill, &key);
+        if (!value) {
+            // the whole file has been discarded
+            forget_spilled_values(conn_state, lane);
+            return;
+        }
+        AVS_RBTREE_ELEM(anjay_observe_entry_t) entry =
+                AVS_RBTREE_FIND(conn_state->entries,
+                                _anjay_observe_entry_query(&key));
+        if (!entry || !entry->spilled_values
+                || _anjay_observe_lane(conn_state, entry) != lane
+                || !token_equal(&value->identity.token,
+                                &newest_value(entry)->identity.token)) {
+            AVS_LIST_DELETE(&value);
+            continue;
+        }
+        if (entry->superseded_spilled_values) {
+            --entry->superseded_spilled_values;
+            if (!is_error_value(value)) {
+                --entry->spilled_values;
+                AVS_LIST_DELETE(&value);
+                continue;
+            }
+        }
+        value->ref = entry;
+        if (!--entry->spilled_values && entry->last_spilled) {
+            // this is the copy of the newest value kept in memory
+            assert(!entry->last_unsent);
+            AVS_LIST_CLEAR(&entry->last_spilled);
+            entry->last_unsent = value;
+        }
+        AVS_LIST_INSERT(&lane->unsent, value);
+        if (!lane->unsent_last) {
+            lane->unsent_last = value;
+        }
+        conn_state->unsent_size += value_size(value);
+        lane->unsent_head_restored = true;
+    }
+}
+
+static bool has_unsent_values(const anjay_observe_lane_t *lane) {
+    return lane->unsent || _anjay_observe_spill_records(&lane->spill);
+}
+
+/**
+ * @returns The lane of the highest priority that has any unsent values, or
+ *          NULL if there are none.
+ */
+static anjay_observe_lane_t *
+highest_pending_lane(anjay_observe_connection_entry_t *conn) {
+    for (size_t i = AVS_ARRAY_SIZE(conn->lanes); i-- > 0;) {
+        if (has_unsent_values(&conn->lanes[i])) {
+            return &conn->lanes[i];
+        }
+    }
+    return NULL;
+}
+
+static void value_sent(anjay_observe_connection_entry_t *conn_state,
+                       anjay_observe_lane_t *lane) {
     anjay_observe_resource_value_t *sent =
-            detach_first_unsent_value(conn_state);
+            detach_first_unsent_value(conn_state, lane);
     anjay_observe_entry_t *entry = sent->ref;
     assert(AVS_LIST_SIZE(entry->last_sent) <= 1);
     AVS_LIST_CLEAR(&entry->last_sent);
@@ -677,20 +1114,21 @@ static int sched_flush_send_queue(anjay_t *anjay,
                                   anjay_observe_connection_entry_t *conn);
 
 static int send_entry(anjay_t *anjay,
-                      anjay_observe_connection_entry_t *conn_state) {
+                      anjay_observe_connection_entry_t *conn_state,
+                      anjay_observe_lane_t *lane) {
     int result;
     anjay_connection_ref_t ref;
     if ((result = get_conn_ref(anjay, &ref,
                                conn_state->key.ssid, conn_state->key.type))
-            || (result = ensure_conn_online(anjay, ref))
+            || (result = _anjay_connection_ensure_online(anjay, ref))
             || (result = _anjay_bind_server_stream(anjay, ref))) {
         return result;
     }
     anjay_server_info_t *server = anjay->current_connection.server;
-    assert(conn_state->unsent);
-    anjay_observe_entry_t *entry = conn_state->unsent->ref;
-    const avs_coap_msg_identity_t *id = &conn_state->unsent->identity;
-    anjay_msg_details_t details = conn_state->unsent->details;
+    assert(lane->unsent);
+    anjay_observe_entry_t *entry = lane->unsent->ref;
+    const avs_coap_msg_identity_t *id = &lane->unsent->identity;
+    anjay_msg_details_t details = lane->unsent->details;
     avs_coap_msg_identity_t notify_id;
 
     avs_time_real_t now = avs_time_real_now();
@@ -702,8 +1140,8 @@ static int send_entry(anjay_t *anjay,
     (void) ((result = _anjay_coap_stream_setup_request(
                     anjay->comm_stream, &details, &id->token))
             || (result = avs_stream_write(anjay->comm_stream,
-                                          conn_state->unsent->value,
-                                          conn_state->unsent->value_length))
+                                          lane->unsent->value,
+                                          lane->unsent->value_length))
             || (result = _anjay_coap_stream_get_request_identity(
                     anjay->comm_stream, &notify_id))
             || (result = avs_stream_finish_message(anjay->comm_stream)));
@@ -714,7 +1152,7 @@ static int send_entry(anjay_t *anjay,
         if (details.msg_type == AVS_COAP_MSG_CONFIRMABLE) {
             entry->last_confirmable = now;
         }
-        value_sent(conn_state);
+        value_sent(conn_state, lane);
         entry->last_sent->identity.msg_id = notify_id.msg_id;
     } else if (result == AVS_COAP_CTX_ERR_NETWORK
             || result == AVS_COAP_CTX_ERR_TIMEOUT) {
@@ -757,15 +1195,23 @@ static observe_server_state_t server_state(anjay_t *anjay, anjay_ssid_t ssid) {
         .notification_storing_enabled = true
     };
 
+    anjay_server_config_cache_t *cache =
+            _anjay_servers_config_cache(anjay, ssid);
     anjay_iid_t server_iid;
-    if (!_anjay_find_server_iid(anjay, ssid, &server_iid)) {
+    if (cache && cache->notification_storing_valid) {
+        result.notification_storing_enabled = cache->notification_storing;
+    } else if (!_anjay_find_server_iid(anjay, ssid, &server_iid)) {
         const anjay_uri_path_t path =
                 MAKE_RESOURCE_PATH(ANJAY_DM_OID_SERVER, server_iid,
                                    ANJAY_DM_RID_SERVER_NOTIFICATION_STORING);
         bool storing;
-        if (!_anjay_dm_res_read_bool(anjay, &path, &storing) && !storing) {
-            // default value is true, use false only if explicitly set
-            result.notification_storing_enabled = false;
+        // default value is true, use false only if explicitly set
+        if (!_anjay_dm_res_read_bool(anjay, &path, &storing)) {
+            result.notification_storing_enabled = storing;
+            if (cache) {
+                cache->notification_storing_valid = true;
+                cache->notification_storing = storing;
+            }
         }
     }
 
@@ -775,25 +1221,26 @@ static observe_server_state_t server_state(anjay_t *anjay, anjay_ssid_t ssid) {
     return result;
 }
 
-static inline bool is_error_value(const anjay_observe_resource_value_t *value) {
-    return avs_coap_msg_code_get_class(value->details.msg_code) >= 4;
-}
-
 static void remove_all_unsent_values(anjay_observe_connection_entry_t *conn) {
-    while (conn->unsent) {
-        AVS_LIST(anjay_observe_resource_value_t) value =
-                detach_first_unsent_value(conn);
-        AVS_LIST_DELETE(&value);
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(conn->lanes); ++i) {
+        while (conn->lanes[i].unsent) {
+            AVS_LIST(anjay_observe_resource_value_t) value =
+                    detach_first_unsent_value(conn, &conn->lanes[i]);
+            AVS_LIST_DELETE(&value);
+        }
+        _anjay_observe_spill_discard(&conn->lanes[i].spill);
     }
+    forget_spilled_values(conn, NULL);
 }
 
 static int handle_send_queue_entry(anjay_t *anjay,
                                    anjay_observe_connection_entry_t *conn_state,
+                                   anjay_observe_lane_t *lane,
                                    observe_server_state_t observe_state) {
-    assert(conn_state->unsent);
+    assert(lane->unsent);
     assert(observe_state.server_active);
-    bool is_error = is_error_value(conn_state->unsent);
-    int result = send_entry(anjay, conn_state);
+    bool is_error = is_error_value(lane->unsent);
+    int result = send_entry(anjay, conn_state, lane);
     if (result > 0) {
         anjay_log(INFO, "Reset received as reply to notification, result == %d",
                   result);
@@ -821,11 +1268,11 @@ static void schedule_all_triggers(anjay_t *anjay,
     observe_key.rid = INT32_MIN;
     AVS_RBTREE_ELEM(anjay_observe_entry_t) entry;
     AVS_RBTREE_FOREACH(entry, conn->entries) {
-        if (!entry->notify_task) {
+        if (!_anjay_observe_timer_armed(&entry->notify_timer)) {
             anjay_dm_internal_res_attrs_t attrs;
             if (get_attrs(anjay, &attrs, &entry->key)
-                    || schedule_trigger(anjay, entry,
-                                        attrs.standard.common.max_period)) {
+                    || schedule_pmax_trigger(anjay, entry,
+                                             &attrs.standard.common)) {
                 anjay_log(ERROR,
                           "Could not schedule automatic notification trigger");
             }
@@ -838,17 +1285,23 @@ static void flush_send_queue(anjay_t *anjay,
                              const observe_server_state_t *observe_state) {
     int result = 0;
     observe_server_state_t observe_state_buf;
+    anjay_observe_lane_t *lane;
 
-    while (result >= 0 && conn && conn->unsent) {
-        anjay_observe_key_t key = conn->unsent->ref->key;
+    while (result >= 0 && conn && (lane = highest_pending_lane(conn))) {
         if (!observe_state) {
-            observe_state_buf = server_state(anjay, key.connection.ssid);
+            observe_state_buf = server_state(anjay, conn->key.ssid);
             observe_state = &observe_state_buf;
             if (!observe_state_buf.server_active) {
                 break;
             }
         }
-        if ((result = handle_send_queue_entry(anjay, conn,
+        restore_spilled_value(conn, lane);
+        if (!lane->unsent) {
+            // only values of already cleared entries were left in the lane
+            continue;
+        }
+        anjay_observe_key_t key = lane->unsent->ref->key;
+        if ((result = handle_send_queue_entry(anjay, conn, lane,
                                               *observe_state)) > 0) {
             _anjay_observe_remove_entry(anjay, &key);
             // the above might've deleted the connection entry,
@@ -857,7 +1310,7 @@ static void flush_send_queue(anjay_t *anjay,
                                    connection_query(&key.connection));
         }
     }
-    if (result >= 0 && conn && !conn->unsent) {
+    if (result >= 0 && conn && !highest_pending_lane(conn)) {
         schedule_all_triggers(anjay, conn);
     }
 }
@@ -908,9 +1361,10 @@ update_notification_value(anjay_t *anjay,
         return 0;
     }
 
-    const anjay_dm_object_def_t *const *obj =
-            _anjay_dm_find_object_by_oid(anjay, entry->key.oid);
-    if (!obj) {
+    // composite entries only use the Server-level attributes
+    const anjay_dm_object_def_t *const *obj = NULL;
+    if (!entry->composite_paths
+            && !(obj = _anjay_dm_find_object_by_oid(anjay, entry->key.oid))) {
         return ANJAY_ERR_NOT_FOUND;
     }
 
@@ -944,20 +1398,19 @@ update_notification_value(anjay_t *anjay,
     if (pmax_expired || should_update(newest_value(entry), &attrs.standard,
                                       &observe_details, numeric,
                                       buf, (size_t) size)) {
-        result = insert_new_value(conn_state, entry, &observe_details,
+        result = insert_new_value(anjay, conn_state, entry, &observe_details,
                                   &newest_value(entry)->identity, numeric,
                                   buf, (size_t) size);
     }
 
-    if (schedule_trigger(anjay, entry, attrs.standard.common.max_period)) {
+    if (schedule_pmax_trigger(anjay, entry, &attrs.standard.common)) {
         anjay_log(ERROR, "Could not schedule automatic notification trigger");
     }
 
     return result;
 }
 
-static void trigger_observe(anjay_t *anjay, void *entry_) {
-    anjay_observe_entry_t *entry = (anjay_observe_entry_t *) entry_;
+static void trigger_observe(anjay_t *anjay, anjay_observe_entry_t *entry) {
     AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) conn =
             AVS_RBTREE_FIND(anjay->observe.connection_entries,
                             connection_query(&entry->key.connection));
@@ -980,6 +1433,11 @@ static void trigger_observe(anjay_t *anjay, void *entry_) {
     }
 }
 
+static void notify_timer_fired(anjay_t *anjay, anjay_observe_timer_t *timer) {
+    trigger_observe(anjay,
+                    AVS_CONTAINER_OF(timer, anjay_observe_entry_t, notify_timer));
+}
+
 static inline int notify_entry(anjay_t *anjay,
                                const anjay_dm_object_def_t *const *obj,
                                anjay_observe_entry_t *entry) {
@@ -989,7 +1447,7 @@ static inline int notify_entry(anjay_t *anjay,
             && attrs.standard.common.min_period > 0) {
         period = attrs.standard.common.min_period;
     }
-    return schedule_trigger(anjay, entry, period);
+    return schedule_trigger(anjay, entry, period, 0);
 }
 
 #ifdef ANJAY_TEST
@@ -1018,6 +1476,37 @@ static int observe_notify_bound(anjay_t *anjay,
     return retval;
 }
 
+/**
+ * Calls <c>notify_entry()</c> on all Observe-Composite entries of
+ * @p connection that observe any path overlapping with the one specified by
+ * @p key.
+ */
+static int observe_notify_composite(anjay_t *anjay,
+                                    anjay_observe_connection_entry_t *connection,
+                                    const anjay_observe_key_t *key) {
+    anjay_uri_path_t changed = MAKE_OBJECT_PATH(key->oid);
+    if (key->rid >= 0) {
+        changed = MAKE_RESOURCE_PATH(key->oid, key->iid,
+                                     (anjay_rid_t) key->rid);
+    } else if (key->iid != ANJAY_IID_INVALID) {
+        changed = MAKE_INSTANCE_PATH(key->oid, key->iid);
+    }
+
+    int retval = 0;
+    AVS_RBTREE_ELEM(anjay_observe_entry_t) it;
+    for (it = first_composite_entry(connection); it;
+            it = AVS_RBTREE_ELEM_NEXT(it)) {
+        AVS_LIST(const anjay_uri_path_t) path;
+        AVS_LIST_FOREACH(path, it->composite_paths) {
+            if (_anjay_uri_path_overlap(path, &changed)) {
+                _anjay_update_ret(&retval, notify_entry(anjay, NULL, it));
+                break;
+            }
+        }
+    }
+    return retval;
+}
+
 static int
 observe_notify_wildcard_impl(anjay_t *anjay,
                              anjay_observe_connection_entry_t *connection,
@@ -1128,6 +1617,12 @@ observe_notify_rid_wildcard(anjay_t *anjay,
  * We also need to notify the OID entries (with wildcard IID and RID), so we do
  * yet another search, with lower bound at (SSID, conn_type, OID, 65535, -1, 0)
  * and the upper bound at (SSID, conn_type, OID, 65535, -1, U16_MAX).
+ *
+ * Observe-Composite entries
+ * -------------------------
+ * These are stored under the reserved OID 65535, so none of the searches above
+ * ever finds them. Instead, the lists of paths of all of them are matched
+ * against the query directly.
  */
 static int observe_notify(anjay_t *anjay,
                           anjay_observe_connection_entry_t *connection,
@@ -1166,6 +1661,8 @@ static int observe_notify(anjay_t *anjay,
     _anjay_update_ret(&retval,
                       observe_notify_bound(anjay, connection, &lower_bound,
                                            &upper_bound, obj));
+    _anjay_update_ret(&retval,
+                      observe_notify_composite(anjay, connection, key));
     return retval;
 }
 
@@ -21,13 +21,27 @@
 #include <avsystem/commons/stream.h>
 #include <avsystem/commons/stream/stream_outbuf.h>
 
+#include <anjay/dm.h>
+
 #include <anjay_modules/observe.h>
 
 #include "../coap/coap_stream.h"
 #include "../servers.h"
 
+#include "timer_wheel.h"
+
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
+/**
+ * Limits of the store of unsent notifications, see the stored_notifications_*
+ * and coalesce_stored_notifications fields of anjay_configuration_t.
+ */
+typedef struct {
+    size_t memory_limit;
+    const char *spill_path;
+    bool coalesce;
+} anjay_observe_store_config_t;
+
 #ifdef WITH_OBSERVE
 
 typedef struct {
@@ -48,9 +62,24 @@ typedef struct anjay_observe_entry_struct anjay_observe_entry_t;
 typedef struct anjay_observe_connection_entry_struct
         anjay_observe_connection_entry_t;
 
+typedef struct {
+    anjay_oid_t oid;
+    anjay_notify_priority_t priority;
+} anjay_observe_object_priority_t;
+
 typedef struct {
     AVS_RBTREE(anjay_observe_connection_entry_t) connection_entries;
+    anjay_observe_timer_wheel_t timers;
     bool confirmable_notifications;
+
+    // Objects with priority other than ANJAY_NOTIFY_PRIORITY_NORMAL
+    AVS_LIST(anjay_observe_object_priority_t) object_priorities;
+
+    // 0 if unlimited
+    size_t store_memory_limit;
+    // owned copy; NULL if values that exceed the limit are dropped
+    char *store_spill_path;
+    bool store_coalesce;
 } anjay_observe_state_t;
 
 typedef struct {
@@ -71,12 +100,26 @@ typedef struct {
     uint16_t format;
 } anjay_observe_key_t;
 
+/**
+ * Object ID used in the keys of Observe-Composite entries. It is reserved by
+ * the LwM2M specification, so it never refers to a registered Object. The IID
+ * of such keys is always ANJAY_IID_INVALID, and the RID tells apart
+ * observations of different lists of paths.
+ */
+#define ANJAY_OBSERVE_COMPOSITE_OID UINT16_MAX
+
 int _anjay_observe_init(anjay_observe_state_t *observe,
-                        bool confirmable_notifications);
+                        anjay_sched_t *sched,
+                        bool confirmable_notifications,
+                        const anjay_observe_store_config_t *store_config);
 
 void _anjay_observe_cleanup(anjay_observe_state_t *observe,
                             anjay_sched_t *sched);
 
+int _anjay_observe_set_priority(anjay_observe_state_t *observe,
+                                anjay_oid_t oid,
+                                anjay_notify_priority_t priority);
+
 int _anjay_observe_put_entry(anjay_t *anjay,
                              const anjay_observe_key_t *key,
                              const anjay_msg_details_t *details,
@@ -88,6 +131,37 @@ int _anjay_observe_put_entry(anjay_t *anjay,
 void _anjay_observe_remove_entry(anjay_t *anjay,
                                  const anjay_observe_key_t *key);
 
+/**
+ * Establishes an Observe-Composite entry for the list of paths @p paths_ptr.
+ * An existing entry for an equal list of paths, on the same connection and
+ * with the same format, is replaced.
+ *
+ * @param inout_key Key with the connection and format fields set; on success,
+ *                  the remaining fields are filled in, so that the key may be
+ *                  passed to _anjay_observe_remove_entry().
+ * @param paths_ptr Observed paths. On success, the list is taken over by the
+ *                  entry and *paths_ptr is set to NULL.
+ *
+ * The remaining arguments have the same meaning as for
+ * _anjay_observe_put_entry().
+ */
+int _anjay_observe_put_composite_entry(anjay_t *anjay,
+                                       anjay_observe_key_t *inout_key,
+                                       AVS_LIST(anjay_uri_path_t) *paths_ptr,
+                                       const anjay_msg_details_t *details,
+                                       const avs_coap_msg_identity_t *identity,
+                                       const void *data,
+                                       size_t size);
+
+/**
+ * Removes the Observe-Composite entry for the list of paths @p paths, on the
+ * connection and with the format given in @p key, if it exists.
+ */
+void _anjay_observe_remove_composite_entry(
+        anjay_t *anjay,
+        const anjay_observe_key_t *key,
+        AVS_LIST(const anjay_uri_path_t) paths);
+
 void _anjay_observe_remove_by_msg_id(anjay_t *anjay,
                                      uint16_t notify_id);
 
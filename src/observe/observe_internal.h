@@ -17,38 +17,84 @@
 #ifndef ANJAY_OBSERVE_INTERNAL_H
 #define ANJAY_OBSERVE_INTERNAL_H
 
+#include "notification_store.h"
 #include "observe_core.h"
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
 struct anjay_observe_entry_struct {
     const anjay_observe_key_t key;
-    anjay_sched_handle_t notify_task;
+    anjay_observe_timer_t notify_timer;
     avs_time_real_t last_confirmable;
 
     // last_sent has ALWAYS EXACTLY one element,
     // but is stored as a list to allow easy moving from unsent
     AVS_LIST(anjay_observe_resource_value_t) last_sent;
 
-    // pointer to some element of the
-    // anjay_observe_connection_entry_t::unsent list
+    // pointer to some element of the anjay_observe_lane_t::unsent list of
+    // the lane for this entry's priority
     // may or may not be the same as
-    // anjay_observe_connection_entry_t::unsent_last
+    // anjay_observe_lane_t::unsent_last
     // (depending on whether the last unsent value in the server refers
     // to this resource+format or not)
     AVS_LIST(anjay_observe_resource_value_t) last_unsent;
+
+    // copy of the newest value, if it has been moved to the spill file;
+    // last_unsent is NULL in that case
+    AVS_LIST(anjay_observe_resource_value_t) last_spilled;
+    // number of values of this entry in the spill file
+    size_t spilled_values;
+    // number of the oldest values counted in spilled_values that have been
+    // superseded by a newer value and are to be dropped when read back
+    size_t superseded_spilled_values;
+
+    // determines the lane used for the values, see _anjay_observe_lane()
+    anjay_notify_priority_t priority;
+
+    // paths observed by an Observe-Composite entry, whose key has
+    // oid == ANJAY_OBSERVE_COMPOSITE_OID; NULL for all other entries
+    AVS_LIST(anjay_uri_path_t) composite_paths;
 };
 
+#define ANJAY_OBSERVE_LANES \
+    (ANJAY_NOTIFY_PRIORITY_HIGH - ANJAY_NOTIFY_PRIORITY_LOW + 1)
+
+/**
+ * Queue of unsent values of a single priority.
+ */
+typedef struct {
+    AVS_LIST(anjay_observe_resource_value_t) unsent;
+    // pointer to the last element of unsent
+    AVS_LIST(anjay_observe_resource_value_t) unsent_last;
+
+    // oldest unsent values that exceeded the memory limit; they precede all
+    // elements of unsent, except for the first one if unsent_head_restored
+    anjay_observe_spill_t spill;
+    // true if the first element of unsent has been read back from the spill
+    // file, so that it cannot be spilled again without reordering
+    bool unsent_head_restored;
+} anjay_observe_lane_t;
+
 struct anjay_observe_connection_entry_struct {
     anjay_connection_key_t key;
     AVS_RBTREE(anjay_observe_entry_t) entries;
     anjay_sched_handle_t flush_task;
 
-    AVS_LIST(anjay_observe_resource_value_t) unsent;
-    // pointer to the last element of unsent
-    AVS_LIST(anjay_observe_resource_value_t) unsent_last;
+    // indexed by priority - ANJAY_NOTIFY_PRIORITY_LOW; lanes of higher
+    // priority are drained first
+    anjay_observe_lane_t lanes[ANJAY_OBSERVE_LANES];
+    // total size of the values on the unsent lists of all lanes
+    size_t unsent_size;
 };
 
+static inline anjay_observe_lane_t *
+_anjay_observe_lane(anjay_observe_connection_entry_t *conn,
+                    const anjay_observe_entry_t *entry) {
+    assert(entry->priority >= ANJAY_NOTIFY_PRIORITY_LOW
+           && entry->priority <= ANJAY_NOTIFY_PRIORITY_HIGH);
+    return &conn->lanes[entry->priority - ANJAY_NOTIFY_PRIORITY_LOW];
+}
+
 static inline const anjay_observe_entry_t *
 _anjay_observe_entry_query(const anjay_observe_key_t *key) {
     return AVS_CONTAINER_OF(key, anjay_observe_entry_t, key);
@@ -62,6 +62,10 @@ NON_NUMERIC(int, observe_objlnk, anjay_ret_objlnk, anjay_oid_t, anjay_iid_t)
 NON_NUMERIC(anjay_output_ctx_t *, observe_array_start, anjay_ret_array_start)
 NON_NUMERIC(anjay_output_ctx_t *, observe_object_start,
             _anjay_output_object_start)
+NON_NUMERIC(int, observe_i64_array, anjay_ret_i64_array,
+            const int64_t *, size_t)
+NON_NUMERIC(int, observe_double_array, anjay_ret_double_array,
+            const double *, size_t)
 
 #define NUMERIC(Typeid, Type) \
 static int observe_##Typeid (anjay_output_ctx_t *ctx_, Type value) { \
@@ -106,7 +110,9 @@ static const anjay_output_ctx_vtable_t OBSERVE_OUT_VTABLE = {
     .array_start = observe_array_start,
     .object_start = observe_object_start,
     .set_id = observe_set_id,
-    .close = observe_close
+    .close = observe_close,
+    .i64_array = observe_i64_array,
+    .f64_array = observe_double_array
 };
 
 anjay_output_ctx_t *_anjay_observe_decorate_ctx(anjay_output_ctx_t *backend,
@@ -19,11 +19,15 @@
 #include <errno.h>
 #include <math.h>
 #include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 #include <avsystem/commons/unit/test.h>
 
 #include <anjay_test/dm.h>
 #include <anjay_test/mock_clock.h>
+#include <anjay_test/utils.h>
 
 #include "../../anjay_core.h"
 #include "../../sched_internal.h"
@@ -460,7 +464,7 @@ static void notify_max_period_test(const char *con_notify_ack,
                        .format = ANJAY_COAP_FORMAT_PLAINTEXT,
                        .observe_serial = true
                    }, "Hello", 5);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
     AVS_UNIT_ASSERT_EQUAL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->last_sent->timestamp.since_real_epoch.seconds,
                           1010);
     AVS_UNIT_ASSERT_EQUAL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->last_confirmable.since_real_epoch.seconds,
@@ -470,7 +474,6 @@ static void notify_max_period_test(const char *con_notify_ack,
     _anjay_mock_clock_advance(avs_time_duration_diff(
             avs_time_duration_from_scalar(1, AVS_TIME_DAY),
             avs_time_duration_from_scalar(10, AVS_TIME_S)));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "Hi!"));
     static const char CON_NOTIFY_RESPONSE[] =
@@ -552,12 +555,11 @@ AVS_UNIT_TEST(notify, min_period) {
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "Hi!"));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     DM_TEST_FINISH;
 }
@@ -651,24 +653,22 @@ AVS_UNIT_TEST(notify, extremes) {
                                     sizeof(NOTIFY_RESPONSE) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// EVEN LESS //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 14.7));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// IN BETWEEN //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 695));
     static const char NOTIFY_RESPONSE2[] =
@@ -680,24 +680,22 @@ AVS_UNIT_TEST(notify, extremes) {
                                     sizeof(NOTIFY_RESPONSE2) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// EQUAL - STILL NOT CROSSING //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 69));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// GREATER //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 1024));
     static const char NOTIFY_RESPONSE3[] =
@@ -709,24 +707,22 @@ AVS_UNIT_TEST(notify, extremes) {
                                     sizeof(NOTIFY_RESPONSE3) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// STILL GREATER //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 999));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// LESS AGAIN //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, -69.75));
     static const char NOTIFY_RESPONSE4[] =
@@ -738,7 +734,7 @@ AVS_UNIT_TEST(notify, extremes) {
                                     sizeof(NOTIFY_RESPONSE4) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     DM_TEST_FINISH;
 }
@@ -780,13 +776,12 @@ AVS_UNIT_TEST(notify, greater_only) {
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 9001));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// LESS //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 42));
     static const char NOTIFY_RESPONSE[] =
@@ -798,13 +793,12 @@ AVS_UNIT_TEST(notify, greater_only) {
                                     sizeof(NOTIFY_RESPONSE) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// GREATER AGAIN //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 77));
     static const char NOTIFY_RESPONSE2[] =
@@ -816,7 +810,7 @@ AVS_UNIT_TEST(notify, greater_only) {
                                     sizeof(NOTIFY_RESPONSE2) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     DM_TEST_FINISH;
 }
@@ -865,24 +859,22 @@ AVS_UNIT_TEST(notify, less_only) {
                                     sizeof(NOTIFY_RESPONSE) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// STILL LESS //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 514));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// GREATER //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 9001));
     static const char NOTIFY_RESPONSE2[] =
@@ -894,13 +886,12 @@ AVS_UNIT_TEST(notify, less_only) {
                                     sizeof(NOTIFY_RESPONSE2) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// LESS AGAIN //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 69));
     static const char NOTIFY_RESPONSE3[] =
@@ -912,7 +903,7 @@ AVS_UNIT_TEST(notify, less_only) {
                                     sizeof(NOTIFY_RESPONSE3) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     DM_TEST_FINISH;
 }
@@ -954,13 +945,12 @@ AVS_UNIT_TEST(notify, step) {
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 523.5));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// INCREASE BY EXACTLY stp //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 524));
     static const char NOTIFY_RESPONSE0[] =
@@ -972,13 +962,12 @@ AVS_UNIT_TEST(notify, step) {
                                     sizeof(NOTIFY_RESPONSE0) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// INCREASE BY OVER stp //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 540.048));
     static const char NOTIFY_RESPONSE1[] =
@@ -990,13 +979,12 @@ AVS_UNIT_TEST(notify, step) {
                                     sizeof(NOTIFY_RESPONSE1) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// NON-NUMERIC VALUE //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "trololo"));
     static const char NOTIFY_RESPONSE2[] =
@@ -1008,13 +996,12 @@ AVS_UNIT_TEST(notify, step) {
                                     sizeof(NOTIFY_RESPONSE2) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// BACK TO NUMBERS //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 42));
     static const char NOTIFY_RESPONSE3[] =
@@ -1026,24 +1013,22 @@ AVS_UNIT_TEST(notify, step) {
                                     sizeof(NOTIFY_RESPONSE3) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// TOO LITTLE DECREASE //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 32.001));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// DECREASE BY EXACTLY stp //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 31));
     static const char NOTIFY_RESPONSE4[] =
@@ -1055,13 +1040,12 @@ AVS_UNIT_TEST(notify, step) {
                                     sizeof(NOTIFY_RESPONSE4) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// DECREASE BY MORE THAN stp //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 20));
     static const char NOTIFY_RESPONSE5[] =
@@ -1073,13 +1057,12 @@ AVS_UNIT_TEST(notify, step) {
                                     sizeof(NOTIFY_RESPONSE5) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     ////// INCREASE BY EXACTLY stp //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 30));
     static const char NOTIFY_RESPONSE6[] =
@@ -1091,7 +1074,7 @@ AVS_UNIT_TEST(notify, step) {
                                     sizeof(NOTIFY_RESPONSE6) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
     assert_observe_size(anjay, 1);
-    AVS_UNIT_ASSERT_NOT_NULL(AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_task);
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&AVS_RBTREE_FIRST(AVS_RBTREE_FIRST(anjay->observe.connection_entries)->entries)->notify_timer));
 
     DM_TEST_FINISH;
 }
@@ -1165,7 +1148,6 @@ AVS_UNIT_TEST(notify, multiple_formats) {
     avs_unit_mocksock_expect_output(mocksocks[0], N_NOTIFY_RESPONSE,
                                     sizeof(N_NOTIFY_RESPONSE) - 1);
     // plaintext
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "Hello"));
     static const char P_NOTIFY_RESPONSE[] =
@@ -1176,7 +1158,6 @@ AVS_UNIT_TEST(notify, multiple_formats) {
     avs_unit_mocksock_expect_output(mocksocks[0], P_NOTIFY_RESPONSE,
                                     sizeof(P_NOTIFY_RESPONSE) - 1);
     // TLV
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "Hello"));
     static const char T_NOTIFY_RESPONSE[] =
@@ -1192,7 +1173,6 @@ AVS_UNIT_TEST(notify, multiple_formats) {
     ////// NOTIFICATION - FORMAT CHANGE //////
     _anjay_mock_clock_advance(avs_time_duration_from_scalar(10, AVS_TIME_S));
     // no format preference
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4,
                     ANJAY_MOCK_DM_BYTES(0, "\x12\x34\x56\x78"));
@@ -1204,7 +1184,6 @@ AVS_UNIT_TEST(notify, multiple_formats) {
     avs_unit_mocksock_expect_output(mocksocks[0], N_BYTES_RESPONSE,
                                     sizeof(N_BYTES_RESPONSE) - 1);
     // plaintext - error
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4,
                     ANJAY_MOCK_DM_BYTES(0, "\x12\x34\x56\x78"));
@@ -1216,7 +1195,6 @@ AVS_UNIT_TEST(notify, multiple_formats) {
     avs_unit_mocksock_expect_output(mocksocks[0], P_BYTES_RESPONSE,
                                     sizeof(P_BYTES_RESPONSE) - 1);
     // TLV
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     expect_read_res(anjay, &OBJ, 69, 4,
                     ANJAY_MOCK_DM_BYTES(0, "\x12\x34\x56\x78"));
@@ -1260,7 +1238,7 @@ static void test_observe_entry(anjay_t *anjay,
 
 static anjay_t *create_test_env(void) {
     anjay_t *anjay = (anjay_t *) avs_calloc(1, sizeof(anjay_t));
-    _anjay_observe_init(&anjay->observe, false);
+    _anjay_observe_init(&anjay->observe, NULL, false, NULL);
     test_observe_entry(anjay, 1, ANJAY_CONNECTION_UDP, 2, 3, 1);
     test_observe_entry(anjay, 1, ANJAY_CONNECTION_UDP, 2, 3, 2);
     test_observe_entry(anjay, 1, ANJAY_CONNECTION_UDP, 2, 9, 4);
@@ -1388,6 +1366,100 @@ AVS_UNIT_TEST(notify, notify_changed) {
     destroy_test_env(anjay);
 }
 
+static void test_composite_entry(anjay_t *anjay,
+                                 anjay_ssid_t ssid,
+                                 int32_t rid,
+                                 const anjay_uri_path_t *paths,
+                                 size_t path_count) {
+    test_observe_entry(anjay, ssid, ANJAY_CONNECTION_UDP,
+                       ANJAY_OBSERVE_COMPOSITE_OID, ANJAY_IID_INVALID, rid);
+    AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) conn =
+            find_or_create_connection_state(
+                    anjay, &(const anjay_connection_key_t) {
+                        ssid, ANJAY_CONNECTION_UDP
+                    });
+    AVS_UNIT_ASSERT_NOT_NULL(conn);
+    AVS_RBTREE_ELEM(anjay_observe_entry_t) entry = AVS_RBTREE_FIND(
+            conn->entries,
+            _anjay_observe_entry_query(&(const anjay_observe_key_t) {
+                { ssid, ANJAY_CONNECTION_UDP },
+                ANJAY_OBSERVE_COMPOSITE_OID, ANJAY_IID_INVALID, rid,
+                AVS_COAP_FORMAT_NONE
+            }));
+    AVS_UNIT_ASSERT_NOT_NULL(entry);
+    for (size_t i = 0; i < path_count; ++i) {
+        AVS_LIST(anjay_uri_path_t) path =
+                AVS_LIST_NEW_ELEMENT(anjay_uri_path_t);
+        AVS_UNIT_ASSERT_NOT_NULL(path);
+        *path = paths[i];
+        AVS_LIST_APPEND(&entry->composite_paths, path);
+    }
+}
+
+AVS_UNIT_TEST(notify, composite) {
+    anjay_t *anjay = create_test_env();
+    const anjay_uri_path_t paths[] = {
+        MAKE_RESOURCE_PATH(2, 3, 1),
+        MAKE_OBJECT_PATH(5)
+    };
+    test_composite_entry(anjay, 1, 0, paths, AVS_ARRAY_SIZE(paths));
+    test_composite_entry(anjay, 1, 2, &MAKE_INSTANCE_PATH(2, 9), 1);
+
+    AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) conn =
+            find_or_create_connection_state(
+                    anjay, &(const anjay_connection_key_t) {
+                        1, ANJAY_CONNECTION_UDP
+                    });
+    AVS_UNIT_ASSERT_EQUAL(unused_composite_rid(conn), 1);
+
+    AVS_UNIT_MOCK(_anjay_dm_find_object_by_oid) = fake_object;
+    AVS_UNIT_MOCK(notify_entry) = mock_notify_entry;
+
+    // a single composite notification for any of the listed paths
+    expect_notify_entry(1, ANJAY_OBSERVE_COMPOSITE_OID, ANJAY_IID_INVALID, 0,
+                        AVS_COAP_FORMAT_NONE, 0);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_notify(anjay,
+            &(const anjay_observe_key_t) {
+                { 1, ANJAY_CONNECTION_UNSET },
+                5, 7, 1, AVS_COAP_FORMAT_NONE
+            }, false));
+    expect_notify_clear();
+
+    expect_notify_entry(1, 2, 3, 1, AVS_COAP_FORMAT_NONE, 0);
+    expect_notify_entry(1, ANJAY_OBSERVE_COMPOSITE_OID, ANJAY_IID_INVALID, 0,
+                        AVS_COAP_FORMAT_NONE, 0);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_notify(anjay,
+            &(const anjay_observe_key_t) {
+                { 1, ANJAY_CONNECTION_UNSET },
+                2, 3, 1, AVS_COAP_FORMAT_NONE
+            }, false));
+    expect_notify_clear();
+
+    // a change of the whole object affects both composite entries
+    expect_notify_entry(1, 2, 3, 1, AVS_COAP_FORMAT_NONE, 0);
+    expect_notify_entry(1, 2, 3, 2, AVS_COAP_FORMAT_NONE, 0);
+    expect_notify_entry(1, 2, 9, 4, AVS_COAP_FORMAT_NONE, 0);
+    expect_notify_entry(1, ANJAY_OBSERVE_COMPOSITE_OID, ANJAY_IID_INVALID, 0,
+                        AVS_COAP_FORMAT_NONE, 0);
+    expect_notify_entry(1, ANJAY_OBSERVE_COMPOSITE_OID, ANJAY_IID_INVALID, 2,
+                        AVS_COAP_FORMAT_NONE, 0);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_notify(anjay,
+            &(const anjay_observe_key_t) {
+                { 1, ANJAY_CONNECTION_UNSET },
+                2, ANJAY_IID_INVALID, -1, AVS_COAP_FORMAT_NONE
+            }, false));
+    expect_notify_clear();
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_notify(anjay,
+            &(const anjay_observe_key_t) {
+                { 1, ANJAY_CONNECTION_UNSET },
+                2, 3, 7, AVS_COAP_FORMAT_NONE
+            }, false));
+    expect_notify_clear();
+
+    destroy_test_env(anjay);
+}
+
 AVS_UNIT_TEST(notify, storing_when_inactive) {
     SUCCESS_TEST(14, 34);
 
@@ -1437,14 +1509,12 @@ AVS_UNIT_TEST(notify, storing_when_inactive) {
 
     _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
 
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
     _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 69, 1);
     _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 69, 4, 1);
     _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, 0,
                                         ANJAY_MOCK_DM_STRING(0, "Miku"));
 
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 34, true);
     DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
     _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 69, 1);
     _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 69, 4, 1);
@@ -1469,7 +1539,6 @@ AVS_UNIT_TEST(notify, storing_when_inactive) {
     _anjay_observe_sched_flush_current_connection(anjay);
     memset(&anjay->current_connection, 0, sizeof(anjay->current_connection));
 
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     static const char NOTIFY_RESPONSE3[] =
             "\x50\x45\x69\xEF" // CoAP header
             "\x63\xF5\x00\x00" // Observe option
@@ -1533,8 +1602,6 @@ AVS_UNIT_TEST(notify, no_storing_when_disabled) {
 
     _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
 
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, false);
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 34, false);
     DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
     _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 69, 1);
     _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 69, 4, 1);
@@ -1593,7 +1660,6 @@ AVS_UNIT_TEST(notify, storing_on_send_error) {
 
     _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
 
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
     _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 69, 1);
     _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 69, 4, 1);
@@ -1621,7 +1687,6 @@ AVS_UNIT_TEST(notify, storing_on_send_error) {
     AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
 
     // now the notifications shall arrive
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     static const char NOTIFY_RESPONSE[] =
             "\x50\x45\x69\xEF" // CoAP header
             "\x63\xF5\x00\x00" // Observe option
@@ -1663,8 +1728,11 @@ AVS_UNIT_TEST(notify, no_storing_on_send_error) {
     avs_unit_mocksock_expect_errno(mocksocks[0], EMSGSIZE);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
 
-    // second notification
+    // second notification; Server object change invalidates cached settings
     DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(
+            anjay, ANJAY_DM_OID_SERVER, 14,
+            ANJAY_DM_RID_SERVER_NOTIFICATION_STORING));
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
 
@@ -1732,7 +1800,6 @@ AVS_UNIT_TEST(notify, storing_of_errors) {
     _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
 
     // sending is now scheduled, should receive the previous error
-    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
     static const char CON_NOTIFY_RESPONSE[] =
             "\x40\xA0\x69\xEE"; // CoAP header only - no Observe option
     avs_unit_mocksock_expect_output(mocksocks[0], CON_NOTIFY_RESPONSE,
@@ -1802,3 +1869,324 @@ AVS_UNIT_TEST(notify, reconnect) {
 
     DM_TEST_FINISH;
 }
+
+#define STORE_TEST_SPILL_TEMPLATE "anjay_observe_store_test.XXXXXX"
+#define STORE_TEST_VALUE_SIZE \
+    (offsetof(anjay_observe_resource_value_t, value) + 4)
+
+/**
+ * Creates a unique file in the temporary directory, whose name is then used as
+ * the spill path prefix, so that concurrent test runs do not share spill
+ * files.
+ */
+static char *store_test_spill_path_create(void) {
+    const char *tmpdir = getenv("TMPDIR");
+    if (!tmpdir || !*tmpdir) {
+        tmpdir = "/tmp";
+    }
+    size_t size = strlen(tmpdir) + sizeof("/" STORE_TEST_SPILL_TEMPLATE);
+    char *path = (char *) avs_malloc(size);
+    AVS_UNIT_ASSERT_NOT_NULL(path);
+    AVS_UNIT_ASSERT_TRUE(avs_simple_snprintf(
+            path, size, "%s/" STORE_TEST_SPILL_TEMPLATE, tmpdir) >= 0);
+    int fd = mkstemp(path);
+    AVS_UNIT_ASSERT_TRUE(fd >= 0);
+    close(fd);
+    return path;
+}
+
+static void store_test_spill_path_delete(char **path) {
+    if (*path) {
+        (void) remove(*path);
+        avs_free(*path);
+        *path = NULL;
+    }
+}
+
+#define SCOPED_STORE_TEST_SPILL_PATH(Name)                  \
+    SCOPED_PTR(char, store_test_spill_path_delete) Name =   \
+            store_test_spill_path_create();
+
+static anjay_t *create_store_test_env(size_t limit_values,
+                                      const char *spill_path,
+                                      bool coalesce) {
+    anjay_t *anjay = (anjay_t *) avs_calloc(1, sizeof(anjay_t));
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_init(
+            &anjay->observe, NULL, false,
+            &(const anjay_observe_store_config_t) {
+                .memory_limit = limit_values * STORE_TEST_VALUE_SIZE,
+                .spill_path = spill_path,
+                .coalesce = coalesce
+            }));
+    test_observe_entry(anjay, 1, ANJAY_CONNECTION_UDP, 2, 3, 1);
+    test_observe_entry(anjay, 1, ANJAY_CONNECTION_UDP, 2, 3, 2);
+    return anjay;
+}
+
+static anjay_observe_connection_entry_t *store_test_conn(anjay_t *anjay) {
+    anjay_observe_connection_entry_t *conn =
+            AVS_RBTREE_FIND(anjay->observe.connection_entries,
+                            connection_query(&(const anjay_connection_key_t) {
+                                1, ANJAY_CONNECTION_UDP
+                            }));
+    AVS_UNIT_ASSERT_NOT_NULL(conn);
+    return conn;
+}
+
+static anjay_observe_entry_t *store_test_entry(anjay_t *anjay, int32_t rid) {
+    anjay_observe_entry_t *entry =
+            AVS_RBTREE_FIND(store_test_conn(anjay)->entries,
+                            _anjay_observe_entry_query(
+                                    &(const anjay_observe_key_t) {
+                                        { 1, ANJAY_CONNECTION_UDP },
+                                        2, 3, rid, AVS_COAP_FORMAT_NONE
+                                    }));
+    AVS_UNIT_ASSERT_NOT_NULL(entry);
+    return entry;
+}
+
+static void store_value(anjay_t *anjay, int32_t rid, const char *value) {
+    static const anjay_msg_details_t DETAILS = {
+        .msg_type = AVS_COAP_MSG_NON_CONFIRMABLE,
+        .msg_code = AVS_COAP_CODE_CONTENT,
+        .format = AVS_COAP_FORMAT_NONE
+    };
+    AVS_UNIT_ASSERT_EQUAL(strlen(value), 4);
+    AVS_UNIT_ASSERT_SUCCESS(insert_new_value(
+            anjay, store_test_conn(anjay), store_test_entry(anjay, rid),
+            &DETAILS, &NULL_IDENTITY, NAN, value, strlen(value)));
+}
+
+static void assert_next_stored(anjay_t *anjay,
+                               int32_t rid,
+                               const char *value) {
+    anjay_observe_connection_entry_t *conn = store_test_conn(anjay);
+    anjay_observe_lane_t *lane;
+    while ((lane = highest_pending_lane(conn))) {
+        restore_spilled_value(conn, lane);
+        if (lane->unsent) {
+            break;
+        }
+    }
+    AVS_UNIT_ASSERT_NOT_NULL(lane);
+    AVS_UNIT_ASSERT_TRUE(lane->unsent->ref == store_test_entry(anjay, rid));
+    AVS_UNIT_ASSERT_EQUAL(lane->unsent->value_length, strlen(value));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(lane->unsent->value, value,
+                                      strlen(value));
+    value_sent(conn, lane);
+}
+
+static anjay_observe_lane_t *
+store_test_lane(anjay_observe_connection_entry_t *conn,
+                anjay_notify_priority_t priority) {
+    return &conn->lanes[priority - ANJAY_NOTIFY_PRIORITY_LOW];
+}
+
+AVS_UNIT_TEST(notification_store, spill_in_order) {
+    SCOPED_STORE_TEST_SPILL_PATH(spill_path);
+    anjay_t *anjay = create_store_test_env(2, spill_path, false);
+    anjay_observe_connection_entry_t *conn = store_test_conn(anjay);
+
+    store_value(anjay, 1, "a001");
+    store_value(anjay, 2, "b001");
+    store_value(anjay, 1, "a002");
+    store_value(anjay, 2, "b002");
+    store_value(anjay, 1, "a003");
+    AVS_UNIT_ASSERT_EQUAL(_anjay_observe_spill_records(
+            &store_test_lane(conn, ANJAY_NOTIFY_PRIORITY_NORMAL)->spill), 3);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(
+            store_test_lane(conn, ANJAY_NOTIFY_PRIORITY_NORMAL)->unsent), 2);
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent_size, 2 * STORE_TEST_VALUE_SIZE);
+
+    assert_next_stored(anjay, 1, "a001");
+    assert_next_stored(anjay, 2, "b001");
+    // values stored in the meantime go after everything spilled earlier
+    store_value(anjay, 2, "b003");
+    assert_next_stored(anjay, 1, "a002");
+    assert_next_stored(anjay, 2, "b002");
+    // the spill file is removed as soon as it is drained
+    AVS_UNIT_ASSERT_NULL(
+            store_test_lane(conn, ANJAY_NOTIFY_PRIORITY_NORMAL)->spill.path);
+    assert_next_stored(anjay, 1, "a003");
+    assert_next_stored(anjay, 2, "b003");
+    AVS_UNIT_ASSERT_NULL(highest_pending_lane(conn));
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent_size, 0);
+
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(notification_store, newest_value_kept_in_memory) {
+    SCOPED_STORE_TEST_SPILL_PATH(spill_path);
+    anjay_t *anjay = create_store_test_env(1, spill_path, false);
+    anjay_observe_entry_t *entry = store_test_entry(anjay, 1);
+
+    store_value(anjay, 1, "a001");
+    store_value(anjay, 2, "b001");
+    AVS_UNIT_ASSERT_NULL(entry->last_unsent);
+    AVS_UNIT_ASSERT_NOT_NULL(entry->last_spilled);
+    AVS_UNIT_ASSERT_TRUE(newest_value(entry) == entry->last_spilled);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(newest_value(entry)->value, "a001", 4);
+
+    assert_next_stored(anjay, 1, "a001");
+    AVS_UNIT_ASSERT_NULL(entry->last_spilled);
+    AVS_UNIT_ASSERT_EQUAL(entry->spilled_values, 0);
+    assert_next_stored(anjay, 2, "b001");
+
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(notification_store, cleared_entry_skipped) {
+    SCOPED_STORE_TEST_SPILL_PATH(spill_path);
+    anjay_t *anjay = create_store_test_env(1, spill_path, false);
+    anjay_observe_connection_entry_t *conn = store_test_conn(anjay);
+
+    store_value(anjay, 1, "a001");
+    store_value(anjay, 2, "b001");
+    store_value(anjay, 2, "b002");
+    AVS_UNIT_ASSERT_EQUAL(_anjay_observe_spill_records(
+            &store_test_lane(conn, ANJAY_NOTIFY_PRIORITY_NORMAL)->spill), 2);
+    clear_entry(anjay, conn, store_test_entry(anjay, 1));
+
+    assert_next_stored(anjay, 2, "b001");
+    assert_next_stored(anjay, 2, "b002");
+    AVS_UNIT_ASSERT_NULL(highest_pending_lane(conn));
+
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(notification_store, drop_without_spill_path) {
+    anjay_t *anjay = create_store_test_env(1, NULL, false);
+    anjay_observe_connection_entry_t *conn = store_test_conn(anjay);
+
+    store_value(anjay, 1, "a001");
+    store_value(anjay, 2, "b001");
+    AVS_UNIT_ASSERT_NULL(store_test_entry(anjay, 1)->last_unsent);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_observe_spill_records(
+            &store_test_lane(conn, ANJAY_NOTIFY_PRIORITY_NORMAL)->spill), 0);
+
+    assert_next_stored(anjay, 2, "b001");
+    AVS_UNIT_ASSERT_NULL(highest_pending_lane(conn));
+
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(notification_store, coalesce) {
+    anjay_t *anjay = create_store_test_env(0, NULL, true);
+    anjay_observe_connection_entry_t *conn = store_test_conn(anjay);
+
+    store_value(anjay, 1, "a001");
+    store_value(anjay, 2, "b001");
+    store_value(anjay, 1, "a002");
+    store_value(anjay, 1, "a003");
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(
+            store_test_lane(conn, ANJAY_NOTIFY_PRIORITY_NORMAL)->unsent), 2);
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent_size, 2 * STORE_TEST_VALUE_SIZE);
+
+    assert_next_stored(anjay, 2, "b001");
+    assert_next_stored(anjay, 1, "a003");
+    AVS_UNIT_ASSERT_NULL(highest_pending_lane(conn));
+
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(notification_store, coalesce_spilled) {
+    SCOPED_STORE_TEST_SPILL_PATH(spill_path);
+    anjay_t *anjay = create_store_test_env(1, spill_path, true);
+    anjay_observe_connection_entry_t *conn = store_test_conn(anjay);
+
+    store_value(anjay, 1, "a001");
+    store_value(anjay, 2, "b001");
+    store_value(anjay, 1, "a002");
+    store_value(anjay, 1, "a003");
+    AVS_UNIT_ASSERT_EQUAL(_anjay_observe_spill_records(
+            &store_test_lane(conn, ANJAY_NOTIFY_PRIORITY_NORMAL)->spill), 2);
+    AVS_UNIT_ASSERT_EQUAL(
+            store_test_entry(anjay, 1)->superseded_spilled_values, 1);
+
+    // a001 is still in the spill file, but it is not sent
+    assert_next_stored(anjay, 2, "b001");
+    AVS_UNIT_ASSERT_EQUAL(store_test_entry(anjay, 1)->spilled_values, 0);
+    AVS_UNIT_ASSERT_EQUAL(
+            store_test_entry(anjay, 1)->superseded_spilled_values, 0);
+    assert_next_stored(anjay, 1, "a003");
+    AVS_UNIT_ASSERT_NULL(highest_pending_lane(conn));
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent_size, 0);
+
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(notification_store, high_priority_overtakes) {
+    anjay_t *anjay = create_store_test_env(0, NULL, false);
+    store_test_entry(anjay, 2)->priority = ANJAY_NOTIFY_PRIORITY_HIGH;
+
+    store_value(anjay, 1, "a001");
+    store_value(anjay, 1, "a002");
+    store_value(anjay, 2, "b001");
+    store_value(anjay, 1, "a003");
+    store_value(anjay, 2, "b002");
+
+    assert_next_stored(anjay, 2, "b001");
+    assert_next_stored(anjay, 2, "b002");
+    assert_next_stored(anjay, 1, "a001");
+    assert_next_stored(anjay, 1, "a002");
+    assert_next_stored(anjay, 1, "a003");
+    AVS_UNIT_ASSERT_NULL(highest_pending_lane(store_test_conn(anjay)));
+
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(notification_store, low_priority_spilled_first) {
+    SCOPED_STORE_TEST_SPILL_PATH(spill_path);
+    anjay_t *anjay = create_store_test_env(2, spill_path, false);
+    anjay_observe_connection_entry_t *conn = store_test_conn(anjay);
+    store_test_entry(anjay, 2)->priority = ANJAY_NOTIFY_PRIORITY_HIGH;
+
+    store_value(anjay, 1, "a001");
+    store_value(anjay, 2, "b001");
+    store_value(anjay, 1, "a002");
+    store_value(anjay, 2, "b002");
+    AVS_UNIT_ASSERT_EQUAL(_anjay_observe_spill_records(
+            &store_test_lane(conn, ANJAY_NOTIFY_PRIORITY_NORMAL)->spill), 2);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_observe_spill_records(
+            &store_test_lane(conn, ANJAY_NOTIFY_PRIORITY_HIGH)->spill), 0);
+
+    assert_next_stored(anjay, 2, "b001");
+    assert_next_stored(anjay, 2, "b002");
+    assert_next_stored(anjay, 1, "a001");
+    assert_next_stored(anjay, 1, "a002");
+    AVS_UNIT_ASSERT_NULL(highest_pending_lane(conn));
+
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(notification_store, object_priorities) {
+    anjay_t *anjay = create_store_test_env(0, NULL, false);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_set_priority(
+            &anjay->observe, 5, ANJAY_NOTIFY_PRIORITY_HIGH));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_set_priority(
+            &anjay->observe, 7, ANJAY_NOTIFY_PRIORITY_LOW));
+    AVS_UNIT_ASSERT_EQUAL(object_priority(&anjay->observe, 5),
+                          ANJAY_NOTIFY_PRIORITY_HIGH);
+    AVS_UNIT_ASSERT_EQUAL(object_priority(&anjay->observe, 6),
+                          ANJAY_NOTIFY_PRIORITY_NORMAL);
+    AVS_UNIT_ASSERT_EQUAL(object_priority(&anjay->observe, 7),
+                          ANJAY_NOTIFY_PRIORITY_LOW);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_set_priority(
+            &anjay->observe, 5, ANJAY_NOTIFY_PRIORITY_LOW));
+    AVS_UNIT_ASSERT_EQUAL(object_priority(&anjay->observe, 5),
+                          ANJAY_NOTIFY_PRIORITY_LOW);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_set_priority(
+            &anjay->observe, 5, ANJAY_NOTIFY_PRIORITY_NORMAL));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_set_priority(
+            &anjay->observe, 7, ANJAY_NOTIFY_PRIORITY_NORMAL));
+    AVS_UNIT_ASSERT_NULL(anjay->observe.object_priorities);
+
+    destroy_test_env(anjay);
+}
+
+#undef STORE_TEST_VALUE_SIZE
+#undef SCOPED_STORE_TEST_SPILL_PATH
+#undef STORE_TEST_SPILL_TEMPLATE
@@ -0,0 +1,307 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#ifdef ANJAY_TEST_BENCHMARKS
+#include <stdio.h>
+#include <time.h>
+#endif // ANJAY_TEST_BENCHMARKS
+
+#include <avsystem/commons/unit/test.h>
+
+#include <anjay_test/mock_clock.h>
+
+typedef struct {
+    anjay_observe_timer_wheel_t *wheel;
+    anjay_observe_timer_t timer;
+    char id;
+    int fired;
+    // if positive, the timer re-arms itself with this period after firing
+    int32_t period_s;
+} test_timer_t;
+
+typedef struct {
+    anjay_sched_t *sched;
+    anjay_observe_timer_wheel_t wheel;
+    char order[16];
+    size_t order_length;
+} wheel_test_env_t;
+
+static wheel_test_env_t *current_env;
+
+static avs_time_monotonic_t after_s(int64_t seconds) {
+    return avs_time_monotonic_add(
+            avs_time_monotonic_now(),
+            avs_time_duration_from_scalar(seconds, AVS_TIME_S));
+}
+
+static void test_timer_fired(anjay_t *anjay, anjay_observe_timer_t *timer) {
+    (void) anjay;
+    test_timer_t *test_timer = AVS_CONTAINER_OF(timer, test_timer_t, timer);
+    ++test_timer->fired;
+    if (current_env->order_length < sizeof(current_env->order) - 1) {
+        current_env->order[current_env->order_length++] = test_timer->id;
+    }
+    if (test_timer->period_s > 0) {
+        avs_time_monotonic_t deadline = after_s(test_timer->period_s);
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_timer_arm(
+                test_timer->wheel, timer, deadline, deadline));
+    }
+}
+
+static void setup_wheel_test(wheel_test_env_t *env) {
+    memset(env, 0, sizeof(*env));
+    _anjay_mock_clock_start(avs_time_monotonic_from_scalar(1000, AVS_TIME_S));
+    env->sched = _anjay_sched_new(NULL);
+    AVS_UNIT_ASSERT_NOT_NULL(env->sched);
+    _anjay_observe_timer_wheel_init(&env->wheel, env->sched, test_timer_fired);
+    current_env = env;
+}
+
+static void teardown_wheel_test(wheel_test_env_t *env) {
+    _anjay_observe_timer_wheel_cleanup(&env->wheel);
+    _anjay_sched_delete(&env->sched);
+    _anjay_mock_clock_finish();
+    current_env = NULL;
+}
+
+static void arm_at(wheel_test_env_t *env,
+                   test_timer_t *timer,
+                   int64_t start_s,
+                   int64_t deadline_s) {
+    timer->wheel = &env->wheel;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_timer_arm(
+            &env->wheel, &timer->timer, after_s(start_s),
+            after_s(deadline_s)));
+    AVS_UNIT_ASSERT_TRUE(_anjay_observe_timer_armed(&timer->timer));
+}
+
+static int64_t time_to_next_s(wheel_test_env_t *env) {
+    avs_time_duration_t delay;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sched_time_to_next(env->sched, &delay));
+    return delay.seconds;
+}
+
+static void advance_s(int64_t seconds) {
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(seconds,
+                                                            AVS_TIME_S));
+}
+
+AVS_UNIT_TEST(timer_wheel, fires_in_deadline_order) {
+    wheel_test_env_t env;
+    setup_wheel_test(&env);
+
+    test_timer_t a = { .id = 'A' };
+    test_timer_t b = { .id = 'B' };
+    test_timer_t c = { .id = 'C' };
+    arm_at(&env, &a, 5, 5);
+    arm_at(&env, &b, 2, 2);
+    arm_at(&env, &c, 2, 2);
+    AVS_UNIT_ASSERT_EQUAL(time_to_next_s(&env), 2);
+
+    advance_s(1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_sched_run(env.sched), 0);
+    advance_s(1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_sched_run(env.sched), 1);
+    AVS_UNIT_ASSERT_EQUAL_STRING(env.order, "BC");
+    AVS_UNIT_ASSERT_FALSE(_anjay_observe_timer_armed(&b.timer));
+    AVS_UNIT_ASSERT_EQUAL(time_to_next_s(&env), 3);
+
+    advance_s(3);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_sched_run(env.sched), 1);
+    AVS_UNIT_ASSERT_EQUAL_STRING(env.order, "BCA");
+    AVS_UNIT_ASSERT_FAILED(_anjay_sched_time_to_next(env.sched, NULL));
+
+    teardown_wheel_test(&env);
+}
+
+AVS_UNIT_TEST(timer_wheel, cancel) {
+    wheel_test_env_t env;
+    setup_wheel_test(&env);
+
+    test_timer_t a = { .id = 'A' };
+    test_timer_t b = { .id = 'B' };
+    arm_at(&env, &a, 1, 1);
+    arm_at(&env, &b, 2, 2);
+    _anjay_observe_timer_cancel(&a.timer);
+    AVS_UNIT_ASSERT_FALSE(_anjay_observe_timer_armed(&a.timer));
+    // cancelling twice is harmless
+    _anjay_observe_timer_cancel(&a.timer);
+
+    advance_s(2);
+    _anjay_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(a.fired, 0);
+    AVS_UNIT_ASSERT_EQUAL(b.fired, 1);
+
+    teardown_wheel_test(&env);
+}
+
+AVS_UNIT_TEST(timer_wheel, far_timers_cascade) {
+    wheel_test_env_t env;
+    setup_wheel_test(&env);
+
+    // level 0, level 1 and overflow, respectively
+    test_timer_t a = { .id = 'A' };
+    test_timer_t b = { .id = 'B' };
+    test_timer_t c = { .id = 'C' };
+    arm_at(&env, &c, 100000, 100000);
+    arm_at(&env, &b, 1000, 1000);
+    arm_at(&env, &a, 10, 10);
+
+    AVS_UNIT_ASSERT_EQUAL(time_to_next_s(&env), 10);
+    advance_s(10);
+    _anjay_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(time_to_next_s(&env), 990);
+    advance_s(990);
+    _anjay_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(time_to_next_s(&env), 99000);
+    // oversleeping shall not lose anything
+    advance_s(200000);
+    _anjay_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL_STRING(env.order, "ABC");
+
+    teardown_wheel_test(&env);
+}
+
+AVS_UNIT_TEST(timer_wheel, slack_coalescing) {
+    wheel_test_env_t env;
+    setup_wheel_test(&env);
+
+    test_timer_t a = { .id = 'A' };
+    test_timer_t b = { .id = 'B' };
+    arm_at(&env, &a, 5, 10);
+    arm_at(&env, &b, 8, 8);
+    AVS_UNIT_ASSERT_EQUAL(time_to_next_s(&env), 8);
+
+    // A is within its window when B expires, so they fire together
+    advance_s(8);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_sched_run(env.sched), 1);
+    AVS_UNIT_ASSERT_EQUAL_STRING(env.order, "BA");
+
+    teardown_wheel_test(&env);
+}
+
+AVS_UNIT_TEST(timer_wheel, level1_timer_due_before_later_level0_timer) {
+    wheel_test_env_t env;
+    setup_wheel_test(&env);
+    // move to the beginning of a level 1 block (1024 == 16 * SLOTS), so that
+    // the timer armed 70 s from now lands on level 1
+    advance_s(1024 - 1000);
+
+    test_timer_t x = { .id = 'X' };
+    test_timer_t y = { .id = 'Y', .period_s = 60 };
+    arm_at(&env, &x, 70, 70);
+    arm_at(&env, &y, 30, 30);
+    AVS_UNIT_ASSERT_EQUAL(time_to_next_s(&env), 30);
+
+    advance_s(30);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_sched_run(env.sched), 1);
+    AVS_UNIT_ASSERT_EQUAL_STRING(env.order, "Y");
+    // Y is now due at 90 and sits in a level 0 slot, while X is still on
+    // level 1 and is due earlier
+    AVS_UNIT_ASSERT_EQUAL(time_to_next_s(&env), 40);
+
+    advance_s(40);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_sched_run(env.sched), 1);
+    AVS_UNIT_ASSERT_EQUAL_STRING(env.order, "YX");
+    AVS_UNIT_ASSERT_EQUAL(time_to_next_s(&env), 20);
+
+    _anjay_observe_timer_cancel(&y.timer);
+    teardown_wheel_test(&env);
+}
+
+#ifdef ANJAY_TEST_BENCHMARKS
+// compares the timer wheel with the general scheduler; only compiled in with
+// WITH_TEST_BENCHMARKS, as it takes much longer than the other tests
+#define BENCHMARK_TIMERS 5000
+#define BENCHMARK_PERIOD_S 60
+#define BENCHMARK_DURATION_S 600
+
+static void bump_sched_counter(anjay_t *anjay, void *timer_);
+
+static void sched_rearm(anjay_sched_t *sched, test_timer_t *timer) {
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sched(
+            sched, NULL,
+            avs_time_duration_from_scalar(timer->period_s, AVS_TIME_S),
+            bump_sched_counter, timer));
+}
+
+static void bump_sched_counter(anjay_t *anjay, void *timer_) {
+    (void) anjay;
+    test_timer_t *timer = (test_timer_t *) timer_;
+    ++timer->fired;
+    sched_rearm(current_env->sched, timer);
+}
+
+static double run_benchmark(wheel_test_env_t *env,
+                            test_timer_t *timers,
+                            bool use_wheel) {
+    for (size_t i = 0; i < BENCHMARK_TIMERS; ++i) {
+        timers[i].period_s = BENCHMARK_PERIOD_S;
+        timers[i].fired = 0;
+        // spread the initial expirations over a whole period
+        int64_t first_s = 1 + (int64_t) (i % BENCHMARK_PERIOD_S);
+        if (use_wheel) {
+            arm_at(env, &timers[i], first_s, first_s);
+        } else {
+            AVS_UNIT_ASSERT_SUCCESS(_anjay_sched(
+                    env->sched, NULL,
+                    avs_time_duration_from_scalar(first_s, AVS_TIME_S),
+                    bump_sched_counter, &timers[i]));
+        }
+    }
+
+    clock_t begin = clock();
+    for (int64_t s = 0; s < BENCHMARK_DURATION_S; ++s) {
+        advance_s(1);
+        _anjay_sched_run(env->sched);
+    }
+    double elapsed = (double) (clock() - begin) / CLOCKS_PER_SEC;
+
+    for (size_t i = 0; i < BENCHMARK_TIMERS; ++i) {
+        AVS_UNIT_ASSERT_EQUAL(timers[i].fired,
+                              BENCHMARK_DURATION_S / BENCHMARK_PERIOD_S);
+        _anjay_observe_timer_cancel(&timers[i].timer);
+    }
+    return elapsed;
+}
+
+AVS_UNIT_TEST(timer_wheel, benchmark) {
+    test_timer_t *timers = (test_timer_t *) avs_calloc(BENCHMARK_TIMERS,
+                                                       sizeof(*timers));
+    AVS_UNIT_ASSERT_NOT_NULL(timers);
+
+    wheel_test_env_t env;
+    setup_wheel_test(&env);
+    double wheel_time = run_benchmark(&env, timers, true);
+    teardown_wheel_test(&env);
+
+    memset(timers, 0, BENCHMARK_TIMERS * sizeof(*timers));
+    setup_wheel_test(&env);
+    double sched_time = run_benchmark(&env, timers, false);
+    teardown_wheel_test(&env);
+
+    printf("%d timers, pmax=%ds, %ds simulated: timer wheel %.3fs, "
+           "general scheduler %.3fs\n", BENCHMARK_TIMERS, BENCHMARK_PERIOD_S,
+           BENCHMARK_DURATION_S, wheel_time, sched_time);
+    avs_free(timers);
+}
+
+#undef BENCHMARK_DURATION_S
+#undef BENCHMARK_PERIOD_S
+#undef BENCHMARK_TIMERS
+#endif // ANJAY_TEST_BENCHMARKS
@@ -0,0 +1,371 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <string.h>
+
+#include "../anjay_core.h"
+
+#include "timer_wheel.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#define SLOTS ANJAY_OBSERVE_TIMER_WHEEL_SLOTS
+
+static int64_t tick_of(avs_time_monotonic_t time) {
+    return time.since_monotonic_epoch.seconds;
+}
+
+static int64_t block_of(int64_t tick) {
+    return tick >= 0 ? tick / SLOTS : -((-tick + SLOTS - 1) / SLOTS);
+}
+
+static size_t slot_of(int64_t value) {
+    return (size_t) (((value % SLOTS) + SLOTS) % SLOTS);
+}
+
+static void link_timer(anjay_observe_timer_t **head,
+                       anjay_observe_timer_t *timer) {
+    assert(!timer->pprev);
+    timer->next = *head;
+    if (*head) {
+        (*head)->pprev = &timer->next;
+    }
+    timer->pprev = head;
+    *head = timer;
+}
+
+void _anjay_observe_timer_cancel(anjay_observe_timer_t *timer) {
+    if (!timer->pprev) {
+        return;
+    }
+    *timer->pprev = timer->next;
+    if (timer->next) {
+        timer->next->pprev = timer->pprev;
+    }
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+/**
+ * Timers are bucketed by the start of their windows. Level 0 holds timers
+ * starting within [current_tick, current_tick + SLOTS), one slot per second.
+ * Level 1 holds timers starting in the following SLOTS - 1 blocks of SLOTS
+ * seconds each. Anything later lands on the overflow list.
+ */
+static anjay_observe_timer_t **bucket_for(anjay_observe_timer_wheel_t *wheel,
+                                          int64_t tick) {
+    if (tick < wheel->current_tick) {
+        tick = wheel->current_tick;
+    }
+    if (tick - wheel->current_tick < SLOTS) {
+        return &wheel->level0[slot_of(tick)];
+    }
+    if (block_of(tick) - block_of(wheel->current_tick) < SLOTS) {
+        return &wheel->level1[slot_of(block_of(tick))];
+    }
+    return &wheel->overflow;
+}
+
+static void insert_timer(anjay_observe_timer_wheel_t *wheel,
+                         anjay_observe_timer_t *timer) {
+    link_timer(bucket_for(wheel, tick_of(timer->start)), timer);
+}
+
+static void reinsert_all(anjay_observe_timer_wheel_t *wheel,
+                         anjay_observe_timer_t **head) {
+    anjay_observe_timer_t *timer = *head;
+    *head = NULL;
+    while (timer) {
+        anjay_observe_timer_t *next = timer->next;
+        timer->next = NULL;
+        timer->pprev = NULL;
+        insert_timer(wheel, timer);
+        timer = next;
+    }
+}
+
+static void move_all(anjay_observe_timer_t **head,
+                     anjay_observe_timer_t **out_list) {
+    while (*head) {
+        anjay_observe_timer_t *timer = *head;
+        _anjay_observe_timer_cancel(timer);
+        link_timer(out_list, timer);
+    }
+}
+
+static void move_started(anjay_observe_timer_t **head,
+                         avs_time_monotonic_t now,
+                         anjay_observe_timer_t **out_list) {
+    anjay_observe_timer_t *timer = *head;
+    while (timer) {
+        anjay_observe_timer_t *next = timer->next;
+        if (!avs_time_monotonic_before(now, timer->start)) {
+            _anjay_observe_timer_cancel(timer);
+            link_timer(out_list, timer);
+        }
+        timer = next;
+    }
+}
+
+/**
+ * Moves the wheel forward to @p now_tick. Timers from the level 0 slots that
+ * have been passed have all started and are moved to @p out_started. Level 1
+ * slots (and the overflow list) that come into range are cascaded down.
+ */
+static void advance(anjay_observe_timer_wheel_t *wheel,
+                    int64_t now_tick,
+                    anjay_observe_timer_t **out_started) {
+    if (now_tick <= wheel->current_tick) {
+        return;
+    }
+    int64_t old_tick = wheel->current_tick;
+    int64_t passed = now_tick - old_tick;
+    if (passed > SLOTS) {
+        passed = SLOTS;
+    }
+    for (int64_t i = 0; i < passed; ++i) {
+        move_all(&wheel->level0[slot_of(old_tick + i)], out_started);
+    }
+    wheel->current_tick = now_tick;
+
+    int64_t old_block = block_of(old_tick);
+    int64_t blocks = block_of(now_tick) - old_block;
+    if (blocks > 0) {
+        if (blocks > SLOTS) {
+            blocks = SLOTS;
+        }
+        for (int64_t i = 1; i <= blocks; ++i) {
+            reinsert_all(wheel, &wheel->level1[slot_of(old_block + i)]);
+        }
+        reinsert_all(wheel, &wheel->overflow);
+    }
+}
+
+/**
+ * Returns the @p index -th bucket in the order of window starts, or NULL if
+ * there are no more buckets. @p out_lower_tick is set to the lowest tick that
+ * a timer in that bucket may start at.
+ */
+static anjay_observe_timer_t **nth_bucket(anjay_observe_timer_wheel_t *wheel,
+                                          int64_t index,
+                                          int64_t *out_lower_tick) {
+    if (index < SLOTS) {
+        *out_lower_tick = wheel->current_tick + index;
+        return &wheel->level0[slot_of(*out_lower_tick)];
+    }
+    int64_t block = block_of(wheel->current_tick) + 1 + (index - SLOTS);
+    *out_lower_tick = block * SLOTS;
+    if (index < 2 * SLOTS - 1) {
+        return &wheel->level1[slot_of(block)];
+    } else if (index == 2 * SLOTS - 1) {
+        return &wheel->overflow;
+    }
+    return NULL;
+}
+
+static bool fires_before(const anjay_observe_timer_t *left,
+                         const anjay_observe_timer_t *right) {
+    if (avs_time_monotonic_before(left->deadline, right->deadline)) {
+        return true;
+    } else if (avs_time_monotonic_before(right->deadline, left->deadline)) {
+        return false;
+    }
+    return left->seq < right->seq;
+}
+
+static anjay_observe_timer_t *merge_sort(anjay_observe_timer_t *list) {
+    if (!list || !list->next) {
+        return list;
+    }
+    anjay_observe_timer_t *slow = list;
+    anjay_observe_timer_t *fast = list->next;
+    while (fast && fast->next) {
+        slow = slow->next;
+        fast = fast->next->next;
+    }
+    anjay_observe_timer_t *left = list;
+    anjay_observe_timer_t *right = slow->next;
+    slow->next = NULL;
+    left = merge_sort(left);
+    right = merge_sort(right);
+
+    anjay_observe_timer_t *result = NULL;
+    anjay_observe_timer_t **tail_ptr = &result;
+    while (left && right) {
+        if (fires_before(right, left)) {
+            *tail_ptr = right;
+            right = right->next;
+        } else {
+            *tail_ptr = left;
+            left = left->next;
+        }
+        tail_ptr = &(*tail_ptr)->next;
+    }
+    *tail_ptr = left ? left : right;
+    return result;
+}
+
+static void sort_timers(anjay_observe_timer_t **head) {
+    *head = merge_sort(*head);
+    for (anjay_observe_timer_t **ptr = head; *ptr; ptr = &(*ptr)->next) {
+        (*ptr)->pprev = ptr;
+    }
+}
+
+static void wheel_job(anjay_t *anjay, void *wheel_);
+
+static int schedule_job(anjay_observe_timer_wheel_t *wheel,
+                        avs_time_monotonic_t start,
+                        avs_time_monotonic_t deadline) {
+    avs_time_monotonic_t now = avs_time_monotonic_now();
+    if (avs_time_monotonic_before(start, now)) {
+        start = now;
+    }
+    if (avs_time_monotonic_before(deadline, start)) {
+        deadline = start;
+    }
+    _anjay_sched_del(wheel->sched, &wheel->job);
+    if (_anjay_sched_with_slack(wheel->sched, &wheel->job,
+                                avs_time_monotonic_diff(start, now),
+                                avs_time_monotonic_diff(deadline, start),
+                                wheel_job, wheel)) {
+        anjay_log(ERROR, "could not schedule observation timers");
+        return -1;
+    }
+    wheel->job_start = start;
+    wheel->job_deadline = deadline;
+    return 0;
+}
+
+/**
+ * Schedules the job for the window between the earliest start and the earliest
+ * deadline of all timers. The latter requires scanning all the buckets that may
+ * contain timers starting before that deadline. Note that the first level 1
+ * block may begin before the last level 0 slot, so the level 1 blocks need to
+ * be checked even if the scan of level 0 could otherwise stop early.
+ */
+static void rearm_job(anjay_observe_timer_wheel_t *wheel) {
+    const anjay_observe_timer_t *first = NULL;
+    avs_time_monotonic_t start = avs_time_monotonic_from_scalar(0, AVS_TIME_S);
+    avs_time_monotonic_t deadline = start;
+    anjay_observe_timer_t **bucket;
+    int64_t lower_tick;
+    for (int64_t i = 0; (bucket = nth_bucket(wheel, i, &lower_tick)); ++i) {
+        if (first && lower_tick > tick_of(deadline)) {
+            if (i >= SLOTS) {
+                break;
+            }
+            // skip the rest of level 0, its slots start even later
+            i = SLOTS - 1;
+            continue;
+        }
+        for (const anjay_observe_timer_t *timer = *bucket; timer;
+                timer = timer->next) {
+            if (!first) {
+                first = timer;
+                start = timer->start;
+                deadline = timer->deadline;
+                continue;
+            }
+            if (avs_time_monotonic_before(timer->start, start)) {
+                start = timer->start;
+            }
+            if (avs_time_monotonic_before(timer->deadline, deadline)) {
+                deadline = timer->deadline;
+            }
+        }
+    }
+    if (!first) {
+        _anjay_sched_del(wheel->sched, &wheel->job);
+        return;
+    }
+    schedule_job(wheel, start, deadline);
+}
+
+/**
+ * Fires all timers whose windows have already started. The job is scheduled
+ * for the earliest deadline, but may run earlier if the scheduler is woken up
+ * for any other reason, so that the timers ride along with other jobs. Timers
+ * are fired in the order of their deadlines.
+ */
+static void wheel_job(anjay_t *anjay, void *wheel_) {
+    anjay_observe_timer_wheel_t *wheel = (anjay_observe_timer_wheel_t *) wheel_;
+    avs_time_monotonic_t now = avs_time_monotonic_now();
+
+    anjay_observe_timer_t *fired = NULL;
+    advance(wheel, tick_of(now), &fired);
+    move_started(&wheel->level0[slot_of(wheel->current_tick)], now, &fired);
+    sort_timers(&fired);
+
+    // timers re-armed by the callbacks do not need to reschedule the job
+    wheel->job_running = true;
+    while (fired) {
+        anjay_observe_timer_t *timer = fired;
+        _anjay_observe_timer_cancel(timer);
+        wheel->clb(anjay, timer);
+    }
+    wheel->job_running = false;
+    rearm_job(wheel);
+}
+
+void _anjay_observe_timer_wheel_init(anjay_observe_timer_wheel_t *wheel,
+                                     anjay_sched_t *sched,
+                                     anjay_observe_timer_clb_t *clb) {
+    memset(wheel, 0, sizeof(*wheel));
+    wheel->sched = sched;
+    wheel->clb = clb;
+    wheel->current_tick = tick_of(avs_time_monotonic_now());
+}
+
+void _anjay_observe_timer_wheel_cleanup(anjay_observe_timer_wheel_t *wheel) {
+    _anjay_sched_del(wheel->sched, &wheel->job);
+}
+
+int _anjay_observe_timer_arm(anjay_observe_timer_wheel_t *wheel,
+                             anjay_observe_timer_t *timer,
+                             avs_time_monotonic_t start,
+                             avs_time_monotonic_t deadline) {
+    _anjay_observe_timer_cancel(timer);
+    if (avs_time_monotonic_before(deadline, start)) {
+        start = deadline;
+    }
+    timer->start = start;
+    timer->deadline = deadline;
+    timer->seq = wheel->next_seq++;
+    insert_timer(wheel, timer);
+
+    if (wheel->job_running
+            || (wheel->job && !avs_time_monotonic_before(
+                                      deadline, wheel->job_deadline))) {
+        return 0;
+    }
+    // the new timer is now the earliest one - move the job window, keeping
+    // its start if that was earlier, to retain the coalescing opportunity
+    if (wheel->job && avs_time_monotonic_before(wheel->job_start, start)) {
+        start = wheel->job_start;
+    }
+    if (schedule_job(wheel, start, deadline)) {
+        _anjay_observe_timer_cancel(timer);
+        return -1;
+    }
+    return 0;
+}
+
+#ifdef ANJAY_TEST
+#include "test/timer_wheel.c"
+#endif // ANJAY_TEST
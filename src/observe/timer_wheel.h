@@ -0,0 +1,108 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANJAY_OBSERVE_TIMER_WHEEL_H
+#define ANJAY_OBSERVE_TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <avsystem/commons/time.h>
+
+#include <anjay_modules/sched.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Number of slots on each level of the wheel. The first level has a
+ * granularity of one second, and the second one of
+ * ANJAY_OBSERVE_TIMER_WHEEL_SLOTS seconds. Timers further in the future are
+ * kept on an overflow list.
+ */
+#define ANJAY_OBSERVE_TIMER_WHEEL_SLOTS 64
+
+typedef struct anjay_observe_timer_struct anjay_observe_timer_t;
+
+struct anjay_observe_timer_struct {
+    anjay_observe_timer_t *next;
+    // pointer to the pointer that points to this timer; NULL if not armed
+    anjay_observe_timer_t **pprev;
+    // the timer may fire at any moment between start and deadline
+    avs_time_monotonic_t start;
+    avs_time_monotonic_t deadline;
+    // arming order, used to fire timers with equal deadlines in FIFO order
+    uint64_t seq;
+};
+
+typedef void anjay_observe_timer_clb_t(anjay_t *anjay,
+                                       anjay_observe_timer_t *timer);
+
+/**
+ * Hierarchical timer wheel for observation timers. Arming and cancelling
+ * a timer are O(1) operations, and all armed timers are driven by a single
+ * scheduler job, armed for the earliest bucket of timers.
+ */
+typedef struct {
+    anjay_sched_t *sched;
+    anjay_observe_timer_clb_t *clb;
+
+    int64_t current_tick;
+    anjay_observe_timer_t *level0[ANJAY_OBSERVE_TIMER_WHEEL_SLOTS];
+    anjay_observe_timer_t *level1[ANJAY_OBSERVE_TIMER_WHEEL_SLOTS];
+    anjay_observe_timer_t *overflow;
+    uint64_t next_seq;
+
+    anjay_sched_handle_t job;
+    avs_time_monotonic_t job_start;
+    avs_time_monotonic_t job_deadline;
+    bool job_running;
+} anjay_observe_timer_wheel_t;
+
+void _anjay_observe_timer_wheel_init(anjay_observe_timer_wheel_t *wheel,
+                                     anjay_sched_t *sched,
+                                     anjay_observe_timer_clb_t *clb);
+
+/**
+ * Cancels the scheduler job. All timers shall be cancelled by their owners
+ * before or after calling this function.
+ */
+void _anjay_observe_timer_wheel_cleanup(anjay_observe_timer_wheel_t *wheel);
+
+/**
+ * (Re)arms @p timer so that it fires at any moment between @p start and
+ * @p deadline, preferably together with other timers or scheduler jobs.
+ *
+ * @returns 0 on success, or a negative value if the scheduler job could not be
+ *          scheduled. In the latter case, the timer is not armed.
+ */
+int _anjay_observe_timer_arm(anjay_observe_timer_wheel_t *wheel,
+                             anjay_observe_timer_t *timer,
+                             avs_time_monotonic_t start,
+                             avs_time_monotonic_t deadline);
+
+/**
+ * Cancels @p timer. Does nothing if the timer is not armed.
+ */
+void _anjay_observe_timer_cancel(anjay_observe_timer_t *timer);
+
+static inline bool
+_anjay_observe_timer_armed(const anjay_observe_timer_t *timer) {
+    return timer->pprev != NULL;
+}
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_OBSERVE_TIMER_WHEEL_H */
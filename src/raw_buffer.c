@@ -17,6 +17,7 @@
 #include <anjay_config.h>
 
 #include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -54,3 +55,52 @@ int _anjay_raw_buffer_from_data(anjay_raw_buffer_t *dst,
     memcpy(dst->data, src, size);
     return 0;
 }
+
+static int reserve(anjay_raw_buffer_t *buffer, size_t size) {
+    if (buffer->capacity - buffer->size >= size) {
+        return 0;
+    }
+    size_t new_capacity = buffer->capacity ? buffer->capacity : 256;
+    while (new_capacity - buffer->size < size) {
+        if (new_capacity > SIZE_MAX / 2) {
+            return -1;
+        }
+        new_capacity *= 2;
+    }
+    void *new_data = avs_realloc(buffer->data, new_capacity);
+    if (!new_data) {
+        return -1;
+    }
+    buffer->data = new_data;
+    buffer->capacity = new_capacity;
+    return 0;
+}
+
+int _anjay_raw_buffer_append(anjay_raw_buffer_t *buffer,
+                             const void *src,
+                             size_t size) {
+    if (reserve(buffer, size)) {
+        return -1;
+    }
+    memcpy((char *) buffer->data + buffer->size, src, size);
+    buffer->size += size;
+    return 0;
+}
+
+int _anjay_raw_buffer_append_stream(anjay_raw_buffer_t *buffer,
+                                    avs_stream_abstract_t *stream) {
+    char message_finished = 0;
+    while (!message_finished) {
+        size_t bytes_read;
+        int retval;
+        if ((retval = reserve(buffer, 1024))
+                || (retval = avs_stream_read(
+                            stream, &bytes_read, &message_finished,
+                            (char *) buffer->data + buffer->size,
+                            buffer->capacity - buffer->size))) {
+            return retval;
+        }
+        buffer->size += bytes_read;
+    }
+    return 0;
+}
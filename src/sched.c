@@ -55,14 +55,25 @@ anjay_sched_t *_anjay_sched_new(anjay_t *anjay) {
     return sched;
 }
 
+/**
+ * Detaches the job that shall be executed next: out of all jobs whose windows
+ * have already started, the one with the earliest deadline is chosen. For jobs
+ * scheduled without slack, this is equivalent to taking the list head.
+ */
 static anjay_sched_entry_t *fetch_task(anjay_sched_t *sched,
                                        const avs_time_monotonic_t *now) {
-    if (sched->entries
-            && !avs_time_monotonic_before(*now, sched->entries->when)) {
-        return AVS_LIST_DETACH(&sched->entries);
-    } else {
-        return NULL;
+    AVS_LIST(anjay_sched_entry_t) *task_ptr = NULL;
+    AVS_LIST(anjay_sched_entry_t) *entry_ptr;
+    AVS_LIST_FOREACH_PTR(entry_ptr, &sched->entries) {
+        if (avs_time_monotonic_before(*now, (*entry_ptr)->when)) {
+            break;
+        }
+        if (!task_ptr || avs_time_monotonic_before((*entry_ptr)->deadline,
+                                                   (*task_ptr)->deadline)) {
+            task_ptr = entry_ptr;
+        }
     }
+    return task_ptr ? AVS_LIST_DETACH(task_ptr) : NULL;
 }
 
 static void update_backoff(anjay_sched_retryable_backoff_t *cfg) {
@@ -76,6 +87,7 @@ static void update_backoff(anjay_sched_retryable_backoff_t *cfg) {
 static anjay_sched_handle_t
 sched_delayed(anjay_sched_t *sched,
               avs_time_duration_t delay,
+              avs_time_duration_t slack,
               AVS_LIST(anjay_sched_entry_t) entry);
 
 static void execute_task(anjay_sched_t *sched,
@@ -107,7 +119,8 @@ static void execute_task(anjay_sched_t *sched,
             if (clb_result == ANJAY_SCHED_FINISH) {
                 sched_log(TRACE, "retryable job %p finished", (void*) entry);
                 AVS_LIST_DELETE(&entry);
-            } else if (!sched_delayed(sched, backoff->delay, entry)) {
+            } else if (!sched_delayed(sched, backoff->delay,
+                                      AVS_TIME_DURATION_ZERO, entry)) {
                 sched_log(TRACE, "could not reschedule job %p - cancelling",
                           (void*) entry);
                 AVS_LIST_DELETE(&entry);
@@ -222,6 +235,7 @@ create_entry(anjay_sched_task_type_t type,
 static anjay_sched_handle_t
 sched_delayed(anjay_sched_t *sched,
               avs_time_duration_t delay,
+              avs_time_duration_t slack,
               AVS_LIST(anjay_sched_entry_t) entry) {
     avs_time_monotonic_t sched_time = avs_time_monotonic_now();
     sched_log(TRACE, "current time %" PRId64 ".%09" PRId32,
@@ -233,12 +247,19 @@ sched_delayed(anjay_sched_t *sched,
     }
     sched_log(TRACE,
               "job scheduled at %" PRId64 ".%09" PRId32
-              " (+%" PRId64 ".%09" PRId32 "); type %d",
+              " (+%" PRId64 ".%09" PRId32 ", slack %" PRId64 ".%09" PRId32
+              "); type %d",
               sched_time.since_monotonic_epoch.seconds,
               sched_time.since_monotonic_epoch.nanoseconds,
-              delay.seconds, delay.nanoseconds, (int)entry->type);
+              delay.seconds, delay.nanoseconds,
+              slack.seconds, slack.nanoseconds, (int)entry->type);
 
     entry->when = sched_time;
+    entry->deadline = sched_time;
+    if (avs_time_duration_valid(slack)
+            && avs_time_duration_less(AVS_TIME_DURATION_ZERO, slack)) {
+        entry->deadline = avs_time_monotonic_add(sched_time, slack);
+    }
     return insert_entry(sched, entry);
 }
 
@@ -255,6 +276,7 @@ static int schedule(anjay_sched_t *sched,
                     anjay_sched_handle_t *out_handle,
                     anjay_sched_retryable_backoff_t *backoff_config,
                     avs_time_duration_t delay,
+                    avs_time_duration_t slack,
                     anjay_sched_clb_union_t clb,
                     void *clb_data) {
     AVS_ASSERT((!out_handle || *out_handle == NULL),
@@ -268,7 +290,7 @@ static int schedule(anjay_sched_t *sched,
         return -1;
     }
     entry->handle_ptr = out_handle;
-    anjay_sched_handle_t task = sched_delayed(sched, delay, entry);
+    anjay_sched_handle_t task = sched_delayed(sched, delay, slack, entry);
     if (!task) {
         AVS_LIST_DELETE(&entry);
         return -1;
@@ -284,11 +306,21 @@ int _anjay_sched(anjay_sched_t *sched,
                  avs_time_duration_t delay,
                  anjay_sched_clb_t clb,
                  void *clb_data) {
+    return _anjay_sched_with_slack(sched, out_handle, delay,
+                                   AVS_TIME_DURATION_ZERO, clb, clb_data);
+}
+
+int _anjay_sched_with_slack(anjay_sched_t *sched,
+                            anjay_sched_handle_t *out_handle,
+                            avs_time_duration_t delay,
+                            avs_time_duration_t slack,
+                            anjay_sched_clb_t clb,
+                            void *clb_data) {
     if (clb == NULL) {
         sched_log(ERROR, "Attempted to schedule a null callback pointer");
         return -1;
     }
-    return schedule(sched, out_handle, NULL, delay,
+    return schedule(sched, out_handle, NULL, delay, slack,
                     (anjay_sched_clb_union_t) { .oneshot = clb }, clb_data);
 }
 
@@ -298,11 +330,23 @@ int _anjay_sched_retryable(anjay_sched_t *sched,
                            anjay_sched_retryable_backoff_t config,
                            anjay_sched_retryable_clb_t clb,
                            void *clb_data) {
+    return _anjay_sched_retryable_with_slack(sched, out_handle, delay,
+                                             AVS_TIME_DURATION_ZERO, config,
+                                             clb, clb_data);
+}
+
+int _anjay_sched_retryable_with_slack(anjay_sched_t *sched,
+                                      anjay_sched_handle_t *out_handle,
+                                      avs_time_duration_t delay,
+                                      avs_time_duration_t slack,
+                                      anjay_sched_retryable_backoff_t config,
+                                      anjay_sched_retryable_clb_t clb,
+                                      void *clb_data) {
     if (clb == NULL) {
         sched_log(ERROR, "Attempted to schedule a null callback pointer");
         return -1;
     }
-    return schedule(sched, out_handle, &config, delay,
+    return schedule(sched, out_handle, &config, delay, slack,
                     (anjay_sched_clb_union_t) { .retryable = clb }, clb_data);
 }
 
@@ -331,20 +375,32 @@ int _anjay_sched_del(anjay_sched_t *sched, anjay_sched_handle_t *handle) {
 
 int _anjay_sched_time_to_next(anjay_sched_t *sched,
                               avs_time_duration_t *delay) {
-    anjay_sched_entry_t *elem;
-    avs_time_monotonic_t now = avs_time_monotonic_now();
+    if (!sched->entries) {
+        return -1;
+    }
 
-    AVS_LIST_FOREACH(elem, sched->entries) {
-        if (delay) {
-            *delay = avs_time_monotonic_diff(elem->when, now);
-            if (avs_time_duration_less(*delay, AVS_TIME_DURATION_ZERO)) {
-                *delay = AVS_TIME_DURATION_ZERO;
-            }
+    // The next wakeup is the earliest deadline; all jobs whose windows start
+    // before it will be executed together with the one that set it. Entries
+    // are sorted by window start, which is never later than the deadline, so
+    // the scan may stop as soon as a window starts after the best deadline.
+    avs_time_monotonic_t next = sched->entries->deadline;
+    anjay_sched_entry_t *elem;
+    AVS_LIST_FOREACH(elem, AVS_LIST_NEXT(sched->entries)) {
+        if (!avs_time_monotonic_before(elem->when, next)) {
+            break;
+        }
+        if (avs_time_monotonic_before(elem->deadline, next)) {
+            next = elem->deadline;
         }
-        return 0;
     }
 
-    return -1;
+    if (delay) {
+        *delay = avs_time_monotonic_diff(next, avs_time_monotonic_now());
+        if (avs_time_duration_less(*delay, AVS_TIME_DURATION_ZERO)) {
+            *delay = AVS_TIME_DURATION_ZERO;
+        }
+    }
+    return 0;
 }
 
 #ifdef ANJAY_TEST
@@ -38,6 +38,11 @@ typedef struct {
 
     anjay_sched_handle_t *handle_ptr;
     avs_time_monotonic_t when;
+    /**
+     * Latest moment at which the job shall be executed; equal to @ref when
+     * unless the job has been scheduled with slack.
+     */
+    avs_time_monotonic_t deadline;
     anjay_sched_clb_union_t clb;
     void *clb_data;
 } anjay_sched_entry_t;
@@ -0,0 +1,504 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <assert.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <avsystem/commons/coap/msg.h>
+#include <avsystem/commons/memory.h>
+#include <avsystem/commons/stream.h>
+
+#include "../anjay_core.h"
+#include "../coap/coap_stream.h"
+#include "../coap/content_format.h"
+#include "../io/fp_conv.h"
+#include "../servers.h"
+#include "../utils_core.h"
+
+#include "send_core.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#ifdef WITH_SEND
+
+/** Returned by check_send_response() if retrying makes no sense. */
+#define SEND_REJECTED 1
+
+static AVS_LIST(anjay_send_batch_t) *find_batch_ptr(anjay_send_state_t *send,
+                                                    anjay_ssid_t ssid) {
+    AVS_LIST(anjay_send_batch_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &send->batches) {
+        if ((*it)->ssid == ssid) {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+static anjay_send_batch_t *find_batch(anjay_t *anjay, anjay_ssid_t ssid) {
+    AVS_LIST(anjay_send_batch_t) *batch_ptr = find_batch_ptr(&anjay->send,
+                                                             ssid);
+    if (!batch_ptr) {
+        anjay_log(ERROR, "no Send batch configured for SSID %" PRIu16, ssid);
+        return NULL;
+    }
+    return *batch_ptr;
+}
+
+static anjay_send_sample_t *sample_at(const anjay_send_batch_t *batch,
+                                      size_t index) {
+    assert(index < batch->count);
+    return &batch->samples[(batch->first + index) % batch->config.capacity];
+}
+
+static void drop_oldest_samples(anjay_send_batch_t *batch, size_t count) {
+    assert(count <= batch->count);
+    batch->first = (batch->first + count) % batch->config.capacity;
+    batch->count -= count;
+}
+
+static size_t flush_threshold(const anjay_send_batch_config_t *config) {
+    if (!config->flush_threshold
+            || config->flush_threshold > config->capacity) {
+        return config->capacity;
+    }
+    return config->flush_threshold;
+}
+
+static int write_time(avs_stream_abstract_t *stream,
+                      const char *key,
+                      avs_time_duration_t value) {
+    char buf[ANJAY_FP_STRING_BUFFER_SIZE];
+    _anjay_fp_format_double(buf, avs_time_duration_to_fscalar(value,
+                                                               AVS_TIME_S));
+    return avs_stream_write_f(stream, "\"%s\":%s,", key, buf);
+}
+
+static int write_value(avs_stream_abstract_t *stream,
+                       const anjay_send_sample_t *sample) {
+    switch ((anjay_send_value_type_t) sample->type) {
+    case ANJAY_SEND_VALUE_INT:
+        return avs_stream_write_f(stream, "\"v\":%" PRId64, sample->value.i);
+    case ANJAY_SEND_VALUE_DOUBLE: {
+        char buf[ANJAY_FP_STRING_BUFFER_SIZE];
+        _anjay_fp_format_double(buf, sample->value.d);
+        return avs_stream_write_f(stream, "\"v\":%s", buf);
+    }
+    case ANJAY_SEND_VALUE_BOOL:
+        return avs_stream_write_f(stream, "\"vb\":%s",
+                                  sample->value.b ? "true" : "false");
+    }
+    AVS_UNREACHABLE("invalid value type");
+    return -1;
+}
+
+/**
+ * Writes all samples of @p batch as a SenML JSON (RFC 8428) array. The
+ * timestamp of the oldest sample is used as the base time, and the timestamps
+ * of the following ones are encoded relative to it.
+ */
+static int write_senml(avs_stream_abstract_t *stream,
+                       const anjay_send_batch_t *batch) {
+    assert(batch->count > 0);
+    const avs_time_real_t base_time = sample_at(batch, 0)->timestamp;
+    int result = avs_stream_write(stream, "[", 1);
+    for (size_t i = 0; !result && i < batch->count; ++i) {
+        const anjay_send_sample_t *sample = sample_at(batch, i);
+        avs_time_duration_t offset =
+                avs_time_real_diff(sample->timestamp, base_time);
+        (void) ((result = avs_stream_write(stream, i ? ",{" : "{",
+                                           i ? 2 : 1))
+                || (!i && (result = write_time(stream, "bt",
+                                               base_time.since_real_epoch)))
+                || (i && (result = write_time(stream, "t", offset)))
+                || (result = avs_stream_write_f(
+                        stream, "\"n\":\"/%" PRIu16 "/%" PRIu16 "/%" PRIu16
+                        "\",", sample->oid, sample->iid, sample->rid))
+                || (result = write_value(stream, sample))
+                || (result = avs_stream_write(stream, "}", 1)));
+    }
+    if (!result) {
+        result = avs_stream_write(stream, "]", 1);
+    }
+    return result;
+}
+
+static int check_send_response(avs_stream_abstract_t *stream) {
+    const avs_coap_msg_t *response;
+    if (_anjay_coap_stream_get_incoming_msg(stream, &response)) {
+        anjay_log(ERROR, "could not get response");
+        return -1;
+    }
+
+    const uint8_t code = avs_coap_msg_get_code(response);
+    if (code == AVS_COAP_CODE_CHANGED) {
+        return 0;
+    } else if (avs_coap_msg_code_is_client_error(code)) {
+        // the same payload would most likely be rejected again
+        anjay_log(ERROR, "Send rejected: %s", AVS_COAP_CODE_STRING(code));
+        return SEND_REJECTED;
+    } else {
+        anjay_log(ERROR, "server responded with %s (expected %s)",
+                  AVS_COAP_CODE_STRING(code),
+                  AVS_COAP_CODE_STRING(AVS_COAP_CODE_CHANGED));
+        return -1;
+    }
+}
+
+static int send_batch(anjay_t *anjay, anjay_send_batch_t *batch) {
+    if (!batch->count) {
+        return 0;
+    }
+
+    anjay_connection_ref_t ref = {
+        .server = _anjay_servers_find_active(anjay->servers, batch->ssid)
+    };
+    if (anjay_is_offline(anjay) || !ref.server
+            || _anjay_server_registration_expired(ref.server)) {
+        anjay_log(DEBUG, "server %" PRIu16 " not registered, postponing Send",
+                  batch->ssid);
+        return -1;
+    }
+    ref.conn_type = _anjay_server_primary_conn_type(ref.server);
+
+    int result;
+    if ((result = _anjay_connection_ensure_online(anjay, ref))
+            || (result = _anjay_bind_server_stream(anjay, ref))) {
+        return result;
+    }
+
+    anjay_msg_details_t details = {
+        .msg_type = AVS_COAP_MSG_CONFIRMABLE,
+        .msg_code = AVS_COAP_CODE_POST,
+        .format = ANJAY_COAP_FORMAT_SENML_JSON,
+        .uri_path = ANJAY_MAKE_STRING_LIST("dp")
+    };
+    const size_t sent_count = batch->count;
+    if (!details.uri_path) {
+        anjay_log(ERROR, "out of memory");
+        result = -1;
+    } else {
+        (void) ((result = _anjay_coap_stream_setup_request(
+                        anjay->comm_stream, &details, NULL))
+                || (result = write_senml(anjay->comm_stream, batch))
+                || (result = avs_stream_finish_message(anjay->comm_stream))
+                || (result = check_send_response(anjay->comm_stream)));
+    }
+    _anjay_release_server_stream(anjay);
+    AVS_LIST_CLEAR(&details.uri_path);
+
+    if (!result || result == SEND_REJECTED) {
+        anjay_log(INFO, "Send with %lu samples %s", (unsigned long) sent_count,
+                  result ? "dropped" : "delivered");
+        drop_oldest_samples(batch, sent_count);
+        return 0;
+    } else if (result == AVS_COAP_CTX_ERR_NETWORK
+            || result == AVS_COAP_CTX_ERR_TIMEOUT) {
+        anjay_log(ERROR, "network communication error while sending Send");
+        _anjay_schedule_server_reconnect(anjay, ref.server);
+    }
+    return result;
+}
+
+static void flush_job(anjay_t *anjay, void *batch_);
+
+static int schedule_age_flush(anjay_t *anjay, anjay_send_batch_t *batch) {
+    if (batch->flush_job || !batch->count
+            || !avs_time_duration_valid(batch->config.max_age)) {
+        return 0;
+    }
+    return _anjay_sched(anjay->sched, &batch->flush_job, batch->config.max_age,
+                        flush_job, batch);
+}
+
+static int request_flush(anjay_t *anjay, anjay_send_batch_t *batch) {
+    if (batch->flush_requested) {
+        return 0;
+    }
+    _anjay_sched_del(anjay->sched, &batch->flush_job);
+    if (_anjay_sched_now(anjay->sched, &batch->flush_job, flush_job, batch)) {
+        anjay_log(ERROR, "could not schedule Send");
+        return -1;
+    }
+    batch->flush_requested = true;
+    return 0;
+}
+
+static void flush_job(anjay_t *anjay, void *batch_) {
+    anjay_send_batch_t *batch = (anjay_send_batch_t *) batch_;
+    batch->flush_requested = false;
+    send_batch(anjay, batch);
+    // on failure, retry after max_age - if samples were delivered, the batch
+    // is empty and the next age flush is scheduled when a sample is added
+    if (schedule_age_flush(anjay, batch)) {
+        anjay_log(ERROR, "could not schedule Send retry");
+    }
+}
+
+static void delete_batch(anjay_sched_t *sched,
+                         AVS_LIST(anjay_send_batch_t) *batch_ptr) {
+    _anjay_sched_del(sched, &(*batch_ptr)->flush_job);
+    avs_free((*batch_ptr)->samples);
+    AVS_LIST_DELETE(batch_ptr);
+}
+
+void _anjay_send_cleanup(anjay_send_state_t *send, anjay_sched_t *sched) {
+    while (send->batches) {
+        delete_batch(sched, &send->batches);
+    }
+}
+
+int anjay_send_batch_configure(anjay_t *anjay,
+                               anjay_ssid_t ssid,
+                               const anjay_send_batch_config_t *config) {
+    AVS_LIST(anjay_send_batch_t) *batch_ptr =
+            find_batch_ptr(&anjay->send, ssid);
+    if (!config) {
+        if (batch_ptr) {
+            delete_batch(anjay->sched, batch_ptr);
+        }
+        return 0;
+    }
+    if (ssid == ANJAY_SSID_ANY || ssid == ANJAY_SSID_BOOTSTRAP) {
+        anjay_log(ERROR, "invalid SSID for Send: %" PRIu16, ssid);
+        return -1;
+    }
+    if (!config->capacity) {
+        anjay_log(ERROR, "Send batch capacity must not be zero");
+        return -1;
+    }
+
+    anjay_send_sample_t *samples = (anjay_send_sample_t *)
+            avs_calloc(config->capacity, sizeof(anjay_send_sample_t));
+    if (!samples) {
+        anjay_log(ERROR, "out of memory");
+        return -1;
+    }
+
+    anjay_send_batch_t *batch;
+    if (batch_ptr) {
+        batch = *batch_ptr;
+        // keep the newest samples that fit in the new buffer
+        if (batch->count > config->capacity) {
+            drop_oldest_samples(batch, batch->count - config->capacity);
+        }
+        for (size_t i = 0; i < batch->count; ++i) {
+            samples[i] = *sample_at(batch, i);
+        }
+        avs_free(batch->samples);
+    } else {
+        if (!(batch = AVS_LIST_NEW_ELEMENT(anjay_send_batch_t))) {
+            anjay_log(ERROR, "out of memory");
+            avs_free(samples);
+            return -1;
+        }
+        AVS_LIST_APPEND(&anjay->send.batches, batch);
+    }
+
+    batch->ssid = ssid;
+    batch->config = *config;
+    batch->samples = samples;
+    batch->first = 0;
+
+    if (batch->count >= flush_threshold(&batch->config)) {
+        return request_flush(anjay, batch);
+    }
+    if (!batch->flush_requested) {
+        // max_age might have changed
+        _anjay_sched_del(anjay->sched, &batch->flush_job);
+    }
+    return schedule_age_flush(anjay, batch);
+}
+
+static int add_sample(anjay_t *anjay,
+                      anjay_ssid_t ssid,
+                      anjay_send_sample_t *sample) {
+    anjay_send_batch_t *batch = find_batch(anjay, ssid);
+    if (!batch) {
+        return -1;
+    }
+    // 65535 is reserved in all path segments
+    if (sample->oid == UINT16_MAX || sample->iid == ANJAY_IID_INVALID
+            || sample->rid == UINT16_MAX) {
+        anjay_log(ERROR, "invalid path for Send: /%" PRIu16 "/%" PRIu16
+                  "/%" PRIu16, sample->oid, sample->iid, sample->rid);
+        return -1;
+    }
+    if (!avs_time_real_valid(sample->timestamp)) {
+        sample->timestamp = avs_time_real_now();
+    }
+
+    if (batch->count == batch->config.capacity) {
+        anjay_log(DEBUG, "Send batch for SSID %" PRIu16 " full, dropping the "
+                  "oldest sample", ssid);
+        drop_oldest_samples(batch, 1);
+    }
+    batch->samples[(batch->first + batch->count) % batch->config.capacity] =
+            *sample;
+    ++batch->count;
+
+    if (batch->count >= flush_threshold(&batch->config)) {
+        return request_flush(anjay, batch);
+    }
+    return schedule_age_flush(anjay, batch);
+}
+
+int anjay_send_batch_add_int(anjay_t *anjay,
+                             anjay_ssid_t ssid,
+                             anjay_oid_t oid,
+                             anjay_iid_t iid,
+                             anjay_rid_t rid,
+                             avs_time_real_t timestamp,
+                             int64_t value) {
+    anjay_send_sample_t sample = {
+        .timestamp = timestamp,
+        .value = { .i = value },
+        .oid = oid,
+        .iid = iid,
+        .rid = rid,
+        .type = ANJAY_SEND_VALUE_INT
+    };
+    return add_sample(anjay, ssid, &sample);
+}
+
+int anjay_send_batch_add_double(anjay_t *anjay,
+                                anjay_ssid_t ssid,
+                                anjay_oid_t oid,
+                                anjay_iid_t iid,
+                                anjay_rid_t rid,
+                                avs_time_real_t timestamp,
+                                double value) {
+    if (!isfinite(value)) {
+        // SenML JSON has no representation for NaN or infinities, and a single
+        // such value would get the whole batch rejected
+        anjay_log(ERROR, "non-finite values cannot be sent");
+        return -1;
+    }
+    anjay_send_sample_t sample = {
+        .timestamp = timestamp,
+        .value = { .d = value },
+        .oid = oid,
+        .iid = iid,
+        .rid = rid,
+        .type = ANJAY_SEND_VALUE_DOUBLE
+    };
+    return add_sample(anjay, ssid, &sample);
+}
+
+int anjay_send_batch_add_bool(anjay_t *anjay,
+                              anjay_ssid_t ssid,
+                              anjay_oid_t oid,
+                              anjay_iid_t iid,
+                              anjay_rid_t rid,
+                              avs_time_real_t timestamp,
+                              bool value) {
+    anjay_send_sample_t sample = {
+        .timestamp = timestamp,
+        .value = { .b = value },
+        .oid = oid,
+        .iid = iid,
+        .rid = rid,
+        .type = ANJAY_SEND_VALUE_BOOL
+    };
+    return add_sample(anjay, ssid, &sample);
+}
+
+int anjay_send_batch_flush(anjay_t *anjay, anjay_ssid_t ssid) {
+    anjay_send_batch_t *batch = find_batch(anjay, ssid);
+    if (!batch) {
+        return -1;
+    }
+    return request_flush(anjay, batch);
+}
+
+size_t anjay_send_batch_size(anjay_t *anjay, anjay_ssid_t ssid) {
+    AVS_LIST(anjay_send_batch_t) *batch_ptr =
+            find_batch_ptr(&anjay->send, ssid);
+    return batch_ptr ? (*batch_ptr)->count : 0;
+}
+
+#ifdef ANJAY_TEST
+#include "test/send.c"
+#endif // ANJAY_TEST
+
+#else // WITH_SEND
+
+int anjay_send_batch_configure(anjay_t *anjay,
+                               anjay_ssid_t ssid,
+                               const anjay_send_batch_config_t *config) {
+    (void) anjay;
+    (void) ssid;
+    (void) config;
+    anjay_log(ERROR, "Send support disabled");
+    return -1;
+}
+
+int anjay_send_batch_add_int(anjay_t *anjay,
+                             anjay_ssid_t ssid,
+                             anjay_oid_t oid,
+                             anjay_iid_t iid,
+                             anjay_rid_t rid,
+                             avs_time_real_t timestamp,
+                             int64_t value) {
+    (void) anjay; (void) ssid; (void) oid; (void) iid; (void) rid;
+    (void) timestamp; (void) value;
+    anjay_log(ERROR, "Send support disabled");
+    return -1;
+}
+
+int anjay_send_batch_add_double(anjay_t *anjay,
+                                anjay_ssid_t ssid,
+                                anjay_oid_t oid,
+                                anjay_iid_t iid,
+                                anjay_rid_t rid,
+                                avs_time_real_t timestamp,
+                                double value) {
+    (void) anjay; (void) ssid; (void) oid; (void) iid; (void) rid;
+    (void) timestamp; (void) value;
+    anjay_log(ERROR, "Send support disabled");
+    return -1;
+}
+
+int anjay_send_batch_add_bool(anjay_t *anjay,
+                              anjay_ssid_t ssid,
+                              anjay_oid_t oid,
+                              anjay_iid_t iid,
+                              anjay_rid_t rid,
+                              avs_time_real_t timestamp,
+                              bool value) {
+    (void) anjay; (void) ssid; (void) oid; (void) iid; (void) rid;
+    (void) timestamp; (void) value;
+    anjay_log(ERROR, "Send support disabled");
+    return -1;
+}
+
+int anjay_send_batch_flush(anjay_t *anjay, anjay_ssid_t ssid) {
+    (void) anjay;
+    (void) ssid;
+    anjay_log(ERROR, "Send support disabled");
+    return -1;
+}
+
+size_t anjay_send_batch_size(anjay_t *anjay, anjay_ssid_t ssid) {
+    (void) anjay;
+    (void) ssid;
+    return 0;
+}
+
+#endif // WITH_SEND
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANJAY_SEND_CORE_H
+#define ANJAY_SEND_CORE_H
+
+#include <anjay/send.h>
+
+#include <anjay_modules/sched.h>
+
+#include <avsystem/commons/list.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+typedef enum {
+    ANJAY_SEND_VALUE_INT,
+    ANJAY_SEND_VALUE_DOUBLE,
+    ANJAY_SEND_VALUE_BOOL
+} anjay_send_value_type_t;
+
+typedef struct {
+    avs_time_real_t timestamp;
+    union {
+        int64_t i;
+        double d;
+        bool b;
+    } value;
+    anjay_oid_t oid;
+    anjay_iid_t iid;
+    anjay_rid_t rid;
+    uint8_t type; // semantically anjay_send_value_type_t
+} anjay_send_sample_t;
+
+typedef struct {
+    anjay_ssid_t ssid;
+    anjay_send_batch_config_t config;
+
+    /**
+     * Ring buffer of <c>config.capacity</c> samples; <c>count</c> of them are
+     * valid, starting at index <c>first</c>.
+     */
+    anjay_send_sample_t *samples;
+    size_t first;
+    size_t count;
+
+    anjay_sched_handle_t flush_job;
+    /** True if <c>flush_job</c> is going to run immediately. */
+    bool flush_requested;
+} anjay_send_batch_t;
+
+typedef struct {
+    AVS_LIST(anjay_send_batch_t) batches;
+} anjay_send_state_t;
+
+/**
+ * Cancels all scheduled flushes and discards all buffered samples.
+ */
+void _anjay_send_cleanup(anjay_send_state_t *send, anjay_sched_t *sched);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_SEND_CORE_H */
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <math.h>
+
+#include <avsystem/commons/unit/test.h>
+
+#include <anjay_test/mock_clock.h>
+
+static anjay_t *create_test_env(void) {
+    _anjay_mock_clock_start(avs_time_monotonic_from_scalar(1000, AVS_TIME_S));
+    anjay_t *anjay = (anjay_t *) avs_calloc(1, sizeof(anjay_t));
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    anjay->sched = _anjay_sched_new(anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay->sched);
+    return anjay;
+}
+
+static void destroy_test_env(anjay_t *anjay) {
+    _anjay_send_cleanup(&anjay->send, anjay->sched);
+    _anjay_sched_delete(&anjay->sched);
+    avs_free(anjay);
+    _anjay_mock_clock_finish();
+}
+
+static avs_time_real_t real_ms(int64_t ms) {
+    return (avs_time_real_t) {
+        .since_real_epoch = avs_time_duration_from_scalar(ms, AVS_TIME_MS)
+    };
+}
+
+static anjay_send_batch_t *get_batch(anjay_t *anjay, anjay_ssid_t ssid) {
+    AVS_LIST(anjay_send_batch_t) *batch_ptr =
+            find_batch_ptr(&anjay->send, ssid);
+    AVS_UNIT_ASSERT_NOT_NULL(batch_ptr);
+    return *batch_ptr;
+}
+
+AVS_UNIT_TEST(send, ring_buffer) {
+    anjay_t *anjay = create_test_env();
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_configure(
+            anjay, 1, &(const anjay_send_batch_config_t) {
+                .capacity = 3,
+                .max_age = AVS_TIME_DURATION_INVALID
+            }));
+    anjay_send_batch_t *batch = get_batch(anjay, 1);
+
+    AVS_UNIT_ASSERT_FAILED(anjay_send_batch_add_int(anjay, 2, 3, 0, 1,
+                                                    AVS_TIME_REAL_INVALID, 0));
+    AVS_UNIT_ASSERT_FAILED(anjay_send_batch_add_int(
+            anjay, 1, 3, ANJAY_IID_INVALID, 1, AVS_TIME_REAL_INVALID, 0));
+
+    for (int64_t i = 0; i < 2; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_add_int(
+                anjay, 1, 3303, 0, 5700, real_ms(i), i));
+    }
+    AVS_UNIT_ASSERT_EQUAL(anjay_send_batch_size(anjay, 1), 2);
+    AVS_UNIT_ASSERT_NULL(batch->flush_job);
+
+    // reaching the capacity requests a flush
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_add_int(anjay, 1, 3303, 0, 5700,
+                                                     real_ms(2), 2));
+    AVS_UNIT_ASSERT_TRUE(batch->flush_requested);
+    AVS_UNIT_ASSERT_NOT_NULL(batch->flush_job);
+
+    // a full batch drops the oldest sample
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_add_int(anjay, 1, 3303, 0, 5700,
+                                                     real_ms(3), 3));
+    AVS_UNIT_ASSERT_EQUAL(anjay_send_batch_size(anjay, 1), 3);
+    for (size_t i = 0; i < 3; ++i) {
+        AVS_UNIT_ASSERT_EQUAL(sample_at(batch, i)->value.i, (int64_t) i + 1);
+    }
+
+    // shrinking keeps the newest samples
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_configure(
+            anjay, 1, &(const anjay_send_batch_config_t) {
+                .capacity = 2,
+                .max_age = AVS_TIME_DURATION_INVALID
+            }));
+    AVS_UNIT_ASSERT_TRUE(batch == get_batch(anjay, 1));
+    AVS_UNIT_ASSERT_EQUAL(anjay_send_batch_size(anjay, 1), 2);
+    AVS_UNIT_ASSERT_EQUAL(sample_at(batch, 0)->value.i, 2);
+    AVS_UNIT_ASSERT_EQUAL(sample_at(batch, 1)->value.i, 3);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_configure(anjay, 1, NULL));
+    AVS_UNIT_ASSERT_EQUAL(anjay_send_batch_size(anjay, 1), 0);
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(send, max_age) {
+    anjay_t *anjay = create_test_env();
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_configure(
+            anjay, 1, &(const anjay_send_batch_config_t) {
+                .capacity = 16,
+                .flush_threshold = 8,
+                .max_age = avs_time_duration_from_scalar(60, AVS_TIME_S)
+            }));
+    anjay_send_batch_t *batch = get_batch(anjay, 1);
+    AVS_UNIT_ASSERT_NULL(batch->flush_job);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_add_bool(
+            anjay, 1, 1, 0, 6, AVS_TIME_REAL_INVALID, true));
+    AVS_UNIT_ASSERT_NOT_NULL(batch->flush_job);
+    AVS_UNIT_ASSERT_FALSE(batch->flush_requested);
+
+    avs_time_duration_t delay;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sched_time_to_next(anjay->sched, &delay));
+    AVS_UNIT_ASSERT_EQUAL(delay.seconds, 60);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_flush(anjay, 1));
+    AVS_UNIT_ASSERT_TRUE(batch->flush_requested);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sched_time_to_next(anjay->sched, &delay));
+    AVS_UNIT_ASSERT_EQUAL(delay.seconds, 0);
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(send, senml) {
+    anjay_t *anjay = create_test_env();
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_configure(
+            anjay, 1, &(const anjay_send_batch_config_t) {
+                .capacity = 3,
+                .flush_threshold = 4,
+                .max_age = AVS_TIME_DURATION_INVALID
+            }));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_add_int(
+            anjay, 1, 3303, 0, 5700, real_ms(1000500), 42));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_add_double(
+            anjay, 1, 3303, 0, 5701, real_ms(1001500), 21.5));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_add_bool(
+            anjay, 1, 1, 0, 6, real_ms(1002000), true));
+
+    char buf[256];
+    avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+    avs_stream_outbuf_set_buffer(&outbuf, buf, sizeof(buf));
+    AVS_UNIT_ASSERT_SUCCESS(write_senml((avs_stream_abstract_t *) &outbuf,
+                                        get_batch(anjay, 1)));
+    static const char EXPECTED[] =
+            "[{\"bt\":1000.5,\"n\":\"/3303/0/5700\",\"v\":42},"
+            "{\"t\":1,\"n\":\"/3303/0/5701\",\"v\":21.5},"
+            "{\"t\":1.5,\"n\":\"/1/0/6\",\"vb\":true}]";
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf),
+                          sizeof(EXPECTED) - 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, EXPECTED, sizeof(EXPECTED) - 1);
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(send, non_finite_values) {
+    anjay_t *anjay = create_test_env();
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_configure(
+            anjay, 1, &(const anjay_send_batch_config_t) {
+                .capacity = 4,
+                .max_age = AVS_TIME_DURATION_INVALID
+            }));
+    AVS_UNIT_ASSERT_FAILED(anjay_send_batch_add_double(
+            anjay, 1, 3303, 0, 5700, AVS_TIME_REAL_INVALID, NAN));
+    AVS_UNIT_ASSERT_FAILED(anjay_send_batch_add_double(
+            anjay, 1, 3303, 0, 5700, AVS_TIME_REAL_INVALID, INFINITY));
+    AVS_UNIT_ASSERT_FAILED(anjay_send_batch_add_double(
+            anjay, 1, 3303, 0, 5700, AVS_TIME_REAL_INVALID, -INFINITY));
+    AVS_UNIT_ASSERT_EQUAL(anjay_send_batch_size(anjay, 1), 0);
+    destroy_test_env(anjay);
+}
@@ -79,6 +79,32 @@ typedef struct {
     anjay_connection_type_t conn_type;
 } anjay_connection_ref_t;
 
+typedef struct {
+    bool valid;
+    int32_t value;
+} anjay_server_cached_period_t;
+
+/**
+ * Values of the Server Object Instance resources associated with a server,
+ * cached so that the hot paths (e.g. sending notifications) do not need to
+ * query the data model each time. Each value is read lazily when first needed
+ * and is only valid if the corresponding flag is set. All values are
+ * invalidated whenever the Server Object is notified as changed.
+ */
+typedef struct {
+    bool lifetime_valid;
+    int64_t lifetime;
+
+    bool binding_valid;
+    anjay_binding_mode_t binding;
+
+    bool notification_storing_valid;
+    bool notification_storing;
+
+    anjay_server_cached_period_t default_min_period;
+    anjay_server_cached_period_t default_max_period;
+} anjay_server_config_cache_t;
+
 anjay_servers_t *_anjay_servers_create(void);
 
 /** Deregisters from every active server. */
@@ -147,6 +173,14 @@ _anjay_servers_find_by_udp_socket(anjay_servers_t *servers,
 anjay_server_info_t *_anjay_servers_find_active(anjay_servers_t *servers,
                                                 anjay_ssid_t ssid);
 
+/**
+ * Returns the cache of Server Object settings for a server with given SSID
+ * (active or not), or NULL if there is no such server, in which case the data
+ * model needs to be queried directly.
+ */
+anjay_server_config_cache_t *
+_anjay_servers_config_cache(anjay_t *anjay, anjay_ssid_t ssid);
+
 int _anjay_schedule_reload_servers(anjay_t *anjay);
 
 int _anjay_schedule_socket_update(anjay_t *anjay,
@@ -184,6 +218,17 @@ int _anjay_connection_bring_online(anjay_t *anjay,
                                    anjay_connection_ref_t ref,
                                    bool *out_session_resumed);
 
+/**
+ * Makes sure that a queue mode connection is online before sending a request
+ * through it. If bringing it online fails, reconnecting the server is
+ * scheduled; if the DTLS session could not be resumed, re-registration is
+ * scheduled instead, as the server will not recognize the new session.
+ *
+ * @returns 0 if the connection is ready to use, AVS_COAP_CTX_ERR_NETWORK if
+ *          the request shall be retried after re-registration, or -1 on error.
+ */
+int _anjay_connection_ensure_online(anjay_t *anjay, anjay_connection_ref_t ref);
+
 void _anjay_connection_suspend(anjay_connection_ref_t conn_ref);
 
 
@@ -170,6 +170,7 @@ activate_server_job(anjay_t *anjay, void *ssid_) {
         return ANJAY_SCHED_FINISH;
     }
 
+    _anjay_server_apply_restored_state(anjay->servers, *server_ptr);
     initialize_active_server_result_t registration_result =
             initialize_active_server(anjay, *server_ptr);
     if (registration_result == IAS_SUCCESS) {
@@ -18,6 +18,7 @@
 
 #include <inttypes.h>
 
+#include <avsystem/commons/coap/ctx.h>
 #include <avsystem/commons/stream/stream_net.h>
 #include <avsystem/commons/utils.h>
 
@@ -62,6 +63,12 @@ _anjay_connection_internal_clean_socket(anjay_server_connection_t *connection) {
 
 static anjay_binding_mode_t read_binding_mode(anjay_t *anjay,
                                               anjay_ssid_t ssid) {
+    anjay_server_config_cache_t *cache =
+            _anjay_servers_config_cache(anjay, ssid);
+    if (cache && cache->binding_valid) {
+        return cache->binding;
+    }
+
     char buf[8];
     anjay_uri_path_t path =
             MAKE_RESOURCE_PATH(ANJAY_DM_OID_SERVER, ANJAY_IID_INVALID,
@@ -69,7 +76,12 @@ static anjay_binding_mode_t read_binding_mode(anjay_t *anjay,
 
     if (!_anjay_find_server_iid(anjay, ssid, &path.iid)
             && !_anjay_dm_res_read_string(anjay, &path, buf, sizeof(buf))) {
-        return anjay_binding_mode_from_str(buf);
+        anjay_binding_mode_t binding = anjay_binding_mode_from_str(buf);
+        if (cache) {
+            cache->binding_valid = true;
+            cache->binding = binding;
+        }
+        return binding;
     } else {
         anjay_log(WARNING, "could not read binding mode for LwM2M server %u",
                   ssid);
@@ -497,19 +509,75 @@ static int get_udp_dtls_keys(anjay_t *anjay,
     return 0;
 }
 
+static AVS_LIST(anjay_security_cache_entry_t) *
+find_security_cache_insert_ptr(anjay_servers_t *servers,
+                               anjay_iid_t security_iid) {
+    AVS_LIST(anjay_security_cache_entry_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &servers->security_cache) {
+        if ((*it)->security_iid >= security_iid) {
+            break;
+        }
+    }
+    return it;
+}
+
+void _anjay_servers_invalidate_security_cache(anjay_t *anjay,
+                                              anjay_iid_t security_iid) {
+    if (!anjay->servers) {
+        return;
+    }
+    if (security_iid == ANJAY_IID_INVALID) {
+        AVS_LIST_CLEAR(&anjay->servers->security_cache);
+        return;
+    }
+    AVS_LIST(anjay_security_cache_entry_t) *entry_ptr =
+            find_security_cache_insert_ptr(anjay->servers, security_iid);
+    if (*entry_ptr && (*entry_ptr)->security_iid == security_iid) {
+        AVS_LIST_DELETE(entry_ptr);
+    }
+}
+
+static const anjay_security_cache_entry_t *
+get_udp_security_cache_entry(anjay_t *anjay, anjay_iid_t security_iid) {
+    AVS_LIST(anjay_security_cache_entry_t) *entry_ptr =
+            find_security_cache_insert_ptr(anjay->servers, security_iid);
+    if (*entry_ptr && (*entry_ptr)->security_iid == security_iid) {
+        return *entry_ptr;
+    }
+
+    AVS_LIST(anjay_security_cache_entry_t) entry =
+            AVS_LIST_NEW_ELEMENT(anjay_security_cache_entry_t);
+    if (!entry) {
+        anjay_log(ERROR, "out of memory");
+        return NULL;
+    }
+    entry->security_iid = security_iid;
+    if (get_udp_security_mode(anjay, security_iid, &entry->udp_security_mode)
+            || get_udp_dtls_keys(anjay, security_iid, entry->udp_security_mode,
+                                 &entry->dtls_keys)) {
+        AVS_LIST_DELETE(&entry);
+        return NULL;
+    }
+    AVS_LIST_INSERT(entry_ptr, entry);
+    return entry;
+}
+
 static int
 get_udp_connection_info(anjay_t *anjay,
                         server_connection_info_t *inout_info,
                         anjay_server_dtls_keys_t *dtls_keys) {
-    if (get_udp_security_mode(anjay, inout_info->security_iid,
-                              &inout_info->udp.security_mode)
-            || (inout_info->uri
-                    && !uri_protocol_matching(inout_info->udp.security_mode,
-                                              inout_info->uri))
-            || get_udp_dtls_keys(anjay, inout_info->security_iid,
-                                 inout_info->udp.security_mode, dtls_keys)) {
+    const anjay_security_cache_entry_t *security =
+            get_udp_security_cache_entry(anjay, inout_info->security_iid);
+    if (!security) {
+        return -1;
+    }
+    inout_info->udp.security_mode = security->udp_security_mode;
+    if (inout_info->uri
+            && !uri_protocol_matching(inout_info->udp.security_mode,
+                                      inout_info->uri)) {
         return -1;
     }
+    *dtls_keys = security->dtls_keys;
 
     anjay_log(DEBUG, "server /%u/%u: UDP security mode = %d",
               ANJAY_DM_OID_SECURITY, inout_info->security_iid,
@@ -774,6 +842,33 @@ int _anjay_connection_bring_online(anjay_t *anjay,
             anjay, _anjay_get_server_connection(ref), out_session_resumed);
 }
 
+int _anjay_connection_ensure_online(anjay_t *anjay,
+                                    anjay_connection_ref_t ref) {
+    if (_anjay_connection_current_mode(ref) == ANJAY_CONNECTION_QUEUE
+            && !_anjay_connection_get_online_socket(ref)) {
+        bool session_resumed;
+        if (_anjay_connection_bring_online(anjay, ref, &session_resumed)) {
+            anjay_log(ERROR, "broken socket for server %" PRIu16,
+                      _anjay_server_ssid(ref.server));
+            if (_anjay_schedule_server_reconnect(anjay, ref.server)) {
+                anjay_log(ERROR,
+                          "could not schedule reconnect for server %" PRIu16,
+                          _anjay_server_ssid(ref.server));
+            }
+            return -1;
+        }
+        if (!session_resumed) {
+            if (_anjay_schedule_reregister(anjay, ref.server)) {
+                anjay_log(ERROR,
+                          "could not schedule reregister for server %" PRIu16,
+                          _anjay_server_ssid(ref.server));
+            }
+            return AVS_COAP_CTX_ERR_NETWORK;
+        }
+    }
+    return 0;
+}
+
 int _anjay_get_security_info(anjay_t *anjay,
                              avs_net_security_info_t *out_net_info,
                              anjay_server_dtls_keys_t *out_dtls_keys,
@@ -831,6 +926,12 @@ queue_mode_close_socket_args_decode(void *value) {
     return result;
 }
 
+/**
+ * The queue mode socket close may happen up to MAX_TRANSMIT_WAIT divided by
+ * this value before MAX_TRANSMIT_WAIT elapses.
+ */
+#define QUEUE_MODE_CLOSE_SLACK_DIVISOR 16
+
 static void queue_mode_close_socket(anjay_t *anjay, void *args_) {
     queue_mode_close_socket_args_t args =
             queue_mode_close_socket_args_decode(args_);
@@ -861,11 +962,17 @@ _anjay_connection_schedule_queue_mode_close(anjay_t *anjay,
         .ssid = ref.server->ssid,
         .conn_type = (uint16_t) ref.conn_type
     };
-    // see comment on field declaration for logic summary
-    if (_anjay_sched(anjay->sched,
-                     &connection->queue_mode_close_socket_clb_handle,
-                     delay, queue_mode_close_socket,
-                     queue_mode_close_socket_args_encode(args))) {
+    // see comment on field declaration for logic summary; the socket is never
+    // kept open past MAX_TRANSMIT_WAIT, as that would defeat the purpose of
+    // Queue Mode, but the close may happen slightly earlier if that lets it
+    // share a wakeup with other jobs
+    avs_time_duration_t slack =
+            avs_time_duration_div(delay, QUEUE_MODE_CLOSE_SLACK_DIVISOR);
+    if (_anjay_sched_with_slack(anjay->sched,
+                                &connection->queue_mode_close_socket_clb_handle,
+                                avs_time_duration_diff(delay, slack), slack,
+                                queue_mode_close_socket,
+                                queue_mode_close_socket_args_encode(args))) {
         anjay_log(ERROR, "could not schedule queue mode operations");
     }
 }
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#ifdef WITH_AVS_PERSISTENCE
+#include <avsystem/commons/persistence.h>
+#endif // WITH_AVS_PERSISTENCE
+
+#include <string.h>
+
+#define ANJAY_SERVERS_INTERNALS
+
+#include "../anjay_core.h"
+
+#include "connection_info.h"
+#include "servers_internal.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+void _anjay_server_apply_restored_state(anjay_servers_t *servers,
+                                        anjay_server_info_t *server) {
+    AVS_LIST(anjay_server_restored_state_t) *state_ptr;
+    AVS_LIST_FOREACH_PTR(state_ptr, &servers->restored_states) {
+        if ((*state_ptr)->ssid >= server->ssid) {
+            break;
+        }
+    }
+    if (*state_ptr && (*state_ptr)->ssid == server->ssid) {
+        anjay_log(DEBUG, "using restored connection state for SSID %u",
+                  server->ssid);
+        server->data_active.udp_connection.nontransient_state =
+                (*state_ptr)->state;
+        AVS_LIST_DELETE(state_ptr);
+    }
+}
+
+#ifdef WITH_AVS_PERSISTENCE
+
+static const char MAGIC[] = { 'C', 'O', 'N', '\0' };
+
+static bool state_empty(
+        const anjay_server_connection_nontransient_state_t *state) {
+    static const anjay_server_connection_nontransient_state_t EMPTY;
+    return !memcmp(state, &EMPTY, sizeof(*state));
+}
+
+/**
+ * The nontransient state is stored as raw memory, so the stored data may only
+ * be restored by a binary built with the same buffer sizes.
+ */
+static int handle_layout(avs_persistence_context_t *ctx) {
+    const uint32_t sizes[] = {
+        sizeof(((anjay_server_connection_nontransient_state_t *) 0)
+                       ->preferred_endpoint),
+        sizeof(((anjay_server_connection_nontransient_state_t *) 0)
+                       ->dtls_session_buffer),
+        sizeof(((anjay_server_connection_nontransient_state_t *) 0)
+                       ->last_local_port)
+    };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(sizes); ++i) {
+        uint32_t value = sizes[i];
+        int retval = avs_persistence_u32(ctx, &value);
+        if (retval) {
+            return retval;
+        }
+        if (value != sizes[i]) {
+            anjay_log(ERROR, "connection state was stored with incompatible "
+                             "buffer sizes");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int handle_state(avs_persistence_context_t *ctx,
+                        void *element_,
+                        void *user_data) {
+    (void) user_data;
+    anjay_server_restored_state_t *element =
+            (anjay_server_restored_state_t *) element_;
+    int retval = 0;
+    (void) ((retval = avs_persistence_u16(ctx, &element->ssid))
+            || (retval = avs_persistence_bytes(
+                        ctx, &element->state.preferred_endpoint,
+                        sizeof(element->state.preferred_endpoint)))
+            || (retval = avs_persistence_bytes(
+                        ctx, element->state.dtls_session_buffer,
+                        sizeof(element->state.dtls_session_buffer)))
+            || (retval = avs_persistence_bytes(
+                        ctx, element->state.last_local_port,
+                        sizeof(element->state.last_local_port))));
+    if (!retval) {
+        element->state.last_local_port[
+                sizeof(element->state.last_local_port) - 1] = '\0';
+    }
+    return retval;
+}
+
+static int
+append_state(AVS_LIST(anjay_server_restored_state_t) **tail_ptr_ptr,
+             anjay_ssid_t ssid,
+             const anjay_server_connection_nontransient_state_t *state) {
+    AVS_LIST(anjay_server_restored_state_t) entry =
+            AVS_LIST_NEW_ELEMENT(anjay_server_restored_state_t);
+    if (!entry) {
+        anjay_log(ERROR, "out of memory");
+        return -1;
+    }
+    entry->ssid = ssid;
+    entry->state = *state;
+    AVS_LIST_INSERT(*tail_ptr_ptr, entry);
+    *tail_ptr_ptr = AVS_LIST_NEXT_PTR(*tail_ptr_ptr);
+    return 0;
+}
+
+/**
+ * Gathers the states to persist, ordered by SSID. States restored earlier that
+ * have not been applied yet take precedence over the (necessarily unused)
+ * state of the server entry with the same SSID.
+ */
+static int snapshot_states(anjay_servers_t *servers,
+                           AVS_LIST(anjay_server_restored_state_t) *out) {
+    AVS_LIST(anjay_server_restored_state_t) *tail_ptr = out;
+    AVS_LIST(anjay_server_info_t) server = servers->servers;
+    AVS_LIST(anjay_server_restored_state_t) restored =
+            servers->restored_states;
+    int result = 0;
+    while (!result && (server || restored)) {
+        if (restored && (!server || restored->ssid <= server->ssid)) {
+            if (server && server->ssid == restored->ssid) {
+                server = AVS_LIST_NEXT(server);
+            }
+            result = append_state(&tail_ptr, restored->ssid, &restored->state);
+            restored = AVS_LIST_NEXT(restored);
+        } else {
+            const anjay_server_connection_nontransient_state_t *state =
+                    &server->data_active.udp_connection.nontransient_state;
+            if (!state_empty(state)) {
+                result = append_state(&tail_ptr, server->ssid, state);
+            }
+            server = AVS_LIST_NEXT(server);
+        }
+    }
+    if (result) {
+        AVS_LIST_CLEAR(out);
+    }
+    return result;
+}
+
+int anjay_connection_state_persist(anjay_t *anjay,
+                                   avs_stream_abstract_t *out_stream) {
+    assert(anjay);
+
+    AVS_LIST(anjay_server_restored_state_t) states = NULL;
+    if (snapshot_states(anjay->servers, &states)) {
+        return -1;
+    }
+    int retval = avs_stream_write(out_stream, MAGIC, sizeof(MAGIC));
+    if (retval) {
+        goto finish;
+    }
+    avs_persistence_context_t *ctx =
+            avs_persistence_store_context_new(out_stream);
+    if (!ctx) {
+        anjay_log(ERROR, "out of memory");
+        retval = -1;
+        goto finish;
+    }
+    (void) ((retval = handle_layout(ctx))
+            || (retval = avs_persistence_list(ctx, (AVS_LIST(void) *) &states,
+                                              sizeof(*states), handle_state,
+                                              NULL, NULL)));
+    avs_persistence_context_delete(ctx);
+    if (!retval) {
+        anjay_log(INFO, "connection state of %lu servers persisted",
+                  (unsigned long) AVS_LIST_SIZE(states));
+    }
+finish:
+    AVS_LIST_CLEAR(&states);
+    return retval;
+}
+
+static int validate_restored_states(
+        AVS_LIST(const anjay_server_restored_state_t) states) {
+    AVS_LIST(const anjay_server_restored_state_t) it;
+    AVS_LIST_FOREACH(it, states) {
+        if (AVS_LIST_NEXT(it) && AVS_LIST_NEXT(it)->ssid <= it->ssid) {
+            anjay_log(ERROR, "restored connection states are not ordered "
+                             "by SSID");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int anjay_connection_state_restore(anjay_t *anjay,
+                                   avs_stream_abstract_t *in_stream) {
+    assert(anjay);
+
+    char magic_header[sizeof(MAGIC)];
+    int retval = avs_stream_read_reliably(in_stream, magic_header,
+                                          sizeof(magic_header));
+    if (retval) {
+        anjay_log(ERROR, "could not read connection state header");
+        return retval;
+    }
+    if (memcmp(magic_header, MAGIC, sizeof(MAGIC))) {
+        anjay_log(ERROR, "header magic constant mismatch");
+        return -1;
+    }
+    avs_persistence_context_t *ctx =
+            avs_persistence_restore_context_new(in_stream);
+    if (!ctx) {
+        anjay_log(ERROR, "cannot create persistence restore context");
+        return -1;
+    }
+    AVS_LIST(anjay_server_restored_state_t) states = NULL;
+    (void) ((retval = handle_layout(ctx))
+            || (retval = avs_persistence_list(ctx, (AVS_LIST(void) *) &states,
+                                              sizeof(*states), handle_state,
+                                              NULL, NULL))
+            || (retval = validate_restored_states(states)));
+    avs_persistence_context_delete(ctx);
+    if (retval) {
+        AVS_LIST_CLEAR(&states);
+        return retval;
+    }
+    AVS_LIST_CLEAR(&anjay->servers->restored_states);
+    anjay->servers->restored_states = states;
+    anjay_log(INFO, "connection state of %lu servers restored",
+              (unsigned long) AVS_LIST_SIZE(states));
+    return 0;
+}
+
+#ifdef ANJAY_TEST
+#include "test/connection_persistence.c"
+#endif
+
+#else // WITH_AVS_PERSISTENCE
+
+int anjay_connection_state_persist(anjay_t *anjay,
+                                   avs_stream_abstract_t *out_stream) {
+    (void) anjay; (void) out_stream;
+    anjay_log(ERROR, "Persistence not compiled in");
+    return -1;
+}
+
+int anjay_connection_state_restore(anjay_t *anjay,
+                                   avs_stream_abstract_t *in_stream) {
+    (void) anjay; (void) in_stream;
+    anjay_log(ERROR, "Persistence not compiled in");
+    return -1;
+}
+
+#endif // WITH_AVS_PERSISTENCE
@@ -103,15 +103,19 @@ static int
 schedule_update(anjay_t *anjay,
                 anjay_sched_handle_t *out_handle,
                 const anjay_server_info_t *server,
-                avs_time_duration_t delay) {
+                avs_time_duration_t delay,
+                avs_time_duration_t slack) {
     anjay_log(DEBUG, "scheduling update for SSID %u after "
-                     "%" PRId64 ".%09" PRId32,
-              server->ssid, delay.seconds, delay.nanoseconds);
-
-    return _anjay_sched_retryable(anjay->sched, out_handle, delay,
-                                  ANJAY_SERVER_RETRYABLE_BACKOFF,
-                                  send_update_sched_job,
-                                  (void *) (uintptr_t) server->ssid);
+                     "%" PRId64 ".%09" PRId32 " (slack %" PRId64 ".%09" PRId32
+                     ")",
+              server->ssid, delay.seconds, delay.nanoseconds,
+              slack.seconds, slack.nanoseconds);
+
+    return _anjay_sched_retryable_with_slack(anjay->sched, out_handle, delay,
+                                             slack,
+                                             ANJAY_SERVER_RETRYABLE_BACKOFF,
+                                             send_update_sched_job,
+                                             (void *) (uintptr_t) server->ssid);
 }
 
 static int
@@ -130,7 +134,21 @@ schedule_next_update(anjay_t *anjay,
                                                   AVS_TIME_S);
     }
 
-    return schedule_update(anjay, out_handle, server, remaining);
+    // Sending the Update early is always safe, so allow it to happen up to one
+    // more interval margin before the regular time, so that it may share
+    // a wakeup with e.g. notifications
+    avs_time_duration_t earliest =
+            avs_time_duration_diff(remaining, interval_margin);
+    if (earliest.seconds < ANJAY_MIN_UPDATE_INTERVAL_S) {
+        earliest = avs_time_duration_from_scalar(ANJAY_MIN_UPDATE_INTERVAL_S,
+                                                 AVS_TIME_S);
+    }
+    if (avs_time_duration_less(remaining, earliest)) {
+        earliest = remaining;
+    }
+
+    return schedule_update(anjay, out_handle, server, earliest,
+                           avs_time_duration_diff(remaining, earliest));
 }
 
 bool _anjay_server_primary_connection_valid(anjay_server_info_t *server) {
@@ -174,7 +192,8 @@ static int reschedule_update_for_server(anjay_t *anjay,
                                         anjay_server_info_t *server) {
     _anjay_sched_del(anjay->sched, &server->sched_update_or_reactivate_handle);
     if (schedule_update(anjay, &server->sched_update_or_reactivate_handle,
-                        server, AVS_TIME_DURATION_ZERO)) {
+                        server, AVS_TIME_DURATION_ZERO,
+                        AVS_TIME_DURATION_ZERO)) {
         anjay_log(ERROR, "could not schedule send_update_sched_job");
         return -1;
     }
@@ -170,6 +170,10 @@ static void reload_servers_sched_job(anjay_t *anjay, void *unused) {
 
     anjay_servers_t old_servers = *anjay->servers;
     memset(anjay->servers, 0, sizeof(*anjay->servers));
+    anjay->servers->restored_states = old_servers.restored_states;
+    old_servers.restored_states = NULL;
+    anjay->servers->security_cache = old_servers.security_cache;
+    old_servers.security_cache = NULL;
     reload_servers_state_t reload_state = {
         .old_servers = &old_servers,
         .retval = 0
@@ -18,6 +18,7 @@
 
 #include <errno.h>
 #include <inttypes.h>
+#include <string.h>
 
 #include <anjay_modules/time_defs.h>
 
@@ -82,6 +83,8 @@ void _anjay_servers_internal_cleanup(anjay_t *anjay,
         _anjay_server_cleanup(anjay, servers->servers);
     }
     AVS_LIST_CLEAR(&servers->public_sockets);
+    AVS_LIST_CLEAR(&servers->restored_states);
+    AVS_LIST_CLEAR(&servers->security_cache);
 }
 
 void _anjay_servers_deregister(anjay_t *anjay) {
@@ -282,6 +285,28 @@ anjay_server_info_t *_anjay_servers_find_active(anjay_servers_t *servers,
     return (ptr && *ptr && _anjay_server_active(*ptr)) ? *ptr : NULL;
 }
 
+anjay_server_config_cache_t *
+_anjay_servers_config_cache(anjay_t *anjay, anjay_ssid_t ssid) {
+    if (!anjay->servers) {
+        return NULL;
+    }
+    // not using _anjay_servers_find_ptr(), as this is called for every
+    // notification and a missing server is not worth logging
+    AVS_LIST(anjay_server_info_t) *ptr =
+            _anjay_servers_find_insert_ptr(anjay->servers, ssid);
+    return (*ptr && (*ptr)->ssid == ssid) ? &(*ptr)->config_cache : NULL;
+}
+
+void _anjay_servers_invalidate_config_cache(anjay_t *anjay) {
+    if (!anjay->servers) {
+        return;
+    }
+    AVS_LIST(anjay_server_info_t) server;
+    AVS_LIST_FOREACH(server, anjay->servers->servers) {
+        memset(&server->config_cache, 0, sizeof(server->config_cache));
+    }
+}
+
 static bool is_valid_coap_uri(const anjay_url_t *uri) {
     if (strcmp(uri->protocol, "coap") && strcmp(uri->protocol, "coaps")) {
         anjay_log(ERROR, "unsupported protocol: %s", uri->protocol);
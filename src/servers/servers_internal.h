@@ -29,16 +29,44 @@
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
+typedef struct {
+    anjay_ssid_t ssid;
+    anjay_server_connection_nontransient_state_t state;
+} anjay_server_restored_state_t;
+
+typedef struct {
+    anjay_iid_t security_iid;
+    anjay_udp_security_mode_t udp_security_mode;
+    anjay_server_dtls_keys_t dtls_keys;
+} anjay_security_cache_entry_t;
+
 struct anjay_servers_struct {
     AVS_LIST(anjay_server_info_t) servers;
 
     AVS_LIST(anjay_socket_entry_t) public_sockets;
+
+    /**
+     * Connection states loaded by @ref anjay_connection_state_restore,
+     * sorted by SSID, that have not yet been applied to a server entry. Each
+     * entry is consumed by the first activation of a server with matching SSID.
+     */
+    AVS_LIST(anjay_server_restored_state_t) restored_states;
+
+    /**
+     * Security mode and key material read from the Security object, sorted by
+     * Security IID, so that reconnecting does not need to query the data model
+     * each time. An entry is dropped whenever the corresponding Security
+     * Object Instance is notified as changed.
+     */
+    AVS_LIST(anjay_security_cache_entry_t) security_cache;
 };
 
 struct anjay_server_info_struct {
     anjay_ssid_t ssid; // or ANJAY_SSID_BOOTSTRAP
     anjay_sched_handle_t sched_update_or_reactivate_handle;
 
+    anjay_server_config_cache_t config_cache;
+
     // These fields are valid only for active servers
     struct {
         anjay_url_t uri;
@@ -98,6 +126,15 @@ _anjay_servers_find_insert_ptr(anjay_servers_t *servers, anjay_ssid_t ssid);
 AVS_LIST(anjay_server_info_t) *
 _anjay_servers_find_ptr(anjay_servers_t *servers, anjay_ssid_t ssid);
 
+/**
+ * If a connection state for @p server has been restored from persistence and
+ * not yet used, moves it into the server's connection, so that the subsequent
+ * connection attempt may reuse the preferred endpoint and resume the DTLS
+ * session.
+ */
+void _anjay_server_apply_restored_state(anjay_servers_t *servers,
+                                        anjay_server_info_t *server);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif // ANJAY_SERVERS_SERVERS_H
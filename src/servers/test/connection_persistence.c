@@ -0,0 +1,92 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/stream/stream_membuf.h>
+#include <avsystem/commons/unit/test.h>
+
+#include "../activate.h"
+
+static const anjay_configuration_t CONFIG = {
+    .endpoint_name = "test"
+};
+
+static anjay_server_info_t *add_server(anjay_t *anjay, anjay_ssid_t ssid) {
+    AVS_LIST(anjay_server_info_t) server = _anjay_servers_create_inactive(ssid);
+    AVS_UNIT_ASSERT_NOT_NULL(server);
+    _anjay_servers_add(anjay->servers, server);
+    return server;
+}
+
+static void fill_state(anjay_server_connection_nontransient_state_t *state,
+                       char seed) {
+    memset(&state->preferred_endpoint, seed,
+           sizeof(state->preferred_endpoint));
+    memset(state->dtls_session_buffer, seed + 1,
+           sizeof(state->dtls_session_buffer));
+    strcpy(state->last_local_port, "5683");
+}
+
+AVS_UNIT_TEST(connection_persistence, persist_and_restore) {
+    anjay_t *stored = anjay_new(&CONFIG);
+    AVS_UNIT_ASSERT_NOT_NULL(stored);
+    anjay_t *restored = anjay_new(&CONFIG);
+    AVS_UNIT_ASSERT_NOT_NULL(restored);
+    avs_stream_abstract_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+
+    fill_state(&add_server(stored, 1)->data_active.udp_connection
+                       .nontransient_state, 'a');
+    // server that never connected - nothing to persist
+    add_server(stored, 2);
+    fill_state(&add_server(stored, ANJAY_SSID_BOOTSTRAP)
+                       ->data_active.udp_connection.nontransient_state, 'x');
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_connection_state_persist(stored, stream));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_connection_state_restore(restored, stream));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(restored->servers->restored_states), 2);
+
+    anjay_server_info_t *server = add_server(restored, 1);
+    _anjay_server_apply_restored_state(restored->servers, server);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            &server->data_active.udp_connection.nontransient_state,
+            &stored->servers->servers->data_active.udp_connection
+                    .nontransient_state,
+            sizeof(anjay_server_connection_nontransient_state_t));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(restored->servers->restored_states), 1);
+    AVS_UNIT_ASSERT_EQUAL(restored->servers->restored_states->ssid,
+                          ANJAY_SSID_BOOTSTRAP);
+
+    // the state not yet applied is persisted again
+    AVS_UNIT_ASSERT_SUCCESS(anjay_connection_state_persist(restored, stream));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_connection_state_restore(stored, stream));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(stored->servers->restored_states), 2);
+
+    avs_stream_cleanup(&stream);
+    anjay_delete(stored);
+    anjay_delete(restored);
+}
+
+AVS_UNIT_TEST(connection_persistence, invalid_magic) {
+    anjay_t *anjay = anjay_new(&CONFIG);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    avs_stream_abstract_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "SRV", 4));
+    AVS_UNIT_ASSERT_FAILED(anjay_connection_state_restore(anjay, stream));
+    AVS_UNIT_ASSERT_NULL(anjay->servers->restored_states);
+    avs_stream_cleanup(&stream);
+    anjay_delete(anjay);
+}
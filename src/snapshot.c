@@ -0,0 +1,386 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <anjay_config.h>
+
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <avsystem/commons/stream/stream_inbuf.h>
+#include <avsystem/commons/stream/stream_membuf.h>
+#include <avsystem/commons/utils.h>
+
+#include <anjay_modules/raw_buffer.h>
+
+#include "anjay_core.h"
+#include "utils_core.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#ifdef WITH_AVS_PERSISTENCE
+
+/*
+ * Snapshot layout (all integers are big-endian):
+ *
+ * - MAGIC
+ * - u16 version
+ * - u16 number of sections
+ * - for each section:
+ *   - u8 name length, name (not NUL-terminated)
+ *   - u32 payload size, payload
+ * - u32 CRC-32 of all the preceding bytes
+ */
+static const char MAGIC[] = { 'S', 'N', 'P', '\0' };
+
+#define SNAPSHOT_VERSION 1
+
+#define SNAPSHOT_HEADER_SIZE (sizeof(MAGIC) + 2 * sizeof(uint16_t))
+
+static const char CONNECTION_SECTION_NAME[] = "connection";
+
+static int
+buffer_append(anjay_raw_buffer_t *buf, const void *data, size_t size) {
+    if (_anjay_raw_buffer_append(buf, data, size)) {
+        anjay_log(ERROR, "out of memory");
+        return -1;
+    }
+    return 0;
+}
+
+static int buffer_append_u16(anjay_raw_buffer_t *buf, uint16_t value) {
+    value = avs_convert_be16(value);
+    return buffer_append(buf, &value, sizeof(value));
+}
+
+static int buffer_append_u32(anjay_raw_buffer_t *buf, uint32_t value) {
+    value = avs_convert_be32(value);
+    return buffer_append(buf, &value, sizeof(value));
+}
+
+static int append_section(anjay_t *anjay,
+                          anjay_raw_buffer_t *buf,
+                          const char *name,
+                          anjay_dm_module_persist_t *persist) {
+    size_t name_length = strlen(name);
+    assert(name_length > 0 && name_length <= UINT8_MAX);
+    const uint8_t name_length8 = (uint8_t) name_length;
+
+    avs_stream_abstract_t *section = avs_stream_membuf_create();
+    if (!section) {
+        anjay_log(ERROR, "out of memory");
+        return -1;
+    }
+    int retval;
+    size_t payload_offset = 0;
+    (void) ((retval = persist(anjay, section))
+            || (retval = buffer_append(buf, &name_length8, 1))
+            || (retval = buffer_append(buf, name, name_length))
+            || (retval = buffer_append_u32(buf, 0))
+            || (payload_offset = buf->size,
+                retval = _anjay_raw_buffer_append_stream(buf, section)));
+    avs_stream_cleanup(&section);
+    if (retval) {
+        anjay_log(ERROR, "could not persist snapshot section: %s", name);
+        return retval;
+    }
+    if (buf->size - payload_offset > UINT32_MAX) {
+        anjay_log(ERROR, "snapshot section too large: %s", name);
+        return -1;
+    }
+    const uint32_t payload_size =
+            avs_convert_be32((uint32_t) (buf->size - payload_offset));
+    memcpy((char *) buf->data + payload_offset - sizeof(payload_size),
+           &payload_size, sizeof(payload_size));
+    return 0;
+}
+
+static int append_module_sections(anjay_t *anjay,
+                                  anjay_raw_buffer_t *buf,
+                                  anjay_dm_module_snapshot_stage_t stage,
+                                  uint16_t *inout_count) {
+    AVS_LIST(anjay_dm_installed_module_t) module;
+    AVS_LIST_FOREACH(module, anjay->dm.modules) {
+        const anjay_dm_module_t *def = module->def;
+        if (!def->snapshot_name || def->snapshot_stage != stage) {
+            continue;
+        }
+        assert(def->persist && def->restore);
+        if (*inout_count == UINT16_MAX) {
+            anjay_log(ERROR, "too many snapshot sections");
+            return -1;
+        }
+        int retval = append_section(anjay, buf, def->snapshot_name,
+                                    def->persist);
+        if (retval) {
+            return retval;
+        }
+        ++*inout_count;
+    }
+    return 0;
+}
+
+int anjay_snapshot_persist(anjay_t *anjay, avs_stream_abstract_t *out_stream) {
+    assert(anjay);
+
+    anjay_raw_buffer_t buf = ANJAY_RAW_BUFFER_EMPTY;
+    uint16_t count = 0;
+    int retval;
+    (void) ((retval = buffer_append(&buf, MAGIC, sizeof(MAGIC)))
+            || (retval = buffer_append_u16(&buf, SNAPSHOT_VERSION))
+            // placeholder for the number of sections
+            || (retval = buffer_append_u16(&buf, 0))
+            || (retval = append_module_sections(
+                        anjay, &buf, ANJAY_DM_MODULE_SNAPSHOT_OBJECTS, &count))
+            || (retval = append_module_sections(
+                        anjay, &buf, ANJAY_DM_MODULE_SNAPSHOT_METADATA,
+                        &count))
+            || (retval = append_section(anjay, &buf, CONNECTION_SECTION_NAME,
+                                        anjay_connection_state_persist)));
+    if (!retval) {
+        ++count;
+        const uint16_t count_be = avs_convert_be16(count);
+        memcpy((char *) buf.data + sizeof(MAGIC) + sizeof(uint16_t), &count_be,
+               sizeof(count_be));
+        (void) ((retval = buffer_append_u32(
+                         &buf, _anjay_crc32(0, buf.data, buf.size)))
+                || (retval = avs_stream_write(out_stream, buf.data,
+                                              buf.size)));
+    }
+    if (!retval) {
+        anjay_log(INFO, "snapshot with %" PRIu16 " sections persisted (%lu B)",
+                  count, (unsigned long) buf.size);
+    }
+    _anjay_raw_buffer_clear(&buf);
+    return retval;
+}
+
+typedef struct {
+    const uint8_t *ptr;
+    size_t left;
+} snapshot_reader_t;
+
+static const void *reader_take(snapshot_reader_t *reader, size_t size) {
+    if (reader->left < size) {
+        return NULL;
+    }
+    const void *result = reader->ptr;
+    reader->ptr += size;
+    reader->left -= size;
+    return result;
+}
+
+static int reader_u8(snapshot_reader_t *reader, uint8_t *out) {
+    const void *data = reader_take(reader, sizeof(*out));
+    if (!data) {
+        return -1;
+    }
+    memcpy(out, data, sizeof(*out));
+    return 0;
+}
+
+static int reader_u16(snapshot_reader_t *reader, uint16_t *out) {
+    const void *data = reader_take(reader, sizeof(*out));
+    if (!data) {
+        return -1;
+    }
+    memcpy(out, data, sizeof(*out));
+    *out = avs_convert_be16(*out);
+    return 0;
+}
+
+static int reader_u32(snapshot_reader_t *reader, uint32_t *out) {
+    const void *data = reader_take(reader, sizeof(*out));
+    if (!data) {
+        return -1;
+    }
+    memcpy(out, data, sizeof(*out));
+    *out = avs_convert_be32(*out);
+    return 0;
+}
+
+typedef struct {
+    const char *name;
+    size_t name_length;
+    const void *payload;
+    size_t payload_size;
+} snapshot_section_t;
+
+static int read_section(snapshot_reader_t *reader, snapshot_section_t *out) {
+    uint8_t name_length;
+    uint32_t payload_size;
+    if (reader_u8(reader, &name_length) || !name_length
+            || !(out->name = (const char *) reader_take(reader, name_length))
+            || reader_u32(reader, &payload_size)
+            || !(out->payload = reader_take(reader, payload_size))) {
+        anjay_log(ERROR, "malformed snapshot section");
+        return -1;
+    }
+    out->name_length = name_length;
+    out->payload_size = payload_size;
+    return 0;
+}
+
+static bool section_name_equal(const snapshot_section_t *section,
+                               const char *name) {
+    return strlen(name) == section->name_length
+           && !memcmp(section->name, name, section->name_length);
+}
+
+static anjay_dm_module_restore_t *
+find_restore_handler(anjay_t *anjay, const snapshot_section_t *section) {
+    if (section_name_equal(section, CONNECTION_SECTION_NAME)) {
+        return anjay_connection_state_restore;
+    }
+    AVS_LIST(anjay_dm_installed_module_t) module;
+    AVS_LIST_FOREACH(module, anjay->dm.modules) {
+        if (module->def->snapshot_name
+                && section_name_equal(section, module->def->snapshot_name)) {
+            return module->def->restore;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Checks the header, the checksum and the framing of all sections, so that
+ * nothing is restored from a damaged or incompatible snapshot. On success,
+ * @p out_reader is positioned at the first section.
+ */
+static int validate_snapshot(const void *data,
+                             size_t size,
+                             snapshot_reader_t *out_reader,
+                             uint16_t *out_count) {
+    uint32_t crc;
+    if (size < SNAPSHOT_HEADER_SIZE + sizeof(crc)) {
+        anjay_log(ERROR, "snapshot too short");
+        return -1;
+    }
+    if (memcmp(data, MAGIC, sizeof(MAGIC))) {
+        anjay_log(ERROR, "snapshot magic constant mismatch");
+        return -1;
+    }
+    snapshot_reader_t reader = {
+        .ptr = (const uint8_t *) data + size - sizeof(crc),
+        .left = sizeof(crc)
+    };
+    if (reader_u32(&reader, &crc)
+            || crc != _anjay_crc32(0, data, size - sizeof(crc))) {
+        anjay_log(ERROR, "snapshot checksum mismatch");
+        return -1;
+    }
+
+    reader.ptr = (const uint8_t *) data + sizeof(MAGIC);
+    reader.left = size - sizeof(MAGIC) - sizeof(crc);
+    uint16_t version;
+    if (reader_u16(&reader, &version) || reader_u16(&reader, out_count)) {
+        return -1;
+    }
+    if (version != SNAPSHOT_VERSION) {
+        anjay_log(ERROR, "unsupported snapshot version: %" PRIu16, version);
+        return -1;
+    }
+    *out_reader = reader;
+    for (uint16_t i = 0; i < *out_count; ++i) {
+        snapshot_section_t section;
+        if (read_section(&reader, &section)) {
+            return -1;
+        }
+    }
+    if (reader.left) {
+        anjay_log(ERROR, "unexpected data after the last snapshot section");
+        return -1;
+    }
+    return 0;
+}
+
+int anjay_snapshot_restore_from_buffer(anjay_t *anjay,
+                                       const void *data,
+                                       size_t size) {
+    assert(anjay);
+
+    snapshot_reader_t reader;
+    uint16_t count;
+    if (validate_snapshot(data, size, &reader, &count)) {
+        return -1;
+    }
+    for (uint16_t i = 0; i < count; ++i) {
+        snapshot_section_t section;
+        int retval = read_section(&reader, &section);
+        assert(!retval);
+
+        anjay_dm_module_restore_t *restore =
+                find_restore_handler(anjay, &section);
+        if (!restore) {
+            anjay_log(WARNING, "ignoring snapshot section of a module that is "
+                               "not installed: %.*s",
+                      (int) section.name_length, section.name);
+            continue;
+        }
+        avs_stream_inbuf_t inbuf = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+        avs_stream_inbuf_set_buffer(&inbuf, section.payload,
+                                    section.payload_size);
+        if ((retval = restore(anjay, (avs_stream_abstract_t *) &inbuf))) {
+            anjay_log(ERROR, "could not restore snapshot section: %.*s",
+                      (int) section.name_length, section.name);
+            return retval;
+        }
+    }
+    anjay_log(INFO, "snapshot with %" PRIu16 " sections restored", count);
+    return 0;
+}
+
+int anjay_snapshot_restore(anjay_t *anjay, avs_stream_abstract_t *in_stream) {
+    assert(anjay);
+
+    anjay_raw_buffer_t buf = ANJAY_RAW_BUFFER_EMPTY;
+    int retval = _anjay_raw_buffer_append_stream(&buf, in_stream);
+    if (retval) {
+        anjay_log(ERROR, "could not read snapshot");
+    } else {
+        retval = anjay_snapshot_restore_from_buffer(anjay, buf.data, buf.size);
+    }
+    _anjay_raw_buffer_clear(&buf);
+    return retval;
+}
+
+#ifdef ANJAY_TEST
+#include "test/snapshot.c"
+#endif // ANJAY_TEST
+
+#else // WITH_AVS_PERSISTENCE
+
+int anjay_snapshot_persist(anjay_t *anjay, avs_stream_abstract_t *out_stream) {
+    (void) anjay; (void) out_stream;
+    anjay_log(ERROR, "Persistence not compiled in");
+    return -1;
+}
+
+int anjay_snapshot_restore(anjay_t *anjay, avs_stream_abstract_t *in_stream) {
+    (void) anjay; (void) in_stream;
+    anjay_log(ERROR, "Persistence not compiled in");
+    return -1;
+}
+
+int anjay_snapshot_restore_from_buffer(anjay_t *anjay,
+                                       const void *data,
+                                       size_t size) {
+    (void) anjay; (void) data; (void) size;
+    anjay_log(ERROR, "Persistence not compiled in");
+    return -1;
+}
+
+#endif // WITH_AVS_PERSISTENCE
@@ -754,6 +754,47 @@ AVS_UNIT_TEST(queue_mode, change) {
     DM_TEST_FINISH;
 }
 
+static void expect_read_security_mode(anjay_t *anjay,
+                                      anjay_iid_t iid,
+                                      anjay_udp_security_mode_t mode) {
+    _anjay_mock_dm_expect_resource_present(anjay, &FAKE_SECURITY2, iid,
+                                           ANJAY_DM_RID_SECURITY_MODE, 1);
+    _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SECURITY2, iid,
+                                        ANJAY_DM_RID_SECURITY_MODE, 0,
+                                        ANJAY_MOCK_DM_INT(0, mode));
+}
+
+AVS_UNIT_TEST(security_cache, reads_data_model_once) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ, &FAKE_SECURITY2, &FAKE_SERVER);
+    (void) mocksocks;
+    avs_net_security_info_t security_info;
+    anjay_server_dtls_keys_t dtls_keys;
+
+    expect_read_security_mode(anjay, 1, ANJAY_UDP_SECURITY_NOSEC);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_get_security_info(
+            anjay, &security_info, &dtls_keys, 1, ANJAY_CONNECTION_UDP));
+    // served from cache
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_get_security_info(
+            anjay, &security_info, &dtls_keys, 1, ANJAY_CONNECTION_UDP));
+
+    // other instances are not affected by invalidation
+    expect_read_security_mode(anjay, 2, ANJAY_UDP_SECURITY_NOSEC);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_get_security_info(
+            anjay, &security_info, &dtls_keys, 2, ANJAY_CONNECTION_UDP));
+    _anjay_servers_invalidate_security_cache(anjay, 1);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_get_security_info(
+            anjay, &security_info, &dtls_keys, 2, ANJAY_CONNECTION_UDP));
+
+    expect_read_security_mode(anjay, 1, ANJAY_UDP_SECURITY_NOSEC);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_get_security_info(
+            anjay, &security_info, &dtls_keys, 1, ANJAY_CONNECTION_UDP));
+
+    _anjay_servers_invalidate_security_cache(anjay, ANJAY_IID_INVALID);
+    AVS_UNIT_ASSERT_NULL(anjay->servers->security_cache);
+
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(anjay_new, no_endpoint_name) {
     const anjay_configuration_t configuration = {
         .endpoint_name = NULL,
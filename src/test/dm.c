@@ -191,6 +191,71 @@ AVS_UNIT_TEST(dm_read, instance_some) {
     DM_TEST_FINISH;
 }
 
+static int bulk_instance_read(anjay_t *anjay,
+                              const anjay_dm_object_def_t *const *obj_ptr,
+                              anjay_iid_t iid,
+                              anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+    if (anjay_ret_resource_id(ctx, 0)
+            || anjay_ret_i32(ctx, 69)
+            || anjay_ret_resource_id(ctx, 6)
+            || anjay_ret_string(ctx, "Hello")) {
+        return ANJAY_ERR_INTERNAL;
+    }
+    return 0;
+}
+
+static const anjay_dm_object_def_t *const OBJ_WITH_INSTANCE_READ =
+        &(const anjay_dm_object_def_t) {
+            .oid = 42,
+            .supported_rids = ANJAY_DM_SUPPORTED_RIDS(0, 1, 2, 3, 4, 5, 6),
+            .handlers = {
+                ANJAY_MOCK_DM_HANDLERS,
+                .instance_read = bulk_instance_read
+            }
+        };
+
+AVS_UNIT_TEST(dm_read, instance_bulk) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ_WITH_INSTANCE_READ, &FAKE_SECURITY);
+    static const char REQUEST[] =
+            "\x40\x01\xFA\x3E" // CoAP header
+            "\xB2" "42" // OID
+            "\x02" "13"; // IID
+    avs_unit_mocksock_input(mocksocks[0], REQUEST, sizeof(REQUEST) - 1);
+    // no per-Resource handlers are called
+    _anjay_mock_dm_expect_instance_present(anjay, &OBJ_WITH_INSTANCE_READ, 13,
+                                           1);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0],
+            "\x60\x45\xFA\x3E" // CoAP header
+            "\xc2\x2d\x16" // Content-Format
+            "\xff"
+            "\xc1\x00\x45"
+            "\xc5\x06" "Hello");
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_read, object_bulk) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ_WITH_INSTANCE_READ, &FAKE_SECURITY);
+    static const char REQUEST[] =
+            "\x40\x01\xFA\x3E" // CoAP header
+            "\xB2" "42"; // OID
+    avs_unit_mocksock_input(mocksocks[0], REQUEST, sizeof(REQUEST) - 1);
+    _anjay_mock_dm_expect_instance_it(anjay, &OBJ_WITH_INSTANCE_READ, 0, 0, 3);
+    _anjay_mock_dm_expect_instance_it(anjay, &OBJ_WITH_INSTANCE_READ, 1, 0,
+                                      ANJAY_IID_INVALID);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0],
+            "\x60\x45\xFA\x3E" // CoAP header
+            "\xc2\x2d\x16" // Content-Format
+            "\xff\x08\x03\x0a"
+            "\xc1\x00\x45"
+            "\xc5\x06" "Hello");
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(dm_read, instance_resource_doesnt_support_read) {
     DM_TEST_INIT;
     static const char REQUEST[] =
@@ -483,6 +548,77 @@ AVS_UNIT_TEST(dm_read_accept, invalid_format) {
     DM_TEST_FINISH;
 }
 
+#ifdef WITH_JSON
+AVS_UNIT_TEST(dm_read_composite, resource_and_instance) {
+    DM_TEST_INIT;
+    static const char REQUEST[] =
+            "\x40\x05\xFA\x3E" // CoAP header, FETCH
+            "\xC1\x28" // Content-Format: application/link-format
+            "\xFF" "</42/69/4>, </42/13>,</42/14>";
+    avs_unit_mocksock_input(mocksocks[0], REQUEST, sizeof(REQUEST) - 1);
+    _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 69, 1);
+    _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 69, 4, 1);
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, 0,
+                                        ANJAY_MOCK_DM_INT(0, 514));
+    _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 13, 1);
+    _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 13, 0, 1);
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 13, 0, 0,
+                                        ANJAY_MOCK_DM_STRING(0, "Hello"));
+    for (anjay_rid_t rid = 1; rid <= 6; ++rid) {
+        _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 13, rid, 0);
+    }
+    // nonexistent paths are skipped
+    _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 14, 0);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0],
+            "\x60\x45\xFA\x3E" // CoAP header
+            "\xc2\x2d\x17" // Content-Format: JSON
+            "\xff"
+            "{\"bn\":\"\",\"e\":["
+            "{\"n\":\"/42/69/4\",\"v\":514},"
+            "{\"n\":\"/42/13/0\",\"sv\":\"Hello\"}]}");
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_read_composite, malformed_payload) {
+    DM_TEST_INIT;
+    static const char REQUEST[] =
+            "\x40\x05\xFA\x3E" // CoAP header, FETCH
+            "\xC1\x28" // Content-Format: application/link-format
+            "\xFF" "</42/69/4>,/42/13";
+    avs_unit_mocksock_input(mocksocks[0], REQUEST, sizeof(REQUEST) - 1);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], "\x60\x80\xFA\x3E");
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_read_composite, uri_path_not_allowed) {
+    DM_TEST_INIT;
+    static const char REQUEST[] =
+            "\x40\x05\xFA\x3E" // CoAP header, FETCH
+            "\xB2" "42" // OID
+            "\x11\x28" // Content-Format: application/link-format
+            "\xFF" "</42/69/4>";
+    avs_unit_mocksock_input(mocksocks[0], REQUEST, sizeof(REQUEST) - 1);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], "\x60\x80\xFA\x3E");
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_read_composite, force_tlv) {
+    DM_TEST_INIT;
+    static const char REQUEST[] =
+            "\x40\x05\xFA\x3E" // CoAP header, FETCH
+            "\xC1\x28" // Content-Format: application/link-format
+            "\x52\x2d\x16" // Accept: TLV
+            "\xFF" "</42/69/4>";
+    avs_unit_mocksock_input(mocksocks[0], REQUEST, sizeof(REQUEST) - 1);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], "\x60\x86\xFA\x3E");
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+#endif // WITH_JSON
+
 AVS_UNIT_TEST(dm_write, resource) {
     DM_TEST_INIT;
     static const char REQUEST[] =
@@ -2262,6 +2398,63 @@ AVS_UNIT_TEST(dm_effective_attrs, server_default) {
     DM_TEST_FINISH;
 }
 
+AVS_UNIT_TEST(dm_effective_attrs, server_default_cached) {
+    DM_TEST_INIT;
+    (void) mocksocks;
+    _anjay_mock_dm_expect_object_read_default_attrs(
+            anjay, &OBJ, 1, 0, &ANJAY_DM_INTERNAL_ATTRS_EMPTY);
+    _anjay_mock_dm_expect_instance_it(anjay, &FAKE_SERVER, 0, 0, 1);
+    _anjay_mock_dm_expect_resource_present(anjay, &FAKE_SERVER, 1,
+                                           ANJAY_DM_RID_SERVER_SSID, 1);
+    _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, 1,
+                                        ANJAY_DM_RID_SERVER_SSID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 1));
+    _anjay_mock_dm_expect_resource_present(anjay, &FAKE_SERVER, 1,
+                                           ANJAY_DM_RID_SERVER_DEFAULT_PMIN, 1);
+    _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, 1,
+                                        ANJAY_DM_RID_SERVER_DEFAULT_PMIN, 0,
+                                        ANJAY_MOCK_DM_INT(0, 7));
+    _anjay_mock_dm_expect_resource_present(anjay, &FAKE_SERVER, 1,
+                                           ANJAY_DM_RID_SERVER_DEFAULT_PMAX, 0);
+    anjay_dm_internal_res_attrs_t attrs;
+    anjay_dm_attrs_query_details_t details = DM_EFFECTIVE_ATTRS_STANDARD_QUERY;
+    details.rid = -1;
+    details.iid = ANJAY_IID_INVALID;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_effective_attrs(anjay, &details, &attrs));
+    AVS_UNIT_ASSERT_EQUAL(attrs.standard.common.min_period, 7);
+    AVS_UNIT_ASSERT_EQUAL(attrs.standard.common.max_period,
+                          ANJAY_ATTRIB_PERIOD_NONE);
+
+    // second query does not touch the Server object
+    _anjay_mock_dm_expect_object_read_default_attrs(
+            anjay, &OBJ, 1, 0, &ANJAY_DM_INTERNAL_ATTRS_EMPTY);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_effective_attrs(anjay, &details, &attrs));
+    AVS_UNIT_ASSERT_EQUAL(attrs.standard.common.min_period, 7);
+    AVS_UNIT_ASSERT_EQUAL(attrs.standard.common.max_period,
+                          ANJAY_ATTRIB_PERIOD_NONE);
+
+    // until it is invalidated
+    _anjay_servers_invalidate_config_cache(anjay);
+    _anjay_mock_dm_expect_object_read_default_attrs(
+            anjay, &OBJ, 1, 0, &ANJAY_DM_INTERNAL_ATTRS_EMPTY);
+    _anjay_mock_dm_expect_instance_it(anjay, &FAKE_SERVER, 0, 0, 1);
+    _anjay_mock_dm_expect_resource_present(anjay, &FAKE_SERVER, 1,
+                                           ANJAY_DM_RID_SERVER_SSID, 1);
+    _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, 1,
+                                        ANJAY_DM_RID_SERVER_SSID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 1));
+    _anjay_mock_dm_expect_resource_present(anjay, &FAKE_SERVER, 1,
+                                           ANJAY_DM_RID_SERVER_DEFAULT_PMIN, 1);
+    _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, 1,
+                                        ANJAY_DM_RID_SERVER_DEFAULT_PMIN, 0,
+                                        ANJAY_MOCK_DM_INT(0, 3));
+    _anjay_mock_dm_expect_resource_present(anjay, &FAKE_SERVER, 1,
+                                           ANJAY_DM_RID_SERVER_DEFAULT_PMAX, 0);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_effective_attrs(anjay, &details, &attrs));
+    AVS_UNIT_ASSERT_EQUAL(attrs.standard.common.min_period, 3);
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(dm_effective_attrs, no_server) {
     DM_TEST_INIT;
     (void) mocksocks;
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/unit/test.h>
+
+static const char TEST_MAGIC[] = { 'T', 'S', 'T', '\0' };
+
+static int write_string(avs_stream_abstract_t *out_stream, void *str) {
+    return avs_stream_write(out_stream, str, strlen((const char *) str));
+}
+
+static int fail_writer(avs_stream_abstract_t *out_stream, void *arg) {
+    (void) arg;
+    (void) avs_stream_write(out_stream, "garbage", 7);
+    return -1;
+}
+
+typedef struct {
+    char records[4][16];
+    size_t count;
+    bool damaged_tail;
+} replayed_t;
+
+static int collect_record(avs_stream_abstract_t *in_stream, void *replayed_) {
+    replayed_t *replayed = (replayed_t *) replayed_;
+    AVS_UNIT_ASSERT_TRUE(replayed->count < AVS_ARRAY_SIZE(replayed->records));
+    char *record = replayed->records[replayed->count++];
+    size_t bytes_read;
+    char message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(in_stream, &bytes_read,
+                                            &message_finished, record, 15));
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    return 0;
+}
+
+static void append_records(anjay_raw_buffer_t *out, const char *magic) {
+    avs_stream_abstract_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_journal_append(stream, magic, write_string, "foo"));
+    AVS_UNIT_ASSERT_FAILED(
+            _anjay_journal_append(stream, magic, fail_writer, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_journal_append(stream, magic, write_string, ""));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_journal_append(stream, magic, write_string, "bar"));
+    *out = ANJAY_RAW_BUFFER_EMPTY;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_raw_buffer_append_stream(out, stream));
+    avs_stream_cleanup(&stream);
+}
+
+static int replay(const anjay_raw_buffer_t *journal,
+                  size_t size,
+                  replayed_t *out) {
+    memset(out, 0, sizeof(*out));
+    avs_stream_inbuf_t inbuf = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&inbuf, journal->data, size);
+    return _anjay_journal_replay((avs_stream_abstract_t *) &inbuf, TEST_MAGIC,
+                                 collect_record, out, &out->damaged_tail);
+}
+
+AVS_UNIT_TEST(journal, append_and_replay) {
+    anjay_raw_buffer_t journal;
+    append_records(&journal, TEST_MAGIC);
+    // 3 records, 12 bytes of framing each
+    AVS_UNIT_ASSERT_EQUAL(journal.size, 3 * 12 + 6);
+
+    replayed_t replayed;
+    AVS_UNIT_ASSERT_EQUAL(replay(&journal, journal.size, &replayed), 3);
+    AVS_UNIT_ASSERT_EQUAL(replayed.count, 3);
+    AVS_UNIT_ASSERT_EQUAL_STRING(replayed.records[0], "foo");
+    AVS_UNIT_ASSERT_EQUAL_STRING(replayed.records[1], "");
+    AVS_UNIT_ASSERT_EQUAL_STRING(replayed.records[2], "bar");
+    AVS_UNIT_ASSERT_FALSE(replayed.damaged_tail);
+
+    AVS_UNIT_ASSERT_EQUAL(replay(&journal, 0, &replayed), 0);
+    AVS_UNIT_ASSERT_FALSE(replayed.damaged_tail);
+    _anjay_raw_buffer_clear(&journal);
+}
+
+AVS_UNIT_TEST(journal, torn_record) {
+    anjay_raw_buffer_t journal;
+    append_records(&journal, TEST_MAGIC);
+
+    replayed_t replayed;
+    for (size_t size = journal.size - 14; size < journal.size; ++size) {
+        AVS_UNIT_ASSERT_EQUAL(replay(&journal, size, &replayed), 2);
+        AVS_UNIT_ASSERT_EQUAL_STRING(replayed.records[1], "");
+        AVS_UNIT_ASSERT_TRUE(replayed.damaged_tail);
+    }
+
+    // damaged payload of the last record
+    ((char *) journal.data)[journal.size - 5] ^= 0x20;
+    AVS_UNIT_ASSERT_EQUAL(replay(&journal, journal.size, &replayed), 2);
+    AVS_UNIT_ASSERT_TRUE(replayed.damaged_tail);
+    _anjay_raw_buffer_clear(&journal);
+}
+
+AVS_UNIT_TEST(journal, damaged_size) {
+    anjay_raw_buffer_t journal;
+    append_records(&journal, TEST_MAGIC);
+
+    // size field of the last record claims almost 4 GiB of payload
+    const uint32_t huge_size = avs_convert_be32(0xFFFFFFF0);
+    memcpy((char *) journal.data + journal.size - 11, &huge_size,
+           sizeof(huge_size));
+    replayed_t replayed;
+    AVS_UNIT_ASSERT_EQUAL(replay(&journal, journal.size, &replayed), 2);
+    AVS_UNIT_ASSERT_EQUAL_STRING(replayed.records[1], "");
+    AVS_UNIT_ASSERT_TRUE(replayed.damaged_tail);
+
+    // size field claims less payload than there is
+    const uint32_t short_size = avs_convert_be32(1);
+    memcpy((char *) journal.data + journal.size - 11, &short_size,
+           sizeof(short_size));
+    AVS_UNIT_ASSERT_EQUAL(replay(&journal, journal.size, &replayed), 2);
+    _anjay_raw_buffer_clear(&journal);
+}
+
+AVS_UNIT_TEST(journal, unexpected_magic) {
+    anjay_raw_buffer_t journal;
+    append_records(&journal, "ABC");
+
+    replayed_t replayed;
+    AVS_UNIT_ASSERT_FAILED(replay(&journal, journal.size, &replayed));
+    AVS_UNIT_ASSERT_EQUAL(replayed.count, 0);
+    _anjay_raw_buffer_clear(&journal);
+}
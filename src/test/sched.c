@@ -120,6 +120,86 @@ AVS_UNIT_TEST(sched, sched_del) {
     teardown_test(&env);
 }
 
+typedef struct {
+    char order[8];
+    size_t count;
+} execution_log_t;
+
+typedef struct {
+    execution_log_t *log;
+    char id;
+} logging_task_arg_t;
+
+static void logging_task(anjay_t *anjay, void *arg_) {
+    (void) anjay;
+    logging_task_arg_t *arg = (logging_task_arg_t *) arg_;
+    AVS_UNIT_ASSERT_TRUE(arg->log->count < sizeof(arg->log->order) - 1);
+    arg->log->order[arg->log->count++] = arg->id;
+}
+
+AVS_UNIT_TEST(sched, slack_wakes_up_at_deadline) {
+    sched_test_env_t env = setup_test();
+
+    int counter = 0;
+    anjay_sched_handle_t task = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sched_with_slack(
+            env.sched, &task, avs_time_duration_from_scalar(1, AVS_TIME_S),
+            avs_time_duration_from_scalar(4, AVS_TIME_S), increment_task,
+            &counter));
+
+    avs_time_duration_t time_to_next;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sched_time_to_next(env.sched,
+                                                      &time_to_next));
+    AVS_UNIT_ASSERT_EQUAL(time_to_next.seconds, 5);
+    AVS_UNIT_ASSERT_EQUAL(time_to_next.nanoseconds, 0);
+
+    _anjay_mock_clock_advance(time_to_next);
+    AVS_UNIT_ASSERT_EQUAL(1, _anjay_sched_run(env.sched));
+    AVS_UNIT_ASSERT_EQUAL(1, counter);
+    AVS_UNIT_ASSERT_NULL(task);
+
+    teardown_test(&env);
+}
+
+AVS_UNIT_TEST(sched, slack_coalesces_overlapping_windows) {
+    sched_test_env_t env = setup_test();
+
+    execution_log_t log = { "", 0 };
+    logging_task_arg_t args[] = { { &log, 'A' }, { &log, 'B' }, { &log, 'C' } };
+    // A: [1, 10]; B: [3, 3]; C: [4, 6]
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sched_with_slack(
+            env.sched, NULL, avs_time_duration_from_scalar(1, AVS_TIME_S),
+            avs_time_duration_from_scalar(9, AVS_TIME_S), logging_task,
+            &args[0]));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sched(
+            env.sched, NULL, avs_time_duration_from_scalar(3, AVS_TIME_S),
+            logging_task, &args[1]));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sched_with_slack(
+            env.sched, NULL, avs_time_duration_from_scalar(4, AVS_TIME_S),
+            avs_time_duration_from_scalar(2, AVS_TIME_S), logging_task,
+            &args[2]));
+
+    avs_time_duration_t time_to_next;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sched_time_to_next(env.sched,
+                                                      &time_to_next));
+    AVS_UNIT_ASSERT_EQUAL(time_to_next.seconds, 3);
+
+    // A rides along with B, in the order of deadlines
+    _anjay_mock_clock_advance(time_to_next);
+    AVS_UNIT_ASSERT_EQUAL(2, _anjay_sched_run(env.sched));
+    AVS_UNIT_ASSERT_EQUAL_STRING(log.order, "BA");
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sched_time_to_next(env.sched,
+                                                      &time_to_next));
+    AVS_UNIT_ASSERT_EQUAL(time_to_next.seconds, 3);
+    _anjay_mock_clock_advance(time_to_next);
+    AVS_UNIT_ASSERT_EQUAL(1, _anjay_sched_run(env.sched));
+    AVS_UNIT_ASSERT_EQUAL_STRING(log.order, "BAC");
+    AVS_UNIT_ASSERT_FAILED(_anjay_sched_time_to_next(env.sched, NULL));
+
+    teardown_test(&env);
+}
+
 static void assert_executes_after_delay(sched_test_env_t *env,
                                         avs_time_duration_t delay) {
     avs_time_duration_t epsilon = avs_time_duration_from_scalar(1, AVS_TIME_MS);
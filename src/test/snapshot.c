@@ -0,0 +1,219 @@
+/*
+ * Copyright 2017-2018 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/unit/test.h>
+
+static const anjay_configuration_t CONFIG = {
+    .endpoint_name = "test"
+};
+
+typedef struct {
+    char value[16];
+    /** Global counter value at the moment of the last restore. */
+    int restored_at;
+} fake_module_state_t;
+
+static int restore_counter;
+
+static int fake_persist(anjay_t *anjay,
+                        avs_stream_abstract_t *out_stream,
+                        const anjay_dm_module_t *module) {
+    fake_module_state_t *state =
+            (fake_module_state_t *) _anjay_dm_module_get_arg(anjay, module);
+    return avs_stream_write(out_stream, state->value, strlen(state->value));
+}
+
+static int fake_restore(anjay_t *anjay,
+                        avs_stream_abstract_t *in_stream,
+                        const anjay_dm_module_t *module) {
+    fake_module_state_t *state =
+            (fake_module_state_t *) _anjay_dm_module_get_arg(anjay, module);
+    size_t bytes_read;
+    char message_finished;
+    memset(state->value, 0, sizeof(state->value));
+    int retval = avs_stream_read(in_stream, &bytes_read, &message_finished,
+                                 state->value, sizeof(state->value) - 1);
+    state->restored_at = ++restore_counter;
+    return retval;
+}
+
+static const anjay_dm_module_t OBJECT_MODULE;
+static const anjay_dm_module_t METADATA_MODULE;
+
+static int object_persist(anjay_t *anjay, avs_stream_abstract_t *out_stream) {
+    return fake_persist(anjay, out_stream, &OBJECT_MODULE);
+}
+
+static int object_restore(anjay_t *anjay, avs_stream_abstract_t *in_stream) {
+    return fake_restore(anjay, in_stream, &OBJECT_MODULE);
+}
+
+static int metadata_persist(anjay_t *anjay, avs_stream_abstract_t *out_stream) {
+    return fake_persist(anjay, out_stream, &METADATA_MODULE);
+}
+
+static int metadata_restore(anjay_t *anjay, avs_stream_abstract_t *in_stream) {
+    return fake_restore(anjay, in_stream, &METADATA_MODULE);
+}
+
+static const anjay_dm_module_t OBJECT_MODULE = {
+    .snapshot_name = "object",
+    .persist = object_persist,
+    .restore = object_restore
+};
+
+static const anjay_dm_module_t METADATA_MODULE = {
+    .snapshot_name = "metadata",
+    .snapshot_stage = ANJAY_DM_MODULE_SNAPSHOT_METADATA,
+    .persist = metadata_persist,
+    .restore = metadata_restore
+};
+
+typedef struct {
+    anjay_t *anjay;
+    fake_module_state_t object;
+    fake_module_state_t metadata;
+} snapshot_test_env_t;
+
+static void snapshot_test_env_init(snapshot_test_env_t *env,
+                                   bool install_object) {
+    memset(env, 0, sizeof(*env));
+    env->anjay = anjay_new(&CONFIG);
+    AVS_UNIT_ASSERT_NOT_NULL(env->anjay);
+    // metadata module installed first, yet its section is restored last
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_module_install(
+            env->anjay, &METADATA_MODULE, &env->metadata));
+    if (install_object) {
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_module_install(
+                env->anjay, &OBJECT_MODULE, &env->object));
+    }
+}
+
+static void
+snapshot_test_env_persist(snapshot_test_env_t *env, anjay_raw_buffer_t *out) {
+    avs_stream_abstract_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_snapshot_persist(env->anjay, stream));
+    *out = ANJAY_RAW_BUFFER_EMPTY;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_raw_buffer_append_stream(out, stream));
+    avs_stream_cleanup(&stream);
+}
+
+AVS_UNIT_TEST(snapshot, persist_and_restore) {
+    snapshot_test_env_t stored;
+    snapshot_test_env_init(&stored, true);
+    strcpy(stored.object.value, "foo");
+    strcpy(stored.metadata.value, "bar");
+    anjay_raw_buffer_t snapshot;
+    snapshot_test_env_persist(&stored, &snapshot);
+
+    snapshot_test_env_t restored;
+    snapshot_test_env_init(&restored, true);
+    restore_counter = 0;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_snapshot_restore_from_buffer(
+            restored.anjay, snapshot.data, snapshot.size));
+    AVS_UNIT_ASSERT_EQUAL_STRING(restored.object.value, "foo");
+    AVS_UNIT_ASSERT_EQUAL_STRING(restored.metadata.value, "bar");
+    AVS_UNIT_ASSERT_EQUAL(restored.object.restored_at, 1);
+    AVS_UNIT_ASSERT_EQUAL(restored.metadata.restored_at, 2);
+
+    _anjay_raw_buffer_clear(&snapshot);
+    anjay_delete(stored.anjay);
+    anjay_delete(restored.anjay);
+}
+
+AVS_UNIT_TEST(snapshot, module_not_installed) {
+    snapshot_test_env_t stored;
+    snapshot_test_env_init(&stored, true);
+    strcpy(stored.object.value, "foo");
+    strcpy(stored.metadata.value, "bar");
+    anjay_raw_buffer_t snapshot;
+    snapshot_test_env_persist(&stored, &snapshot);
+
+    snapshot_test_env_t restored;
+    snapshot_test_env_init(&restored, false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_snapshot_restore_from_buffer(
+            restored.anjay, snapshot.data, snapshot.size));
+    AVS_UNIT_ASSERT_EQUAL_STRING(restored.object.value, "");
+    AVS_UNIT_ASSERT_EQUAL_STRING(restored.metadata.value, "bar");
+
+    _anjay_raw_buffer_clear(&snapshot);
+    anjay_delete(stored.anjay);
+    anjay_delete(restored.anjay);
+}
+
+AVS_UNIT_TEST(snapshot, corrupted) {
+    snapshot_test_env_t stored;
+    snapshot_test_env_init(&stored, true);
+    strcpy(stored.object.value, "foo");
+    strcpy(stored.metadata.value, "bar");
+    anjay_raw_buffer_t snapshot;
+    snapshot_test_env_persist(&stored, &snapshot);
+
+    snapshot_test_env_t restored;
+    snapshot_test_env_init(&restored, true);
+    for (size_t i = 0; i < snapshot.size; ++i) {
+        ((char *) snapshot.data)[i] ^= 0x20;
+        AVS_UNIT_ASSERT_FAILED(anjay_snapshot_restore_from_buffer(
+                restored.anjay, snapshot.data, snapshot.size));
+        ((char *) snapshot.data)[i] ^= 0x20;
+    }
+    AVS_UNIT_ASSERT_FAILED(anjay_snapshot_restore_from_buffer(
+            restored.anjay, snapshot.data, snapshot.size - 1));
+    // nothing is restored from a damaged snapshot
+    AVS_UNIT_ASSERT_EQUAL(restored.object.restored_at, 0);
+    AVS_UNIT_ASSERT_EQUAL(restored.metadata.restored_at, 0);
+
+    _anjay_raw_buffer_clear(&snapshot);
+    anjay_delete(stored.anjay);
+    anjay_delete(restored.anjay);
+}
+
+AVS_UNIT_TEST(snapshot, unsupported_version) {
+    snapshot_test_env_t env;
+    snapshot_test_env_init(&env, true);
+    anjay_raw_buffer_t snapshot;
+    snapshot_test_env_persist(&env, &snapshot);
+
+    // bump the version and fix the checksum
+    ((char *) snapshot.data)[sizeof(MAGIC) + 1] = SNAPSHOT_VERSION + 1;
+    snapshot.size -= sizeof(uint32_t);
+    AVS_UNIT_ASSERT_SUCCESS(buffer_append_u32(
+            &snapshot, _anjay_crc32(0, snapshot.data, snapshot.size)));
+    AVS_UNIT_ASSERT_FAILED(anjay_snapshot_restore_from_buffer(
+            env.anjay, snapshot.data, snapshot.size));
+
+    _anjay_raw_buffer_clear(&snapshot);
+    anjay_delete(env.anjay);
+}
+
+AVS_UNIT_TEST(snapshot, restore_from_stream) {
+    snapshot_test_env_t stored;
+    snapshot_test_env_init(&stored, true);
+    strcpy(stored.object.value, "foo");
+    avs_stream_abstract_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_snapshot_persist(stored.anjay, stream));
+
+    snapshot_test_env_t restored;
+    snapshot_test_env_init(&restored, true);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_snapshot_restore(restored.anjay, stream));
+    AVS_UNIT_ASSERT_EQUAL_STRING(restored.object.value, "foo");
+
+    avs_stream_cleanup(&stream);
+    anjay_delete(stored.anjay);
+    anjay_delete(restored.anjay);
+}
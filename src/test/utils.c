@@ -408,3 +408,11 @@ AVS_UNIT_TEST(binding_mode_from_str, unsupported_binding_mode) {
     AVS_UNIT_ASSERT_EQUAL(ANJAY_BINDING_NONE,
                           anjay_binding_mode_from_str("☃"));
 }
+
+AVS_UNIT_TEST(crc32, check_value) {
+    AVS_UNIT_ASSERT_EQUAL(_anjay_crc32(0, NULL, 0), 0);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_crc32(0, "123456789", 9), 0xCBF43926);
+    // calculating in chunks yields the same result
+    AVS_UNIT_ASSERT_EQUAL(_anjay_crc32(_anjay_crc32(0, "1234", 4), "56789", 5),
+                          0xCBF43926);
+}
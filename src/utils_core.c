@@ -180,6 +180,23 @@ uint32_t _anjay_rand32(anjay_rand_seed_t *seed) {
 }
 #endif
 
+uint32_t _anjay_crc32(uint32_t crc, const void *data, size_t size) {
+    // reflected polynomial 0x04C11DB7, processed four bits at a time
+    static const uint32_t TABLE[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    const uint8_t *bytes = (const uint8_t *) data;
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = TABLE[(crc ^ bytes[i]) & 0xF] ^ (crc >> 4);
+        crc = TABLE[(crc ^ (uint32_t) (bytes[i] >> 4)) & 0xF] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
 AVS_LIST(const anjay_string_t)
 _anjay_copy_string_list(AVS_LIST(const anjay_string_t) input) {
     AVS_LIST(const anjay_string_t) output = NULL;
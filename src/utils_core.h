@@ -61,6 +61,12 @@ typedef unsigned anjay_rand_seed_t;
 #endif
 uint32_t _anjay_rand32(anjay_rand_seed_t *seed);
 
+/**
+ * Continues calculating the CRC-32 (as used by Ethernet and zlib) of a data
+ * stream. Pass 0 as @p crc for the first chunk.
+ */
+uint32_t _anjay_crc32(uint32_t crc, const void *data, size_t size);
+
 static inline void _anjay_update_ret(int *var, int new_retval) {
     if (!*var) {
         *var = new_retval;
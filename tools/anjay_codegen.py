@@ -20,6 +20,7 @@ import argparse
 import collections
 import textwrap
 import operator
+import os
 import sys
 import re
 from xml.etree import ElementTree
@@ -429,6 +430,457 @@ void {{ obj_name_snake }}_object_release(const anjay_dm_object_def_t **def) {
 }
 """
 
+FAST_TEMPLATE = """\
+/**
+ * Generated by anjay_codegen.py --fast on {{ date_time }}
+ *
+ * LwM2M Object: {{ obj.name }}
+ * ID: {{ obj.oid }}, URN: {{ obj.urn }}, {{ obj.mandatory_str }}, {{ obj.multiple_str }}
+ *
+ * {{ obj.description }}
+ */
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anjay/anjay.h>
+#include <avsystem/commons/defs.h>
+#include <avsystem/commons/memory.h>
+
+{% for res in obj.resources %}
+/**
+ * {{ res.name }}: {{ res.operations }}, {{ res.multiple_str }}, {{ res.mandatory_str }}
+ * type: {{ res.type }}, range: {{ res.range_enumeration }}, unit: {{ res.units }}
+ * {{ res.description }}
+ */
+#define {{ res.name_upper }} {{ res.rid }}
+
+{% endfor %}
+{% if obj.multiple %}
+#define MAX_INSTANCES 16
+{% endif %}
+{% if obj.has_any_multiple_resources %}
+#define MAX_RESOURCE_INSTANCES 8
+{% endif %}
+{% if obj.has_any_buffer_resources %}
+#define MAX_VALUE_SIZE 64
+{% endif %}
+
+/**
+ * Position of each Resource in OBJ_DEF.supported_rids, used as a bit index in
+ * the Resource bitmaps below.
+ */
+enum {
+{% for res in obj.resources %}
+    {{ res.index_name }},
+{% endfor %}
+    RESOURCE_COUNT
+};
+
+#define BITMAP_WORDS {{ bitmap_words }}
+
+static const uint32_t MANDATORY_RESOURCES[BITMAP_WORDS] = { {{ bitmaps.mandatory }} };
+static const uint32_t READABLE_RESOURCES[BITMAP_WORDS] = { {{ bitmaps.readable }} };
+static const uint32_t WRITABLE_RESOURCES[BITMAP_WORDS] = { {{ bitmaps.writable }} };
+static const uint32_t EXECUTABLE_RESOURCES[BITMAP_WORDS] = { {{ bitmaps.executable }} };
+
+static inline bool bitmap_test(const uint32_t *bitmap, int index) {
+    return !!(bitmap[index / 32] & ((uint32_t) 1 << (index % 32)));
+}
+
+static inline void bitmap_set(uint32_t *bitmap, int index) {
+    bitmap[index / 32] |= ((uint32_t) 1 << (index % 32));
+}
+
+static int resource_index(anjay_rid_t rid) {
+    switch (rid) {
+{% for res in obj.resources %}
+    case {{ res.name_upper }}:
+        return {{ res.index_name }};
+{% endfor %}
+    default:
+        return -1;
+    }
+}
+
+{% if obj.has_any_objlnk_resources %}
+typedef struct {
+    anjay_oid_t oid;
+    anjay_iid_t iid;
+} objlnk_value_t;
+
+{% endif %}
+typedef struct {{ obj_inst_tag }} {
+{% if obj.multiple %}
+    bool exists;
+{% endif %}
+    /** Resources present in the Instance, indexed like MANDATORY_RESOURCES */
+    uint32_t present[BITMAP_WORDS];
+{% for res in obj.resources %}
+{% if res.fast_field_decl %}
+    {{ res.fast_field_decl }}
+{% endif %}
+{% endfor %}
+} {{ obj_inst_type }};
+
+typedef struct {{ obj_repr_tag }} {
+    const anjay_dm_object_def_t *def;
+{% if obj.multiple %}
+    {{ obj_inst_type }} instances[MAX_INSTANCES];
+{% else %}
+    {{ obj_inst_type }} instance;
+{% endif %}
+
+    // TODO: object state
+} {{ obj_repr_type }};
+
+static inline {{ obj_repr_type }} *
+get_obj(const anjay_dm_object_def_t *const *obj_ptr) {
+    assert(obj_ptr);
+    return AVS_CONTAINER_OF(obj_ptr, {{ obj_repr_type }}, def);
+}
+
+static {{ obj_inst_type }} *
+get_instance(const anjay_dm_object_def_t *const *obj_ptr, anjay_iid_t iid) {
+    {{ obj_repr_type }} *obj = get_obj(obj_ptr);
+{% if obj.multiple %}
+    assert(iid < MAX_INSTANCES && obj->instances[iid].exists);
+    return &obj->instances[iid];
+{% else %}
+    assert(iid == 0);
+    (void) iid;
+    return &obj->instance;
+{% endif %}
+}
+
+static void init_instance({{ obj_inst_type }} *inst) {
+    memset(inst, 0, sizeof(*inst));
+    memcpy(inst->present, MANDATORY_RESOURCES, sizeof(inst->present));
+    // TODO: default Resource values
+}
+
+{% if obj.multiple %}
+static int instance_present(anjay_t *anjay,
+                            const anjay_dm_object_def_t *const *obj_ptr,
+                            anjay_iid_t iid) {
+    (void) anjay;
+    return iid < MAX_INSTANCES && get_obj(obj_ptr)->instances[iid].exists;
+}
+
+static int instance_it(anjay_t *anjay,
+                       const anjay_dm_object_def_t *const *obj_ptr,
+                       anjay_iid_t *out,
+                       void **cookie) {
+    (void) anjay;
+    {{ obj_repr_type }} *obj = get_obj(obj_ptr);
+
+    // the cookie is the lowest Instance ID that has not been returned yet
+    uintptr_t iid = (uintptr_t) *cookie;
+    while (iid < MAX_INSTANCES && !obj->instances[iid].exists) {
+        ++iid;
+    }
+    if (iid < MAX_INSTANCES) {
+        *out = (anjay_iid_t) iid;
+        *cookie = (void *) (iid + 1);
+    } else {
+        *out = ANJAY_IID_INVALID;
+    }
+    return 0;
+}
+
+static int instance_create(anjay_t *anjay,
+                           const anjay_dm_object_def_t *const *obj_ptr,
+                           anjay_iid_t *inout_iid,
+                           anjay_ssid_t ssid) {
+    (void) anjay; (void) ssid;
+    {{ obj_repr_type }} *obj = get_obj(obj_ptr);
+
+    if (*inout_iid == ANJAY_IID_INVALID) {
+        anjay_iid_t iid = 0;
+        while (iid < MAX_INSTANCES && obj->instances[iid].exists) {
+            ++iid;
+        }
+        if (iid >= MAX_INSTANCES) {
+            return ANJAY_ERR_INTERNAL;
+        }
+        *inout_iid = iid;
+    } else if (*inout_iid >= MAX_INSTANCES
+            || obj->instances[*inout_iid].exists) {
+        return ANJAY_ERR_BAD_REQUEST;
+    }
+
+    init_instance(&obj->instances[*inout_iid]);
+    obj->instances[*inout_iid].exists = true;
+    return 0;
+}
+
+static int instance_remove(anjay_t *anjay,
+                           const anjay_dm_object_def_t *const *obj_ptr,
+                           anjay_iid_t iid) {
+    (void) anjay;
+    get_instance(obj_ptr, iid)->exists = false;
+    return 0;
+}
+
+{% endif %}
+{% if obj.needs_instance_reset_handler %}
+static int instance_reset(anjay_t *anjay,
+                          const anjay_dm_object_def_t *const *obj_ptr,
+                          anjay_iid_t iid) {
+    (void) anjay;
+    init_instance(get_instance(obj_ptr, iid));
+{% if obj.multiple %}
+    get_instance(obj_ptr, iid)->exists = true;
+{% endif %}
+    return 0;
+}
+
+{% endif %}
+static int resource_present(anjay_t *anjay,
+                            const anjay_dm_object_def_t *const *obj_ptr,
+                            anjay_iid_t iid,
+                            anjay_rid_t rid) {
+    (void) anjay;
+    int index = resource_index(rid);
+    return index >= 0 && bitmap_test(get_instance(obj_ptr, iid)->present, index);
+}
+
+static int resource_operations(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj_ptr,
+                               anjay_rid_t rid,
+                               anjay_dm_resource_op_mask_t *out) {
+    (void) anjay; (void) obj_ptr;
+    int index = resource_index(rid);
+    int mask = 0;
+    if (index >= 0) {
+        if (bitmap_test(READABLE_RESOURCES, index)) {
+            mask |= ANJAY_DM_RESOURCE_OP_BIT_R;
+        }
+        if (bitmap_test(WRITABLE_RESOURCES, index)) {
+            mask |= ANJAY_DM_RESOURCE_OP_BIT_W;
+        }
+        if (bitmap_test(EXECUTABLE_RESOURCES, index)) {
+            mask |= ANJAY_DM_RESOURCE_OP_BIT_E;
+        }
+    }
+    *out = (anjay_dm_resource_op_mask_t) mask;
+    return 0;
+}
+
+{% if obj.has_any_readable_resources %}
+static int read_resource(const {{ obj_inst_type }} *inst,
+                         anjay_rid_t rid,
+                         anjay_output_ctx_t *ctx) {
+    switch (rid) {
+{% for res in obj.resources %}
+{% if 'R' in res.operations %}
+    case {{ res.name_upper }}:
+        {{ res.fast_read_handler|indent(8) }}
+
+{% endif %}
+{% endfor %}
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int resource_read(anjay_t *anjay,
+                         const anjay_dm_object_def_t *const *obj_ptr,
+                         anjay_iid_t iid,
+                         anjay_rid_t rid,
+                         anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    return read_resource(get_instance(obj_ptr, iid), rid, ctx);
+}
+
+static int instance_read(anjay_t *anjay,
+                         const anjay_dm_object_def_t *const *obj_ptr,
+                         anjay_iid_t iid,
+                         anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    const {{ obj_inst_type }} *inst = get_instance(obj_ptr, iid);
+    int result = 0;
+{% for res in obj.resources %}
+{% if 'R' in res.operations %}
+    if (bitmap_test(inst->present, {{ res.index_name }})
+            && ((result = anjay_ret_resource_id(ctx, {{ res.name_upper }}))
+                || (result = read_resource(inst, {{ res.name_upper }}, ctx)))) {
+        return result;
+    }
+{% endif %}
+{% endfor %}
+    return 0;
+}
+
+{% endif %}
+{% if obj.has_any_writable_resources %}
+static int resource_write(anjay_t *anjay,
+                          const anjay_dm_object_def_t *const *obj_ptr,
+                          anjay_iid_t iid,
+                          anjay_rid_t rid,
+                          anjay_input_ctx_t *ctx) {
+    (void) anjay;
+    {{ obj_inst_type }} *inst = get_instance(obj_ptr, iid);
+
+    switch (rid) {
+{% for res in obj.resources %}
+{% if 'W' in res.operations %}
+    case {{ res.name_upper }}:
+        {{ res.fast_write_handler|indent(8) }}
+
+{% endif %}
+{% endfor %}
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+{% endif %}
+{% if obj.has_any_executable_resources %}
+static int resource_execute(anjay_t *anjay,
+                            const anjay_dm_object_def_t *const *obj_ptr,
+                            anjay_iid_t iid,
+                            anjay_rid_t rid,
+                            anjay_execute_ctx_t *arg_ctx) {
+    (void) anjay; (void) arg_ctx;
+    {{ obj_inst_type }} *inst = get_instance(obj_ptr, iid);
+    (void) inst;
+
+    switch (rid) {
+{% for res in obj.resources %}
+{% if 'E' in res.operations %}
+    case {{ res.name_upper }}:
+        return ANJAY_ERR_NOT_IMPLEMENTED; // TODO
+
+{% endif %}
+{% endfor %}
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+{% endif %}
+{% if obj.has_any_multiple_resources %}
+static int resource_dim(anjay_t *anjay,
+                        const anjay_dm_object_def_t *const *obj_ptr,
+                        anjay_iid_t iid,
+                        anjay_rid_t rid) {
+    (void) anjay;
+    {{ obj_inst_type }} *inst = get_instance(obj_ptr, iid);
+
+    switch (rid) {
+{% for res in obj.resources %}
+{% if res.multiple and res.fast_field_decl %}
+    case {{ res.name_upper }}:
+        return (int) inst->{{ res.field_name }}_count;
+
+{% endif %}
+{% endfor %}
+    default:
+        return ANJAY_DM_DIM_INVALID;
+    }
+}
+
+{% endif %}
+{{ cdef }}
+
+const anjay_dm_object_def_t **{{ obj_name_snake }}_object_create(void) {
+    {{ obj_repr_type }} *obj = ({{ obj_repr_type }} *)
+            avs_calloc(1, sizeof({{ obj_repr_type }}));
+    if (!obj) {
+        return NULL;
+    }
+    obj->def = &OBJ_DEF;
+{% if not obj.multiple %}
+    init_instance(&obj->instance);
+{% endif %}
+
+    // TODO: object init
+
+    return &obj->def;
+}
+
+void {{ obj_name_snake }}_object_release(const anjay_dm_object_def_t **def) {
+    if (def) {
+        // TODO: object cleanup
+
+        avs_free(get_obj(def));
+    }
+}
+"""
+
+FAST_TEST_TEMPLATE = """\
+/**
+ * Generated by anjay_codegen.py --fast on {{ date_time }}
+ *
+ * Unit tests for the LwM2M Object: {{ obj.name }}
+ */
+#include <avsystem/commons/unit/test.h>
+
+#include "{{ object_source }}"
+
+AVS_UNIT_TEST({{ obj_name_snake }}, resource_bitmaps) {
+    const anjay_dm_object_def_t **def = {{ obj_name_snake }}_object_create();
+    AVS_UNIT_ASSERT_NOT_NULL(def);
+    anjay_dm_resource_op_mask_t ops;
+{% if obj.multiple %}
+    anjay_iid_t iid = ANJAY_IID_INVALID;
+    AVS_UNIT_ASSERT_SUCCESS(instance_create(NULL, def, &iid, 1));
+{% else %}
+    anjay_iid_t iid = 0;
+{% endif %}
+
+{% for res in obj.resources %}
+    AVS_UNIT_ASSERT_EQUAL(resource_present(NULL, def, iid, {{ res.name_upper }}),
+                          {{ 1 if res.mandatory else 0 }});
+    AVS_UNIT_ASSERT_SUCCESS(resource_operations(NULL, def, {{ res.name_upper }}, &ops));
+    AVS_UNIT_ASSERT_EQUAL(ops, {{ res.operations_mask }});
+{% endfor %}
+
+    AVS_UNIT_ASSERT_FALSE(resource_present(NULL, def, iid, {{ unknown_rid }}));
+    AVS_UNIT_ASSERT_SUCCESS(resource_operations(NULL, def, {{ unknown_rid }}, &ops));
+    AVS_UNIT_ASSERT_EQUAL(ops, ANJAY_DM_RESOURCE_OP_NONE);
+
+    {{ obj_name_snake }}_object_release(def);
+}
+{% if obj.multiple %}
+
+AVS_UNIT_TEST({{ obj_name_snake }}, instances) {
+    const anjay_dm_object_def_t **def = {{ obj_name_snake }}_object_create();
+    AVS_UNIT_ASSERT_NOT_NULL(def);
+
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(instance_create(NULL, def, &iid, 1));
+    AVS_UNIT_ASSERT_FAILED(instance_create(NULL, def, &iid, 1));
+    for (anjay_iid_t expected = 0; expected < MAX_INSTANCES; ++expected) {
+        if (expected != 1) {
+            iid = ANJAY_IID_INVALID;
+            AVS_UNIT_ASSERT_SUCCESS(instance_create(NULL, def, &iid, 1));
+            AVS_UNIT_ASSERT_EQUAL(iid, expected);
+        }
+    }
+    iid = ANJAY_IID_INVALID;
+    AVS_UNIT_ASSERT_FAILED(instance_create(NULL, def, &iid, 1));
+
+    AVS_UNIT_ASSERT_SUCCESS(instance_remove(NULL, def, 0));
+    AVS_UNIT_ASSERT_FALSE(instance_present(NULL, def, 0));
+    AVS_UNIT_ASSERT_TRUE(instance_present(NULL, def, 1));
+    AVS_UNIT_ASSERT_FALSE(instance_present(NULL, def, MAX_INSTANCES));
+
+    void *cookie = NULL;
+    for (anjay_iid_t expected = 1; expected < MAX_INSTANCES; ++expected) {
+        AVS_UNIT_ASSERT_SUCCESS(instance_it(NULL, def, &iid, &cookie));
+        AVS_UNIT_ASSERT_EQUAL(iid, expected);
+    }
+    AVS_UNIT_ASSERT_SUCCESS(instance_it(NULL, def, &iid, &cookie));
+    AVS_UNIT_ASSERT_EQUAL(iid, ANJAY_IID_INVALID);
+
+    {{ obj_name_snake }}_object_release(def);
+}
+{% endif %}
+"""
+
 
 def _node_text(n: Element) -> str:
     return (n.text if n.text is not None else '').strip()
@@ -438,6 +890,43 @@ def _sanitize_macro_name(n: str) -> str:
     return re.sub(r'[^a-zA-Z0-9]+', '_', n).strip('_')
 
 
+_C_KEYWORDS = {'bool', 'char', 'default', 'double', 'float', 'int', 'long', 'short', 'signed', 'unsigned', 'void'}
+
+
+def _sanitize_field_name(n: str) -> str:
+    name = _sanitize_macro_name(n.lower()) or 'value'
+    if name[0].isdigit() or name in _C_KEYWORDS:
+        name = 'res_' + name
+    return name
+
+
+def _bitmap_words(count: int) -> int:
+    return max(1, (count + 31) // 32)
+
+
+def _bitmap_initializer(indices, count: int) -> str:
+    words = [0] * _bitmap_words(count)
+    for index in indices:
+        words[index // 32] |= 1 << (index % 32)
+    return ', '.join('0x%08xu' % word for word in words)
+
+
+# Normalized resource type: (C field type, output expression, input expression)
+# Expressions are formatted with (ctx, value); buffer types are handled separately.
+_FAST_SCALAR_TYPES = {
+    'boolean': ('bool',    'anjay_ret_bool(%s, %s)',   'anjay_get_bool(%s, &%s)'),
+    'integer': ('int64_t', 'anjay_ret_i64(%s, %s)',    'anjay_get_i64(%s, &%s)'),
+    'float':   ('double',  'anjay_ret_double(%s, %s)', 'anjay_get_double(%s, &%s)'),
+    'time':    ('int64_t', 'anjay_ret_i64(%s, %s)',    'anjay_get_i64(%s, &%s)'),
+}
+
+_FAST_TYPE_ALIASES = {
+    'bool': 'boolean',
+    'int': 'integer',
+    'str': 'string',
+}
+
+
 class ResourceDef(collections.namedtuple('ResourceDef', ['rid', 'name', 'operations', 'multiple', 'mandatory', 'type',
                                                          'range_enumeration', 'units', 'description'])):
     @property
@@ -452,6 +941,163 @@ class ResourceDef(collections.namedtuple('ResourceDef', ['rid', 'name', 'operati
     def name_upper(self) -> str:
         return _sanitize_macro_name('RID_' + self.name.upper())
 
+    @property
+    def index_name(self) -> str:
+        return _sanitize_macro_name('IDX_' + self.name.upper())
+
+    @property
+    def field_name(self) -> str:
+        return _sanitize_field_name(self.name)
+
+    @property
+    def fast_type(self) -> Optional[str]:
+        type = _FAST_TYPE_ALIASES.get(self.type, self.type)
+        if type in _FAST_SCALAR_TYPES or type in ('string', 'opaque', 'objlnk'):
+            return type
+        return None
+
+    @property
+    def operations_mask(self) -> str:
+        bits = ['ANJAY_DM_RESOURCE_OP_BIT_%s' % op for op in 'RWE' if op in self.operations]
+        if not bits:
+            return 'ANJAY_DM_RESOURCE_OP_NONE'
+        return '(anjay_dm_resource_op_mask_t) (%s)' % ' | '.join(bits)
+
+    @property
+    def fast_field_decl(self) -> Optional[str]:
+        if self.fast_type is None:
+            return None
+
+        dim = '[MAX_RESOURCE_INSTANCES]' if self.multiple else ''
+        name = self.field_name
+        if self.fast_type in _FAST_SCALAR_TYPES:
+            decl = '%s %s%s;' % (_FAST_SCALAR_TYPES[self.fast_type][0], name, dim)
+        elif self.fast_type == 'string':
+            decl = 'char %s%s[MAX_VALUE_SIZE];' % (name, dim)
+        elif self.fast_type == 'opaque':
+            decl = ('uint8_t %s%s[MAX_VALUE_SIZE];\n'
+                    '    size_t %s_size%s;') % (name, dim, name, dim)
+        else:
+            decl = 'objlnk_value_t %s%s;' % (name, dim)
+
+        if self.multiple:
+            decl += ('\n    anjay_riid_t %s_riids[MAX_RESOURCE_INSTANCES];'
+                     '\n    size_t %s_count;') % (name, name)
+        return decl
+
+    def _fast_ret_expr(self, ctx: str, index: str) -> str:
+        value = 'inst->%s%s' % (self.field_name, index)
+        if self.fast_type in _FAST_SCALAR_TYPES:
+            return _FAST_SCALAR_TYPES[self.fast_type][1] % (ctx, value)
+        elif self.fast_type == 'string':
+            return 'anjay_ret_string(%s, %s)' % (ctx, value)
+        elif self.fast_type == 'opaque':
+            return 'anjay_ret_bytes(%s, %s, inst->%s_size%s)' % (ctx, value, self.field_name, index)
+        else:
+            return 'anjay_ret_objlnk(%s, %s.oid, %s.iid)' % (ctx, value, value)
+
+    @property
+    def fast_read_handler(self) -> Optional[str]:
+        if 'R' not in self.operations:
+            return None
+        if self.fast_type is None:
+            return 'return ANJAY_ERR_NOT_IMPLEMENTED; // TODO'
+
+        if not self.multiple:
+            return 'return %s;' % (self._fast_ret_expr('ctx', ''),)
+        else:
+            return textwrap.dedent("""\
+                    {
+                        anjay_output_ctx_t *array = anjay_ret_array_start(ctx);
+                        if (!array) {
+                            return ANJAY_ERR_INTERNAL;
+                        }
+                        for (size_t i = 0; i < inst->%s_count; ++i) {
+                            int result;
+                            if ((result = anjay_ret_array_index(array, inst->%s_riids[i]))
+                                    || (result = %s)) {
+                                return result;
+                            }
+                        }
+                        return anjay_ret_array_finish(array);
+                    }
+                    """) % (self.field_name, self.field_name, self._fast_ret_expr('array', '[i]'))
+
+    def _fast_get_stmts(self, ctx: str, target: str, size_target: str) -> str:
+        """
+        Returns statements that read a value from ctx into target, setting
+        `result` and returning early on error.
+        """
+        if self.fast_type in _FAST_SCALAR_TYPES:
+            return 'if ((result = %s)) {\n    return result;\n}' % (
+                    _FAST_SCALAR_TYPES[self.fast_type][2] % (ctx, target),)
+        elif self.fast_type == 'string':
+            return ('if ((result = anjay_get_string(%s, %s, sizeof(%s)))) {\n'
+                    '    return result == ANJAY_BUFFER_TOO_SHORT ? ANJAY_ERR_BAD_REQUEST : result;\n'
+                    '}') % (ctx, target, target)
+        elif self.fast_type == 'opaque':
+            return ('bool finished;\n'
+                    'if ((result = anjay_get_bytes(%s, &%s, &finished, %s, sizeof(%s)))) {\n'
+                    '    return result;\n'
+                    '} else if (!finished) {\n'
+                    '    return ANJAY_ERR_BAD_REQUEST;\n'
+                    '}') % (ctx, size_target, target, target)
+        else:
+            return ('if ((result = anjay_get_objlnk(%s, &%s.oid, &%s.iid))) {\n'
+                    '    return result;\n'
+                    '}') % (ctx, target, target)
+
+    @property
+    def fast_write_handler(self) -> Optional[str]:
+        if 'W' not in self.operations:
+            return None
+        if self.fast_type is None:
+            return 'return ANJAY_ERR_NOT_IMPLEMENTED; // TODO'
+
+        name = self.field_name
+        if not self.multiple:
+            if self.fast_type in _FAST_SCALAR_TYPES:
+                local = '%s value' % (_FAST_SCALAR_TYPES[self.fast_type][0],)
+                store = 'inst->%s = value;' % (name,)
+            elif self.fast_type == 'string':
+                local = 'char value[MAX_VALUE_SIZE]'
+                store = 'memcpy(inst->%s, value, sizeof(value));' % (name,)
+            elif self.fast_type == 'opaque':
+                local = 'uint8_t value[MAX_VALUE_SIZE];\nsize_t size'
+                store = 'memcpy(inst->%s, value, size);\ninst->%s_size = size;' % (name, name)
+            else:
+                local = 'objlnk_value_t value'
+                store = 'inst->%s = value;' % (name,)
+            body = '%s;\nint result;\n%s\n%s\nbitmap_set(inst->present, %s);\nreturn 0;' % (
+                    local, self._fast_get_stmts('ctx', 'value', 'size'), store, self.index_name)
+        else:
+            read_value = self._fast_get_stmts('array', 'inst->%s[count]' % (name,),
+                                              'inst->%s_size[count]' % (name,))
+            body = textwrap.dedent("""\
+                    anjay_input_ctx_t *array = anjay_get_array(ctx);
+                    if (!array) {
+                        return ANJAY_ERR_INTERNAL;
+                    }
+
+                    size_t count = 0;
+                    anjay_riid_t riid;
+                    int result;
+                    while (!(result = anjay_get_array_index(array, &riid))) {
+                        if (count >= MAX_RESOURCE_INSTANCES) {
+                            return ANJAY_ERR_BAD_REQUEST;
+                        }
+                        inst->%s_riids[count] = riid;
+                    %s
+                        ++count;
+                    }
+                    if (result != ANJAY_GET_INDEX_END) {
+                        return result;
+                    }
+                    inst->%s_count = count;
+                    bitmap_set(inst->present, %s);
+                    return 0;""") % (name, textwrap.indent(read_value, '    '), name, self.index_name)
+        return '{\n%s\n}' % (textwrap.indent(body, '    '),)
+
     @property
     def read_handler(self) -> Optional[str]:
         if 'R' not in self.operations:
@@ -593,6 +1239,14 @@ class ObjectDef(collections.namedtuple('ObjectDef',
     def has_any_multiple_resources(self) -> bool:
         return any(res.multiple for res in self.resources)
 
+    @property
+    def has_any_buffer_resources(self) -> bool:
+        return any(res.fast_type in ('string', 'opaque') for res in self.resources)
+
+    @property
+    def has_any_objlnk_resources(self) -> bool:
+        return any(res.fast_type == 'objlnk' for res in self.resources)
+
     @property
     def needs_instance_reset_handler(self) -> bool:
         return self.multiple or self.has_any_writable_resources
@@ -609,7 +1263,27 @@ class ObjectDef(collections.namedtuple('ObjectDef',
                                     key=operator.attrgetter('rid')))
 
 
-def generate_object_boilerplate(obj_ddf_xml: str, cxx: bool):
+def _template_args(obj: ObjectDef) -> dict:
+    return dict(obj=obj,
+                date_time=datetime.datetime.now().strftime('%Y-%m-%d %H:%M:%S'),
+                obj_name_snake=obj.name_snake,
+                obj_repr_tag=obj.name_snake + '_struct',
+                obj_repr_type=obj.name_snake + '_t',
+                obj_inst_tag=obj.name_snake + '_instance_struct',
+                obj_inst_type=obj.name_snake + '_instance_t')
+
+
+def _fast_template_args(obj: ObjectDef) -> dict:
+    count = len(obj.resources)
+    indices = lambda pred: [i for i, res in enumerate(obj.resources) if pred(res)]
+    bitmaps = dict(mandatory=_bitmap_initializer(indices(lambda res: res.mandatory), count),
+                   readable=_bitmap_initializer(indices(lambda res: 'R' in res.operations), count),
+                   writable=_bitmap_initializer(indices(lambda res: 'W' in res.operations), count),
+                   executable=_bitmap_initializer(indices(lambda res: 'E' in res.operations), count))
+    return dict(bitmap_words=_bitmap_words(count), bitmaps=bitmaps)
+
+
+def generate_object_boilerplate(obj_ddf_xml: str, cxx: bool, fast: bool = False):
     tree = ElementTree.fromstring(obj_ddf_xml)
     obj = ObjectDef.from_etree(tree.find('Object'))
 
@@ -629,9 +1303,15 @@ def generate_object_boilerplate(obj_ddf_xml: str, cxx: bool):
         handlers.append(('instance_reset', 'instance_reset'))
 
     handlers.append('')
-    handlers.append(('resource_present', 'anjay_dm_resource_present_TRUE'))
+    if fast:
+        handlers.append(('resource_present', 'resource_present'))
+        handlers.append(('resource_operations', 'resource_operations'))
+    else:
+        handlers.append(('resource_present', 'anjay_dm_resource_present_TRUE'))
     if obj.has_any_readable_resources:
         handlers.append(('resource_read', 'resource_read'))
+        if fast:
+            handlers.append(('instance_read', 'instance_read'))
     if obj.has_any_writable_resources:
         handlers.append(('resource_write', 'resource_write'))
     if obj.has_any_executable_resources:
@@ -650,15 +1330,23 @@ def generate_object_boilerplate(obj_ddf_xml: str, cxx: bool):
                 .from_string(CXX_OBJDEF_TEMPLATE if cxx else C_OBJDEF_TEMPLATE)
                 .render(oid=obj.oid, resources=obj.resources, handlers=handlers))
 
-    return (jinja_env.from_string(TEMPLATE)
-                .render(obj=obj,
-                        date_time=datetime.datetime.now().strftime('%Y-%m-%d %H:%M:%S'),
-                        obj_name_snake=obj.name_snake,
-                        obj_repr_tag=obj.name_snake + '_struct',
-                        obj_repr_type=obj.name_snake + '_t',
-                        obj_inst_tag=obj.name_snake + '_instance_struct',
-                        obj_inst_type=obj.name_snake + '_instance_t',
-                        cdef=cdef))
+    args = _template_args(obj)
+    if fast:
+        args.update(_fast_template_args(obj))
+    return (jinja_env.from_string(FAST_TEMPLATE if fast else TEMPLATE)
+                .render(cdef=cdef, **args))
+
+
+def generate_object_test(obj_ddf_xml: str, object_source: str):
+    tree = ElementTree.fromstring(obj_ddf_xml)
+    obj = ObjectDef.from_etree(tree.find('Object'))
+
+    used_rids = set(res.rid for res in obj.resources)
+    unknown_rid = next(rid for rid in range(65535) if rid not in used_rids)
+
+    return (Environment(trim_blocks=True)
+                .from_string(FAST_TEST_TEMPLATE)
+                .render(object_source=object_source, unknown_rid=unknown_rid, **_template_args(obj)))
 
 
 if __name__ == '__main__':
@@ -666,6 +1354,12 @@ if __name__ == '__main__':
     parser.add_argument('-i', '--input', help='Input filename or - to read from stdin')
     parser.add_argument('-o', '--output', default='/dev/stdout', help='Output filename (default: stdout)')
     parser.add_argument('-x', '--c++', dest='cxx', action='store_true', help='Generate C++ code (default: C)')
+    parser.add_argument('-f', '--fast', action='store_true',
+                        help='Generate an object backed by a fixed-size instance array with typed Resource fields '
+                             'and compile-time Resource bitmaps, instead of a stub over an AVS_LIST')
+    parser.add_argument('-t', '--test-output',
+                        help='Also generate a unit test for the object into this file; requires --fast and an '
+                             '--output file that the test will #include')
 
     args = parser.parse_args()
     if args.input == '-':
@@ -673,12 +1367,16 @@ if __name__ == '__main__':
     if args.output == '-':
         args.output = '/dev/stdout'
 
-    if args.input is None:
+    if args.input is None or (args.test_output and (not args.fast or args.output == '/dev/stdout')):
         parser.print_usage()
         sys.exit(1)
 
     with open(args.input) as f:
-        boilerplate = generate_object_boilerplate(f.read(), args.cxx)
+        obj_ddf_xml = f.read()
 
     with open(args.output, 'w') as f:
-        print(boilerplate, file=f)
+        print(generate_object_boilerplate(obj_ddf_xml, args.cxx, args.fast), file=f)
+
+    if args.test_output:
+        with open(args.test_output, 'w') as f:
+            print(generate_object_test(obj_ddf_xml, os.path.basename(args.output)), file=f)